@@ -29,34 +29,44 @@ bool CmdLineParser::isTokenName(const AnsiStr& str) {
 	return (str.firstChar() == '-');
 }
 
-bool CmdLineParser::add_option(const AnsiStr& name, const AnsiStr& desc, const Value& defval) {
-
-	if(name.length() == 0)
-		return false;
-
-	CmdOption cmdOp;
-	cmdOp.desc = desc;
-	cmdOp.value = defval;
-	cmdOp.shortcut = "";
+AnsiStr CmdLineParser::registerShortcut(const AnsiStr& name, const AnsiStr& shortcut) {
+	//requested shortcut
+	if(shortcut.length() > 0) {
+		if(m_shortcuts.find(shortcut.cptr()) == m_shortcuts.end()) {
+			m_shortcuts.insert( std::make_pair(shortcut.cptr(), name.cptr()));
+			return shortcut;
+		}
+		LogWarningArg2("Shortcut %s is taken. Picking another one for option: %s", shortcut.cptr(), name.cptr());
+	}
 
 	//register shortcut if not present
 	for(int i=0; i < name.length() - 1; i++) {
-		AnsiStr shortcut = name.substr(i, 1);
-		if(m_shortcuts.find(shortcut.cptr()) == m_shortcuts.end()) {
-			cmdOp.shortcut = shortcut;
-			m_shortcuts.insert( std::make_pair(shortcut.cptr(), name.cptr()));
-			break;
+		AnsiStr candidate = name.substr(i, 1);
+		if(m_shortcuts.find(candidate.cptr()) == m_shortcuts.end()) {
+			m_shortcuts.insert( std::make_pair(candidate.cptr(), name.cptr()));
+			return candidate;
 		}
 	}
 
 	//if there is no shortcut
-	if(cmdOp.shortcut.length() == 0)
-		LogWarningArg1("No shortcut registered for option: %s", name.cptr());
+	LogWarningArg1("No shortcut registered for option: %s", name.cptr());
+	return AnsiStr("");
+}
+
+bool CmdLineParser::add_option(const AnsiStr& name, const AnsiStr& desc, const Value& defval, const AnsiStr& shortcut) {
+
+	if(name.length() == 0)
+		return false;
+
+	CmdOption cmdOp;
+	cmdOp.desc = desc;
+	cmdOp.value = defval;
+	cmdOp.shortcut = registerShortcut(name, shortcut);
 
 	return this->add(cmdOp, name.cptr());
 }
 
-bool CmdLineParser::add_toggle(const AnsiStr& name, const AnsiStr& desc) {
+bool CmdLineParser::add_toggle(const AnsiStr& name, const AnsiStr& desc, const AnsiStr& shortcut) {
 	if(name.length() == 0)
 		return false;
 
@@ -64,21 +74,7 @@ bool CmdLineParser::add_toggle(const AnsiStr& name, const AnsiStr& desc) {
 	cmdOp.toggle = true;
 	cmdOp.desc = desc;
 	cmdOp.value = (int)0;
-	cmdOp.shortcut = "";
-
-	//register shortcut if not present
-	for(int i=0; i < name.length() - 1; i++) {
-		AnsiStr shortcut = name.substr(i, 1);
-		if(m_shortcuts.find(shortcut.cptr()) == m_shortcuts.end()) {
-			cmdOp.shortcut = shortcut;
-			m_shortcuts.insert( std::make_pair(shortcut.cptr(), name.cptr()));
-			break;
-		}
-	}
-
-	//if there is no shortcut
-	if(cmdOp.shortcut.length() == 0)
-		LogWarningArg1("No shortcut registered for option: %s", name.cptr());
+	cmdOp.shortcut = registerShortcut(name, shortcut);
 
 	return this->add(cmdOp, name.cptr());
 }
@@ -92,7 +88,7 @@ int CmdLineParser::parse(int argc, char* argv[]) {
 			strName = strName.substr(1);
 
 			//resolve shortcut
-			if (strName.length() == 1) {
+			if (!this->has(strName.cptr())) {
 				string temp = string(strName.c_str());
 				if (m_shortcuts.find(temp) != m_shortcuts.end())
 					strName = AnsiStr(m_shortcuts[temp].c_str());
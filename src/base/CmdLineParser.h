@@ -46,8 +46,9 @@ public:
 	virtual ~CmdLineParser();
 
 	void printHelp() const;
-	bool add_option(const AnsiStr& name, const AnsiStr& desc, const Value& defval);
-	bool add_toggle(const AnsiStr& name, const AnsiStr& desc);
+	//an empty shortcut takes the first free letter of the name
+	bool add_option(const AnsiStr& name, const AnsiStr& desc, const Value& defval, const AnsiStr& shortcut = AnsiStr(""));
+	bool add_toggle(const AnsiStr& name, const AnsiStr& desc, const AnsiStr& shortcut = AnsiStr(""));
 	int parse(int argc, char* argv[]);
 
 	template <typename value_type>
@@ -57,6 +58,9 @@ public:
 
 
 	static bool isTokenName(const AnsiStr& str);
+protected:
+	AnsiStr registerShortcut(const AnsiStr& name, const AnsiStr& shortcut);
+
 protected:
 	std::map<string, string> m_shortcuts;
 };
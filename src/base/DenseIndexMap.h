@@ -0,0 +1,136 @@
+/*
+ * DenseIndexMap.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef DENSEINDEXMAP_H_
+#define DENSEINDEXMAP_H_
+
+#include "MathBase.h"
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace PS {
+
+/*!
+ * Map from small integer keys such as mesh handles to values. Every key owns a slot in a
+ * dense array that points into a compact list of entries, so a lookup is one indexed load
+ * and iteration only visits the entries. Slots are stamped with a generation and clear()
+ * only bumps the generation. Entries are kept in insertion order until an erase moves the
+ * last entry into the gap.
+ */
+template <typename V>
+class DenseIndexMap {
+public:
+	typedef std::pair<U32, V> ENTRY;
+	typedef typename vector<ENTRY>::iterator iterator;
+	typedef typename vector<ENTRY>::const_iterator const_iterator;
+
+	DenseIndexMap() {
+		m_generation = 1;
+	}
+
+	//number of entries
+	U32 size() const { return m_vEntries.size();}
+	bool empty() const { return m_vEntries.empty();}
+
+	//number of keys with a slot
+	U32 countKeys() const { return m_vSlots.size();}
+
+	//drops all entries in constant time
+	void clear() {
+		m_vEntries.clear();
+		m_generation++;
+
+		//stamps restart after a wrap around
+		if(m_generation == 0) {
+			m_vSlots.assign(m_vSlots.size(), SLOT());
+			m_generation = 1;
+		}
+	}
+
+	//makes room for the keys in [0, ctKeys)
+	void reserveKeys(U32 ctKeys) {
+		if(ctKeys > m_vSlots.size())
+			m_vSlots.resize(ctKeys);
+	}
+
+	/*!
+	 * inserts a new key. Existing keys are not overwritten.
+	 * @return true if the key was inserted
+	 */
+	bool insert(U32 key, const V& value) {
+		if(contains(key))
+			return false;
+
+		if(key >= m_vSlots.size())
+			m_vSlots.resize(MATHMAX((U32)m_vSlots.size() * 2, key + 1));
+
+		m_vSlots[key].generation = m_generation;
+		m_vSlots[key].idxEntry = m_vEntries.size();
+		m_vEntries.push_back(ENTRY(key, value));
+		return true;
+	}
+
+	bool insert(const ENTRY& entry) { return insert(entry.first, entry.second);}
+
+	//returns NULL if the key is not found
+	V* find(U32 key) {
+		return contains(key) ? &m_vEntries[m_vSlots[key].idxEntry].second : NULL;
+	}
+
+	const V* find(U32 key) const {
+		return contains(key) ? &m_vEntries[m_vSlots[key].idxEntry].second : NULL;
+	}
+
+	bool contains(U32 key) const {
+		return (key < m_vSlots.size()) && (m_vSlots[key].generation == m_generation);
+	}
+
+	//removes a key and moves the last entry into its place
+	bool erase(U32 key) {
+		if(!contains(key))
+			return false;
+
+		U32 idxEntry = m_vSlots[key].idxEntry;
+		if(idxEntry + 1 < m_vEntries.size()) {
+			m_vEntries[idxEntry] = m_vEntries.back();
+			m_vSlots[m_vEntries[idxEntry].first].idxEntry = idxEntry;
+		}
+
+		m_vEntries.pop_back();
+		m_vSlots[key].generation = 0;
+		return true;
+	}
+
+	//entries
+	iterator begin() { return m_vEntries.begin();}
+	iterator end() { return m_vEntries.end();}
+	const_iterator begin() const { return m_vEntries.begin();}
+	const_iterator end() const { return m_vEntries.end();}
+
+	const ENTRY& entryAt(U32 i) const { return m_vEntries[i];}
+
+private:
+	struct SLOT {
+		U32 generation;
+		U32 idxEntry;
+
+		SLOT() {
+			generation = 0;
+			idxEntry = 0;
+		}
+	};
+
+	vector<SLOT> m_vSlots;
+	vector<ENTRY> m_vEntries;
+	U32 m_generation;
+};
+
+}
+
+#endif /* DENSEINDEXMAP_H_ */
@@ -0,0 +1,203 @@
+/*
+ * FlatHashMap.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef FLATHASHMAP_H_
+#define FLATHASHMAP_H_
+
+#include "MathBase.h"
+#include <vector>
+
+using namespace std;
+
+namespace PS {
+
+/*!
+ * Open addressing hash table with 64-bit integer keys and linear probing. All entries
+ * live in two flat arrays so lookups touch at most a few consecutive cache lines.
+ * Erase uses backward shift deletion so no tombstones are left behind.
+ */
+template <typename V>
+class FlatHashMap {
+public:
+	//reserved key marks empty slots
+	static const U64 EMPTY_KEY = (U64)-1;
+
+	FlatHashMap() {
+		m_count = 0;
+		m_mask = 0;
+	}
+
+	explicit FlatHashMap(U32 ctExpected) {
+		m_count = 0;
+		m_mask = 0;
+		reserve(ctExpected);
+	}
+
+	//number of entries
+	U32 size() const { return m_count;}
+	bool empty() const { return (m_count == 0);}
+	U32 capacity() const { return m_vKeys.size();}
+
+	void clear() {
+		m_vKeys.assign(m_vKeys.size(), EMPTY_KEY);
+		m_count = 0;
+	}
+
+	//makes room for ct entries without rehashing
+	void reserve(U32 ct) {
+		U32 cap = 16;
+		while(cap * MAX_LOAD_NUM < ct * MAX_LOAD_DEN)
+			cap <<= 1;
+
+		if(cap > m_vKeys.size())
+			rehash(cap);
+	}
+
+	/*!
+	 * inserts a new key. Existing keys are not overwritten.
+	 * @return true if the key was inserted
+	 */
+	bool insert(U64 key, const V& value) {
+		if(key == EMPTY_KEY)
+			return false;
+
+		if((m_count + 1) * MAX_LOAD_DEN > m_vKeys.size() * MAX_LOAD_NUM)
+			rehash(MATHMAX((U32)m_vKeys.size() * 2, (U32)16));
+
+		U32 slot = Hash(key) & m_mask;
+		while(m_vKeys[slot] != EMPTY_KEY) {
+			if(m_vKeys[slot] == key)
+				return false;
+			slot = (slot + 1) & m_mask;
+		}
+
+		m_vKeys[slot] = key;
+		m_vValues[slot] = value;
+		m_count++;
+		return true;
+	}
+
+	//inserts or overwrites
+	void set(U64 key, const V& value) {
+		V* pval = find(key);
+		if(pval)
+			*pval = value;
+		else
+			insert(key, value);
+	}
+
+	//returns NULL if the key is not found
+	V* find(U64 key) {
+		U32 slot = findSlot(key);
+		return (slot == INVALID_SLOT) ? NULL : &m_vValues[slot];
+	}
+
+	const V* find(U64 key) const {
+		U32 slot = findSlot(key);
+		return (slot == INVALID_SLOT) ? NULL : &m_vValues[slot];
+	}
+
+	bool contains(U64 key) const { return (findSlot(key) != INVALID_SLOT);}
+
+	//removes a key and closes the gap in its probe sequence
+	bool erase(U64 key) {
+		U32 hole = findSlot(key);
+		if(hole == INVALID_SLOT)
+			return false;
+
+		U32 slot = hole;
+		while(true) {
+			slot = (slot + 1) & m_mask;
+			if(m_vKeys[slot] == EMPTY_KEY)
+				break;
+
+			//move back entries whose home slot is not within (hole, slot]
+			U32 home = Hash(m_vKeys[slot]) & m_mask;
+			if(((slot - home) & m_mask) >= ((slot - hole) & m_mask)) {
+				m_vKeys[hole] = m_vKeys[slot];
+				m_vValues[hole] = m_vValues[slot];
+				hole = slot;
+			}
+		}
+
+		m_vKeys[hole] = EMPTY_KEY;
+		m_count--;
+		return true;
+	}
+
+	//visits all entries in slot order: f(key, value)
+	template <typename Func>
+	void for_each(Func f) {
+		for(U32 i=0; i < m_vKeys.size(); i++) {
+			if(m_vKeys[i] != EMPTY_KEY)
+				f(m_vKeys[i], m_vValues[i]);
+		}
+	}
+
+	//64-bit finalizer from murmurhash3
+	static inline U32 Hash(U64 key) {
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return (U32)key;
+	}
+
+protected:
+	static const U32 INVALID_SLOT = (U32)-1;
+
+	//maximum load factor is 7/10
+	static const U32 MAX_LOAD_NUM = 7;
+	static const U32 MAX_LOAD_DEN = 10;
+
+	U32 findSlot(U64 key) const {
+		if(m_count == 0 || key == EMPTY_KEY)
+			return INVALID_SLOT;
+
+		U32 slot = Hash(key) & m_mask;
+		while(m_vKeys[slot] != EMPTY_KEY) {
+			if(m_vKeys[slot] == key)
+				return slot;
+			slot = (slot + 1) & m_mask;
+		}
+
+		return INVALID_SLOT;
+	}
+
+	void rehash(U32 cap) {
+		vector<U64> vOldKeys;
+		vector<V> vOldValues;
+		vOldKeys.swap(m_vKeys);
+		vOldValues.swap(m_vValues);
+
+		m_vKeys.assign(cap, EMPTY_KEY);
+		m_vValues.resize(cap);
+		m_mask = cap - 1;
+		m_count = 0;
+
+		for(U32 i=0; i < vOldKeys.size(); i++) {
+			if(vOldKeys[i] != EMPTY_KEY)
+				insert(vOldKeys[i], vOldValues[i]);
+		}
+	}
+
+private:
+	vector<U64> m_vKeys;
+	vector<V> m_vValues;
+	U32 m_count;
+	U32 m_mask;
+};
+
+template <typename V> const U64 FlatHashMap<V>::EMPTY_KEY;
+template <typename V> const U32 FlatHashMap<V>::INVALID_SLOT;
+template <typename V> const U32 FlatHashMap<V>::MAX_LOAD_NUM;
+template <typename V> const U32 FlatHashMap<V>::MAX_LOAD_DEN;
+
+}
+
+#endif /* FLATHASHMAP_H_ */
@@ -0,0 +1,101 @@
+/*
+ * LatencyHistogram.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "LatencyHistogram.h"
+#include <math.h>
+
+#define LATENCY_NO_VALUE	0xFFFFFFFFFFFFFFFFULL
+
+namespace PS {
+
+LatencyHistogram::LatencyHistogram() {
+	reset();
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& rhs) {
+	reset();
+	merge(rhs);
+}
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& rhs) {
+	if(this != &rhs) {
+		reset();
+		merge(rhs);
+	}
+	return *this;
+}
+
+void LatencyHistogram::reset() {
+	for(U32 i=0; i < LATENCY_BUCKETS; i++)
+		m_buckets[i].store(0, std::memory_order_relaxed);
+	m_total.store(0, std::memory_order_relaxed);
+	m_lowest.store(LATENCY_NO_VALUE, std::memory_order_relaxed);
+	m_highest.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& rhs) {
+	for(U32 i=0; i < LATENCY_BUCKETS; i++) {
+		U64 ct = rhs.m_buckets[i].load(std::memory_order_relaxed);
+		if(ct > 0)
+			m_buckets[i].store(m_buckets[i].load(std::memory_order_relaxed) + ct, std::memory_order_relaxed);
+	}
+
+	m_total.store(total() + rhs.total(), std::memory_order_relaxed);
+	if(rhs.highest() > highest())
+		m_highest.store(rhs.highest(), std::memory_order_relaxed);
+	if(rhs.m_lowest.load(std::memory_order_relaxed) < m_lowest.load(std::memory_order_relaxed))
+		m_lowest.store(rhs.m_lowest.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+//the buckets are the reference so the count matches the percentiles under concurrent writes
+U64 LatencyHistogram::count() const {
+	U64 ct = 0;
+	for(U32 i=0; i < LATENCY_BUCKETS; i++)
+		ct += m_buckets[i].load(std::memory_order_relaxed);
+	return ct;
+}
+
+U64 LatencyHistogram::lowest() const {
+	U64 value = m_lowest.load(std::memory_order_relaxed);
+	return (value == LATENCY_NO_VALUE) ? 0 : value;
+}
+
+U64 LatencyHistogram::BucketHighestValue(U32 idxBucket) {
+	if(idxBucket < 2 * LATENCY_SUB_BUCKETS)
+		return idxBucket;
+
+	U32 shift = idxBucket / LATENCY_SUB_BUCKETS - 1;
+	U64 lower = (U64)(idxBucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS) << shift;
+	return lower + ((1ULL << shift) - 1);
+}
+
+U64 LatencyHistogram::valueAtPercentile(double percent) const {
+	U64 ct = count();
+	if(ct == 0)
+		return 0;
+
+	percent = MATHMIN(MATHMAX(percent, 0.0), 100.0);
+	U64 target = (U64)ceil(percent * 0.01 * (double)ct);
+	target = MATHMAX(target, (U64)1);
+
+	//exact at both ends
+	if(target == 1)
+		return lowest();
+
+	U64 accum = 0;
+	for(U32 i=0; i < LATENCY_BUCKETS; i++) {
+		accum += m_buckets[i].load(std::memory_order_relaxed);
+		if(accum >= target) {
+			U64 value = BucketHighestValue(i);
+			return MATHMAX(MATHMIN(value, highest()), lowest());
+		}
+	}
+
+	return highest();
+}
+
+}
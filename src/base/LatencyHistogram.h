@@ -0,0 +1,88 @@
+/*
+ * LatencyHistogram.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <atomic>
+#include "MathBase.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//sub buckets per power of two. Values are kept within 1/32 of their magnitude.
+#define LATENCY_SUB_BUCKET_BITS	5
+#define LATENCY_SUB_BUCKETS		(1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKETS			((65 - LATENCY_SUB_BUCKET_BITS) * LATENCY_SUB_BUCKETS)
+
+namespace PS {
+
+/*!
+ * Log linear histogram of durations in the style of HdrHistogram. Values below
+ * 2 * LATENCY_SUB_BUCKETS are exact and larger ones fall into buckets whose width is 1/32
+ * of their power of two, so percentiles are within about 3% for any range of values.
+ * Only one thread records into a histogram. Others may read or merge it concurrently and
+ * see a slightly stale state.
+ */
+class LatencyHistogram {
+public:
+	LatencyHistogram();
+	LatencyHistogram(const LatencyHistogram& rhs);
+	LatencyHistogram& operator=(const LatencyHistogram& rhs);
+
+	void reset();
+
+	//owner thread
+	inline void record(U64 value) {
+		U32 idxBucket = BucketIndex(value);
+		m_buckets[idxBucket].store(m_buckets[idxBucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		m_total.store(m_total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		if(value > m_highest.load(std::memory_order_relaxed))
+			m_highest.store(value, std::memory_order_relaxed);
+		if(value < m_lowest.load(std::memory_order_relaxed))
+			m_lowest.store(value, std::memory_order_relaxed);
+	}
+
+	//adds the values of another histogram
+	void merge(const LatencyHistogram& rhs);
+
+	U64 count() const;
+	U64 total() const { return m_total.load(std::memory_order_relaxed);}
+	U64 lowest() const;
+	U64 highest() const { return m_highest.load(std::memory_order_relaxed);}
+
+	//value at or below which the given percent [0, 100] of the recorded values fall
+	U64 valueAtPercentile(double percent) const;
+
+	static inline U32 BucketIndex(U64 value) {
+		if(value < 2 * LATENCY_SUB_BUCKETS)
+			return (U32)value;
+
+#ifdef _MSC_VER
+		unsigned long msb;
+		_BitScanReverse64(&msb, value);
+#else
+		U32 msb = 63 - __builtin_clzll(value);
+#endif
+		U32 shift = msb - LATENCY_SUB_BUCKET_BITS;
+		return (shift + 1) * LATENCY_SUB_BUCKETS + (U32)(value >> shift) - LATENCY_SUB_BUCKETS;
+	}
+
+	//largest value that falls into the bucket
+	static U64 BucketHighestValue(U32 idxBucket);
+
+private:
+	std::atomic<U64> m_buckets[LATENCY_BUCKETS];
+	std::atomic<U64> m_total;
+	std::atomic<U64> m_lowest;
+	std::atomic<U64> m_highest;
+};
+
+}
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -3,6 +3,8 @@
 #include "MathBase.h"
 #include <fstream>
 #include <stdexcept>
+#include <string.h>
+#include <chrono>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -18,6 +20,11 @@ namespace PS{
 
 	void psLog(const char* lpDesc, ...)
 	{
+		//filtered before any formatting
+		EventLogger& logger = TheEventLogger::Instance();
+		if(!logger.isEnabled(EventLogger::etInfo))
+			return;
+
 		va_list	vl;
 		va_start( vl, lpDesc );
 
@@ -29,12 +36,16 @@ namespace PS{
 #endif
 		va_end( vl );
 
-		TheEventLogger::Instance().add(buff, EventLogger::etInfo);
+		logger.add(buff, EventLogger::etInfo);
 	}
 
 	//Log a single line
 	void psLog(EventLogger::EVENTTYPE etype, const char* lpSource, int line, const char* lpDesc, ...)
 	{
+		EventLogger& logger = TheEventLogger::Instance();
+		if(!logger.isEnabled(etype))
+			return;
+
 		va_list	vl;
 		va_start( vl, lpDesc );
 
@@ -46,7 +57,7 @@ namespace PS{
 #endif
 		va_end( vl );
 
-		TheEventLogger::Instance().add(buff, etype, lpSource, line);
+		logger.add(buff, etype, lpSource, line);
 	}
 
 
@@ -57,6 +68,14 @@ namespace PS{
 		m_strFP = ChangeFileExt(GetExePath(), AnsiStr(".log"));
         m_strRootPath = ExtractOneLevelUp(ExtractFilePath(GetExePath()));
 		m_szBufferSize = 0;
+		m_eventMask.store(emAll);
+		m_isAsync.store(false);
+		m_ctProducers.store(0);
+		m_ctDropped.store(0);
+		m_ctDroppedReported = 0;
+		m_lpQueue = NULL;
+		m_isStopping = false;
+		m_ctFlushRequests = m_ctFlushed = 0;
 		setWriteFlags(PS_LOG_WRITE_EVENTTYPE | PS_LOG_WRITE_SOURCE | PS_LOG_WRITE_TO_SCREEN);
 	}
 
@@ -65,12 +84,22 @@ namespace PS{
 		m_fOnDisplay = NULL;
 		m_strFP = AnsiStr(lpFilePath);
 		m_szBufferSize = 0;
+		m_eventMask.store(emAll);
+		m_isAsync.store(false);
+		m_ctProducers.store(0);
+		m_ctDropped.store(0);
+		m_ctDroppedReported = 0;
+		m_lpQueue = NULL;
+		m_isStopping = false;
+		m_ctFlushRequests = m_ctFlushed = 0;
 		setWriteFlags(flags);
 	}
 
 	EventLogger::~EventLogger()
 	{
-		flush();
+		stopWriter();
+		writeToDisk();
+		SAFE_DELETE_ARRAY(m_lpQueue);
 	}
 
 	void EventLogger::setWriteFlags(int flags)
@@ -80,6 +109,11 @@ namespace PS{
 		m_bWriteSourceInfo = ((flags & PS_LOG_WRITE_SOURCE) != 0);		
 		m_bWriteToScreen   = ((flags & PS_LOG_WRITE_TO_SCREEN) != 0);
 		m_bWriteToModal    = ((flags & PS_LOG_WRITE_TO_MODAL) != 0);
+
+		if((flags & PS_LOG_WRITE_ASYNC) != 0)
+			startWriter();
+		else
+			stopWriter();
 	}
 
 	void EventLogger::setOutFilePath(const char* lpStrFilePath)
@@ -96,9 +130,28 @@ namespace PS{
 	void EventLogger::add(const char* lpStrDesc, EVENTTYPE t, 
 		const char* lpStrSource, int value)
 	{
-		if(lpStrDesc == NULL)
+		if(lpStrDesc == NULL || !isEnabled(t))
 			return;
 
+		//the writer thread does the rest. The second check pairs with stopWriter: either this
+		//producer sees the writer stopping and logs in sync, or stopWriter waits for it.
+		if(isAsync()) {
+			m_ctProducers.fetch_add(1);
+			bool isQueued = m_isAsync.load() && enqueue(lpStrDesc, t, lpStrSource, value);
+			m_ctProducers.fetch_sub(1, std::memory_order_release);
+			if(isQueued)
+				return;
+		}
+
+		time_t rawtime = 0;
+		if(m_bWriteTimeStamps)
+			time(&rawtime);
+		addFormatted(formatEvent(lpStrDesc, t, lpStrSource, value, rawtime));
+	}
+
+	AnsiStr EventLogger::formatEvent(const char* lpStrDesc, EVENTTYPE t, const char* lpStrSource,
+									 int value, time_t rawtime) const
+	{
 		AnsiStr strEvent;			
 		//Write Event Type
 		if(m_bWriteEventTypes)
@@ -116,8 +169,6 @@ namespace PS{
 		//Write Event Time
 		if(m_bWriteTimeStamps)
 		{
-			time_t rawtime;
-			time (&rawtime);
 #ifdef PS_SECURE_API
 			char buffer[64];
 			struct tm timeinfo;
@@ -143,6 +194,12 @@ namespace PS{
 
 		//Write Event itself
 		strEvent += AnsiStr(lpStrDesc);			
+		return strEvent;
+	}
+
+	void EventLogger::addFormatted(const AnsiStr& strEvent)
+	{
+		std::lock_guard<std::mutex> lock(m_lockLog);
 		m_lstLog.push_back(strEvent);
 
 		//Write Message to screen
@@ -152,7 +209,7 @@ namespace PS{
 		//Update Buffer size and Flush if ready
 		m_szBufferSize += strEvent.length();
 		if(m_szBufferSize > PS_LOG_BUFFER_SIZE)
-			flush();
+			writeToDiskLocked();
 	}
 
 	void EventLogger::display(const char* chrMessage) const
@@ -176,8 +233,27 @@ namespace PS{
 	}
 
 
-	//Open File and Append
 	bool EventLogger::flush()
+	{
+		if(!isAsync())
+			return writeToDisk();
+
+		//wait for the writer to drain everything queued before this call
+		std::unique_lock<std::mutex> lock(m_lockWriter);
+		U64 ticket = ++m_ctFlushRequests;
+		m_cvWake.notify_one();
+		m_cvFlushed.wait(lock, [&] { return m_ctFlushed >= ticket || m_isStopping; });
+		return true;
+	}
+
+	bool EventLogger::writeToDisk()
+	{
+		std::lock_guard<std::mutex> lock(m_lockLog);
+		return writeToDiskLocked();
+	}
+
+	//Open File and Append. The caller holds the log lock.
+	bool EventLogger::writeToDiskLocked()
 	{
 		if(m_lstLog.size() == 0)
 			return false;
@@ -206,6 +282,179 @@ namespace PS{
 		return true;
 	}
     
+	void EventLogger::startWriter()
+	{
+		if(isAsync())
+			return;
+
+		//entries of the sync mode go first
+		writeToDisk();
+
+		if(m_lpQueue == NULL) {
+			m_lpQueue = new Record[PS_LOG_QUEUE_CAPACITY];
+			for(U32 i=0; i < PS_LOG_QUEUE_CAPACITY; i++)
+				m_lpQueue[i].sequence.store(i, std::memory_order_relaxed);
+			m_enqueuePos.store(0, std::memory_order_relaxed);
+			m_dequeuePos = 0;
+		}
+
+		m_isStopping = false;
+		m_ctFlushRequests = m_ctFlushed = 0;
+		m_writer = std::thread(&EventLogger::runWriter, this);
+		m_isAsync.store(true, std::memory_order_release);
+	}
+
+	void EventLogger::stopWriter()
+	{
+		if(!isAsync())
+			return;
+
+		//new producers log in sync. Wait for the ones already enqueueing so the drain below
+		//sees their entries.
+		m_isAsync.store(false);
+		while(m_ctProducers.load() != 0)
+			std::this_thread::yield();
+
+		{
+			std::lock_guard<std::mutex> lock(m_lockWriter);
+			m_isStopping = true;
+		}
+		m_cvWake.notify_one();
+		m_writer.join();
+
+		drain();
+		writeToDisk();
+		m_cvFlushed.notify_all();
+	}
+
+	/*!
+	* Bounded queue of Dmitry Vyukov. A producer claims a slot with a compare and swap on the
+	* enqueue position and publishes it through the slot sequence, so producers never wait on
+	* each other or on the writer.
+	*/
+	bool EventLogger::enqueue(const char* lpStrDesc, EVENTTYPE t, const char* lpStrSource, int value)
+	{
+		Record* lpRecord = NULL;
+		U64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+		for(;;) {
+			Record& rec = m_lpQueue[pos & (PS_LOG_QUEUE_CAPACITY - 1)];
+			U64 seq = rec.sequence.load(std::memory_order_acquire);
+			I64 dif = (I64)seq - (I64)pos;
+			if(dif == 0) {
+				if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					lpRecord = &rec;
+					break;
+				}
+			}
+			else if(dif < 0) {
+				//full. Warnings and errors wait for the writer, the rest is dropped.
+				if(t == etInfo || t == etProfile) {
+					m_ctDropped.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+				if(!isAsync())
+					return false;
+				std::this_thread::yield();
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+			else
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+		}
+
+		lpRecord->etype = t;
+		lpRecord->value = value;
+		lpRecord->rawtime = 0;
+		if(m_bWriteTimeStamps)
+			time(&lpRecord->rawtime);
+
+		lpRecord->source[0] = 0;
+		if(lpStrSource) {
+			strncpy(lpRecord->source, lpStrSource, PS_LOG_SOURCE_SIZE - 1);
+			lpRecord->source[PS_LOG_SOURCE_SIZE - 1] = 0;
+		}
+		strncpy(lpRecord->desc, lpStrDesc, PS_LOG_LINE_SIZE - 1);
+		lpRecord->desc[PS_LOG_LINE_SIZE - 1] = 0;
+
+		lpRecord->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	//formats the published entries in order. Writer thread only.
+	U32 EventLogger::drain()
+	{
+		std::lock_guard<std::mutex> lock(m_lockLog);
+		U32 ctDrained = 0;
+		std::string strScreen;
+		for(;;) {
+			Record& rec = m_lpQueue[m_dequeuePos & (PS_LOG_QUEUE_CAPACITY - 1)];
+			if(rec.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+				break;
+
+			AnsiStr strEvent = formatEvent(rec.desc, rec.etype, rec.source[0] ? rec.source : NULL, rec.value, rec.rawtime);
+			rec.sequence.store(m_dequeuePos + PS_LOG_QUEUE_CAPACITY, std::memory_order_release);
+			m_dequeuePos++;
+			ctDrained++;
+
+			m_lstLog.push_back(strEvent);
+			m_szBufferSize += strEvent.length();
+
+			//one write to the screen per batch
+			if(m_bWriteToScreen) {
+				if(m_fOnDisplay)
+					m_fOnDisplay(strEvent.cptr());
+				else
+					strScreen += std::string("PS: ") + strEvent.cptr() + "\n";
+			}
+		}
+
+		U64 ctDropped = m_ctDropped.load(std::memory_order_relaxed);
+		if(ctDropped != m_ctDroppedReported) {
+			AnsiStr strEvent = formatEvent(printToAStr("Log queue was full. Dropped %llu entries.", ctDropped - m_ctDroppedReported).cptr(),
+										   etWarning, NULL, 0, time(NULL));
+			m_ctDroppedReported = ctDropped;
+			m_lstLog.push_back(strEvent);
+			if(m_bWriteToScreen)
+				strScreen += std::string("PS: ") + strEvent.cptr() + "\n";
+		}
+
+		if(strScreen.length() > 0)
+			fwrite(strScreen.c_str(), 1, strScreen.length(), stderr);
+
+		//batches go to disk once the buffer fills
+		if(m_szBufferSize > PS_LOG_BUFFER_SIZE)
+			writeToDiskLocked();
+
+		return ctDrained;
+	}
+
+	void EventLogger::runWriter()
+	{
+		for(;;) {
+			U64 ticket;
+			bool isStopping;
+			{
+				std::unique_lock<std::mutex> lock(m_lockWriter);
+				m_cvWake.wait_for(lock, std::chrono::milliseconds(PS_LOG_ASYNC_PERIOD_MS),
+								  [&] { return m_isStopping || m_ctFlushRequests != m_ctFlushed; });
+				ticket = m_ctFlushRequests;
+				isStopping = m_isStopping;
+			}
+
+			drain();
+			if(ticket != m_ctFlushed)
+				writeToDisk();
+
+			if(ticket != m_ctFlushed) {
+				std::lock_guard<std::mutex> lock(m_lockWriter);
+				m_ctFlushed = ticket;
+				m_cvFlushed.notify_all();
+			}
+
+			if(isStopping)
+				break;
+		}
+	}
+
     AnsiStr EventLogger::shortenPathBasedOnRoot(const AnsiStr& strPath) const {
         AnsiStr output = strPath;
         int pos = -1;
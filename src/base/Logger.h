@@ -3,8 +3,14 @@
  * Usages: Debugging, Performance measurements, Profiling, Event Reviews, Process Control
  * Logs are written to disk after a certain sized buffer is filled. 
  * Event logging system is accessible globally so it can be used in all classes. 
+ * In async mode the calling threads only queue the formatted message and a writer thread
+ * adds the prefixes and writes the batches to disk and screen.
  */
 #include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <time.h>
 #include "String.h"
 #include "loki/Singleton.h"
@@ -18,11 +24,19 @@ using namespace Loki;
 #define PS_LOG_WRITE_SOURCE	   4
 #define PS_LOG_WRITE_TO_SCREEN 8
 #define PS_LOG_WRITE_TO_MODAL  16
+#define PS_LOG_WRITE_ASYNC	   32
 
 #define PS_LOG_LINE_SIZE	2048
 //16 KiloBytes for the memory log
 #define PS_LOG_BUFFER_SIZE  8*PS_LOG_LINE_SIZE
 
+//pending entries of the async mode. Power of two.
+#define PS_LOG_QUEUE_CAPACITY	1024
+#define PS_LOG_SOURCE_SIZE		256
+
+//the async writer wakes up at least this often
+#define PS_LOG_ASYNC_PERIOD_MS	20
+
 //Logging Info, Error or Warning
 #define LogInfo(message) psLog(EventLogger::etInfo, __FILE__, __LINE__, message)
 #define LogError(message) psLog(EventLogger::etError, __FILE__, __LINE__, message)
@@ -65,6 +79,10 @@ public:
 
 	enum EVENTTYPE {etProfile, etInfo, etWarning, etError};
 
+	//masks for the event filter
+	enum EVENTMASK {emProfile = 1 << etProfile, emInfo = 1 << etInfo, emWarning = 1 << etWarning,
+					emError = 1 << etError, emAll = emProfile | emInfo | emWarning | emError};
+
 	
 	//Internal Class for holding an instance of an event
 	struct Event{
@@ -93,10 +111,27 @@ public:
 			 int value = 0);
 
 	/*!
+	* Starting and stopping the async writer is safe while other threads log. The format
+	* flags are not guarded, so set them before logging from several threads.
 	* @param flags to control the way log entries are being written to disk
 	*/
 	void setWriteFlags(int flags);
 
+	/*!
+	* Events of the types not in the mask are dropped before they are formatted.
+	* @param mask combination of EVENTMASK values
+	*/
+	void setEventFilter(int mask) { m_eventMask.store(mask, std::memory_order_relaxed);}
+	int eventFilter() const { return m_eventMask.load(std::memory_order_relaxed);}
+	inline bool isEnabled(EVENTTYPE t) const {
+		return (m_eventMask.load(std::memory_order_relaxed) & (1 << t)) != 0;
+	}
+
+	bool isAsync() const { return m_isAsync.load(std::memory_order_relaxed);}
+
+	//entries dropped in async mode because the queue was full
+	U64 countDropped() const { return m_ctDropped.load(std::memory_order_relaxed);}
+
 	//Set output filepath
 	void setOutFilePath(const char* lpStrFilePath);
 
@@ -104,15 +139,36 @@ public:
 	void setDisplayCallBack(FOnDisplay cb) {m_fOnDisplay = cb;}
 
 
-	//Flush the content of string buffer to disk
+	//Flush the content of string buffer to disk. In async mode waits for the writer to catch up.
 	bool flush();
     
     AnsiStr rootPath() const {return m_strRootPath;}
     AnsiStr shortenPathBasedOnRoot(const AnsiStr& strPath) const;
 private:
+	//queued entry of the async mode. The sequence orders producers and the writer.
+	struct Record {
+		std::atomic<U64> sequence;
+		EVENTTYPE etype;
+		int value;
+		time_t rawtime;
+		char source[PS_LOG_SOURCE_SIZE];
+		char desc[PS_LOG_LINE_SIZE];
+	};
 
 	void display(const char* chrMessage) const;
 
+	AnsiStr formatEvent(const char* lpStrDesc, EVENTTYPE t, const char* lpStrSource, int value, time_t rawtime) const;
+	void addFormatted(const AnsiStr& strEvent);
+	bool writeToDisk();
+	bool writeToDiskLocked();
+
+	//async mode
+	void startWriter();
+	void stopWriter();
+	bool enqueue(const char* lpStrDesc, EVENTTYPE t, const char* lpStrSource, int value);
+	U32 drain();
+	void runWriter();
+
 //Private Variables
 private:
 	//On Display Error
@@ -129,6 +185,30 @@ private:
 	AnsiStr m_strFP;
     AnsiStr m_strRootPath;
 	std::vector<AnsiStr> m_lstLog;
+
+	//guards the log buffer. Sync entries can come from the cutting and the render thread.
+	std::mutex m_lockLog;
+
+	std::atomic<int> m_eventMask;
+	std::atomic<bool> m_isAsync;
+
+	//producers between the async check and the end of their enqueue. stopWriter waits for them.
+	std::atomic<U32> m_ctProducers;
+	std::atomic<U64> m_ctDropped;
+	U64 m_ctDroppedReported;
+
+	//bounded multi producer queue drained by the writer thread
+	Record* m_lpQueue;
+	std::atomic<U64> m_enqueuePos;
+	U64 m_dequeuePos;
+
+	std::thread m_writer;
+	std::mutex m_lockWriter;
+	std::condition_variable m_cvWake;
+	std::condition_variable m_cvFlushed;
+	bool m_isStopping;
+	U64 m_ctFlushRequests;
+	U64 m_ctFlushed;
 };
 
 typedef SingletonHolder<EventLogger, CreateUsingNew, PhoenixSingleton> TheEventLogger;
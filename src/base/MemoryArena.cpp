@@ -0,0 +1,93 @@
+/*
+ * MemoryArena.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "MemoryArena.h"
+#include "AlignedAlloc.h"
+#include <assert.h>
+
+namespace PS {
+
+MemoryArena::MemoryArena(size_t szBlock) {
+	m_szBlock = szBlock;
+	m_idxBlock = 0;
+	m_offset = 0;
+}
+
+MemoryArena::~MemoryArena() {
+	release();
+}
+
+void* MemoryArena::allocate(size_t sz, size_t alignment) {
+	//blocks start on a cache line so aligning the offset aligns the address
+	assert(alignment > 0 && alignment <= PS_L1_CACHE_LINE_SIZE && (alignment & (alignment - 1)) == 0);
+
+	//first block that fits starting at the current one
+	while(m_idxBlock < m_vBlocks.size()) {
+		const Block& block = m_vBlocks[m_idxBlock];
+		size_t start = (m_offset + alignment - 1) & ~(alignment - 1);
+		if(start + sz <= block.szData) {
+			m_offset = start + sz;
+			return block.lpData + start;
+		}
+
+		m_idxBlock++;
+		m_offset = 0;
+	}
+
+	//out of blocks
+	Block block;
+	block.szData = MATHMAX(m_szBlock, sz);
+	block.lpData = reinterpret_cast<U8*>(AllocAligned(block.szData));
+	if(block.lpData == NULL)
+		throw std::bad_alloc();
+	m_vBlocks.push_back(block);
+
+	m_idxBlock = m_vBlocks.size() - 1;
+	m_offset = sz;
+	return block.lpData;
+}
+
+void MemoryArena::reset() {
+	m_idxBlock = 0;
+	m_offset = 0;
+}
+
+MemoryArena::Marker MemoryArena::mark() const {
+	Marker marker;
+	marker.idxBlock = m_idxBlock;
+	marker.offset = m_offset;
+	return marker;
+}
+
+void MemoryArena::rewind(const Marker& marker) {
+	m_idxBlock = marker.idxBlock;
+	m_offset = marker.offset;
+}
+
+void MemoryArena::release() {
+	for(U32 i=0; i < m_vBlocks.size(); i++)
+		FreeAligned(m_vBlocks[i].lpData);
+	m_vBlocks.resize(0);
+	m_idxBlock = 0;
+	m_offset = 0;
+}
+
+size_t MemoryArena::bytesUsed() const {
+	size_t total = 0;
+	for(U32 i=0; i < m_idxBlock && i < m_vBlocks.size(); i++)
+		total += m_vBlocks[i].szData;
+	return total + m_offset;
+}
+
+size_t MemoryArena::bytesReserved() const {
+	size_t total = 0;
+	for(U32 i=0; i < m_vBlocks.size(); i++)
+		total += m_vBlocks[i].szData;
+	return total;
+}
+
+}
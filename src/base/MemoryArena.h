@@ -0,0 +1,132 @@
+/*
+ * MemoryArena.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef MEMORYARENA_H_
+#define MEMORYARENA_H_
+
+#include "MathBase.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#define ARENA_DEFAULT_BLOCK_SIZE	(64 * 1024)
+
+using namespace std;
+
+namespace PS {
+
+/*!
+ * Monotonic allocator for the scratch data of a single operation. Allocation bumps
+ * a pointer inside the current block and nothing is freed until the arena is reset
+ * or rewound. Blocks are kept across resets so a steady stream of operations does
+ * not touch the heap. An arena is not thread safe and cannot be copied.
+ */
+class MemoryArena {
+public:
+	//position to rewind to
+	struct Marker {
+		U32 idxBlock;
+		size_t offset;
+	};
+
+	explicit MemoryArena(size_t szBlock = ARENA_DEFAULT_BLOCK_SIZE);
+	MemoryArena(const MemoryArena& other) = delete;
+	~MemoryArena();
+
+	MemoryArena& operator = (const MemoryArena& other) = delete;
+
+	void* allocate(size_t sz, size_t alignment);
+
+	//drops all allocations and keeps the blocks
+	void reset();
+
+	//drops the allocations made after the marker
+	Marker mark() const;
+	void rewind(const Marker& marker);
+
+	//frees all blocks
+	void release();
+
+	//stats
+	size_t bytesUsed() const;
+	size_t bytesReserved() const;
+	U32 countBlocks() const { return m_vBlocks.size();}
+
+private:
+	struct Block {
+		U8* lpData;
+		size_t szData;
+	};
+
+	size_t m_szBlock;
+	vector<Block> m_vBlocks;
+	U32 m_idxBlock;
+	size_t m_offset;
+};
+
+/*!
+ * Rewinds an arena to where it was at construction. Scratch containers of a scope
+ * must be declared after it so they are destroyed first.
+ */
+class ArenaScope {
+public:
+	explicit ArenaScope(MemoryArena& arena) : m_arena(arena), m_marker(arena.mark()) {}
+	~ArenaScope() { m_arena.rewind(m_marker);}
+
+private:
+	ArenaScope(const ArenaScope& other);
+	ArenaScope& operator = (const ArenaScope& other);
+
+	MemoryArena& m_arena;
+	MemoryArena::Marker m_marker;
+};
+
+/*!
+ * STL allocator drawing from an arena. Deallocation is a no-op. A default constructed
+ * allocator has no arena and falls back to the heap. The arena moves with the contents
+ * of a container so a member container can be bound to an arena by assignment.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	ArenaAllocator() : m_lpArena(NULL) {}
+	explicit ArenaAllocator(MemoryArena* lpArena) : m_lpArena(lpArena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : m_lpArena(other.arena()) {}
+
+	T* allocate(size_t n) {
+		if(m_lpArena == NULL)
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		return static_cast<T*>(m_lpArena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* p, size_t) {
+		if(m_lpArena == NULL)
+			::operator delete(p);
+	}
+
+	MemoryArena* arena() const { return m_lpArena;}
+
+	template <typename U>
+	bool operator == (const ArenaAllocator<U>& rhs) const { return m_lpArena == rhs.arena();}
+
+	template <typename U>
+	bool operator != (const ArenaAllocator<U>& rhs) const { return m_lpArena != rhs.arena();}
+
+private:
+	MemoryArena* m_lpArena;
+};
+
+}
+
+#endif /* MEMORYARENA_H_ */
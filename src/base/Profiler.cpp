@@ -8,49 +8,106 @@
 #include "Logger.h"
 #include "FileDirectory.h"
 #include <fstream>
+#include <algorithm>
+#include <string.h>
+
+#define LATENCY_HEADER "tetcutter_latency"
+#define LATENCY_VERSION 1
 
 using namespace PS::FILESTRINGUTILS;
 
 namespace PS {
 
-ProfileAutoEvent::ProfileAutoEvent(const char* filename, const char* funcname, int line, const char* desc) {
-	psProfileStart(filename, funcname, line, desc);
+//ring of the calling thread. Rings outlive the profiler since pool threads may still hold them.
+static thread_local ProfileThreadBuffer* g_lpThreadBuffer = NULL;
+
+static bool CompareLatencyLabel(const ProfileLatency& a, const ProfileLatency& b) {
+	return strcmp(a.strLabel.cptr(), b.strLabel.cptr()) < 0;
 }
 
-ProfileAutoEvent::~ProfileAutoEvent() {
-	psProfileEnd();
+static bool CompareRecordStart(const ProfileRecord& a, const ProfileRecord& b) {
+	return (a.start < b.start) || (a.start == b.start && a.end > b.end);
+}
+
+//json strings
+static string EscapeJson(const char* lpStr) {
+	string strOut;
+	for(; lpStr && *lpStr; lpStr++) {
+		if(*lpStr == '"' || *lpStr == '\\')
+			strOut += '\\';
+		strOut += *lpStr;
+	}
+	return strOut;
 }
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
+ProfileThreadBuffer::ProfileThreadBuffer(U32 idxThread) {
+	m_idxThread = idxThread;
+	m_head.store(0);
+	m_ctOpen = 0;
+	for(U32 i=0; i < MAX_PROFILE_LABELS; i++)
+		m_histograms[i].store(NULL, std::memory_order_relaxed);
+}
 
-ProfileEvent::ProfileEvent(const char* filename, const char* funcname, int line, const char* desc) {
-	m_strFileName = AnsiStr(filename);
-	m_strFuncName = AnsiStr(funcname);
-	if(desc == NULL)
-		m_strDesc = AnsiStr("ProfileEvent");
-	else
-		m_strDesc = AnsiStr(desc);
-	m_line = line;
-	m_timeMS = 0.0;
+LatencyHistogram* ProfileThreadBuffer::createHistogram(U32 idxLabel) {
+	LatencyHistogram* lpHistogram = new LatencyHistogram();
+	m_histograms[idxLabel].store(lpHistogram, std::memory_order_release);
+	return lpHistogram;
 }
 
-ProfileEvent::~ProfileEvent() {
+bool ProfileThreadBuffer::pushOpen(U32 idxLabel, U64 start) {
+	if(m_ctOpen >= MAX_PROFILE_DEPTH)
+		return false;
+
+	m_openLabels[m_ctOpen] = idxLabel;
+	m_openStarts[m_ctOpen] = start;
+	m_ctOpen++;
+	return true;
 }
 
-void ProfileEvent::start() {
-	m_start = tbb::tick_count::now();
+bool ProfileThreadBuffer::popOpen(U32& idxLabel, U64& start) {
+	if(m_ctOpen == 0)
+		return false;
+
+	m_ctOpen--;
+	idxLabel = m_openLabels[m_ctOpen];
+	start = m_openStarts[m_ctOpen];
+	return true;
+}
+
+U64 ProfileThreadBuffer::snapshot(U64 from, vector<ProfileRecord>& out) const {
+	U64 head = m_head.load(std::memory_order_acquire);
+	if(head > PROFILE_RING_CAPACITY)
+		from = MATHMAX(from, head - PROFILE_RING_CAPACITY);
+
+	U32 ctPrev = out.size();
+	for(U64 i = from; i < head; i++)
+		out.push_back(m_records[i & (PROFILE_RING_CAPACITY - 1)]);
+
+	//slots the owner reused while copying are dropped. The slot after the head may be half written.
+	//The fence keeps the slot reads above ahead of the second head load.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	U64 headAfter = m_head.load(std::memory_order_relaxed) + 1;
+	if(headAfter > PROFILE_RING_CAPACITY && headAfter - PROFILE_RING_CAPACITY > from) {
+		U64 ctStale = MATHMIN(headAfter - PROFILE_RING_CAPACITY - from, (U64)(out.size() - ctPrev));
+		out.erase(out.begin() + ctPrev, out.begin() + ctPrev + ctStale);
+	}
+
+	return head;
 }
 
-double ProfileEvent::end() {
-	m_end = tbb::tick_count::now();
-	m_timeMS =  (m_end - m_start).seconds() * 1000.0;
-	return m_timeMS;
+///////////////////////////////////////////////////////////////////////////////////////////////////
+ProfileAutoEvent::ProfileAutoEvent(U32 idxLabel) {
+	m_idxLabel = idxLabel;
+	m_start = Profiler::ReadCycles();
+}
+
+ProfileAutoEvent::~ProfileAutoEvent() {
+	TheProfiler::Instance().recordEvent(m_idxLabel, m_start, Profiler::ReadCycles());
 }
 
 //////////////////////////////////////////////////////////////////////////////////
 ProfileSession::ProfileSession() {
-	m_strTextFile = ChangeFileExt(GetExePath(), AnsiStr(".psprofile.txt"));
-	m_strSQLDB = ChangeFileExt(GetExePath(), AnsiStr(".sqlite"));
-
 	cleanup();
 }
 
@@ -61,100 +118,218 @@ ProfileSession::~ProfileSession() {
 void ProfileSession::cleanup() {
 	m_isStatsValid = false;
 	m_avgMS = m_lowestMS = m_highestMS = 0.0;
-	m_lpSlowestE = m_lpFastestE = NULL;
-
-	//Cleanup
-	for(U32 i=0; i<m_vEvents.size(); i++)
-		SAFE_DELETE(m_vEvents[i]);
-	m_vEvents.resize(0);
-
-	while(!m_stkCurrent.empty())
-		m_stkCurrent.pop();
+	m_p50MS = m_p99MS = 0.0;
+	m_ctEvents = 0;
+	m_cyclesStart = 0;
 }
 
 void ProfileSession::start() {
 	cleanup();
 	m_tickStart = tbb::tick_count::now();
+	m_cyclesStart = Profiler::ReadCycles();
 }
 
 void ProfileSession::end() {
-	//Compute Stats and set valid
-	if(m_vEvents.size() == 0)
+	m_tickEnd = tbb::tick_count::now();
+
+	//Compute Stats over the events that started in this session and set valid
+	Profiler& profiler = TheProfiler::Instance();
+	vector<ProfileRecord> vRecords;
+	profiler.snapshot(vRecords);
+
+	LatencyHistogram hist;
+	for(U32 i=0; i < vRecords.size(); i++) {
+		if(vRecords[i].start >= m_cyclesStart)
+			hist.record(vRecords[i].end - vRecords[i].start);
+	}
+
+	m_ctEvents = (int)hist.count();
+	if(m_ctEvents == 0)
 		return;
 
+	m_highestMS = profiler.cyclesToMS(hist.highest());
+	m_lowestMS = profiler.cyclesToMS(hist.lowest());
+	m_avgMS = profiler.cyclesToMS(hist.total()) / static_cast<double>(m_ctEvents);
+	m_p50MS = profiler.cyclesToMS(hist.valueAtPercentile(50.0));
+	m_p99MS = profiler.cyclesToMS(hist.valueAtPercentile(99.0));
+	m_isStatsValid = true;
+}
 
-	m_highestMS = m_vEvents[0]->timeMS();
-	m_lowestMS = m_vEvents[0]->timeMS();
-	m_lpSlowestE = m_lpFastestE = m_vEvents[0];
-	double sum = m_lowestMS;
-	double current = 0.0;
-	for(int i=1; i<(int)m_vEvents.size(); i++) {
+AnsiStr ProfileSession::toString() const {
+	AnsiStr str;
+	if(m_isStatsValid) {
+		str = printToAStr("SLOWEST Event: %.3f and FASTEST Event: %.3f and AVG: %.3f and P50: %.3f and P99: %.3f",
+                          m_highestMS, m_lowestMS, m_avgMS, m_p50MS, m_p99MS);
+    }
+	else
+		str = "Results are not computed yet!";
+	return str;
+}
 
-		current = m_vEvents[i]->timeMS();
-		if(current > m_highestMS) {
-			m_highestMS = current;
-			m_lpSlowestE = m_vEvents[i];
-		}
+double ProfileSession::duration() const {
+	 return (m_tickEnd - m_tickStart).seconds() * 1000.0;
+}
 
-		if(current < m_lowestMS) {
-			m_lowestMS = current;
-			m_lpFastestE = m_vEvents[i];
-		}
+//////////////////////////////////////////////////////////////////////////////////
+Profiler::Profiler() {
+	//logging every event is not cheap. Enable it with setInjectToLogFlag.
+	m_flags = pbWriteToTextFile | pbWriteLatencyStats;
+	m_ctLabels.store(0);
+	m_strTextFile = ChangeFileExt(GetExePath(), AnsiStr(".psprofile.txt"));
+	m_strLatencyFile = ChangeFileExt(GetExePath(), AnsiStr(".pslatency.txt"));
+	calibrate();
+}
+
+Profiler::~Profiler() {
+	flush();
+
+	for(U32 i=0; i < countLabels(); i++)
+		SAFE_DELETE(m_labels[i]);
+	m_ctLabels.store(0);
+}
+
+//cycles per ms from a short busy wait
+void Profiler::calibrate() {
+	m_tick0 = tbb::tick_count::now();
+	m_cycles0 = ReadCycles();
+
+	tick t1;
+	do {
+		t1 = tbb::tick_count::now();
+	} while((t1 - m_tick0).seconds() < 0.002);
+
+	U64 cycles = ReadCycles() - m_cycles0;
+	m_msPerCycle = (cycles > 0) ? ((t1 - m_tick0).seconds() * 1000.0) / (double)cycles : 1.0e-6;
+}
+
+double Profiler::cyclesToMS(U64 cycles) const {
+	return (double)cycles * m_msPerCycle;
+}
+
+void Profiler::flush() {
+	if((m_flags & pbWriteToTextFile) != 0)
+		writeToTextFile();
+	if((m_flags & pbWriteLatencyStats) != 0)
+		writeLatencyStats(m_strLatencyFile);
+}
+
+void Profiler::startSession() {
+	flush();
+	m_session.start();
+}
 
-		sum += current;
+void Profiler::endSession() {
+	m_session.end();
+	if((m_flags & pbInjectToLogger) != 0)
+		LogInfoArg1("Session ended: Stats: %s", m_session.toString().cptr());
+}
+
+U32 Profiler::registerLabel(const char* filename, const char* funcname, int line, const char* desc) {
+	std::lock_guard<std::mutex> lock(m_lockLabels);
+
+	U32 idxLabel = m_ctLabels.load(std::memory_order_relaxed);
+	if(idxLabel >= MAX_PROFILE_LABELS) {
+		LogErrorArg1("Reached the maximum number of profile labels: %u", MAX_PROFILE_LABELS);
+		return MAX_PROFILE_LABELS - 1;
 	}
 
-	m_avgMS = sum / static_cast<double>(m_vEvents.size());
-	m_isStatsValid = true;
-	m_tickEnd = tbb::tick_count::now();
+	ProfileLabel* lpLabel = new ProfileLabel();
+	lpLabel->strFileName = AnsiStr(filename);
+	lpLabel->strFuncName = AnsiStr(funcname);
+	lpLabel->strDesc = (desc == NULL) ? AnsiStr("ProfileEvent") : AnsiStr(desc);
+	lpLabel->line = line;
+
+	m_labels[idxLabel] = lpLabel;
+	m_ctLabels.store(idxLabel + 1, std::memory_order_release);
+	return idxLabel;
 }
 
-//Events
-void ProfileSession::startEvent(ProfileEvent* e) {
-	if(e == NULL)
-		return;
+U32 Profiler::findOrRegisterLabel(const char* filename, const char* funcname, int line, const char* desc) {
+	{
+		std::lock_guard<std::mutex> lock(m_lockLabels);
+		std::map<std::pair<const char*, int>, U32>::const_iterator it = m_mapCallSites.find(std::make_pair(filename, line));
+		if(it != m_mapCallSites.end())
+			return it->second;
+	}
 
-	m_vEvents.push_back(e);
-	m_stkCurrent.push(e);
+	U32 idxLabel = registerLabel(filename, funcname, line, desc);
+
+	std::lock_guard<std::mutex> lock(m_lockLabels);
+	m_mapCallSites[std::make_pair(filename, line)] = idxLabel;
+	return idxLabel;
 }
 
-ProfileEvent* ProfileSession::endEvent() {
-	if(m_stkCurrent.empty()) {
-		LogError("The Profiler stack is empty! Did you forget to end an event before starting a new one?");
-		return NULL;
+const ProfileLabel* Profiler::label(U32 idxLabel) const {
+	return (idxLabel < countLabels()) ? m_labels[idxLabel] : NULL;
+}
+
+ProfileThreadBuffer* Profiler::threadBuffer() {
+	if(g_lpThreadBuffer == NULL) {
+		std::lock_guard<std::mutex> lock(m_lockBuffers);
+		g_lpThreadBuffer = new ProfileThreadBuffer(m_vBuffers.size());
+		m_vBuffers.push_back(g_lpThreadBuffer);
+		m_vFlushed.push_back(0);
 	}
 
-	ProfileEvent* lpEvent = m_stkCurrent.top();
-	m_stkCurrent.pop();
-	lpEvent->end();
-	return lpEvent;
+	return g_lpThreadBuffer;
 }
 
-ProfileEvent* ProfileSession::get(int index) const {
-	if(!isEventIndex(index))
-		return NULL;
-	return m_vEvents[index];
+void Profiler::recordEvent(U32 idxLabel, U64 start, U64 end) {
+	threadBuffer()->push(idxLabel, start, end);
+
+	//Inject log info
+	if((m_flags & pbInjectToLogger) != 0) {
+		const ProfileLabel* lpLabel = label(idxLabel);
+		if(lpLabel) {
+			AnsiStr strSource = lpLabel->strFileName + AnsiStr(":") + lpLabel->strFuncName;
+			psLog(EventLogger::etProfile, strSource.cptr(), lpLabel->line, "%s Took %.4f [ms]",
+				  lpLabel->strDesc.cptr(), cyclesToMS(end - start));
+		}
+	}
 }
 
-AnsiStr ProfileSession::toString() const {
-	AnsiStr str;
-	if(m_isStatsValid) {
-		str = printToAStr("SLOWEST Event: %.3f and FASTEST Event: %.3f and AVG: %.3f",
-                          m_highestMS, m_lowestMS, m_avgMS);
-    }
-	else
-		str = "Results are not computed yet!";
-	return str;
+void Profiler::startEvent(const char* filename, const char* funcname, int line, const char* desc) {
+	U32 idxLabel = findOrRegisterLabel(filename, funcname, line, desc);
+	if(!threadBuffer()->pushOpen(idxLabel, ReadCycles()))
+		LogErrorArg1("Profiler events are nested deeper than %u.", MAX_PROFILE_DEPTH);
 }
 
-double ProfileSession::duration() const {
-	 return (m_tickEnd - m_tickStart).seconds() * 1000.0;
+double Profiler::endEvent() {
+	U64 end = ReadCycles();
+	U32 idxLabel;
+	U64 start;
+	if(!threadBuffer()->popOpen(idxLabel, start)) {
+		LogError("The Profiler stack is empty! Did you forget to end an event before starting a new one?");
+		return 0.0;
+	}
+
+	recordEvent(idxLabel, start, end);
+	return cyclesToMS(end - start);
+}
+
+void Profiler::snapshot(vector<ProfileRecord>& out) const {
+	out.resize(0);
+	{
+		std::lock_guard<std::mutex> lock(m_lockBuffers);
+		for(U32 i=0; i < m_vBuffers.size(); i++)
+			m_vBuffers[i]->snapshot(0, out);
+	}
+
+	std::sort(out.begin(), out.end(), CompareRecordStart);
 }
 
-//Write profiler events into the text file
-int ProfileSession::writeToTextFile() {
-	if(m_vEvents.size() == 0)
+//Write the profiler events recorded since the last flush into the text file
+int Profiler::writeToTextFile() {
+	vector<ProfileRecord> vRecords;
+	{
+		std::lock_guard<std::mutex> lock(m_lockBuffers);
+		for(U32 i=0; i < m_vBuffers.size(); i++)
+			m_vFlushed[i] = m_vBuffers[i]->snapshot(m_vFlushed[i], vRecords);
+	}
+
+	if(vRecords.size() == 0)
 		return 0;
+	std::sort(vRecords.begin(), vRecords.end(), CompareRecordStart);
 
 	ofstream ofs;
 	if(FileExists(m_strTextFile))
@@ -164,13 +339,15 @@ int ProfileSession::writeToTextFile() {
 	if(!ofs.is_open())
 		return false;
 
-	ProfileEvent* lpEvent = NULL;
 	AnsiStr strLine;
-	for(size_t i=0; i < m_vEvents.size(); i++)
+	for(size_t i=0; i < vRecords.size(); i++)
 	{
-		lpEvent = m_vEvents[i];
-		strLine = lpEvent->filename() + AnsiStr(":") + lpEvent->funcname() + printToAStr(":%d", lpEvent->line());
-		strLine += printToAStr(" %s took %.4f [ms]", lpEvent->desc().cptr(), lpEvent->timeMS());
+		const ProfileLabel* lpLabel = label(vRecords[i].idxLabel);
+		if(lpLabel == NULL)
+			continue;
+
+		strLine = lpLabel->strFileName + AnsiStr(":") + lpLabel->strFuncName + printToAStr(":%d", lpLabel->line);
+		strLine += printToAStr(" %s took %.4f [ms]", lpLabel->strDesc.cptr(), cyclesToMS(vRecords[i].end - vRecords[i].start));
 		ofs << strLine << '\0' << endl;
 	}
 	ofs.close();
@@ -178,62 +355,158 @@ int ProfileSession::writeToTextFile() {
 	return 1;
 }
 
-int ProfileSession::writeToSqlDB() {
-	return 0;
-}
+/*!
+ * complete events with microsecond timestamps relative to the profiler start. Load the
+ * file in chrome://tracing or any viewer of the trace event format.
+ */
+bool Profiler::writeChromeTrace(const AnsiStr& strPath) const {
+	vector<ProfileRecord> vRecords;
+	snapshot(vRecords);
 
-//////////////////////////////////////////////////////////////////////////////////
-Profiler::Profiler() {
-	m_flags = pbInjectToLogger | pbWriteToTextFile;
-}
+	ofstream ofs(strPath.cptr());
+	if(!ofs.is_open()) {
+		LogErrorArg1("Unable to write the trace to: %s", strPath.cptr());
+		return false;
+	}
 
-Profiler::~Profiler() {
-	flush();
-}
+	ofs.precision(3);
+	ofs << std::fixed;
+	ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << endl;
+
+	bool isFirst = true;
+	for(U32 i=0; i < vRecords.size(); i++) {
+		const ProfileRecord& rec = vRecords[i];
+		const ProfileLabel* lpLabel = label(rec.idxLabel);
+		if(lpLabel == NULL || rec.start < m_cycles0)
+			continue;
+
+		double ts = cyclesToMS(rec.start - m_cycles0) * 1000.0;
+		double dur = cyclesToMS(rec.end - rec.start) * 1000.0;
+
+		ofs << (isFirst ? "" : ",\n");
+		ofs << "{\"name\": \"" << EscapeJson(lpLabel->strDesc.cptr()) << "\", \"cat\": \"" << EscapeJson(lpLabel->strFuncName.cptr());
+		ofs << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << rec.idxThread;
+		ofs << ", \"ts\": " << ts << ", \"dur\": " << dur;
+		ofs << ", \"args\": {\"source\": \"" << EscapeJson(lpLabel->strFileName.cptr()) << ":" << lpLabel->line << "\"}}";
+		isFirst = false;
+	}
 
-void Profiler::flush() {
-	if((m_flags & pbWriteToTextFile) != 0)
-		m_session.writeToTextFile();
-	if((m_flags & pbWriteToSqlDB) != 0)
-		m_session.writeToSqlDB();
-}
+	ofs << endl << "]}" << endl;
+	ofs.close();
 
-void Profiler::startSession() {
-	flush();
-	m_session.start();
+	return true;
 }
 
-void Profiler::endSession() {
-	m_session.end();
-	if((m_flags & pbInjectToLogger) != 0)
-		LogInfoArg1("Session ended: Stats: %s", m_session.toString().cptr());
+void Profiler::latency(U32 idxLabel, LatencyHistogram& out) const {
+	out.reset();
+	if(idxLabel >= MAX_PROFILE_LABELS)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_lockBuffers);
+	for(U32 i=0; i < m_vBuffers.size(); i++) {
+		const LatencyHistogram* lpHistogram = m_vBuffers[i]->histogram(idxLabel);
+		if(lpHistogram)
+			out.merge(*lpHistogram);
+	}
 }
 
+void Profiler::latencyStats(vector<ProfileLatency>& out) const {
+	out.resize(0);
+
+	//merge the call sites that share a label
+	std::map<string, LatencyHistogram*> mapMerged;
+	LatencyHistogram hist;
+	for(U32 i=0; i < countLabels(); i++) {
+		latency(i, hist);
+		if(hist.count() == 0)
+			continue;
+
+		const ProfileLabel* lpLabel = label(i);
+		string strKey = string(lpLabel->strFuncName.cptr()) + ":" + string(lpLabel->strDesc.cptr());
+		LatencyHistogram*& lpMerged = mapMerged[strKey];
+		if(lpMerged == NULL)
+			lpMerged = new LatencyHistogram();
+		lpMerged->merge(hist);
+	}
 
-void Profiler::startEvent(const char* filename, const char* funcname, int line, const char* desc) {
-	ProfileEvent* lpEvent = new ProfileEvent(filename, funcname, line, desc);
-	lpEvent->start();
-	m_session.startEvent(lpEvent);
+	for(std::map<string, LatencyHistogram*>::iterator it = mapMerged.begin(); it != mapMerged.end(); ++it) {
+		const LatencyHistogram* lpHist = it->second;
+
+		ProfileLatency stats;
+		stats.strLabel = AnsiStr(it->first.c_str());
+		stats.count = lpHist->count();
+		stats.totalMS = cyclesToMS(lpHist->total());
+		stats.p50MS = cyclesToMS(lpHist->valueAtPercentile(50.0));
+		stats.p90MS = cyclesToMS(lpHist->valueAtPercentile(90.0));
+		stats.p99MS = cyclesToMS(lpHist->valueAtPercentile(99.0));
+		stats.highestMS = cyclesToMS(lpHist->highest());
+		out.push_back(stats);
+
+		SAFE_DELETE(it->second);
+	}
 }
 
-double Profiler::endEvent() {
-	ProfileEvent* e = m_session.endEvent();
-	if(e == NULL)
-		return 0.0;
+/*!
+ * one line per label after the header: count, total, p50, p90, p99 and max in ms followed
+ * by the label which runs to the end of the line.
+ */
+bool Profiler::writeLatencyStats(const AnsiStr& strPath) const {
+	vector<ProfileLatency> vStats;
+	latencyStats(vStats);
 
-	//Inject log info
-	if((m_flags & pbInjectToLogger) != 0) {
-		AnsiStr strSource = e->filename() + AnsiStr(":") + e->funcname();
-		psLog(EventLogger::etProfile, strSource.cptr(), e->line(), "%s Took %.4f [ms]", e->desc().cptr(), e->timeMS());
+	ofstream ofs(strPath.cptr());
+	if(!ofs.is_open()) {
+		LogErrorArg1("Unable to write the latency stats to: %s", strPath.cptr());
+		return false;
 	}
 
-	//Flush if exceeded the container size and there is no pending events
-	if(m_session.count() > MAX_LOG_EVENTS && !m_session.hasPendingEvents())
-		flush();
+	ofs.precision(6);
+	ofs << std::fixed;
+	ofs << LATENCY_HEADER << " " << LATENCY_VERSION << " " << vStats.size() << endl;
+	for(U32 i=0; i < vStats.size(); i++) {
+		const ProfileLatency& stats = vStats[i];
+		ofs << stats.count << " " << stats.totalMS << " " << stats.p50MS << " " << stats.p90MS << " ";
+		ofs << stats.p99MS << " " << stats.highestMS << " " << stats.strLabel.cptr() << endl;
+	}
+	ofs.close();
 
-	return e->timeMS();
+	return true;
 }
 
+bool Profiler::ReadLatencyStats(const AnsiStr& strPath, vector<ProfileLatency>& out) {
+	ifstream ifs(strPath.cptr());
+	if(!ifs.is_open()) {
+		LogErrorArg1("Unable to open latency stats: %s", strPath.cptr());
+		return false;
+	}
+
+	string strHeader;
+	int version = 0;
+	U32 ctLabels = 0;
+	ifs >> strHeader >> version >> ctLabels;
+	if(!ifs || strHeader != LATENCY_HEADER || version != LATENCY_VERSION) {
+		LogErrorArg1("Not a latency stats file or unsupported version: %s", strPath.cptr());
+		return false;
+	}
+
+	out.resize(0);
+	for(U32 i=0; i < ctLabels; i++) {
+		ProfileLatency stats;
+		string strLabel;
+		ifs >> stats.count >> stats.totalMS >> stats.p50MS >> stats.p90MS >> stats.p99MS >> stats.highestMS;
+		std::getline(ifs >> std::ws, strLabel);
+		if(!ifs || strLabel.length() == 0) {
+			LogErrorArg2("Invalid label %u in latency stats: %s", i, strPath.cptr());
+			return false;
+		}
+
+		stats.strLabel = AnsiStr(strLabel.c_str());
+		out.push_back(stats);
+	}
+
+	std::sort(out.begin(), out.end(), CompareLatencyLabel);
+	return true;
+}
 
 tick Profiler::GetTickCount() {
 	return tbb::tick_count::now();
@@ -252,6 +525,10 @@ void Profiler::setInjectToLogFlag(bool enable) {
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
+U32 psProfileRegisterLabel(const char* filename, const char* funcname, int line, const char* desc) {
+	return TheProfiler::Instance().registerLabel(filename, funcname, line, desc);
+}
+
 void psProfileStart(const char* filename, const char* funcname, int line, const char* desc) {
 	TheProfiler::Instance().startEvent(filename, funcname, line, desc);
 }
@@ -262,5 +539,3 @@ void psProfileEnd() {
 
 
 }
-
-
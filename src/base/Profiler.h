@@ -9,9 +9,12 @@
 #define PROFILER_H_
 
 #include <vector>
-#include <stack>
+#include <atomic>
+#include <mutex>
+#include <map>
 #include <time.h>
 #include "String.h"
+#include "LatencyHistogram.h"
 #include "loki/Singleton.h"
 #include "tbb/tick_count.h"
 
@@ -19,12 +22,26 @@ using namespace std;
 using namespace Loki;
 using namespace tbb;
 
-#define MAX_LOG_EVENTS	32
+//labels are registered once per call site
+#define MAX_PROFILE_LABELS	4096
 
-//Easy usage with preprocessor
-#define ProfileAuto() PS::ProfileAutoEvent profile(__FILE__, __FUNCTION__, __LINE__, NULL);
-#define ProfileAutoArg(desc) PS::ProfileAutoEvent profile(__FILE__, __FUNCTION__, __LINE__, desc);
+//events kept per thread. Older events are overwritten. Power of two.
+#define PROFILE_RING_CAPACITY	8192
 
+//nesting depth of ProfileStart/ProfileEnd pairs per thread
+#define MAX_PROFILE_DEPTH	64
+
+/*!
+ * Easy usage with preprocessor. The label of a call site is registered the first time the
+ * scope runs and only its id is recorded afterwards, so desc must outlive the call: use a
+ * string literal. At most one per scope.
+ */
+#define ProfileAuto() static const U32 psProfileLabel = PS::psProfileRegisterLabel(__FILE__, __FUNCTION__, __LINE__, NULL); \
+	PS::ProfileAutoEvent profile(psProfileLabel);
+#define ProfileAutoArg(desc) static const U32 psProfileLabel = PS::psProfileRegisterLabel(__FILE__, __FUNCTION__, __LINE__, desc); \
+	PS::ProfileAutoEvent profile(psProfileLabel);
+
+//manual pairs look the label up by call site on every start
 #define	 ProfileStart() psProfileStart(__FILE__, __FUNCTION__, __LINE__, NULL);
 #define	 ProfileStartArg(desc) psProfileStart(__FILE__, __FUNCTION__, __LINE__, desc);
 #define ProfileEnd() psProfileEnd();
@@ -33,47 +50,105 @@ namespace PS {
 
 typedef tbb::tick_count		tick;
 
-class ProfileAutoEvent {
-public:
-	ProfileAutoEvent(const char* filename, const char* funcname, int line, const char* desc = NULL);
-	virtual ~ProfileAutoEvent();
+//call site of a profiled scope
+struct ProfileLabel {
+	AnsiStr strFileName;
+	AnsiStr strFuncName;
+	AnsiStr strDesc;
+	int line;
+};
+
+//latency summary of one label. Labels with the same function and description are merged.
+struct ProfileLatency {
+	AnsiStr strLabel;
+	U64 count;
+	double totalMS;
+	double p50MS;
+	double p90MS;
+	double p99MS;
+	double highestMS;
+};
+
+//fixed size event. Times are in cycles of Profiler::ReadCycles.
+struct ProfileRecord {
+	U32 idxLabel;
+	U32 idxThread;
+	U64 start;
+	U64 end;
 };
 
 /*!
- * Profiler event is a small structure
+ * Events of one thread. Only the owner thread writes. It fills the slot and then publishes
+ * it by bumping the head, so readers on other threads copy the published slots and drop
+ * the ones the owner may have overwritten meanwhile. Durations also go into a histogram
+ * per label which, unlike the ring, keeps every event since the start.
  */
-class ProfileEvent {
+class ProfileThreadBuffer {
 public:
-	ProfileEvent(const char* filename, const char* funcname, int line, const char* desc = NULL);
-	virtual ~ProfileEvent();
+	explicit ProfileThreadBuffer(U32 idxThread);
+
+	U32 threadIndex() const { return m_idxThread;}
+
+	//owner thread
+	inline void push(U32 idxLabel, U64 start, U64 end) {
+		U64 head = m_head.load(std::memory_order_relaxed);
+		ProfileRecord& rec = m_records[head & (PROFILE_RING_CAPACITY - 1)];
+		rec.idxLabel = idxLabel;
+		rec.idxThread = m_idxThread;
+		rec.start = start;
+		rec.end = end;
+		m_head.store(head + 1, std::memory_order_release);
+
+		LatencyHistogram* lpHistogram = m_histograms[idxLabel].load(std::memory_order_relaxed);
+		if(lpHistogram == NULL)
+			lpHistogram = createHistogram(idxLabel);
+		lpHistogram->record(end - start);
+	}
+
+	//durations of a label on this thread or NULL if it never ran here
+	const LatencyHistogram* histogram(U32 idxLabel) const {
+		return m_histograms[idxLabel].load(std::memory_order_acquire);
+	}
+
+	//open ProfileStart events of the owner thread
+	bool pushOpen(U32 idxLabel, U64 start);
+	bool popOpen(U32& idxLabel, U64& start);
+
+	/*!
+	 * copies the events published after the given count that are still in the ring.
+	 * @return the published count to pass to the next call
+	 */
+	U64 snapshot(U64 from, vector<ProfileRecord>& out) const;
+
+	U64 countPublished() const { return m_head.load(std::memory_order_acquire);}
 
-	//Set timestamps
-	void start();
-	double end();
-
-	//Access
-	double timeMS() const { return m_timeMS;}
-	AnsiStr filename() const {return m_strFileName;}
-	AnsiStr funcname() const {return m_strFuncName;}
-	AnsiStr desc() const {return m_strDesc;}
-	int line() const {return m_line;}
-	//AnsiStr toString() const;
-
-	//Ticks
-	tick getStartTick() const {return m_start;}
-	tick getEndTick() const {return m_end;}
 private:
-	AnsiStr m_strFileName;
-	AnsiStr m_strFuncName;
-	AnsiStr m_strDesc;
-	int m_line;
-	tick m_start;
-	tick m_end;
-	double m_timeMS;
+	LatencyHistogram* createHistogram(U32 idxLabel);
+
+	U32 m_idxThread;
+	std::atomic<U64> m_head;
+	ProfileRecord m_records[PROFILE_RING_CAPACITY];
+
+	U32 m_ctOpen;
+	U32 m_openLabels[MAX_PROFILE_DEPTH];
+	U64 m_openStarts[MAX_PROFILE_DEPTH];
+
+	//allocated on the first event of a label
+	std::atomic<LatencyHistogram*> m_histograms[MAX_PROFILE_LABELS];
+};
+
+class ProfileAutoEvent {
+public:
+	explicit ProfileAutoEvent(U32 idxLabel);
+	~ProfileAutoEvent();
+
+private:
+	U32 m_idxLabel;
+	U64 m_start;
 };
 
 
-//Aggregated Stats
+//Aggregated Stats of the events recorded between start and end
 class ProfileSession {
 public:
 	ProfileSession();
@@ -85,11 +160,7 @@ public:
 	//End
 	void end();
 
-	//Events
-	void startEvent(ProfileEvent* e);
-	ProfileEvent* endEvent();
-	ProfileEvent* get(int index) const;
-	int count() const {return (int)m_vEvents.size();}
+	int count() const {return m_ctEvents;}
 
 	//Avg
 	void setAvg(double a) {m_avgMS = a;}
@@ -103,49 +174,43 @@ public:
 	void setHighest(double h) {m_highestMS = h;}
 	double getHightest() const {return m_highestMS;}
 
+	//Percentiles
+	double getP50() const {return m_p50MS;}
+	double getP99() const {return m_p99MS;}
+
 	double duration() const;
 	void setValid() {m_isStatsValid = true;}
 
-	bool hasPendingEvents() const { return (!m_stkCurrent.empty());}
 	AnsiStr toString() const;
-
-	//Serialization
-	int writeToTextFile();
-	int writeToSqlDB();
 	void cleanup();
-protected:
-
-	bool isEventIndex(int idx) const { return (idx >= 0 && idx < (int)m_vEvents.size());}
-
 
 protected:
-	AnsiStr m_strTextFile;
-	AnsiStr m_strSQLDB;
-
 	//Stats
-	ProfileEvent* m_lpSlowestE;
-	ProfileEvent* m_lpFastestE;
 	double m_avgMS;
 	double m_lowestMS;
 	double m_highestMS;
+	double m_p50MS;
+	double m_p99MS;
 	bool m_isStatsValid;
+	int m_ctEvents;
 	tick m_tickStart;
 	tick m_tickEnd;
-
-	//Storage
-	std::stack<ProfileEvent*> m_stkCurrent;
-	std::vector<ProfileEvent*> m_vEvents;
+	U64 m_cyclesStart;
 };
 
 /*!
- * Profiler manages all profiling events and provides access for reporting
+ * Profiler manages all profiling events and provides access for reporting. Recording an
+ * event reads the cycle counter twice and writes one record into the ring of the calling
+ * thread, so it is safe inside tbb tasks and cheap enough to leave on.
  */
 class Profiler {
 public:
-	enum Behaviour {pbInjectToLogger = 1, pbWriteToTextFile = 2, pbWriteToSqlDB = 4};
+	enum Behaviour {pbInjectToLogger = 1, pbWriteToTextFile = 2, pbWriteLatencyStats = 8};
 public:
 	Profiler();
 	virtual ~Profiler();
+
+	//writes the events recorded since the last flush
 	void flush();
 
 	//Session
@@ -153,29 +218,89 @@ public:
 	void endSession();
 	ProfileSession& session() {return m_session;}
 
+	//labels
+	U32 registerLabel(const char* filename, const char* funcname, int line, const char* desc);
+	U32 findOrRegisterLabel(const char* filename, const char* funcname, int line, const char* desc);
+	const ProfileLabel* label(U32 idxLabel) const;
+	U32 countLabels() const { return m_ctLabels.load(std::memory_order_acquire);}
+
 	//Event Generation
+	void recordEvent(U32 idxLabel, U64 start, U64 end);
 	void startEvent(const char* filename, const char* funcname, int line, const char* desc);
 	double endEvent();
 
+	//events still held by the thread rings, ordered by start time
+	void snapshot(vector<ProfileRecord>& out) const;
+
+	//writes the events held by the thread rings in the chrome trace event format
+	bool writeChromeTrace(const AnsiStr& strPath) const;
+
+	//durations of a label over all threads since the start
+	void latency(U32 idxLabel, LatencyHistogram& out) const;
+
+	//summaries of the labels that ran, sorted by label
+	void latencyStats(vector<ProfileLatency>& out) const;
+	bool writeLatencyStats(const AnsiStr& strPath) const;
+	static bool ReadLatencyStats(const AnsiStr& strPath, vector<ProfileLatency>& out);
+
 	//Flags
 	int flags() const { return m_flags;}
 	void setWriteFlags(int flags) {m_flags = flags;}
 	bool getInjectToLogFlag() const;
 	void setInjectToLogFlag(bool enable);
 
+	//conversion of cycle counts
+	double cyclesToMS(U64 cycles) const;
 
 	static tick GetTickCount();
 
+	//time stamp counter where available, nanoseconds otherwise
+	static inline U64 ReadCycles();
+
 protected:
+	ProfileThreadBuffer* threadBuffer();
+	void calibrate();
+	int writeToTextFile();
 
 private:
 	ProfileSession m_session;
 	int m_flags;
+
+	//labels are never moved once published
+	std::mutex m_lockLabels;
+	ProfileLabel* m_labels[MAX_PROFILE_LABELS];
+	std::atomic<U32> m_ctLabels;
+	std::map<std::pair<const char*, int>, U32> m_mapCallSites;
+
+	//one ring per thread that recorded an event
+	mutable std::mutex m_lockBuffers;
+	vector<ProfileThreadBuffer*> m_vBuffers;
+	vector<U64> m_vFlushed;
+
+	//cycle counter calibration
+	U64 m_cycles0;
+	tick m_tick0;
+	double m_msPerCycle;
+	AnsiStr m_strTextFile;
+	AnsiStr m_strLatencyFile;
 };
 
 //Singleton Instance
 typedef SingletonHolder<Profiler, CreateUsingNew, PhoenixSingleton> TheProfiler;
 
+U64 Profiler::ReadCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	U32 lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((U64)hi << 32) | lo;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (U64)ts.tv_sec * 1000000000ULL + (U64)ts.tv_nsec;
+#endif
+}
+
+U32 psProfileRegisterLabel(const char* filename, const char* funcname, int line, const char* desc = NULL);
 void psProfileStart(const char* filename, const char* funcname, int line, const char* desc = NULL);
 void psProfileEnd();
 
@@ -4,6 +4,7 @@
 #include "base/AlignedAlloc.h"
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 #ifdef PS_OS_MAC
     #include <malloc/malloc.h>
@@ -26,6 +27,19 @@
 //#define SIMD_USE_M256
 //#define SIMD_USE_M512
 
+//intrinsics are included at global scope so other headers see the same declarations
+#ifdef SIMD_USE_M128
+#if defined(PS_OS_LINUX)
+	#include <x86intrin.h>
+#endif
+	#include <xmmintrin.h>
+	#include <emmintrin.h>
+#endif
+
+#ifdef SIMD_USE_M256
+	#include <immintrin.h>
+#endif
+
 //SIMD Functionality namespace
 namespace PS{
 namespace MATHSIMD{
@@ -33,13 +47,10 @@ namespace MATHSIMD{
 /////////////////////////////////////////////////////////////////////////
 //128 bit SIMD
 #ifdef SIMD_USE_M128
-#if defined(PS_OS_LINUX)
-	#include <x86intrin.h>
-#endif
-	#include <xmmintrin.h>
 //	#include <pmmintrin.h>
 
 	#define PS_SIMD_FLEN	4
+	#define PS_SIMD_DLEN	2
 	#define PS_SIMD_ALIGN_SIZE 16
 
 	inline const __m128 fast_pow( const __m128& base, const __m128& exponent)
@@ -54,11 +65,10 @@ namespace MATHSIMD{
 
 //256 bit SIMD
 #ifdef SIMD_USE_M256
-	#include <immintrin.h>
-
 	//#include <intrin.h>
 
 	#define PS_SIMD_FLEN	8
+	#define PS_SIMD_DLEN	4
 	#define PS_SIMD_ALIGN_SIZE 32
 
 	inline const __m256 fast_pow( const __m256& base, const __m256& exponent)
@@ -71,7 +81,11 @@ namespace MATHSIMD{
 
 #endif
 
-	
+
+#ifndef PS_SIMD_DLEN
+	#define PS_SIMD_DLEN	1
+#endif
+
 // gives the number of SIMD blocks necessary for _SIZE_ elements
 #define 	PS_SIMD_BLOCKS(_SIZE_)		(((unsigned)(_SIZE_) + (PS_SIMD_FLEN-1)) / PS_SIMD_FLEN)
 
@@ -686,16 +700,257 @@ public:
 
 };
 
+//=====================================================================
+// Double SIMD
+#undef FOR_I_N
+#define FOR_I_N for (int i=0; i<PS_SIMD_DLEN; ++i)
+
+template<>
+class VecN<double,PS_SIMD_DLEN>
+{
+//==================================================================
+/// 128 bit 2-way double SIMD
+//==================================================================
+#ifdef SIMD_USE_M128
+public:
+	__m128d	v;
+
+	//==================================================================
+	VecN()						{}
+	VecN( const __m128d &v_ )	{ v = v_; }
+	VecN( const VecN &v_ )		{ v = v_.v; }
+	VecN( double a_ )			{ v = _mm_set1_pd( a_ );	}
+	VecN( const double *p_ )	{ v = _mm_load_pd( p_ );	}
+
+	void setZero()				{ v = _mm_setzero_pd();		}
+	void store(double* lpAlignedDest) 			{ _mm_store_pd(lpAlignedDest, v);}
+
+	VecN operator + (const double& rval) const	{ return _mm_add_pd( v, _mm_set1_pd( rval )	); }
+	VecN operator - (const double& rval) const	{ return _mm_sub_pd( v, _mm_set1_pd( rval )	); }
+	VecN operator * (const double& rval) const	{ return _mm_mul_pd( v, _mm_set1_pd( rval )	); }
+	VecN operator / (const double& rval) const	{ return _mm_div_pd( v, _mm_set1_pd( rval )	); }
+	VecN operator + (const VecN &rval) const	{ return _mm_add_pd( v, rval.v	); }
+	VecN operator - (const VecN &rval) const	{ return _mm_sub_pd( v, rval.v	); }
+	VecN operator * (const VecN &rval) const	{ return _mm_mul_pd( v, rval.v	); }
+	VecN operator / (const VecN &rval) const	{ return _mm_div_pd( v, rval.v	); }
+
+	VecN operator -() const						{ return _mm_sub_pd( _mm_setzero_pd(), v ); }
+
+	VecN operator +=(const VecN &rval)			{ *this = *this + rval; return *this; }
+
+	double operator [] (size_t i) const
+	{
+		double PS_SIMD_ALIGN(arrVal[PS_SIMD_DLEN]);
+		_mm_store_pd(arrVal, v);
+		return arrVal[i];
+	}
+
+	//Comparison Operations
+	friend inline VecN SimdMin( const VecN &a, const VecN &b )	{	return _mm_min_pd( a.v, b.v );	}
+	friend inline VecN SimdMax( const VecN &a, const VecN &b )	{	return _mm_max_pd( a.v, b.v );	}
+
+	//Horizontal min and max over all lanes
+	friend inline double SimdhMin( const VecN &a )	{ return _mm_cvtsd_f64( _mm_min_sd( a.v, _mm_unpackhi_pd( a.v, a.v ) ) ); }
+	friend inline double SimdhMax( const VecN &a )	{ return _mm_cvtsd_f64( _mm_max_sd( a.v, _mm_unpackhi_pd( a.v, a.v ) ) ); }
+
+	//Lane masks with bit i set when the comparison holds in lane i
+	friend inline int SimdMaskLT( const VecN &lval, const VecN &rval ) { return _mm_movemask_pd( _mm_cmplt_pd( lval.v, rval.v ) ); }
+	friend inline int SimdMaskLE( const VecN &lval, const VecN &rval ) { return _mm_movemask_pd( _mm_cmple_pd( lval.v, rval.v ) ); }
+	friend inline int SimdMaskGT( const VecN &lval, const VecN &rval ) { return _mm_movemask_pd( _mm_cmpgt_pd( lval.v, rval.v ) ); }
+	friend inline int SimdMaskGE( const VecN &lval, const VecN &rval ) { return _mm_movemask_pd( _mm_cmpge_pd( lval.v, rval.v ) ); }
+
+	friend inline VecN	SimdSqrt( const VecN &a )	{ return _mm_sqrt_pd( a.v );	}
+
+	//Converts from AOS to SOA. The source does not need to be aligned.
+	friend inline void SimdLoadVector(const double* lpVector, VecN& pX, VecN& pY, VecN& pZ)
+	{
+		__m128d x0y0 = _mm_loadu_pd(lpVector);
+		__m128d z0x1 = _mm_loadu_pd(lpVector + 2);
+		__m128d y1z1 = _mm_loadu_pd(lpVector + 4);
+
+		pX = _mm_shuffle_pd(x0y0, z0x1, _MM_SHUFFLE2(1, 0)); // x0x1
+		pY = _mm_shuffle_pd(x0y0, y1z1, _MM_SHUFFLE2(0, 1)); // y0y1
+		pZ = _mm_shuffle_pd(z0x1, y1z1, _MM_SHUFFLE2(1, 0)); // z0z1
+	}
+
+	//Converts from SOA to AOS. The destination does not need to be aligned.
+	friend inline void SimdStoreVector(double* lpVector, const VecN& pX, const VecN& pY, const VecN& pZ)
+	{
+		_mm_storeu_pd(lpVector, _mm_unpacklo_pd(pX.v, pY.v));
+		_mm_storeu_pd(lpVector + 2, _mm_shuffle_pd(pZ.v, pX.v, _MM_SHUFFLE2(1, 0)));
+		_mm_storeu_pd(lpVector + 4, _mm_unpackhi_pd(pY.v, pZ.v));
+	}
+
+#elif defined(SIMD_USE_M256)
+	//==================================================================
+	/// 256 bit 4-way double SIMD
+	//==================================================================
+public:
+	__m256d	v;
+
+	//==================================================================
+	VecN()						{}
+	VecN( const __m256d &v_ )	{ v = v_; }
+	VecN( const VecN &v_ )		{ v = v_.v; }
+	VecN( double a_ )			{ v = _mm256_set1_pd( a_ );	}
+
+	//Loads Aligned
+	VecN( const double *p_ )	{ v = _mm256_load_pd( p_ );	}
+
+	void setZero()				{ v = _mm256_setzero_pd();		}
+	void store(double* lpAlignedDest) 			{ _mm256_store_pd(lpAlignedDest, v);}
+
+	VecN operator + (const double& rval) const	{ return _mm256_add_pd( v, _mm256_set1_pd( rval )	); }
+	VecN operator - (const double& rval) const	{ return _mm256_sub_pd( v, _mm256_set1_pd( rval )	); }
+	VecN operator * (const double& rval) const	{ return _mm256_mul_pd( v, _mm256_set1_pd( rval )	); }
+	VecN operator / (const double& rval) const	{ return _mm256_div_pd( v, _mm256_set1_pd( rval )	); }
+	VecN operator + (const VecN &rval) const	{ return _mm256_add_pd( v, rval.v	); }
+	VecN operator - (const VecN &rval) const	{ return _mm256_sub_pd( v, rval.v	); }
+	VecN operator * (const VecN &rval) const	{ return _mm256_mul_pd( v, rval.v	); }
+	VecN operator / (const VecN &rval) const	{ return _mm256_div_pd( v, rval.v	); }
+
+	VecN operator -() const						{ return _mm256_sub_pd( _mm256_setzero_pd(), v ); }
+
+	VecN operator +=(const VecN &rval)			{ *this = *this + rval; return *this; }
+
+	double operator [] (size_t i) const
+	{
+		double PS_SIMD_ALIGN(arrVal[PS_SIMD_DLEN]);
+		_mm256_store_pd(arrVal, v);
+		return arrVal[i];
+	}
+
+	//Comparison Operations
+	friend inline VecN SimdMin( const VecN &a, const VecN &b )	{	return _mm256_min_pd( a.v, b.v );	}
+	friend inline VecN SimdMax( const VecN &a, const VecN &b )	{	return _mm256_max_pd( a.v, b.v );	}
+
+	//Horizontal min and max over all lanes
+	friend inline double SimdhMin( const VecN &a )
+	{
+		__m128d m = _mm_min_pd( _mm256_castpd256_pd128( a.v ), _mm256_extractf128_pd( a.v, 1 ) );
+		return _mm_cvtsd_f64( _mm_min_sd( m, _mm_unpackhi_pd( m, m ) ) );
+	}
+
+	friend inline double SimdhMax( const VecN &a )
+	{
+		__m128d m = _mm_max_pd( _mm256_castpd256_pd128( a.v ), _mm256_extractf128_pd( a.v, 1 ) );
+		return _mm_cvtsd_f64( _mm_max_sd( m, _mm_unpackhi_pd( m, m ) ) );
+	}
+
+	//Lane masks with bit i set when the comparison holds in lane i
+	friend inline int SimdMaskLT( const VecN &lval, const VecN &rval ) { return _mm256_movemask_pd( _mm256_cmp_pd( lval.v, rval.v, _CMP_LT_OQ ) ); }
+	friend inline int SimdMaskLE( const VecN &lval, const VecN &rval ) { return _mm256_movemask_pd( _mm256_cmp_pd( lval.v, rval.v, _CMP_LE_OQ ) ); }
+	friend inline int SimdMaskGT( const VecN &lval, const VecN &rval ) { return _mm256_movemask_pd( _mm256_cmp_pd( lval.v, rval.v, _CMP_GT_OQ ) ); }
+	friend inline int SimdMaskGE( const VecN &lval, const VecN &rval ) { return _mm256_movemask_pd( _mm256_cmp_pd( lval.v, rval.v, _CMP_GE_OQ ) ); }
+
+	friend inline VecN	SimdSqrt( const VecN &a )	{ return _mm256_sqrt_pd( a.v );	}
+
+	//Converts from AOS to SOA. The source does not need to be aligned.
+	friend inline void SimdLoadVector(const double* lpVector, VecN& pX, VecN& pY, VecN& pZ)
+	{
+		__m256d m0 = _mm256_loadu_pd(lpVector);		// x0y0z0x1
+		__m256d m1 = _mm256_loadu_pd(lpVector + 4);	// y1z1x2y2
+		__m256d m2 = _mm256_loadu_pd(lpVector + 8);	// z2x3y3z3
+
+		__m256d xy = _mm256_permute2f128_pd(m0, m1, 0x30); // x0y0x2y2
+		__m256d zx = _mm256_permute2f128_pd(m0, m2, 0x21); // z0x1z2x3
+		__m256d yz = _mm256_permute2f128_pd(m1, m2, 0x30); // y1z1y3z3
+
+		pX = _mm256_shuffle_pd(xy, zx, 0x0A);
+		pY = _mm256_shuffle_pd(xy, yz, 0x05);
+		pZ = _mm256_shuffle_pd(zx, yz, 0x0A);
+	}
+
+	//Converts from SOA to AOS. The destination does not need to be aligned.
+	friend inline void SimdStoreVector(double* lpVector, const VecN& pX, const VecN& pY, const VecN& pZ)
+	{
+		__m256d xy = _mm256_unpacklo_pd(pX.v, pY.v);		// x0y0x2y2
+		__m256d zx = _mm256_shuffle_pd(pZ.v, pX.v, 0x0A);	// z0x1z2x3
+		__m256d yz = _mm256_shuffle_pd(pY.v, pZ.v, 0x0F);	// y1z1y3z3
+
+		_mm256_storeu_pd(lpVector, _mm256_permute2f128_pd(xy, zx, 0x20));
+		_mm256_storeu_pd(lpVector + 4, _mm256_permute2f128_pd(yz, xy, 0x30));
+		_mm256_storeu_pd(lpVector + 8, _mm256_permute2f128_pd(zx, yz, 0x31));
+	}
+
+#else
+//==================================================================
+/// No hardware SIMD
+//==================================================================
+public:
+	double	v[PS_SIMD_DLEN];
+
+	//==================================================================
+	VecN()						{}
+	VecN( const VecN &v_ )		{ FOR_I_N v[i] = v_.v[i]; }
+	VecN( double a_ )			{ FOR_I_N v[i] = a_;		}
+	VecN( const double *p_ )	{ FOR_I_N v[i] = p_[i];	}
+
+	void setZero()				{ FOR_I_N v[i] = 0;		}
+	void store(double* lpDest)	{ FOR_I_N lpDest[i] = v[i];	}
+
+	VecN operator + (const double& rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] + rval; return tmp; }
+	VecN operator - (const double& rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] - rval; return tmp; }
+	VecN operator * (const double& rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] * rval; return tmp; }
+	VecN operator / (const double& rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] / rval; return tmp; }
+	VecN operator + (const VecN &rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] + rval.v[i]; return tmp; }
+	VecN operator - (const VecN &rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] - rval.v[i]; return tmp; }
+	VecN operator * (const VecN &rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] * rval.v[i]; return tmp; }
+	VecN operator / (const VecN &rval) const	{ VecN tmp; FOR_I_N tmp.v[i] = v[i] / rval.v[i]; return tmp; }
+
+	VecN operator -() const	{ VecN tmp; FOR_I_N tmp.v[i] = -v[i]; return tmp; }
+
+	VecN operator +=(const VecN &rval)	{ *this = *this + rval; return *this; }
+
+	double operator [] (size_t i) const	{ return v[i]; }
+
+	friend inline VecN SimdMin( const VecN &a, const VecN &b )	{ VecN tmp; FOR_I_N tmp.v[i] = (a.v[i] < b.v[i]) ? a.v[i] : b.v[i]; return tmp; }
+	friend inline VecN SimdMax( const VecN &a, const VecN &b )	{ VecN tmp; FOR_I_N tmp.v[i] = (a.v[i] > b.v[i]) ? a.v[i] : b.v[i]; return tmp; }
+
+	friend inline double SimdhMin( const VecN &a )	{ double r = a.v[0]; FOR_I_N r = (a.v[i] < r) ? a.v[i] : r; return r; }
+	friend inline double SimdhMax( const VecN &a )	{ double r = a.v[0]; FOR_I_N r = (a.v[i] > r) ? a.v[i] : r; return r; }
+
+	friend inline int SimdMaskLT( const VecN &lval, const VecN &rval ) { int mask = 0; FOR_I_N mask |= (lval.v[i] < rval.v[i]) ? (1 << i) : 0; return mask; }
+	friend inline int SimdMaskLE( const VecN &lval, const VecN &rval ) { int mask = 0; FOR_I_N mask |= (lval.v[i] <= rval.v[i]) ? (1 << i) : 0; return mask; }
+	friend inline int SimdMaskGT( const VecN &lval, const VecN &rval ) { int mask = 0; FOR_I_N mask |= (lval.v[i] > rval.v[i]) ? (1 << i) : 0; return mask; }
+	friend inline int SimdMaskGE( const VecN &lval, const VecN &rval ) { int mask = 0; FOR_I_N mask |= (lval.v[i] >= rval.v[i]) ? (1 << i) : 0; return mask; }
+
+	friend inline VecN	SimdSqrt( const VecN &a )	{ VecN tmp; FOR_I_N tmp.v[i] = sqrt(a.v[i]); return tmp; }
+
+	friend inline void SimdLoadVector(const double* lpVector, VecN& pX, VecN& pY, VecN& pZ)
+	{
+		FOR_I_N {
+			pX.v[i] = lpVector[i * 3];
+			pY.v[i] = lpVector[i * 3 + 1];
+			pZ.v[i] = lpVector[i * 3 + 2];
+		}
+	}
+
+	friend inline void SimdStoreVector(double* lpVector, const VecN& pX, const VecN& pY, const VecN& pZ)
+	{
+		FOR_I_N {
+			lpVector[i * 3] = pX.v[i];
+			lpVector[i * 3 + 1] = pY.v[i];
+			lpVector[i * 3 + 2] = pZ.v[i];
+		}
+	}
+
+#endif
+
+};
+
 #undef FOR_I_N
 
 //==================================================================
 #if defined(_MSC_VER)
 
 typedef __declspec(align(PS_SIMD_ALIGN_SIZE)) VecN<float,PS_SIMD_FLEN>			Float_;
+typedef __declspec(align(PS_SIMD_ALIGN_SIZE)) VecN<double,PS_SIMD_DLEN>			Double_;
 
 #elif defined(__GNUC__)
 
 typedef 	VecN<float,PS_SIMD_FLEN>			Float_ __attribute__ ((aligned(PS_SIMD_ALIGN_SIZE)));
+typedef 	VecN<double,PS_SIMD_DLEN>			Double_ __attribute__ ((aligned(PS_SIMD_ALIGN_SIZE)));
 
 #endif
 
@@ -0,0 +1,60 @@
+/*
+ * SpaceFillingCurve.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "SpaceFillingCurve.h"
+
+namespace PS {
+namespace MATH {
+
+//spreads the low 21 bits of v two bits apart
+static U64 SpreadBits3(U32 v) {
+	U64 x = v & 0x1fffff;
+	x = (x | (x << 32)) & 0x1f00000000ffffULL;
+	x = (x | (x << 16)) & 0x1f0000ff0000ffULL;
+	x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+	x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+	x = (x | (x << 2)) & 0x1249249249249249ULL;
+	return x;
+}
+
+U64 MortonKey3(U32 x, U32 y, U32 z) {
+	return (SpreadBits3(x) << 2) | (SpreadBits3(y) << 1) | SpreadBits3(z);
+}
+
+U64 HilbertKey3(U32 x, U32 y, U32 z) {
+	//Skilling's transform from axes to the transposed hilbert index
+	U32 X[3] = {x & 0x1fffff, y & 0x1fffff, z & 0x1fffff};
+	const U32 M = 1u << (SFC_BITS_PER_AXIS - 1);
+
+	//inverse undo excess work. Either inverts the low bits of X[0] or exchanges them with
+	//those of X[i]. Both are done with masks since the branches are unpredictable.
+	for(U32 Q = M; Q > 1; Q >>= 1) {
+		U32 P = Q - 1;
+		for(int i=0; i < 3; i++) {
+			U32 isSet = 0 - (U32)((X[i] & Q) != 0);
+			U32 t = (X[0] ^ X[i]) & P & ~isSet;
+			X[0] ^= (P & isSet) | t;
+			X[i] ^= t;
+		}
+	}
+
+	//gray encode
+	for(int i=1; i < 3; i++)
+		X[i] ^= X[i - 1];
+
+	U32 t = 0;
+	for(U32 Q = M; Q > 1; Q >>= 1)
+		t ^= (Q - 1) & (0 - (U32)((X[2] & Q) != 0));
+	for(int i=0; i < 3; i++)
+		X[i] ^= t;
+
+	//the transposed index reads as a morton key
+	return MortonKey3(X[0], X[1], X[2]);
+}
+
+}
+}
@@ -0,0 +1,33 @@
+/*
+ * SpaceFillingCurve.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef SPACEFILLINGCURVE_H_
+#define SPACEFILLINGCURVE_H_
+
+#include "MathBase.h"
+
+#define SFC_BITS_PER_AXIS 21
+
+namespace PS {
+namespace MATH {
+
+/*!
+ * Keys along 3D space filling curves. Coordinates are integers on a grid of
+ * 2^SFC_BITS_PER_AXIS cells per axis. Sorting points by their keys places points
+ * that are close in space close in the sorted order.
+ */
+
+//z-order key. Interleaves the bits of x, y and z with x in the highest bit of each triple.
+U64 MortonKey3(U32 x, U32 y, U32 z);
+
+//hilbert key. Consecutive keys are always face neighbors on the grid.
+U64 HilbertKey3(U32 x, U32 y, U32 z);
+
+}
+}
+
+#endif /* SPACEFILLINGCURVE_H_ */
@@ -178,13 +178,16 @@ void AvatarRing::onTranslate(const vec3f& delta, const vec3f& pos) {
 
 		if(m_isSweptQuadValid) {
 			//call the cut method if the tool has passed through the tissue
-			int res = m_lpTissue->cut(m_vSegmentsCur, m_vSweptQuads, true);
-			LogInfoArg1("Tissue cut. res = %d", res);
-			if((res > 0) && (m_fOnCutFinished != NULL))
-				m_fOnCutFinished();
+			if(m_lpRecorder)
+				m_lpRecorder->endStroke();
+
+			//the tool keeps moving while the tissue is cut
+			if(m_lpTissue->getFlagProgressiveCut())
+				m_lpTissue->queueEndProgressiveCut(m_vSweptQuads, cutCommittedHandler());
+			else
+				m_lpTissue->queueCut(m_vSegmentsCur, m_vSweptQuads, cutCommittedHandler());
 
 			clearCutContext();
-			updateVolMeshInfoHeader();
 		}
 
 		return;
@@ -218,17 +221,36 @@ void AvatarRing::onTranslate(const vec3f& delta, const vec3f& pos) {
 	}
 
 
+	//record the ring
+	if(m_lpRecorder) {
+		if(m_vCuttingPath.size() == 0)
+			m_lpRecorder->beginStroke();
+		m_lpRecorder->addFrame(m_vSegmentsCur);
+	}
+
 	//Insert new scalpal position into buffer
 	m_vCuttingPath.push_back(m_vSegmentsCur.back());
 
 	//delete last if overflow buffer
 	if (m_vCuttingPath.size() > MAX_SCALPEL_TRAJECTORY_NODES)
 		m_vCuttingPath.erase(m_vCuttingPath.begin());
+
+	//Progressive cutting: cut the tets crossed since the last ring position
+	if(m_isSweptQuadValid && m_lpTissue->getFlagProgressiveCut()) {
+		vector<vec3d> vStepQuads(m_vSweptQuads.size());
+		for(U32 i = 0; i < m_vSegmentsCur.size(); i++) {
+			vStepQuads[i * 2] = m_vSegmentsPrev[i];
+			vStepQuads[i * 2 + 1] = m_vSegmentsCur[i];
+		}
+
+		m_lpTissue->queueCutProgressive(m_vSegmentsCur, vStepQuads, progressiveStepCommittedHandler());
+	}
+	m_vSegmentsPrev = m_vSegmentsCur;
 }
 
 void AvatarRing::clearCutContext() {
 	if(m_lpTissue)
-		m_lpTissue->clearCutContext();
+		m_lpTissue->queueClearCutContext();
 	m_vCuttingPath.clear();
 	m_isSweptQuadValid = false;
 	m_applyGripper = false;
@@ -42,6 +42,7 @@ protected:
 	vector<vec3d> m_vSweptQuads;
 	vector<vec3d> m_vSegmentsRef;
 	vector<vec3d> m_vSegmentsCur;
+	vector<vec3d> m_vSegmentsPrev;
 };
 
 } /* namespace MESH */
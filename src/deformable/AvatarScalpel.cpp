@@ -122,7 +122,7 @@ void AvatarScalpel::clearCutContext() {
 	m_isSweptQuadValid = false;
 
 	if(m_lpTissue)
-		m_lpTissue->clearCutContext();
+		m_lpTissue->queueClearCutContext();
 }
 
 
@@ -144,14 +144,16 @@ void AvatarScalpel::onTranslate(const vec3f& delta, const vec3f& pos) {
 			m_vBladeSegments.resize(2);
 			m_vBladeSegments[0] = m_vCuttingPathEdge0.back();
 			m_vBladeSegments[1] = m_vCuttingPathEdge1.back();
+			if(m_lpRecorder)
+				m_lpRecorder->endStroke();
 
-			int res = m_lpTissue->cut(m_vBladeSegments, m_vSweptQuad, true);
-			LogInfoArg1("Tissue cut. res = %d", res);
-			if((res > 0) && (m_fOnCutFinished != NULL))
-				m_fOnCutFinished();
+			//the tool keeps moving while the tissue is cut
+			if(m_lpTissue->getFlagProgressiveCut())
+				m_lpTissue->queueEndProgressiveCut(m_vSweptQuad, cutCommittedHandler());
+			else
+				m_lpTissue->queueCut(m_vBladeSegments, m_vSweptQuad, cutCommittedHandler());
 
 			clearCutContext();
-			updateVolMeshInfoHeader();
 		}
 
 		return;
@@ -207,6 +209,17 @@ void AvatarScalpel::onTranslate(const vec3f& delta, const vec3f& pos) {
 	}
 
 
+	//record the blade
+	if(m_lpRecorder) {
+		if(m_vCuttingPathEdge0.size() == 0)
+			m_lpRecorder->beginStroke();
+
+		CutTrajectory::FRAME blade(2);
+		blade[0] = edge0;
+		blade[1] = edge1;
+		m_lpRecorder->addFrame(blade);
+	}
+
 	//Insert new scalpal position into buffer
 	m_vCuttingPathEdge0.push_back(edge0);
 	m_vCuttingPathEdge1.push_back(edge1);
@@ -218,8 +231,22 @@ void AvatarScalpel::onTranslate(const vec3f& delta, const vec3f& pos) {
 	if (m_vCuttingPathEdge1.size() > MAX_SCALPEL_TRAJECTORY_NODES)
 		m_vCuttingPathEdge1.erase(m_vCuttingPathEdge1.begin());
 
-	//int res = m_lpTissue->cut(m_vCuttingPathEdge0, m_vCuttingPathEdge1, m_sweptQuad, false);
-	//LogInfoArg1("Progressive cutting not implemented. res = %d", res);
+	//Progressive cutting: cut the tets crossed since the last blade position
+	if(m_isSweptQuadValid && m_lpTissue->getFlagProgressiveCut()) {
+		U32 last = m_vCuttingPathEdge0.size() - 1;
+
+		m_vBladeSegments.resize(2);
+		m_vBladeSegments[0] = edge0;
+		m_vBladeSegments[1] = edge1;
+
+		vector<vec3d> vStepQuad(4);
+		vStepQuad[0] = m_vCuttingPathEdge0[last - 1];
+		vStepQuad[1] = edge0;
+		vStepQuad[2] = m_vCuttingPathEdge1[last - 1];
+		vStepQuad[3] = edge1;
+
+		m_lpTissue->queueCutProgressive(m_vBladeSegments, vStepQuad, progressiveStepCommittedHandler());
+	}
 }
 
 
@@ -0,0 +1,216 @@
+/*
+ * CutTrajectory.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "CutTrajectory.h"
+#include "base/Logger.h"
+#include <fstream>
+
+#define TRAJECTORY_HEADER "tetcutter_trajectory"
+#define TRAJECTORY_VERSION 1
+
+namespace PS {
+namespace MESH {
+
+CutTrajectory::CutTrajectory() {
+	m_isRecording = false;
+}
+
+CutTrajectory::~CutTrajectory() {
+	clear();
+}
+
+void CutTrajectory::clear() {
+	m_vStrokes.resize(0);
+	m_current.resize(0);
+	m_isRecording = false;
+}
+
+void CutTrajectory::beginStroke() {
+	m_current.resize(0);
+	m_isRecording = true;
+}
+
+void CutTrajectory::addFrame(const FRAME& blade) {
+	if(!m_isRecording || blade.size() < 2)
+		return;
+
+	//frames of a stroke have the same number of points
+	if(m_current.size() > 0 && m_current.back().size() != blade.size())
+		return;
+
+	m_current.push_back(blade);
+}
+
+void CutTrajectory::endStroke() {
+	if(m_isRecording && m_current.size() >= 2)
+		m_vStrokes.push_back(m_current);
+
+	m_current.resize(0);
+	m_isRecording = false;
+}
+
+void CutTrajectory::addScalpelStroke(const AABB& box, U32 ctFrames, double depth) {
+	if(ctFrames < 2)
+		return;
+
+	vec3f lo = box.lower();
+	vec3f hi = box.upper();
+	vec3f ext = box.extent();
+	double margin = 0.05 * (MATHMAX(MATHMAX(ext.x, ext.y), ext.z));
+
+	//off center so the blade does not run along grid planes
+	double z = lo.z + 0.537 * ext.z;
+	double y0 = hi.y + margin;
+	double y1 = hi.y - depth * ext.y;
+
+	STROKE stroke(ctFrames, FRAME(2));
+	for(U32 i=0; i < ctFrames; i++) {
+		double x = (lo.x - margin) + (ext.x + 2.0 * margin) * (double)i / (double)(ctFrames - 1);
+		stroke[i][0] = vec3d(x, y0, z);
+		stroke[i][1] = vec3d(x, y1, z);
+	}
+
+	m_vStrokes.push_back(stroke);
+}
+
+void CutTrajectory::addRingStroke(const AABB& box, U32 ctFrames, U32 ctSectors, double depth) {
+	if(ctFrames < 2 || ctSectors < 3)
+		return;
+
+	vec3f lo = box.lower();
+	vec3f hi = box.upper();
+	vec3f ext = box.extent();
+	double margin = 0.05 * (MATHMAX(MATHMAX(ext.x, ext.y), ext.z));
+	double radius = 0.261 * (MATHMIN(ext.x, ext.z));
+	vec3d center(lo.x + 0.513 * ext.x, 0.0, lo.z + 0.529 * ext.z);
+
+	double y0 = hi.y + margin;
+	double y1 = hi.y - depth * ext.y;
+
+	//closed ring as in the ring avatar
+	STROKE stroke(ctFrames, FRAME(ctSectors + 1));
+	for(U32 i=0; i < ctFrames; i++) {
+		double y = y0 + (y1 - y0) * (double)i / (double)(ctFrames - 1);
+		for(U32 j=0; j <= ctSectors; j++) {
+			double angle = double(j) * TwoPi / double(ctSectors);
+			stroke[i][j] = vec3d(center.x + radius * cos(angle), y, center.z + radius * sin(angle));
+		}
+	}
+
+	m_vStrokes.push_back(stroke);
+}
+
+void CutTrajectory::sweptQuads(const FRAME& from, const FRAME& to, vector<vec3d>& quadstrips) {
+	quadstrips.resize(from.size() * 2);
+	for(U32 i=0; i < from.size(); i++) {
+		quadstrips[i * 2] = from[i];
+		quadstrips[i * 2 + 1] = to[i];
+	}
+}
+
+int CutTrajectory::replay(CuttableMesh* lpMesh, U32 idxStroke) const {
+	if(lpMesh == NULL || idxStroke >= m_vStrokes.size())
+		return CUT_ERR_INVALID_INPUT_ARG;
+
+	const STROKE& stroke = m_vStrokes[idxStroke];
+	vector<vec3d> quadstrips;
+
+	//cut at every frame
+	if(lpMesh->getFlagProgressiveCut()) {
+		for(U32 i=1; i < stroke.size(); i++) {
+			sweptQuads(stroke[i - 1], stroke[i], quadstrips);
+			int res = lpMesh->cutProgressive(stroke[i], quadstrips);
+			if(res < 0) {
+				lpMesh->clearCutContext();
+				return res;
+			}
+		}
+
+		sweptQuads(stroke.front(), stroke.back(), quadstrips);
+		return lpMesh->endProgressiveCut(quadstrips);
+	}
+
+	//cut once the tool leaves the tissue
+	sweptQuads(stroke.front(), stroke.back(), quadstrips);
+	int res = lpMesh->cut(stroke.back(), quadstrips, true);
+	lpMesh->clearCutContext();
+	return res;
+}
+
+bool CutTrajectory::read(const AnsiStr& strPath) {
+	ifstream fpIn(strPath.cptr());
+	if(!fpIn.is_open()) {
+		LogErrorArg1("Unable to open trajectory file: %s", strPath.cptr());
+		return false;
+	}
+
+	string strHeader;
+	int version = 0;
+	U32 ctStrokes = 0;
+	fpIn >> strHeader >> version >> ctStrokes;
+	if(!fpIn || strHeader != TRAJECTORY_HEADER || version != TRAJECTORY_VERSION) {
+		LogErrorArg1("Not a trajectory file or unsupported version: %s", strPath.cptr());
+		return false;
+	}
+
+	clear();
+	for(U32 i=0; i < ctStrokes; i++) {
+		U32 ctFrames = 0;
+		U32 ctPoints = 0;
+		fpIn >> ctFrames >> ctPoints;
+		if(!fpIn || ctFrames < 2 || ctPoints < 2) {
+			LogErrorArg2("Invalid stroke %u in trajectory file: %s", i, strPath.cptr());
+			clear();
+			return false;
+		}
+
+		STROKE stroke(ctFrames, FRAME(ctPoints));
+		for(U32 f=0; f < ctFrames; f++) {
+			for(U32 p=0; p < ctPoints; p++)
+				fpIn >> stroke[f][p].x >> stroke[f][p].y >> stroke[f][p].z;
+		}
+
+		if(!fpIn) {
+			LogErrorArg2("Trajectory file is truncated at stroke %u: %s", i, strPath.cptr());
+			clear();
+			return false;
+		}
+
+		m_vStrokes.push_back(stroke);
+	}
+
+	return true;
+}
+
+bool CutTrajectory::write(const AnsiStr& strPath) const {
+	ofstream fpOut(strPath.cptr());
+	if(!fpOut.is_open()) {
+		LogErrorArg1("Unable to write trajectory file: %s", strPath.cptr());
+		return false;
+	}
+
+	//round trips doubles
+	fpOut.precision(17);
+	fpOut << TRAJECTORY_HEADER << " " << TRAJECTORY_VERSION << " " << m_vStrokes.size() << endl;
+	for(U32 i=0; i < m_vStrokes.size(); i++) {
+		const STROKE& stroke = m_vStrokes[i];
+		fpOut << stroke.size() << " " << stroke[0].size() << endl;
+
+		for(U32 f=0; f < stroke.size(); f++) {
+			for(U32 p=0; p < stroke[f].size(); p++) {
+				const vec3d& v = stroke[f][p];
+				fpOut << (p > 0 ? " " : "") << v.x << " " << v.y << " " << v.z;
+			}
+			fpOut << endl;
+		}
+	}
+
+	return true;
+}
+
+}
+}
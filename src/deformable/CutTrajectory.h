@@ -0,0 +1,78 @@
+/*
+ * CutTrajectory.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef CUTTRAJECTORY_H_
+#define CUTTRAJECTORY_H_
+
+#include "CuttableMesh.h"
+#include "graphics/AABB.h"
+#include <vector>
+
+using namespace std;
+
+namespace PS {
+namespace MESH {
+
+/*!
+ * Recorded tool trajectory. A stroke is the list of blade positions from the frame the tool
+ * entered the tissue to the frame the cut was made. A frame holds the blade polyline: two
+ * points for the scalpel and the ring points for the ring. Replaying a stroke issues the
+ * same cut calls as the tool avatars so cuts can be reproduced without the ui.
+ */
+class CutTrajectory {
+public:
+	typedef vector<vec3d> FRAME;
+	typedef vector<FRAME> STROKE;
+
+	CutTrajectory();
+	virtual ~CutTrajectory();
+
+	void clear();
+
+	//recording. Beginning a stroke drops a stroke that was not ended.
+	void beginStroke();
+	void addFrame(const FRAME& blade);
+	void endStroke();
+
+	//access
+	U32 countStrokes() const { return m_vStrokes.size();}
+	const STROKE& stroke(U32 i) const { return m_vStrokes[i];}
+
+	/*!
+	 * adds a straight scalpel pass. The blade hangs from above the box down to depth times
+	 * its height and moves along x across the box.
+	 */
+	void addScalpelStroke(const AABB& box, U32 ctFrames, double depth = 0.5);
+
+	//adds a ring of ctSectors pushed down along y into the box to depth times its height
+	void addRingStroke(const AABB& box, U32 ctFrames, U32 ctSectors, double depth = 0.5);
+
+	/*!
+	 * replays a stroke on the mesh. Progressive meshes are cut at every frame and the stroke
+	 * is ended after the last one.
+	 * @return number of tets subdivided or an error code of the cut
+	 */
+	int replay(CuttableMesh* lpMesh, U32 idxStroke) const;
+
+	//text format: a header line, then per stroke its frame and point counts followed by one frame per line
+	bool read(const AnsiStr& strPath);
+	bool write(const AnsiStr& strPath) const;
+
+protected:
+	//swept quads between two frames
+	static void sweptQuads(const FRAME& from, const FRAME& to, vector<vec3d>& quadstrips);
+
+private:
+	vector<STROKE> m_vStrokes;
+	STROKE m_current;
+	bool m_isRecording;
+};
+
+}
+}
+
+#endif /* CUTTRAJECTORY_H_ */
@@ -14,38 +14,129 @@
 #include "base/FlatArray.h"
 #include "base/Profiler.h"
 #include <map>
+#include <algorithm>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
 
 using namespace std;
 using namespace PS::INTERSECTIONS;
 
 namespace PS {
 
+//minimum work per task for the cut classification loops
+#define CUT_EDGE_GRAIN_SIZE 64
+#define CUT_CELL_GRAIN_SIZE 4096
+
+//cut-edges found by one task in candidate order
+typedef CuttableMesh::CutEdgeHits CUTEDGEHITS;
+
+//minimum nodes and edges per task for the node sign classification
+#define CUT_NODE_SIGN_GRAIN_SIZE 1024
+
+//relative distance within which a node counts for both sides of a plane
+#define NODE_SIGN_TOLERANCE 1e-6
+
+//node code bits per quad triangle: above, below and outside of each of the 3 sides
+#define NODE_SIGN_BITS 5
+#define NODE_SIGN_ABOVE 1
+#define NODE_SIGN_BELOW 2
+#define NODE_SIGN_OUTSIDE 28
+
+//cells crossed by a cut and their codes found by one task in cell order
+struct CutCellList {
+	vector<U32> cells;
+	vector<U8> edgeCodes;
+	vector<U8> nodeCodes;
+
+	//first cell listing a cut-edge that does not belong to it
+	U32 idxBadCell;
+	U32 idxBadEdge;
+
+	CutCellList() {
+		idxBadCell = idxBadEdge = VolMesh::INVALID_INDEX;
+	}
+
+	//rhs covers the cells after this list
+	void append(const CutCellList& rhs) {
+		cells.insert(cells.end(), rhs.cells.begin(), rhs.cells.end());
+		edgeCodes.insert(edgeCodes.end(), rhs.edgeCodes.begin(), rhs.edgeCodes.end());
+		nodeCodes.insert(nodeCodes.end(), rhs.nodeCodes.begin(), rhs.nodeCodes.end());
+		if(idxBadCell == VolMesh::INVALID_INDEX) {
+			idxBadCell = rhs.idxBadCell;
+			idxBadEdge = rhs.idxBadEdge;
+		}
+	}
+};
+
 ///////////////////////////////////////////////////////////////////////////
+CuttableMesh::CuttableMesh(): VolMesh() {
+	init();
+}
+
 CuttableMesh::CuttableMesh(const VolMesh& volmesh): VolMesh(volmesh) {
+	init();
 	setup();
 }
 
 CuttableMesh::CuttableMesh(const vector<double>& vertices, const vector<U32>& elements): VolMesh(vertices, elements) {
-
+	init();
 	setup();
 }
 
 CuttableMesh::CuttableMesh(int ctVertices, double* vertices, int ctElements, int* elements) :
 	VolMesh((U32)ctVertices, vertices, (U32)ctElements, reinterpret_cast<U32*>(elements)) {
-
+	init();
 	setup();
 }
 
 CuttableMesh::~CuttableMesh() {
+	//the running operation still uses the mesh. The queued ones are dropped.
+	m_qPendingCuts.clear();
+	waitRunningCut();
+
 	SAFE_DELETE(m_lpSubD);
 	SAFE_DELETE(m_lpRender);
+	SAFE_DELETE(m_lpEdgeBVH);
 	m_quadstrips.resize(0);
 }
 
+void CuttableMesh::init() {
+	m_lpSubD = NULL;
+	m_lpRender = NULL;
+	m_lpEdgeBVH = NULL;
+
+	m_ctCompletedCuts = 0;
+	m_flagSplitMeshAfterCut = false;
+	m_flagDetectCutNodes = false;
+	m_flagNodeSignCut = false;
+	m_flagProgressiveCut = false;
+	m_isStrokeActive = false;
+	m_idxStrokeFirstNode = 0;
+	m_ctStrokeSubdividedTets = 0;
+	m_flagDrawSweepSurf = false;
+	m_flagDrawAABB = false;
+	m_flagDrawNodes = false;
+	m_flagDrawWireFrameMesh = false;
+
+	m_flagBackgroundCut = false;
+	m_isCutRunning = false;
+	m_isInBackground = false;
+	m_isCutDone = false;
+	m_runningResult = 0;
+	m_generation = 0;
+}
+
 void CuttableMesh::setup() {
+	//cut operations use the render and the hierarchy
+	finishBackgroundCuts();
+	clearCutContext();
+	SAFE_DELETE(m_lpSubD);
+	SAFE_DELETE(m_lpRender);
+	SAFE_DELETE(m_lpEdgeBVH);
 
 	resetTransform();
-	if(TheShaderManager::Instance().has("phong")) {
+	if(!VolMeshRender::isHeadless() && TheShaderManager::Instance().has("phong")) {
         m_spEffect = SmartPtrSGEffect(new SGEffect(TheShaderManager::Instance().get("phong")));
     }
 
@@ -55,27 +146,30 @@ void CuttableMesh::setup() {
 
 	//Create Renderer
 	m_lpRender = new VolMeshRender();
+	m_lpRender->attach(this);
 
 	//Create subdivider
 	m_lpSubD = new TetSubdivider();
 
+	//Create edge hierarchy for cut-edge queries
+	m_lpEdgeBVH = new VolMeshBVH(this);
+
 	//Create render
 	syncRender();
 
 	m_aabb = VolMesh::aabb();
 	m_aabb.expand(1.0);
-	m_ctCompletedCuts = 0;
-	m_flagSplitMeshAfterCut = false;
-	m_flagDetectCutNodes = false;
-	m_flagDrawSweepSurf = false;
-	m_flagDrawAABB = false;
-	m_flagDrawNodes = false;
-	m_flagDrawWireFrameMesh = false;
+	m_aabbCommitted = m_aabb;
 }
 
 void CuttableMesh::clearCutContext() {
 	m_mapCutEdges.clear();
 	m_mapCutNodes.clear();
+
+	//drops an unfinished progressive stroke
+	m_isStrokeActive = false;
+	m_ctStrokeSubdividedTets = 0;
+	m_vStrokeSegmentHits.resize(0);
 }
 
 void CuttableMesh::draw() {
@@ -86,7 +180,9 @@ void CuttableMesh::draw() {
 	if(m_spTransform)
 		m_spTransform->bind();
 
-	if(m_flagDrawAABB)
+	//the mesh belongs to the worker until the operation is committed
+	bool isCutInFlight = this->isCutInFlight();
+	if(m_flagDrawAABB && !isCutInFlight)
 		drawBBox();
 
 	//VolMesh::draw();
@@ -99,6 +195,9 @@ void CuttableMesh::draw() {
 		m_spEffect->unbind();
 
 	//draw cut context
+	if(isCutInFlight)
+		return;
+
 	int ctCutEdges = m_mapCutEdges.size();
 	int ctCutNodes = m_mapCutNodes.size();
 	if(ctCutNodes > 0 || ctCutEdges > 0) {
@@ -111,14 +210,14 @@ void CuttableMesh::draw() {
 			for(CUTEDGEITER it = m_mapCutEdges.begin(); it != m_mapCutEdges.end(); ++it) {
 				glColor3f(0.0, 0.0, 0.0);
 				if(isNodeIndex(it->second.idxNP0))
-					glVertex3dv(const_nodeAt(it->second.idxNP0).pos.cptr());
+					glVertex3dv(nodePos(it->second.idxNP0).cptr());
 
 				glColor3f(0.0, 0.0, 1.0);
 				glVertex3dv(it->second.pos.cptr());
 
 				glColor3f(0.0, 0.0, 0.0);
 				if(isNodeIndex(it->second.idxNP1))
-					glVertex3dv(const_nodeAt(it->second.idxNP1).pos.cptr());
+					glVertex3dv(nodePos(it->second.idxNP1).cptr());
 			}
 			glEnd();
 
@@ -156,63 +255,481 @@ void CuttableMesh::draw() {
 }
 
 void CuttableMesh::syncRender() {
+	//gl buffers are updated when the operation is committed
+	if(m_isInBackground)
+		return;
+
 	m_lpRender->sync(this);
 }
 
-int CuttableMesh::computeCutEdgesKernel(const vec3d sweptquad[4],
-						  	  	  	  	std::map<U32, CutEdge>& mapCutEdges) {
+void CuttableMesh::timestep() {
+	commitBackgroundCuts();
+}
 
-	//if the swept surface is degenerate then return
+AABB CuttableMesh::aabb() const {
+	if(isCutInFlight())
+		return m_aabbCommitted;
+	return VolMesh::aabb();
+}
+
+void CuttableMesh::setFlagBackgroundCut(bool flag) {
+	if(!flag)
+		finishBackgroundCuts();
+	m_flagBackgroundCut = flag;
+}
+
+void CuttableMesh::queueCut(const vector<vec3d>& segments, const vector<vec3d>& quadstrips,
+							OnCutCommitted fOnCommitted) {
+	QueuedCut op;
+	op.fRun = [this, segments, quadstrips]() { return this->cut(segments, quadstrips, true); };
+	op.fOnCommitted = fOnCommitted;
+	queueOperation(op);
+}
+
+void CuttableMesh::queueCutProgressive(const vector<vec3d>& segments, const vector<vec3d>& quadstrips,
+									   OnCutCommitted fOnCommitted) {
+	//merge with a pending step. Even entries of a strip are the previous blade position and
+	//odd ones the current, so the merged strip keeps the older start and takes the new end.
+	if(m_flagBackgroundCut && m_qPendingCuts.size() > 0) {
+		QueuedCut& last = m_qPendingCuts.back();
+		if(last.isProgressiveStep && last.segments.size() == segments.size() &&
+		   last.quadstrips.size() == quadstrips.size()) {
+			last.segments = segments;
+			for(U32 i=1; i < quadstrips.size(); i += 2)
+				last.quadstrips[i] = quadstrips[i];
+
+			vector<vec3d> mergedSegments = last.segments;
+			vector<vec3d> mergedQuads = last.quadstrips;
+			last.fRun = [this, mergedSegments, mergedQuads]() { return this->cutProgressive(mergedSegments, mergedQuads); };
+			last.fOnCommitted = fOnCommitted;
+			return;
+		}
+	}
+
+	QueuedCut op;
+	op.fRun = [this, segments, quadstrips]() { return this->cutProgressive(segments, quadstrips); };
+	op.fOnCommitted = fOnCommitted;
+	op.isProgressiveStep = true;
+	op.segments = segments;
+	op.quadstrips = quadstrips;
+	queueOperation(op);
+}
+
+void CuttableMesh::queueEndProgressiveCut(const vector<vec3d>& quadstrips, OnCutCommitted fOnCommitted) {
+	QueuedCut op;
+	op.fRun = [this, quadstrips]() { return this->endProgressiveCut(quadstrips); };
+	op.fOnCommitted = fOnCommitted;
+	queueOperation(op);
+}
+
+void CuttableMesh::queueClearCutContext() {
+	QueuedCut op;
+	op.fRun = [this]() { this->clearCutContext(); return 0; };
+	queueOperation(op);
+}
+
+void CuttableMesh::queueOperation(const QueuedCut& op) {
+	if(!m_flagBackgroundCut) {
+		int res = op.fRun();
+		m_aabbCommitted = m_aabb;
+		m_generation.fetch_add(1, std::memory_order_release);
+		if(op.fOnCommitted)
+			op.fOnCommitted(res);
+		return;
+	}
+
+	m_qPendingCuts.push_back(op);
+	startNextCut();
+}
+
+void CuttableMesh::startNextCut() {
+	if(m_isCutRunning || m_qPendingCuts.size() == 0)
+		return;
+
+	m_runningCut = m_qPendingCuts.front();
+	m_qPendingCuts.pop_front();
+	m_runningResult = 0;
+	m_isCutDone.store(false, std::memory_order_relaxed);
+	m_isCutRunning = true;
+
+	//enqueued tasks get a worker even when the scheduler has a single thread
+	m_arenaCuts.enqueue([this]() { this->runCut(); });
+}
+
+void CuttableMesh::runCut() {
+	m_isInBackground = true;
+	m_runningResult = m_runningCut.fRun();
+	m_isInBackground = false;
+
+	std::lock_guard<std::mutex> lock(m_lockCutDone);
+	m_isCutDone.store(true, std::memory_order_release);
+	m_cvCutDone.notify_all();
+}
+
+void CuttableMesh::waitRunningCut() {
+	if(!m_isCutRunning)
+		return;
+
+	std::unique_lock<std::mutex> lock(m_lockCutDone);
+	m_cvCutDone.wait(lock, [&] { return m_isCutDone.load(std::memory_order_acquire); });
+	m_isCutRunning = false;
+}
+
+void CuttableMesh::commitRunningCut() {
+	waitRunningCut();
+
+	//gl buffers of the new topology
+	tick tickStart = Profiler::GetTickCount();
+	syncRender();
+	m_cutStats.msRenderSync += (Profiler::GetTickCount() - tickStart).seconds() * 1000.0;
+
+	m_aabbCommitted = m_aabb;
+	m_generation.fetch_add(1, std::memory_order_release);
+
+	//the handler may queue more work
+	QueuedCut op = m_runningCut;
+	m_runningCut = QueuedCut();
+	if(op.fOnCommitted)
+		op.fOnCommitted(m_runningResult);
+	startNextCut();
+}
+
+int CuttableMesh::commitBackgroundCuts() {
+	int ctCommitted = 0;
+	while(m_isCutRunning && m_isCutDone.load(std::memory_order_acquire)) {
+		commitRunningCut();
+		ctCommitted++;
+	}
+	return ctCommitted;
+}
+
+void CuttableMesh::finishBackgroundCuts() {
+	while(isCutInFlight()) {
+		if(!m_isCutRunning)
+			startNextCut();
+		commitRunningCut();
+	}
+}
+
+//milliseconds since the last lap
+static double LapMS(tick& t) {
+	tick now = Profiler::GetTickCount();
+	double ms = (now - t).seconds() * 1000.0;
+	t = now;
+	return ms;
+}
+
+//true when the swept surface is too small to cut anything
+static bool IsSweptQuadDegenerate(const vec3d sweptquad[4]) {
 	double area = (sweptquad[1] - sweptquad[0]).length2() * (sweptquad[2] - sweptquad[0]).length2();
 	if(area < EPSILON)
-		return -1;
+		return true;
 	double l2 = (sweptquad[3] - sweptquad[2]).length2();
 	if(l2 < EPSILON)
-		return -1;
+		return true;
+
+	return false;
+}
+
+//tests the triangles of a swept quad in order. The second one is tested only when the first is missed.
+static int IntersectSweptQuad(const vec3d& ss0, const vec3d& ss1,
+							  const vec3d tri1[3], const vec3d tri2[3],
+							  bool testTri1, bool testTri2,
+							  double& t, vec3d& uvw, vec3d& xyz) {
+	int res = 0;
+	if(testTri1)
+		res = IntersectSegmentTriangle(ss0, ss1, tri1, t, uvw, xyz);
+	if(res == 0 && testTri2)
+		res = IntersectSegmentTriangle(ss0, ss1, tri2, t, uvw, xyz);
+	return res;
+}
+
+//planes to classify nodes against one triangle of a swept quad
+struct SweptTrianglePlanes {
+	vec3d normal;
+	double offset;
+	vec3d sideNormals[3];
+	double sideOffsets[3];
+	double tolerance;
+	bool isValid;
+
+	void setup(const vec3d tri[3]) {
+		vec3d e1 = tri[1] - tri[0];
+		vec3d e2 = tri[2] - tri[0];
+		normal = vec3d::cross(e1, e2);
+		tolerance = NODE_SIGN_TOLERANCE * (e1.length() + e2.length());
+
+		//a flat triangle leaves the decision to the exact test
+		double len = normal.length();
+		isValid = (len > EPSILON * EPSILON);
+		if(!isValid)
+			return;
+
+		normal = normal * (1.0 / len);
+		offset = vec3d::dot(normal, tri[0]);
+
+		//side normals point away from the triangle
+		for(int k=0; k < 3; k++) {
+			sideNormals[k] = vec3d::cross(tri[(k + 1) % 3] - tri[k], normal).normalized();
+			sideOffsets[k] = vec3d::dot(sideNormals[k], tri[k]);
+		}
+	}
+
+	U16 classify(const vec3d& p) const {
+		if(!isValid)
+			return NODE_SIGN_ABOVE | NODE_SIGN_BELOW;
+
+		U16 code = 0;
+		double dist = vec3d::dot(normal, p) - offset;
+		if(dist > -tolerance)
+			code |= NODE_SIGN_ABOVE;
+		if(dist < tolerance)
+			code |= NODE_SIGN_BELOW;
+
+		for(int k=0; k < 3; k++) {
+			if(vec3d::dot(sideNormals[k], p) - sideOffsets[k] > tolerance)
+				code |= (4 << k);
+		}
+
+		return code;
+	}
+};
+
+//true when an edge with the given node codes may cross the triangle
+static inline bool MayCrossSweptTriangle(U16 a, U16 b) {
+	bool isStraddling = ((a & NODE_SIGN_ABOVE) && (b & NODE_SIGN_BELOW)) ||
+						((a & NODE_SIGN_BELOW) && (b & NODE_SIGN_ABOVE));
 
+	//both ends beyond the same side
+	return isStraddling && ((a & b & NODE_SIGN_OUTSIDE) == 0);
+}
+
+int CuttableMesh::computeCutEdgesKernel(const vec3d sweptquad[4],
+						  	  	  	  	CutEdgeMap& mapCutEdges) {
+
+	//if the swept surface is degenerate then return
+	if(IsSweptQuadDegenerate(sweptquad))
+		return -1;
 
-	//vars
-	vec3d uvw, xyz, ss0, ss1;
-	double t;
 
 	vec3d tri1[3] = {sweptquad[0], sweptquad[2], sweptquad[1]};
 	vec3d tri2[3] = {sweptquad[2], sweptquad[3], sweptquad[1]};
 
 
-	//Cut-Edges
-	U32 ctEdges = countEdges();
-	int found = 0;
-	for (U32 i=0; i < ctEdges; i++) {
-
-		const EDGE& e = this->const_edgeAt(i);
-
-		ss0 = this->const_nodeAt(e.from).pos;
-		ss1 = this->const_nodeAt(e.to).pos;
-
-		int res = IntersectSegmentTriangle(ss0, ss1, tri1, t, uvw, xyz);
-		if(res == 0)
-			res = IntersectSegmentTriangle(ss0, ss1, tri2, t, uvw, xyz);
-		if(res > 0) {
-			CutEdge ce;
-			ce.idxOrgFrom = e.from;
-			ce.idxOrgTo = e.to;
-			ce.pos = xyz;
-			ce.uvw = uvw;
-			ce.t = t;
-
-			//test
-			vec3d temp = ss0 + (ss1 - ss0).normalized() * t;
-			assert( (xyz - temp).length() < EPSILON);
-
-			//add to cut edges map
-			if(mapCutEdges.find(i) == mapCutEdges.end()) {
-				mapCutEdges.insert( std::make_pair(i, ce));
-				found++;
+	//Cut-Edges: only test edges overlapping the bounding box of the swept quad
+	vec3d lo = vec3d::minP(vec3d::minP(sweptquad[0], sweptquad[1]), vec3d::minP(sweptquad[2], sweptquad[3]));
+	vec3d hi = vec3d::maxP(vec3d::maxP(sweptquad[0], sweptquad[1]), vec3d::maxP(sweptquad[2], sweptquad[3]));
+	lo = lo - vec3d(EPSILON, EPSILON, EPSILON);
+	hi = hi + vec3d(EPSILON, EPSILON, EPSILON);
+
+	vector<U32> vCandidates;
+	m_lpEdgeBVH->query(lo, hi, vCandidates);
+
+	//test the candidates in parallel. hits are joined in candidate order so the
+	//result does not depend on scheduling.
+	CUTEDGEHITS vHits = parallel_reduce(
+		blocked_range<U32>(0, vCandidates.size(), CUT_EDGE_GRAIN_SIZE), CUTEDGEHITS(),
+		[&](const blocked_range<U32>& r, CUTEDGEHITS hits) -> CUTEDGEHITS {
+			const U32 ct = r.size();
+			vector<vec3d> vS0(ct), vS1(ct), vUVW(ct), vXYZ(ct);
+			vector<double> vT(ct);
+			vector<int> vRes(ct);
+
+			for (U32 j=0; j < ct; j++) {
+				const EDGE& e = this->const_edgeAt(vCandidates[r.begin() + j]);
+				vS0[j] = this->nodePos(e.from);
+				vS1[j] = this->nodePos(e.to);
+			}
+
+			//batched tests against the first triangle then the second one for the misses
+			U32 ctHits = IntersectSegmentsTriangle(ct, &vS0[0], &vS1[0], tri1, &vRes[0], &vT[0], &vUVW[0], &vXYZ[0]);
+			if(ctHits < ct) {
+				vector<U32> vMissed;
+				vMissed.reserve(ct - ctHits);
+				for (U32 j=0; j < ct; j++) {
+					if(vRes[j] == 0)
+						vMissed.push_back(j);
+				}
+
+				const U32 ctMissed = vMissed.size();
+				vector<vec3d> vMS0(ctMissed), vMS1(ctMissed), vMUVW(ctMissed), vMXYZ(ctMissed);
+				vector<double> vMT(ctMissed);
+				vector<int> vMRes(ctMissed);
+				for (U32 j=0; j < ctMissed; j++) {
+					vMS0[j] = vS0[vMissed[j]];
+					vMS1[j] = vS1[vMissed[j]];
+				}
+
+				if(IntersectSegmentsTriangle(ctMissed, &vMS0[0], &vMS1[0], tri2, &vMRes[0], &vMT[0], &vMUVW[0], &vMXYZ[0]) > 0) {
+					for (U32 j=0; j < ctMissed; j++) {
+						if(vMRes[j] == 0)
+							continue;
+
+						U32 k = vMissed[j];
+						vRes[k] = vMRes[j];
+						vT[k] = vMT[j];
+						vUVW[k] = vMUVW[j];
+						vXYZ[k] = vMXYZ[j];
+					}
+				}
+			}
+
+			for (U32 j=0; j < ct; j++) {
+				if(vRes[j] == 0)
+					continue;
+
+				U32 i = vCandidates[r.begin() + j];
+				const EDGE& e = this->const_edgeAt(i);
+
+				CutEdge ce;
+				ce.idxOrgFrom = e.from;
+				ce.idxOrgTo = e.to;
+				ce.pos = vXYZ[j];
+				ce.uvw = vUVW[j];
+				ce.t = vT[j];
+
+				//test
+				vec3d temp = vS0[j] + (vS1[j] - vS0[j]).normalized() * vT[j];
+				assert( (vXYZ[j] - temp).length() < EPSILON);
+
+				hits.push_back(std::make_pair(i, ce));
 			}
-			else {
-				mapCutEdges.erase(i);
-				LogErrorArg1("Edge %d has already been cut!", i);
+
+			return hits;
+		},
+		[](CUTEDGEHITS lhs, const CUTEDGEHITS& rhs) -> CUTEDGEHITS {
+			lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+			return lhs;
+		});
+
+	return addCutEdgeHits(vHits, mapCutEdges);
+}
+
+void CuttableMesh::computeCutEdgesByNodeSigns(const vector<vec3d>& quadstrips,
+											  vector<CutEdgeHits>& vQuadHits) {
+
+	ProfileAutoArg("cut:node signs");
+
+	const U32 ctQuads = (quadstrips.size() - 2) / 2;
+	vQuadHits.assign(ctQuads, CutEdgeHits());
+
+	//2 triangles per quad split the same way as in the per quad kernel
+	vector<SweptTrianglePlanes> vPlanes(ctQuads * 2);
+	vector<U8> vIsDegenerate(ctQuads, 0);
+	vec3d lo, hi;
+	bool isEmpty = true;
+	for(U32 q = 0; q < ctQuads; q++) {
+		const vec3d* sweptquad = &quadstrips[q * 2];
+		vec3d tri1[3] = {sweptquad[0], sweptquad[2], sweptquad[1]};
+		vec3d tri2[3] = {sweptquad[2], sweptquad[3], sweptquad[1]};
+
+		vIsDegenerate[q] = IsSweptQuadDegenerate(sweptquad);
+		vPlanes[q * 2].setup(tri1);
+		vPlanes[q * 2 + 1].setup(tri2);
+		if(vIsDegenerate[q])
+			continue;
+
+		//bounding box of the stroke
+		for(int k=0; k < 4; k++) {
+			lo = isEmpty ? sweptquad[k] : vec3d::minP(lo, sweptquad[k]);
+			hi = isEmpty ? sweptquad[k] : vec3d::maxP(hi, sweptquad[k]);
+			isEmpty = false;
+		}
+	}
+
+	if(isEmpty)
+		return;
+
+	//one query for the whole stroke. Candidates in edge order.
+	vector<U32> vCandidates;
+	m_lpEdgeBVH->query(lo - vec3d(EPSILON, EPSILON, EPSILON), hi + vec3d(EPSILON, EPSILON, EPSILON), vCandidates);
+	std::sort(vCandidates.begin(), vCandidates.end());
+
+	//nodes of the candidates
+	vector<U32> vNodeSlots(countNodes(), VolMesh::INVALID_INDEX);
+	vector<U32> vNodes;
+	for(U32 j = 0; j < vCandidates.size(); j++) {
+		const EDGE& e = const_edgeAt(vCandidates[j]);
+		U32 ends[2] = {e.from, e.to};
+		for(int k=0; k < 2; k++) {
+			if(vNodeSlots[ends[k]] == VolMesh::INVALID_INDEX) {
+				vNodeSlots[ends[k]] = vNodes.size();
+				vNodes.push_back(ends[k]);
+			}
+		}
+	}
+
+	//one pass over the nodes for all quads
+	vector<U16> vCodes(vNodes.size() * ctQuads);
+	tbb::parallel_for(blocked_range<U32>(0, vNodes.size(), CUT_NODE_SIGN_GRAIN_SIZE), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			vec3d p = this->nodePos(vNodes[i]);
+			U16* codes = &vCodes[i * ctQuads];
+			for(U32 q = 0; q < ctQuads; q++)
+				codes[q] = vPlanes[q * 2].classify(p) | (vPlanes[q * 2 + 1].classify(p) << NODE_SIGN_BITS);
+		}
+	});
+
+	//exact tests only for the edges that may cross a triangle. Hits are joined in edge order.
+	vQuadHits = parallel_reduce(
+		blocked_range<U32>(0, vCandidates.size(), CUT_NODE_SIGN_GRAIN_SIZE), vector<CUTEDGEHITS>(ctQuads),
+		[&](const blocked_range<U32>& r, vector<CUTEDGEHITS> hits) -> vector<CUTEDGEHITS> {
+			vec3d uvw, xyz;
+			double t;
+
+			for(U32 j = r.begin(); j != r.end(); j++) {
+				U32 i = vCandidates[j];
+				const EDGE& e = this->const_edgeAt(i);
+				const U16* codesFrom = &vCodes[vNodeSlots[e.from] * ctQuads];
+				const U16* codesTo = &vCodes[vNodeSlots[e.to] * ctQuads];
+
+				for(U32 q = 0; q < ctQuads; q++) {
+					U16 a = codesFrom[q];
+					U16 b = codesTo[q];
+					bool testTri1 = MayCrossSweptTriangle(a, b);
+					bool testTri2 = MayCrossSweptTriangle(a >> NODE_SIGN_BITS, b >> NODE_SIGN_BITS);
+					if((!testTri1 && !testTri2) || vIsDegenerate[q])
+						continue;
+
+					const vec3d* sweptquad = &quadstrips[q * 2];
+					vec3d tri1[3] = {sweptquad[0], sweptquad[2], sweptquad[1]};
+					vec3d tri2[3] = {sweptquad[2], sweptquad[3], sweptquad[1]};
+
+					vec3d ss0 = this->nodePos(e.from);
+					vec3d ss1 = this->nodePos(e.to);
+					if(IntersectSweptQuad(ss0, ss1, tri1, tri2, testTri1, testTri2, t, uvw, xyz) > 0) {
+						CutEdge ce;
+						ce.idxOrgFrom = e.from;
+						ce.idxOrgTo = e.to;
+						ce.pos = xyz;
+						ce.uvw = uvw;
+						ce.t = t;
+						hits[q].push_back(std::make_pair(i, ce));
+					}
+				}
 			}
+
+			return hits;
+		},
+		[](vector<CUTEDGEHITS> lhs, const vector<CUTEDGEHITS>& rhs) -> vector<CUTEDGEHITS> {
+			for(U32 q = 0; q < lhs.size(); q++)
+				lhs[q].insert(lhs[q].end(), rhs[q].begin(), rhs[q].end());
+			return lhs;
+		});
+}
+
+int CuttableMesh::addCutEdgeHits(const CutEdgeHits& hits, CutEdgeMap& mapCutEdges) {
+	//add to cut edges map
+	int found = 0;
+	for (U32 j=0; j < hits.size(); j++) {
+		U32 i = hits[j].first;
+		if(mapCutEdges.find(i) == mapCutEdges.end()) {
+			mapCutEdges.insert(hits[j]);
+			found++;
+		}
+		else {
+			mapCutEdges.erase(i);
+			LogErrorArg1("Edge %d has already been cut!", i);
 		}
 	}
 
@@ -222,8 +739,8 @@ int CuttableMesh::computeCutEdgesKernel(const vec3d sweptquad[4],
 int CuttableMesh::computeCutNodesKernel(const vec3d& blade0,
 									   const vec3d& blade1,
 									   const vec3d sweptquad[4],
-									   std::map<U32, CutEdge>& mapCutEdges,
-									   std::map<U32, CutNode>& mapCutNodes) {
+									   CutEdgeMap& mapCutEdges,
+									   CutNodeMap& mapCutNodes) {
 	//Radios of Influence in percent
 	const double roi = 0.2;
 
@@ -233,11 +750,11 @@ int CuttableMesh::computeCutNodesKernel(const vec3d& blade0,
 	vec3d ss0, ss1;
 
 	//detect all cut-nodes and remove the cut-edges that emanate from a cut-node
-	for (CUTEDGEITER it = mapCutEdges.begin(); it != mapCutEdges.end(); ++it) {
+	for (CutEdgeMap::iterator it = mapCutEdges.begin(); it != mapCutEdges.end(); ++it) {
 
 		const EDGE& cutedge = const_edgeAt(it->first);
-		ss0 = const_nodeAt(cutedge.from).pos;
-		ss1 = const_nodeAt(cutedge.to).pos;
+		ss0 = nodePos(cutedge.from);
+		ss1 = nodePos(cutedge.to);
 		double d0 = pointLineDistance(blade0, blade1, edgelen2, ss0);
 		double d1 = pointLineDistance(blade0, blade1, edgelen2, ss1);
 		double denom = (ss1 - ss0).length();
@@ -298,6 +815,9 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 		return CUT_ERR_INVALID_INPUT_ARG;
 
 	ProfileAutoArg("cut");
+	ArenaScope scope(m_cutArena);
+	m_cutStats.reset();
+	tick tickLap = Profiler::GetTickCount();
 
 	//1.Compute all cut-edges
 	//2.Compute cut nodes and remove all incident edges to cut nodes from cut edges
@@ -306,8 +826,8 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 	m_mapCutEdges.clear();
 	m_mapCutNodes.clear();
 
-	std::map< U32, CutEdge > mapTempCutEdges;
-	std::map< U32, CutNode > mapTempCutNodes;
+	CutEdgeMap mapTempCutEdges(cutAlloc());
+	CutNodeMap mapTempCutNodes(cutAlloc());
 
 	U32 ctSegments = segments.size() - 1;
 	U32 ctQuads = (quadstrips.size() - 2) / 2;
@@ -315,6 +835,11 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 
 	U32 ctRemovedCutEdges = 0;
 
+	//all quads at once
+	vector<CutEdgeHits> vQuadHits;
+	if(m_flagNodeSignCut)
+		computeCutEdgesByNodeSigns(quadstrips, vQuadHits);
+
 	//scalpel segments
 	vector<int> vPerSegmentCuts;
 	vPerSegmentCuts.resize(ctSegments);
@@ -322,80 +847,108 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 
 		vec3d s0 = segments[i];
 		vec3d s1 = segments[i + 1];
-		vPerSegmentCuts[i] = computeCutEdgesKernel(&quadstrips[i * 2], mapTempCutEdges);
+		if(m_flagNodeSignCut)
+			vPerSegmentCuts[i] = IsSweptQuadDegenerate(&quadstrips[i * 2]) ? -1 : addCutEdgeHits(vQuadHits[i], mapTempCutEdges);
+		else
+			vPerSegmentCuts[i] = computeCutEdgesKernel(&quadstrips[i * 2], mapTempCutEdges);
 
 		if (m_flagDetectCutNodes) {
 			ctRemovedCutEdges += computeCutNodesKernel(s0, s1, &quadstrips[i * 2], mapTempCutEdges, mapTempCutNodes);
 		}
 	}
 
+	m_cutStats.msIntersect = LapMS(tickLap);
+	m_cutStats.ctCutEdges = mapTempCutEdges.size();
+
 	//nothing has been cut!?
 	if(mapTempCutEdges.size() == 0 && mapTempCutNodes.size() == 0)
 		return 0;
 
-	//Copy
-	m_mapCutEdges.insert(mapTempCutEdges.begin(), mapTempCutEdges.end());
-	m_mapCutNodes.insert(mapTempCutNodes.begin(), mapTempCutNodes.end());
+	//Copy in key order
+	m_mapCutEdges.reserveKeys(countEdges());
+	m_mapCutNodes.reserveKeys(countNodes());
+	for(CutEdgeMap::const_iterator it = mapTempCutEdges.begin(); it != mapTempCutEdges.end(); ++it)
+		m_mapCutEdges.insert(it->first, it->second);
+	for(CutNodeMap::const_iterator it = mapTempCutNodes.begin(); it != mapTempCutNodes.end(); ++it)
+		m_mapCutNodes.insert(it->first, it->second);
 	if(m_mapCutNodes.size() > 0)
-		printf("Cut nodes count %u.\n", (U32)m_mapCutNodes.size());
+		LogInfoArg1("Cut nodes count %u.", (U32)m_mapCutNodes.size());
 	if(m_mapCutEdges.size() > 0)
-		printf("Cut edges count %u. removed %u\n", (U32)m_mapCutEdges.size(), (U32)ctRemovedCutEdges);
-
-	//Find the list of all tets impacted
-	vector<U32> vCutElements;
-	vector<U8> vCutEdgeCodes;
-	vector<U8> vCutNodeCodes;
-	vCutElements.reserve(128);
-	vCutEdgeCodes.reserve(128);
-	vCutNodeCodes.reserve(128);
-
-	for(U32 i=0; i < this->countCells(); i++) {
-		const CELL& cell = this->const_cellAt(i);
-		U8 cutEdgeCode = 0;
-		U8 cutNodeCode = 0;
-
-		//compute cutedge code
-		for(int e=0; e < COUNT_CELL_EDGES; e++) {
-			U32 edge = cell.edges[e];
-			if(m_mapCutEdges.find(edge) != m_mapCutEdges.end()) {
+		LogInfoArg2("Cut edges count %u. removed %u", (U32)m_mapCutEdges.size(), (U32)ctRemovedCutEdges);
+
+	//Find the list of all tets impacted. Each task collects its cells in order and
+	//the lists are joined in cell order.
+	CutCellList cutcells = parallel_reduce(
+		blocked_range<U32>(0, this->countCells(), CUT_CELL_GRAIN_SIZE), CutCellList(),
+		[&](const blocked_range<U32>& r, CutCellList list) -> CutCellList {
+			for(U32 i=r.begin(); i != r.end(); i++) {
+				const CELL& cell = this->const_cellAt(i);
+				U8 cutEdgeCode = 0;
+				U8 cutNodeCode = 0;
+
+				//compute cutedge code
+				for(int e=0; e < COUNT_CELL_EDGES; e++) {
+					U32 edge = cell.edges[e];
+					if(m_mapCutEdges.contains(edge)) {
+
+						//check the edge
+						if(!isEdgeOfCell(edge, i)) {
+							list.idxBadCell = i;
+							list.idxBadEdge = edge;
+							return list;
+						}
+
+						cutEdgeCode |= (1 << e);
+					}
+				}
 
-				//check the edge
-				if(!isEdgeOfCell(edge, i)) {
-					LogErrorArg2("Edge %u does not belong to cell %u", edge, i);
-					return -2;
+				//compute cut node code
+				for(int e=0; e < COUNT_CELL_NODES; e++) {
+					if(m_mapCutNodes.contains(cell.nodes[e]))
+						cutNodeCode |= (1 << e);
 				}
 
-				cutEdgeCode |= (1 << e);
+				//if there is a cut in this cell
+				if(cutEdgeCode != 0 || cutNodeCode != 0) {
+					list.cells.push_back(i);
+					list.edgeCodes.push_back(cutEdgeCode);
+					list.nodeCodes.push_back(cutNodeCode);
+				}
 			}
-		}
 
-		//compute cut node code
-		for(int e=0; e < COUNT_CELL_NODES; e++) {
-			U32 node = cell.nodes[e];
-			if(m_mapCutNodes.find(node) != m_mapCutNodes.end()) {
-				cutNodeCode |= (1 << e);
-			}
-		}
+			return list;
+		},
+		[](CutCellList lhs, const CutCellList& rhs) -> CutCellList {
+			//cells after a bad cell are never reached
+			if(lhs.idxBadCell == VolMesh::INVALID_INDEX)
+				lhs.append(rhs);
+			return lhs;
+		});
 
-		//if there is a cut in this cell
-		if(cutEdgeCode != 0 || cutNodeCode != 0) {
+	vector<U32>& vCutElements = cutcells.cells;
+	vector<U8>& vCutEdgeCodes = cutcells.edgeCodes;
+	vector<U8>& vCutNodeCodes = cutcells.nodeCodes;
 
-			//push back all computed values
-			vCutElements.push_back(i);
-			vCutEdgeCodes.push_back(cutEdgeCode);
-			vCutNodeCodes.push_back(cutNodeCode);
-
-			//check if the codes are implemented already
-			TetSubdivider::CUTCASE cc = m_lpSubD->IdentifyCutCase(true, cutEdgeCode, cutNodeCode);
-			char chrCutCase = m_lpSubD->toAlpha(cc);
-			if(chrCutCase != 'A' && chrCutCase != 'B') {
-				LogErrorArg3("This cut contains a cut case which is not handled yet. case: %c, cutEdgeCode: %x, cutNodeCode: %x",
-							 chrCutCase, cutEdgeCode, cutNodeCode);
-				return CUT_ERR_UNHANDLED_CUT_STATE;
-			}
+	//every pair of codes has a subdivision table entry
+	for(U32 i=0; i < vCutElements.size(); i++) {
+		U8 cutEdgeCode = vCutEdgeCodes[i];
+		U8 cutNodeCode = vCutNodeCodes[i];
+
+		if(!m_lpSubD->canSubdivide(cutEdgeCode, cutNodeCode)) {
+			LogErrorArg2("This cut contains a cut case which is not handled. cutEdgeCode: %x, cutNodeCode: %x",
+						 cutEdgeCode, cutNodeCode);
+			return CUT_ERR_UNHANDLED_CUT_STATE;
 		}
 	}
 
+	if(cutcells.idxBadCell != VolMesh::INVALID_INDEX) {
+		LogErrorArg2("Edge %u does not belong to cell %u", cutcells.idxBadEdge, cutcells.idxBadCell);
+		return -2;
+	}
+
+	m_cutStats.msClassify = LapMS(tickLap);
+	m_cutStats.ctCutCells = vCutElements.size();
+
 	//	int edgeMaskPos[6][2] = { {1, 2}, {2, 3}, {3, 1}, {2, 0}, {0, 3}, {0, 1} };
 	//	int edgeMaskNeg[6][2] = { {3, 2}, {2, 1}, {1, 3}, {3, 0}, {0, 2}, {1, 0} };
 	//	int faceMaskPos[4][3] = { {1, 2, 3}, {2, 0, 3}, {3, 0, 1}, {1, 0, 2} };
@@ -420,33 +973,91 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 		it->second.idxNP0 = idxNP0;
 		it->second.idxNP1 = idxNP1;
 	}
+	m_cutStats.msEdgeCut = LapMS(tickLap);
+
+	U32 ctSubdividedTets = subdivideCutCells(vCutElements, vCutEdgeCodes, vCutNodeCodes);
+	m_cutStats.msSubdivide = LapMS(tickLap);
+	m_cutStats.ctSubdividedTets = ctSubdividedTets;
+
+	//increment completed cuts
+	if(ctSubdividedTets > 0) {
+		LogInfoArg2("END CUTTING# %u: subdivided elements count: %u.", m_ctCompletedCuts + 1, ctSubdividedTets);
+		m_ctCompletedCuts ++;
+
+		//store sweep surf
+		m_quadstrips.clear();
+		m_quadstrips.insert(m_quadstrips.end(), quadstrips.begin(), quadstrips.end());
+	}
+	else {
+		LogWarningArg1("END CUTTING# %u: No elements are subdivided.", m_ctCompletedCuts + 1);
+	}
+
+
+	//clear cut context
+	//clearCutContext();
+
+	//collect all garbage
+	garbage_collection();
+	m_cutStats.msGC = LapMS(tickLap);
+
+	//Perform all tests
+	TestVolMesh::tst_all(this);
+	m_cutStats.msStats = LapMS(tickLap);
+
+	//split mesh parts
+	if(m_flagSplitMeshAfterCut && (ctSubdividedTets > 0)) {
+
+		for(U32 i = 0; i < ctSegments; i++) {
+			if(vPerSegmentCuts[i] > 0)
+				splitParts(&quadstrips[i * 2], DEFAULT_MESH_SPLIT_DIST);
+		}
+	}
+	m_cutStats.msSplitParts = LapMS(tickLap);
+
+	//print mesh parts
+	//printParts();
+	VolMeshStats::printAllStats(this);
+	m_cutStats.msStats += LapMS(tickLap);
+
+	//recompute AABB and expand it to detect cuts
+	m_aabb = this->computeAABB();
+	m_aabb.expand(1.0);
+
+	//update renderer
+	syncRender();
+	m_cutStats.msRenderSync = LapMS(tickLap);
 
+	//Return number of tets cut
+	return ctSubdividedTets;
+}
+
+int CuttableMesh::subdivideCutCells(const vector<U32>& cells,
+									 const vector<U8>& cutEdgeCodes,
+									 const vector<U8>& cutNodeCodes) {
 	U32 ctSubdividedTets = 0;
 	U32 middlePoints[12];
-	for(U32 i=0; i < vCutElements.size(); i++) {
+	for(U32 i=0; i < cells.size(); i++) {
 
-		U8 cutEdgeCode = vCutEdgeCodes[i];
-		U8 cutNodeCode = vCutNodeCodes[i];
+		U8 cutEdgeCode = cutEdgeCodes[i];
+		U8 cutNodeCode = cutNodeCodes[i];
 		if(cutEdgeCode != 0 || cutNodeCode != 0) {
 
-			const CELL& cell = this->const_cellAt(vCutElements[i]);
+			const CELL& cell = this->const_cellAt(cells[i]);
 
 			//select the middle points for cut edges
 			for(int e=0; e < COUNT_CELL_EDGES; e++) {
-				CUTEDGEITER it = m_mapCutEdges.find(cell.edges[e]);
+				const CutEdge* lpCutEdge = m_mapCutEdges.find(cell.edges[e]);
 
 				//mid points
 				middlePoints[e * 2 + 0] = VolMesh::INVALID_INDEX;
 				middlePoints[e * 2 + 1] = VolMesh::INVALID_INDEX;
 
 				//if edge is in the list of cutedges
-				if(it != m_mapCutEdges.end()) {
-					const EDGE& edge = const_edgeAt(cell.edges[e]);
-
-					U32 idxOrgFrom = it->second.idxOrgFrom;
-					U32 idxOrgTo = it->second.idxOrgTo;
-					U32 idxNP0 = it->second.idxNP0;
-					U32 idxNP1 = it->second.idxNP1;
+				if(lpCutEdge) {
+					U32 idxOrgFrom = lpCutEdge->idxOrgFrom;
+					U32 idxOrgTo = lpCutEdge->idxOrgTo;
+					U32 idxNP0 = lpCutEdge->idxNP0;
+					U32 idxNP1 = lpCutEdge->idxNP1;
 
 					bool res1 = edge_exists(idxOrgFrom, idxNP0);
 					bool res2 = edge_exists(idxNP1, idxOrgTo);
@@ -460,46 +1071,278 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 				}
 			}
 			//subdivide the element
-			ctSubdividedTets += m_lpSubD->subdivide(this, vCutElements[i], cutEdgeCode, cutNodeCode, middlePoints);
+			ctSubdividedTets += m_lpSubD->subdivide(this, cells[i], cutEdgeCode, cutNodeCode, middlePoints);
 		}
 	}
 
+	return ctSubdividedTets;
+}
 
-	//increment completed cuts
-	if(ctSubdividedTets > 0) {
-		LogInfoArg2("END CUTTING# %u: subdivided elements count: %u.", m_ctCompletedCuts + 1, ctSubdividedTets);
-		m_ctCompletedCuts ++;
+int CuttableMesh::commitCutFront(bool flagPartial) {
+	if(m_mapCutEdges.size() == 0)
+		return 0;
 
-		//store sweep surf
-		m_quadstrips.clear();
-		m_quadstrips.insert(m_quadstrips.end(), quadstrips.begin(), quadstrips.end());
+	tick tickLap = Profiler::GetTickCount();
+
+	//cells incident to the front edges are the cells around their start node that hold them
+	vector<U32> vCells;
+	for(CUTEDGEITER it = m_mapCutEdges.begin(); it != m_mapCutEdges.end(); ++it) {
+		U32 idxFrom = const_edgeAt(it->first).from;
+		for(IncidenceTable::const_iterator c_it = m_incident_cells_per_node.begin(idxFrom),
+				c_end = m_incident_cells_per_node.end(idxFrom); c_it != c_end; ++c_it) {
+			const CELL& cell = const_cellAt(*c_it);
+			if(std::find(cell.edges, cell.edges + COUNT_CELL_EDGES, it->first) != cell.edges + COUNT_CELL_EDGES)
+				vCells.push_back(*c_it);
+		}
 	}
-	else {
-		LogWarningArg1("END CUTTING# %u: No elements are subdivided.", m_ctCompletedCuts + 1);
+	std::sort(vCells.begin(), vCells.end());
+	vCells.erase(std::unique(vCells.begin(), vCells.end()), vCells.end());
+
+	//cut edge codes. A cell is ready when its cut is complete or, at the end of a stroke,
+	//when the table has an entry for its partial cut.
+	vector<U8> vCutEdgeCodes(vCells.size(), 0);
+	vector<U8> vIsReady(vCells.size(), 0);
+	typedef vector<U32, ArenaAllocator<U32> > CellList;
+	typedef std::map<U32, CellList, std::less<U32>, ArenaAllocator< std::pair<const U32, CellList> > > EdgeCellsMap;
+	EdgeCellsMap mapEdgeCells(cutAlloc());
+	for(U32 i=0; i < vCells.size(); i++) {
+		const CELL& cell = const_cellAt(vCells[i]);
+		for(int e=0; e < COUNT_CELL_EDGES; e++) {
+			if(m_mapCutEdges.contains(cell.edges[e])) {
+				vCutEdgeCodes[i] |= (1 << e);
+				EdgeCellsMap::iterator ec_it = mapEdgeCells.find(cell.edges[e]);
+				if(ec_it == mapEdgeCells.end())
+					ec_it = mapEdgeCells.insert(std::make_pair(cell.edges[e], CellList(cutAlloc()))).first;
+				ec_it->second.push_back(i);
+			}
+		}
+
+		if(flagPartial)
+			vIsReady[i] = m_lpSubD->canSubdivide(vCutEdgeCodes[i], 0);
+		else
+			vIsReady[i] = m_lpSubD->isCutComplete(vCutEdgeCodes[i], 0);
+	}
+
+	//a front edge is split only when all of its cells are ready. Holding back a cell holds
+	//back its cut-edges and with them the neighbour cells. Repeat until nothing changes.
+	bool changed = true;
+	while(changed) {
+		changed = false;
+		for(U32 i=0; i < vCells.size(); i++) {
+			if(!vIsReady[i])
+				continue;
+
+			const CELL& cell = const_cellAt(vCells[i]);
+			for(int e=0; e < COUNT_CELL_EDGES && vIsReady[i]; e++) {
+				if((vCutEdgeCodes[i] & (1 << e)) == 0)
+					continue;
+
+				const CellList& nbors = mapEdgeCells.find(cell.edges[e])->second;
+				for(U32 j=0; j < nbors.size(); j++) {
+					if(!vIsReady[nbors[j]]) {
+						vIsReady[i] = 0;
+						changed = true;
+						break;
+					}
+				}
+			}
+		}
 	}
 
+	//ready cells and their edges
+	vector<U32> vReadyCells;
+	vector<U8> vReadyEdgeCodes;
+	ScratchSet setSplitEdges(cutAlloc());
+	for(U32 i=0; i < vCells.size(); i++) {
+		if(!vIsReady[i])
+			continue;
 
-	//clear cut context
-	//clearCutContext();
+		vReadyCells.push_back(vCells[i]);
+		vReadyEdgeCodes.push_back(vCutEdgeCodes[i]);
 
-	//collect all garbage
+		const CELL& cell = const_cellAt(vCells[i]);
+		for(int e=0; e < COUNT_CELL_EDGES; e++) {
+			if(vCutEdgeCodes[i] & (1 << e))
+				setSplitEdges.insert(cell.edges[e]);
+		}
+	}
+
+	m_cutStats.msClassify += LapMS(tickLap);
+	if(vReadyCells.size() == 0)
+		return 0;
+
+	//split the edges of the ready cells
+	for(ScratchSet::const_iterator e_it = setSplitEdges.begin(); e_it != setSplitEdges.end(); ++e_it) {
+		CutEdge* lpCutEdge = m_mapCutEdges.find(*e_it);
+		U32 idxNP0, idxNP1;
+
+		if(!this->cut_edge(*e_it, lpCutEdge->t, &idxNP0, &idxNP1)) {
+			LogErrorArg2("Unable to cut edge %d, edgecutpoint t = %.3f.", *e_it, lpCutEdge->t);
+			return CUT_ERR_UNABLE_TO_CUT_EDGE;
+		}
+
+		lpCutEdge->idxNP0 = idxNP0;
+		lpCutEdge->idxNP1 = idxNP1;
+	}
+	m_cutStats.msEdgeCut += LapMS(tickLap);
+
+	vector<U8> vReadyNodeCodes(vReadyCells.size(), 0);
+	int ctSubdividedTets = subdivideCutCells(vReadyCells, vReadyEdgeCodes, vReadyNodeCodes);
+	m_cutStats.msSubdivide += LapMS(tickLap);
+	m_cutStats.ctCutCells += vReadyCells.size();
+	m_cutStats.ctSubdividedTets += ctSubdividedTets;
+
+	//retire the split edges and collect garbage
+	for(ScratchSet::const_iterator e_it = setSplitEdges.begin(); e_it != setSplitEdges.end(); ++e_it)
+		m_mapCutEdges.erase(*e_it);
+
+	//the stroke holds node handles so the mesh is reordered once the stroke ends
+	SpaceFillingCurve curve = getReorderAfterGC();
+	setReorderAfterGC(sfcNone);
 	garbage_collection();
+	setReorderAfterGC(curve);
+
+	//edge handles shift after gc. Find the remaining front edges by their nodes again.
+	CutEdgeMap mapFront(cutAlloc());
+	for(CUTEDGEITER it = m_mapCutEdges.begin(); it != m_mapCutEdges.end(); ++it) {
+		U32 idxEdge = edge_handle(it->second.idxOrgFrom, it->second.idxOrgTo);
+		if(isEdgeIndex(idxEdge))
+			mapFront.insert(std::make_pair(idxEdge, it->second));
+	}
+	m_mapCutEdges.clear();
+	m_mapCutEdges.reserveKeys(countEdges());
+	for(CutEdgeMap::const_iterator it = mapFront.begin(); it != mapFront.end(); ++it)
+		m_mapCutEdges.insert(it->first, it->second);
+	m_cutStats.msGC += LapMS(tickLap);
+
+	return ctSubdividedTets;
+}
+
+int CuttableMesh::cutProgressive(const vector<vec3d>& segments,
+								 const vector<vec3d>& quadstrips) {
+	if(segments.size() < 2)
+		return CUT_ERR_INVALID_INPUT_ARG;
+	if(quadstrips.size() < 4 || (quadstrips.size() % 2 != 0))
+		return CUT_ERR_INVALID_INPUT_ARG;
+
+	ProfileAutoArg("cut progressive");
+	ArenaScope scope(m_cutArena);
+
+	U32 ctSegments = segments.size() - 1;
+	U32 ctQuads = (quadstrips.size() - 2) / 2;
+	assert(ctSegments == ctQuads);
+
+	//first step of a stroke
+	if(!m_isStrokeActive) {
+		m_mapCutEdges.clear();
+		m_mapCutNodes.clear();
+		m_cutStats.reset();
+		m_isStrokeActive = true;
+		m_idxStrokeFirstNode = countNodes();
+		m_ctStrokeSubdividedTets = 0;
+		m_vStrokeSegmentHits.assign(ctSegments, 0);
+	}
+	else if(m_vStrokeSegmentHits.size() != ctSegments)
+		return CUT_ERR_INVALID_INPUT_ARG;
+
+	//cut-edges of the latest swept quads. Cut nodes are not detected in this mode.
+	tick tickLap = Profiler::GetTickCount();
+	CutEdgeMap mapStepCutEdges(cutAlloc());
+	vector<CutEdgeHits> vQuadHits;
+	if(m_flagNodeSignCut)
+		computeCutEdgesByNodeSigns(quadstrips, vQuadHits);
+
+	for(U32 i = 0; i < ctSegments; i++) {
+		int found = 0;
+		if(m_flagNodeSignCut)
+			found = addCutEdgeHits(vQuadHits[i], mapStepCutEdges);
+		else
+			found = computeCutEdgesKernel(&quadstrips[i * 2], mapStepCutEdges);
+
+		if(found > 0)
+			m_vStrokeSegmentHits[i] = 1;
+	}
+
+	//extend the front. New nodes are appended so the edges of the cells subdivided during
+	//this stroke touch the nodes at or above the stroke mark. Those are cut already.
+	for(CutEdgeMap::const_iterator it = mapStepCutEdges.begin(); it != mapStepCutEdges.end(); ++it) {
+		if(it->second.idxOrgFrom >= m_idxStrokeFirstNode || it->second.idxOrgTo >= m_idxStrokeFirstNode)
+			continue;
+
+		if(m_mapCutEdges.insert(it->first, it->second))
+			m_cutStats.ctCutEdges++;
+	}
+	m_cutStats.msIntersect += LapMS(tickLap);
+
+	int res = commitCutFront();
+	if(res > 0) {
+		m_ctStrokeSubdividedTets += res;
+		tickLap = Profiler::GetTickCount();
+		syncRender();
+		m_cutStats.msRenderSync += LapMS(tickLap);
+	}
+
+	return res;
+}
+
+int CuttableMesh::endProgressiveCut(const vector<vec3d>& quadstrips) {
+	if(!m_isStrokeActive)
+		return 0;
+
+	ProfileAutoArg("cut progressive end");
+
+	ArenaScope scope(m_cutArena);
+
+	//the tool stopped inside the tissue. Subdivide the cells of the remaining front with
+	//their partial cut entries as the batch cut does.
+	int res = commitCutFront(true);
+	if(res < 0) {
+		clearCutContext();
+		return res;
+	}
+	m_ctStrokeSubdividedTets += res;
+
+	//cells held back by an unhandled neighbour keep their topology
+	if(m_mapCutEdges.size() > 0)
+		LogWarningArg1("Progressive cut left %u cut-edges of partially cut elements.", (U32)m_mapCutEdges.size());
+
+	U32 ctSubdividedTets = m_ctStrokeSubdividedTets;
+	vector<U8> vSegmentHits = m_vStrokeSegmentHits;
+	clearCutContext();
+
+	//skipped by the garbage collections during the stroke
+	tick tickLap = Profiler::GetTickCount();
+	if(ctSubdividedTets > 0 && getReorderAfterGC() != sfcNone)
+		reorder(getReorderAfterGC());
+	m_cutStats.msGC += LapMS(tickLap);
+
+	if(ctSubdividedTets == 0) {
+		LogWarningArg1("END CUTTING# %u: No elements are subdivided.", m_ctCompletedCuts + 1);
+		return 0;
+	}
+
+	LogInfoArg2("END CUTTING# %u: subdivided elements count: %u.", m_ctCompletedCuts + 1, ctSubdividedTets);
+	m_ctCompletedCuts ++;
+
+	//store sweep surf
+	m_quadstrips.assign(quadstrips.begin(), quadstrips.end());
 
 	//Perform all tests
 	TestVolMesh::tst_all(this);
+	m_cutStats.msStats += LapMS(tickLap);
 
 	//split mesh parts
-	if(m_flagSplitMeshAfterCut && (ctSubdividedTets > 0)) {
-
-		for(U32 i = 0; i < ctSegments; i++) {
-			if(vPerSegmentCuts[i] > 0)
+	if(m_flagSplitMeshAfterCut) {
+		U32 ctQuads = (quadstrips.size() >= 4) ? (quadstrips.size() - 2) / 2 : 0;
+		for(U32 i = 0; i < ctQuads && i < vSegmentHits.size(); i++) {
+			if(vSegmentHits[i])
 				splitParts(&quadstrips[i * 2], DEFAULT_MESH_SPLIT_DIST);
 		}
 	}
+	m_cutStats.msSplitParts += LapMS(tickLap);
 
-	//print mesh parts
-	//printParts();
 	VolMeshStats::printAllStats(this);
+	m_cutStats.msStats += LapMS(tickLap);
 
 	//recompute AABB and expand it to detect cuts
 	m_aabb = this->computeAABB();
@@ -507,30 +1350,20 @@ int CuttableMesh::cut(const vector<vec3d>& segments,
 
 	//update renderer
 	syncRender();
+	m_cutStats.msRenderSync += LapMS(tickLap);
 
-	//Return number of tets cut
 	return ctSubdividedTets;
 }
 
 vec3d CuttableMesh::vertexRestPosAt(U32 i) const {
-	return this->const_nodeAt(i).restpos;
+	return this->nodeRestPos(i);
 }
 
 int CuttableMesh::findClosestVertex(const vec3d& query, double& dist, vec3d& outP) const {
-	double minDist = GetMaxLimit<double>();
-	int idxFound = -1;
-	for(U32 i=0; i < this->countNodes(); i++) {
-		vec3d p = this->const_nodeAt(i).pos;
-		double dist2 = (query - p).length2();
-		if (dist2 < minDist) {
-			minDist = dist2;
-			outP = p;
-			idxFound = i;
-		}
-	}
+	int idxFound = this->findClosestNode(query, dist);
+	if(idxFound >= 0)
+		outP = this->nodePos(idxFound);
 
-	//Distance
-	dist = sqrt(minDist);
 	return idxFound;
 }
 
@@ -572,63 +1405,50 @@ bool CuttableMesh::splitParts(const vec3d sweptquad[4], double dist) {
 	sweptSurfCentroid = sweptSurfCentroid * 0.25;
 
 
-	//find disjoint mesh-parts
-	vector< vector<U32> > cellgroups;
-	get_disjoint_parts(cellgroups);
-
+	//label disjoint mesh-parts
+	U32 ctParts = update_cell_parts();
+	const vector<U32>& vCellParts = const_cell_parts();
 
-	//set of nodes
-	set<U32> setFrontNodes;
-	set<U32> setBackNodes;
+	//count cells in front of the sweep surf per part
+	vector<U32> vPartCells(ctParts, 0);
+	vector<U32> vPartFrontCells(ctParts, 0);
+	for(U32 i = 0; i < vCellParts.size(); i++) {
+		vec3d x = computeCellCentroid(i) - sweptSurfCentroid;
+		vPartCells[vCellParts[i]]++;
+		if(vec3d::dot(x, sweptSurfNormal) > 0)
+			vPartFrontCells[vCellParts[i]]++;
+	}
 
 	//partition nodes to front and back of the sweep surf
-	for(U32 i = 0; i < cellgroups.size(); i++) {
-
-		vector<U32> cells = cellgroups[i];
-
-		U32 ctFront = 0;
-		for(vector<U32>::const_iterator it = cells.begin(); it !=cells.end(); ++it) {
-			if(isCellIndex(*it)) {
-				vec3d x = computeCellCentroid(*it);
-
-				x = x - sweptSurfCentroid;
-				if(vec3d::dot(x, sweptSurfNormal) > 0)
-					ctFront++;
-			}
-		}
+	vector<U8> vFrontNodes(countNodes(), 0);
+	vector<U8> vBackNodes(countNodes(), 0);
+	for(U32 i = 0; i < vCellParts.size(); i++) {
+		U32 idxPart = vCellParts[i];
+		const CELL& cell = const_cellAt(i);
 
 		//categorize nodes based on front and back count
-		if(ctFront == cells.size()) {
-			for(vector<U32>::const_iterator it = cells.begin(); it !=cells.end(); it++) {
-				const CELL& cell = const_cellAt(*it);
-				for(int j=0; j < COUNT_CELL_NODES; j++)
-					setFrontNodes.insert(cell.nodes[j]);
-			}
+		if(vPartFrontCells[idxPart] == vPartCells[idxPart]) {
+			for(int j=0; j < COUNT_CELL_NODES; j++)
+				vFrontNodes[cell.nodes[j]] = 1;
 		}
-		else if(ctFront == 0) {
-			//add to back
-			for(vector<U32>::const_iterator it = cells.begin(); it !=cells.end(); it++) {
-				const CELL& cell = const_cellAt(*it);
-				for(int j=0; j < COUNT_CELL_NODES; j++)
-					setBackNodes.insert(cell.nodes[j]);
-			}
+		else if(vPartFrontCells[idxPart] == 0) {
+			for(int j=0; j < COUNT_CELL_NODES; j++)
+				vBackNodes[cell.nodes[j]] = 1;
 		}
 	}
 
-	vector<U32> frontNodes(setFrontNodes.begin(), setFrontNodes.end());
-	vector<U32> backNodes(setBackNodes.begin(), setBackNodes.end());
-
 	//move nodes to front
-	for(vector<U32>::const_iterator it = frontNodes.begin(); it != frontNodes.end(); it++) {
-		NODE& node = nodeAt(*it);
-		node.pos = node.pos + dfront;
-	}
+	for(U32 i = 0; i < vFrontNodes.size(); i++)
+		if(vFrontNodes[i])
+			setNodePos(i, nodePos(i) + dfront);
 
 	//move nodes to back
-	for(vector<U32>::const_iterator it = backNodes.begin(); it != backNodes.end(); it++) {
-		NODE& node = nodeAt(*it);
-		node.pos = node.pos - dfront;
-	}
+	for(U32 i = 0; i < vBackNodes.size(); i++)
+		if(vBackNodes[i])
+			setNodePos(i, nodePos(i) - dfront);
+
+	//nodes moved directly
+	notifyNodeEvent(INVALID_INDEX, teUpdated);
 
 	return true;
 }
@@ -670,7 +1490,7 @@ int CuttableMesh::convertDisjointPartsToMeshes(vector<CuttableMesh*>& vOutNewMes
 
 				//if the new nodes are not cached
 				if(mapNodes.find(cell.nodes[k]) == mapNodes.end()) {
-					vec3d v = const_nodeAt(cell.nodes[k]).pos;
+					vec3d v = nodePos(cell.nodes[k]);
 					vNewNodes.push_back(v);
 					U32 idxNew = vNewNodes.size() - 1;
 					mapNodes.insert(std::make_pair(cell.nodes[k], idxNew));
@@ -708,7 +1528,7 @@ void CuttableMesh::applyTransformToMeshThenResetTransform() {
 		return;
 
 	for(U32 i = 0; i < countNodes(); i++) {
-		NODE& n = nodeAt(i);
+		NODE n = const_nodeAt(i);
 
 		vec3d pd = n.pos;
 		vec3f pf = vec3f(pd.x, pd.y, pd.z);
@@ -718,9 +1538,11 @@ void CuttableMesh::applyTransformToMeshThenResetTransform() {
 		pd = vec3d(pf.x, pf.y, pf.z);
 		n.pos = pd;
 		n.restpos = pd;
+		setNode(i, n);
 	}
 
 	m_spTransform->reset();
+	notifyNodeEvent(INVALID_INDEX, teUpdated);
 	computeAABB();
 }
 
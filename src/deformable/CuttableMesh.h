@@ -13,7 +13,16 @@
 #include "VolMesh.h"
 #include "deformable/VolMeshRender.h"
 #include "TetSubdivider.h"
+#include "VolMeshBVH.h"
 #include "base/Vec.h"
+#include "base/MemoryArena.h"
+#include "base/DenseIndexMap.h"
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <tbb/task_arena.h>
 
 
 using namespace PS::MATH;
@@ -62,6 +71,9 @@ public:
 		}
 	};
 
+	//cut-edges found by a swept quad
+	typedef vector< std::pair<U32, CutEdge> > CutEdgeHits;
+
 	//CutNode
 	struct CutNode {
 		vec3d pos;
@@ -74,13 +86,52 @@ public:
 		}
 	};
 
+	//scratch maps of a single cut operation. Their memory lives in the cut arena.
+	typedef std::map<U32, CutEdge, std::less<U32>, ArenaAllocator< std::pair<const U32, CutEdge> > > CutEdgeMap;
+	typedef std::map<U32, CutNode, std::less<U32>, ArenaAllocator< std::pair<const U32, CutNode> > > CutNodeMap;
+
+	//wall time of the stages of the last cut in milliseconds. A progressive stroke sums its steps.
+	struct CutStats {
+		double msIntersect;
+		double msClassify;
+		double msEdgeCut;
+		double msSubdivide;
+		double msGC;
+		double msSplitParts;
+		double msStats;
+		double msRenderSync;
+		U32 ctCutEdges;
+		U32 ctCutCells;
+		U32 ctSubdividedTets;
+
+		CutStats() { reset();}
+
+		void reset() {
+			msIntersect = msClassify = msEdgeCut = msSubdivide = 0.0;
+			msGC = msSplitParts = msStats = msRenderSync = 0.0;
+			ctCutEdges = ctCutCells = ctSubdividedTets = 0;
+		}
+
+		double total() const {
+			return msIntersect + msClassify + msEdgeCut + msSubdivide + msGC + msSplitParts + msStats + msRenderSync;
+		}
+	};
+
+	//result of a queued cut. Called on the thread that commits it.
+	typedef std::function<void(int)> OnCutCommitted;
+
 public:
 
+	//empty mesh. Fill it, e.g. with VolMeshIO::readBinary, then call setup.
+	CuttableMesh();
 	CuttableMesh(const VolMesh& volmesh);
 	CuttableMesh(const vector<double>& vertices, const vector<U32>& elements);
 	CuttableMesh(int ctVertices, double* vertices, int ctElements, int* elements);
 	virtual ~CuttableMesh();
 
+	//builds the renderer and the cut structures for the current nodes and cells
+	void setup();
+
 	//distances
 	double pointLineDistance(const vec3d& v1, const vec3d& v2, const vec3d& p);
 	double pointLineDistance(const vec3d& v1, const vec3d& v2,
@@ -90,6 +141,12 @@ public:
 	//draw
 	void draw();
 
+	//commits the background cuts that finished
+	void timestep();
+
+	//the box of the last committed cut while a background cut is in flight
+	AABB aabb() const;
+
 	//sync renderer
 	void syncRender();
 
@@ -98,28 +155,98 @@ public:
 
 	//kernel to compute cut-edges per tool segment
 	int computeCutEdgesKernel(const vec3d sweptquad[4],
-							  std::map<U32, CutEdge>& mapCutEdges);
+							  CutEdgeMap& mapCutEdges);
+
+	/*!
+	 * computes the cut-edges of all swept quads in one pass. Every node is classified once
+	 * per quad triangle by its side of the triangle plane and the triangle sides it is
+	 * outside of. Only edges that change side and are not outside a common triangle side
+	 * get the exact segment/triangle test.
+	 * @param quadstrips swept quads of all tool segments
+	 * @param vQuadHits output cut-edges per quad in edge order
+	 */
+	void computeCutEdgesByNodeSigns(const vector<vec3d>& quadstrips,
+									vector<CutEdgeHits>& vQuadHits);
+
+	//adds the cut-edges of one quad. Edges cut twice are dropped.
+	int addCutEdgeHits(const CutEdgeHits& hits, CutEdgeMap& mapCutEdges);
 
 	//kernel to compute cut nodes per tool segment
 	int computeCutNodesKernel(const vec3d& blade0,
 							  const vec3d& blade1,
 							  const vec3d sweptquad[4],
-							  std::map<U32, CutEdge>& mapCutEdges,
-							  std::map<U32, CutNode>& mapCutNodes);
+							  CutEdgeMap& mapCutEdges,
+							  CutNodeMap& mapCutNodes);
 
 
 	int cut(const vector<vec3d>& segments,
 			const vector<vec3d>& quadstrips,
 			bool modifyMesh);
 
+	/*!
+	 * Progressive cutting: cuts the tets crossed by the latest swept quads while the tool
+	 * is still inside the tissue. Cut-edges accumulate in a cut front across calls. A tet is
+	 * subdivided once its cut is complete and none of its cut-edges is shared with a tet
+	 * that is still partially cut. Partially cut tets stay in the front.
+	 * @param segments tool segments at the current position
+	 * @param quadstrips swept quads from the previous tool position to the current one
+	 * @return number of tets subdivided in this step or an error code
+	 */
+	int cutProgressive(const vector<vec3d>& segments,
+					   const vector<vec3d>& quadstrips);
+
+	/*!
+	 * ends the current progressive cut stroke. Tets left partially cut are not subdivided.
+	 * @param quadstrips swept quads of the whole stroke. Used for splitting the mesh parts.
+	 * @return number of tets subdivided during the stroke
+	 */
+	int endProgressiveCut(const vector<vec3d>& quadstrips);
+	bool isProgressiveCutActive() const { return m_isStrokeActive;}
+
+	/*!
+	 * Queued cutting. With the background flag the queued operations run one at a time as
+	 * enqueued tbb tasks while draw keeps using the render buffers of the last commit.
+	 * A finished operation is committed on the gl thread by commitBackgroundCuts, which syncs
+	 * the renderer, publishes the new generation and calls fOnCommitted before the next one
+	 * starts. Without the flag they run and commit right away. Call from the gl thread only.
+	 * Only the render buffers and the aabb of the last commit are kept for drawing. The
+	 * topology itself is not double buffered, so read it after finishBackgroundCuts.
+	 * A progressive step queued behind another pending one is merged into it: the swept
+	 * quads run from the start of the older step to the end of the newer one. The queue
+	 * holds at most one pending step, so the cut trails the tool by a step or two.
+	 */
+	void queueCut(const vector<vec3d>& segments, const vector<vec3d>& quadstrips,
+				  OnCutCommitted fOnCommitted = NULL);
+	void queueCutProgressive(const vector<vec3d>& segments, const vector<vec3d>& quadstrips,
+							 OnCutCommitted fOnCommitted = NULL);
+	void queueEndProgressiveCut(const vector<vec3d>& quadstrips, OnCutCommitted fOnCommitted = NULL);
+	void queueClearCutContext();
+
+	//@return number of committed operations
+	int commitBackgroundCuts();
+
+	//waits for and commits all queued operations. Needed before touching the mesh directly.
+	//Blocks the gl thread for the running operation and the pending ones, which with merged
+	//steps is at most a step, a merged step and the end of the stroke.
+	void finishBackgroundCuts();
+
+	bool isCutInFlight() const { return m_isCutRunning || m_qPendingCuts.size() > 0;}
+
+	//bumped by every committed operation
+	U32 generation() const { return m_generation.load(std::memory_order_acquire);}
+
 	//Access vertex neibors
 	vec3d vertexRestPosAt(U32 i) const;
 	int findClosestVertex(const vec3d& query, double& dist, vec3d& outP) const;
 	int countCompletedCuts() const {return m_ctCompletedCuts;}
+	const CutStats& lastCutStats() const { return m_cutStats;}
 
 	//Access to subdivider
 	TetSubdivider* getSubD() const { return m_lpSubD;}
 
+	//Access to edge hierarchy
+	VolMeshBVH* getEdgeBVH() const { return m_lpEdgeBVH;}
+
 	/*!
 	 * splits the mesh parts using the sweep surface.
 	 * @param vSweeptSurf
@@ -157,9 +284,50 @@ public:
 	bool getFlagDrawAABB() const { return m_flagDrawAABB;}
 	void setFlagDrawAABB(bool flag) { m_flagDrawAABB = flag;}
 
+	//tools cut progressively while moving inside the tissue
+	bool getFlagProgressiveCut() const { return m_flagProgressiveCut;}
+	void setFlagProgressiveCut(bool flag) { m_flagProgressiveCut = flag;}
+
+	//cut-edges come from per node side tests fused over all swept quads
+	bool getFlagNodeSignCut() const { return m_flagNodeSignCut;}
+	void setFlagNodeSignCut(bool flag) { m_flagNodeSignCut = flag;}
+
+	//queued cuts run on a worker thread
+	bool getFlagBackgroundCut() const { return m_flagBackgroundCut;}
+	void setFlagBackgroundCut(bool flag);
+
 
 protected:
-	void setup();
+	void init();
+
+	//subdivides the cut cells. All cut-edges of the cells must be split already.
+	int subdivideCutCells(const vector<U32>& cells,
+						  const vector<U8>& cutEdgeCodes,
+						  const vector<U8>& cutNodeCodes);
+
+	//splits the front edges and subdivides the cells that are ready in the cut front.
+	//with flagPartial the partially cut cells are subdivided too, as at the end of a stroke.
+	int commitCutFront(bool flagPartial = false);
+
+	//allocator for the scratch containers of a cut operation
+	ArenaAllocator<U32> cutAlloc() { return ArenaAllocator<U32>(&m_cutArena);}
+
+	//queued operation and its result handler. Progressive steps keep their input for merging.
+	struct QueuedCut {
+		std::function<int()> fRun;
+		OnCutCommitted fOnCommitted;
+		bool isProgressiveStep;
+		vector<vec3d> segments;
+		vector<vec3d> quadstrips;
+
+		QueuedCut() : isProgressiveStep(false) {}
+	};
+
+	void queueOperation(const QueuedCut& op);
+	void startNextCut();
+	void runCut();
+	void waitRunningCut();
+	void commitRunningCut();
 
 	//TODO: Sync physics mesh after cut
 
@@ -167,22 +335,50 @@ protected:
 private:
 	VolMeshRender* m_lpRender;
 	TetSubdivider* m_lpSubD;
+	VolMeshBVH* m_lpEdgeBVH;
 	int m_ctCompletedCuts;
 	bool m_flagSplitMeshAfterCut;
 	bool m_flagDetectCutNodes;
+	bool m_flagNodeSignCut;
+
+	//progressive cutting
+	bool m_flagProgressiveCut;
+	bool m_isStrokeActive;
+	U32 m_idxStrokeFirstNode;
+	U32 m_ctStrokeSubdividedTets;
+	vector<U8> m_vStrokeSegmentHits;
 
 	//sweep surfaces
 	bool m_flagDrawSweepSurf;
 	bool m_flagDrawAABB;
 	vector<vec3d> m_quadstrips;
 
-	//Cut Nodes
-	std::map<U32, CutNode > m_mapCutNodes;
-	typedef std::map<U32, CutNode >::iterator CUTNODEITER;
-
-	//Cut Edges
-	std::map<U32, CutEdge > m_mapCutEdges;
-	typedef std::map<U32, CutEdge >::iterator CUTEDGEITER;
+	CutStats m_cutStats;
+
+	//background cutting. Only the gl thread touches the queue and the running flag.
+	bool m_flagBackgroundCut;
+	bool m_isCutRunning;
+	bool m_isInBackground;
+	std::atomic<bool> m_isCutDone;
+	std::deque<QueuedCut> m_qPendingCuts;
+	QueuedCut m_runningCut;
+	int m_runningResult;
+	tbb::task_arena m_arenaCuts;
+	std::mutex m_lockCutDone;
+	std::condition_variable m_cvCutDone;
+	std::atomic<U32> m_generation;
+	AABB m_aabbCommitted;
+
+	//scratch memory of the current cut operation. Rewound once the operation returns.
+	MemoryArena m_cutArena;
+
+	//Cut Nodes keyed by node
+	DenseIndexMap<CutNode> m_mapCutNodes;
+	typedef DenseIndexMap<CutNode>::iterator CUTNODEITER;
+
+	//Cut Edges keyed by edge
+	DenseIndexMap<CutEdge> m_mapCutEdges;
+	typedef DenseIndexMap<CutEdge>::iterator CUTEDGEITER;
 };
 
 
@@ -31,6 +31,7 @@ void IAvatar::init() {
 	setName("scalpel");
 	m_fOnCutFinished = NULL;
 	m_lpTissue = NULL;
+	m_lpRecorder = NULL;
 	m_isToolActive = false;
 	m_applyGripper = false;
 
@@ -72,8 +73,7 @@ void IAvatar::mousePress(int button, int state, int x, int y) {
 			m_isToolActive = false;
 
 			//count disjoint parts
-			vector<vector<U32> > parts;
-			U32 ctParts = m_lpTissue->get_disjoint_parts(parts);
+			U32 ctParts = m_lpTissue->update_cell_parts();
 			AnsiStr strMsg = printToAStr("scalpel: finished cut %u. disjoint parts#%u",
 										 (U32)m_lpTissue->countCompletedCuts(),
 										 ctParts);
@@ -83,6 +83,27 @@ void IAvatar::mousePress(int button, int state, int x, int y) {
 	}
 }
 
+void IAvatar::onCutCommitted(int res) {
+	LogInfoArg1("Tissue cut. res = %d", res);
+	if((res > 0) && (m_fOnCutFinished != NULL))
+		m_fOnCutFinished();
+
+	updateVolMeshInfoHeader();
+}
+
+void IAvatar::onProgressiveStepCommitted(int res) {
+	if(res < 0)
+		LogErrorArg1("Progressive cut failed. res = %d", res);
+}
+
+CuttableMesh::OnCutCommitted IAvatar::cutCommittedHandler() {
+	return std::bind(&IAvatar::onCutCommitted, this, std::placeholders::_1);
+}
+
+CuttableMesh::OnCutCommitted IAvatar::progressiveStepCommittedHandler() {
+	return std::bind(&IAvatar::onProgressiveStepCommitted, this, std::placeholders::_1);
+}
+
 void IAvatar::updateVolMeshInfoHeader() const {
 
 	if(m_lpTissue == NULL)
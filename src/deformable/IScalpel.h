@@ -12,6 +12,7 @@
 #include <graphics/Gizmo.h>
 #include <graphics/SGMesh.h>
 #include "deformable/CuttableMesh.h"
+#include "deformable/CutTrajectory.h"
 
 #define MAX_SCALPEL_TRAJECTORY_ANGLE  60.0
 #define MAX_SCALPEL_TRAJECTORY_NODES 1024
@@ -33,6 +34,9 @@ public:
 	//Tool
 	void setOnCutFinishedEventHandler(OnCutFinished f) {m_fOnCutFinished = f;}
 	void setTissue(CuttableMesh* tissue);
+
+	//records the blade frames of every stroke that ends in a cut
+	void setRecorder(CutTrajectory* lpRecorder) { m_lpRecorder = lpRecorder;}
 	virtual void grip();
 	bool isGripActive() const {return m_applyGripper;}
 
@@ -40,12 +44,19 @@ public:
 	bool isActive() const {return m_isToolActive;}
 	void updateVolMeshInfoHeader() const;
 
+	//handlers of the queued tissue operations. Called on the gl thread.
+	void onCutCommitted(int res);
+	void onProgressiveStepCommitted(int res);
+
 	//From Gizmo Manager
 	virtual void mousePress(int button, int state, int x, int y);
 
 protected:
 	void init();
 
+	CuttableMesh::OnCutCommitted cutCommittedHandler();
+	CuttableMesh::OnCutCommitted progressiveStepCommittedHandler();
+
 protected:
 	bool m_isToolActive;
 	bool m_applyGripper;
@@ -53,6 +64,7 @@ protected:
 
 
 	CuttableMesh* m_lpTissue;
+	CutTrajectory* m_lpRecorder;
 };
 
 } /* namespace MESH */
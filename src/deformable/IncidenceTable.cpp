@@ -0,0 +1,279 @@
+/*
+ * IncidenceTable.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "IncidenceTable.h"
+#include <algorithm>
+
+namespace PS {
+namespace MESH {
+
+const U32 IncidenceTable::INVALID_SLOT;
+
+IncidenceTable::IncidenceTable() {
+	m_packed = true;
+	m_vOffsets.push_back(0);
+}
+
+IncidenceTable::IncidenceTable(bool packed) {
+	m_packed = packed;
+	m_vOffsets.push_back(0);
+}
+
+IncidenceTable::~IncidenceTable() {
+	clear();
+}
+
+void IncidenceTable::clear() {
+	m_vOffsets.assign(1, 0);
+	m_vCounts.clear();
+	m_vIndices.clear();
+	m_vSlots.clear();
+	m_vOverflow.clear();
+	m_vFreeSlots.clear();
+}
+
+void IncidenceTable::resize(U32 ct) {
+	if(ct == 0) {
+		clear();
+		return;
+	}
+
+	U32 ctOld = size();
+	if(ct < ctOld) {
+		for(U32 i=ct; i < ctOld; i++)
+			release(i);
+
+		//the last kept list inherits the dead space after it
+		m_vOffsets.resize(ct + 1);
+		m_vOffsets[ct] = m_vIndices.size();
+	}
+	else
+		m_vOffsets.resize(ct + 1, m_vIndices.size());
+
+	m_vCounts.resize(ct, 0);
+	m_vSlots.resize(ct, INVALID_SLOT);
+}
+
+void IncidenceTable::reserve_lists(const vector<U32>& capacities) {
+	clear();
+
+	U32 ct = capacities.size();
+	m_vCounts.assign(ct, 0);
+	m_vSlots.assign(ct, INVALID_SLOT);
+	m_vOffsets.resize(ct + 1);
+
+	if(m_packed) {
+		U32 total = 0;
+		for(U32 i=0; i < ct; i++) {
+			m_vOffsets[i] = total;
+			total += capacities[i];
+		}
+		m_vOffsets[ct] = total;
+		m_vIndices.resize(total);
+	}
+	else {
+		m_vOffsets.assign(ct + 1, 0);
+		m_vOverflow.resize(ct);
+		for(U32 i=0; i < ct; i++) {
+			m_vOverflow[i].reserve(capacities[i]);
+			m_vSlots[i] = i;
+		}
+	}
+}
+
+void IncidenceTable::push_back(U32 i, U32 value) {
+	U32 slot = m_vSlots[i];
+	if(slot == INVALID_SLOT && m_packed) {
+		U32 pos = m_vOffsets[i] + m_vCounts[i];
+
+		//room left in the packed slot
+		if(pos < m_vOffsets[i + 1]) {
+			m_vIndices[pos] = value;
+			m_vCounts[i]++;
+			return;
+		}
+
+		//the last list can grow at the tail of the packed array
+		if(i + 1 == size() && pos == m_vIndices.size()) {
+			m_vIndices.push_back(value);
+			m_vOffsets[i + 1]++;
+			m_vCounts[i]++;
+			return;
+		}
+	}
+
+	if(slot == INVALID_SLOT)
+		slot = spill(i);
+	m_vOverflow[slot].push_back(value);
+}
+
+U32 IncidenceTable::remove(U32 i, U32 value) {
+	U32 slot = m_vSlots[i];
+	if(slot != INVALID_SLOT) {
+		vector<U32>& lst = m_vOverflow[slot];
+		U32 ctOld = lst.size();
+		lst.erase(std::remove(lst.begin(), lst.end(), value), lst.end());
+		return ctOld - lst.size();
+	}
+
+	U32* first = m_vIndices.data() + m_vOffsets[i];
+	U32* last = std::remove(first, first + m_vCounts[i], value);
+	U32 ctRemoved = (first + m_vCounts[i]) - last;
+	m_vCounts[i] -= ctRemoved;
+	return ctRemoved;
+}
+
+void IncidenceTable::erase(U32 i) {
+	release(i);
+
+	//dropping the start offset of i hands its packed slot to list i - 1
+	m_vOffsets.erase(m_vOffsets.begin() + i);
+	m_vCounts.erase(m_vCounts.begin() + i);
+	m_vSlots.erase(m_vSlots.begin() + i);
+}
+
+void IncidenceTable::compactByRemap(const vector<U32>& remap, U32 ctAfter) {
+	vector<U32> vOffsets(ctAfter + 1, 0);
+	vector<U32> vCounts(ctAfter, 0);
+	vector<U32> vSlots(ctAfter, INVALID_SLOT);
+	vector<U32> vIndices;
+	vector< vector<U32> > vOverflow;
+
+	//lists are packed in their new order
+	vector<U32> vSources(ctAfter, INVALID_SLOT);
+	U32 total = 0;
+	for(U32 i=0; i < remap.size(); i++) {
+		if(remap[i] == INVALID_SLOT)
+			continue;
+		vSources[remap[i]] = i;
+		total += count(i);
+	}
+
+	if(m_packed)
+		vIndices.reserve(total);
+	else
+		vOverflow.resize(ctAfter);
+
+	for(U32 dst=0; dst < ctAfter; dst++) {
+		U32 i = vSources[dst];
+		if(i == INVALID_SLOT)
+			continue;
+
+		if(m_packed) {
+			vOffsets[dst] = vIndices.size();
+			vCounts[dst] = count(i);
+			vIndices.insert(vIndices.end(), begin(i), end(i));
+		}
+		else {
+			if(m_vSlots[i] != INVALID_SLOT)
+				vOverflow[dst].swap(m_vOverflow[m_vSlots[i]]);
+			else
+				vOverflow[dst].assign(begin(i), end(i));
+			vSlots[dst] = dst;
+		}
+	}
+	vOffsets[ctAfter] = vIndices.size();
+
+	m_vOffsets.swap(vOffsets);
+	m_vCounts.swap(vCounts);
+	m_vSlots.swap(vSlots);
+	m_vIndices.swap(vIndices);
+	m_vOverflow.swap(vOverflow);
+	m_vFreeSlots.clear();
+}
+
+void IncidenceTable::compact() {
+	if(!m_packed)
+		return;
+
+	//nothing spilled and no dead space
+	U32 total = 0;
+	for(U32 i=0; i < size(); i++)
+		total += count(i);
+	if(countOverflow() == 0 && total == m_vIndices.size() && m_vOverflow.size() == 0)
+		return;
+
+	vector<U32> vIndices;
+	vIndices.reserve(total);
+	for(U32 i=0; i < size(); i++) {
+		U32 ct = count(i);
+		U32 start = vIndices.size();
+		vIndices.insert(vIndices.end(), begin(i), end(i));
+		m_vOffsets[i] = start;
+		m_vCounts[i] = ct;
+	}
+	m_vOffsets[size()] = vIndices.size();
+
+	m_vIndices.swap(vIndices);
+	m_vSlots.assign(size(), INVALID_SLOT);
+	vector< vector<U32> >().swap(m_vOverflow);
+	vector<U32>().swap(m_vFreeSlots);
+
+	//per entity arrays may have grown one handle at a time
+	m_vOffsets.shrink_to_fit();
+	m_vCounts.shrink_to_fit();
+	m_vSlots.shrink_to_fit();
+}
+
+void IncidenceTable::setPacked(bool packed) {
+	if(m_packed == packed)
+		return;
+
+	m_packed = packed;
+	if(m_packed) {
+		compact();
+		return;
+	}
+
+	for(U32 i=0; i < size(); i++) {
+		if(m_vSlots[i] == INVALID_SLOT)
+			spill(i);
+	}
+	vector<U32>().swap(m_vIndices);
+	m_vOffsets.assign(size() + 1, 0);
+}
+
+U64 IncidenceTable::memoryUsage() const {
+	U64 bytes = sizeof(IncidenceTable);
+	bytes += (m_vOffsets.capacity() + m_vCounts.capacity() + m_vIndices.capacity() +
+			  m_vSlots.capacity() + m_vFreeSlots.capacity()) * sizeof(U32);
+	bytes += m_vOverflow.capacity() * sizeof(vector<U32>);
+	for(U32 i=0; i < m_vOverflow.size(); i++)
+		bytes += m_vOverflow[i].capacity() * sizeof(U32);
+	return bytes;
+}
+
+U32 IncidenceTable::spill(U32 i) {
+	U32 slot;
+	if(m_vFreeSlots.size() > 0) {
+		slot = m_vFreeSlots.back();
+		m_vFreeSlots.pop_back();
+	}
+	else {
+		slot = m_vOverflow.size();
+		m_vOverflow.push_back(vector<U32>());
+	}
+
+	const U32* first = m_vIndices.data() + m_vOffsets[i];
+	m_vOverflow[slot].assign(first, first + m_vCounts[i]);
+	m_vCounts[i] = 0;
+	m_vSlots[i] = slot;
+	return slot;
+}
+
+void IncidenceTable::release(U32 i) {
+	U32 slot = m_vSlots[i];
+	if(slot == INVALID_SLOT)
+		return;
+
+	vector<U32>().swap(m_vOverflow[slot]);
+	m_vFreeSlots.push_back(slot);
+	m_vSlots[i] = INVALID_SLOT;
+}
+
+}
+}
@@ -0,0 +1,131 @@
+/*
+ * IncidenceTable.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef INCIDENCETABLE_H_
+#define INCIDENCETABLE_H_
+
+#include "base/MathBase.h"
+#include <vector>
+
+using namespace std;
+
+namespace PS {
+namespace MESH {
+
+/*!
+ * Stores one list of handles per entity (e.g. the edges incident to each node).
+ * In packed mode the lists live in CSR form: an offset array and a single packed
+ * handle array. A list that outgrows its packed slot moves to a small overflow
+ * area until the next compact(), so topology edits during cutting stay cheap.
+ * In unpacked mode every list lives in the overflow area which is equivalent to
+ * the classic vector of vectors layout.
+ */
+class IncidenceTable {
+public:
+	typedef const U32* const_iterator;
+
+	static const U32 INVALID_SLOT = (U32)-1;
+
+	IncidenceTable();
+	explicit IncidenceTable(bool packed);
+	~IncidenceTable();
+
+	//number of entities
+	U32 size() const { return m_vCounts.size();}
+
+	//grows or shrinks the entity count. New entities have empty lists.
+	void resize(U32 ct);
+
+	//resets the table to capacities.size() empty lists with room for capacities[i] handles each
+	void reserve_lists(const vector<U32>& capacities);
+	void clear();
+
+	//list access
+	U32 count(U32 i) const {
+		return (m_vSlots[i] == INVALID_SLOT) ? m_vCounts[i] : m_vOverflow[m_vSlots[i]].size();
+	}
+
+	const_iterator begin(U32 i) const {
+		if(m_vSlots[i] != INVALID_SLOT)
+			return m_vOverflow[m_vSlots[i]].data();
+		return m_vIndices.data() + m_vOffsets[i];
+	}
+
+	const_iterator end(U32 i) const { return begin(i) + count(i);}
+
+	U32 at(U32 i, U32 k) const { return begin(i)[k];}
+
+	//list edits
+	void push_back(U32 i, U32 value);
+
+	//removes all occurrences of value from the list of entity i keeping the order
+	U32 remove(U32 i, U32 value);
+
+	//erases entity i. All following entities shift down by one.
+	void erase(U32 i);
+
+	/*!
+	 * keeps entity i only if remap[i] is valid and moves it to remap[i]. Remap
+	 * must be one to one over the kept entities so it may also permute them.
+	 * The output is packed in packed mode.
+	 */
+	void compactByRemap(const vector<U32>& remap, U32 ctAfter);
+
+	//applies f(U32&) to every stored handle
+	template <typename Func>
+	void for_each_value(Func f) {
+		for(U32 i=0; i < m_vCounts.size(); i++) {
+			if(m_vSlots[i] != INVALID_SLOT)
+				continue;
+			U32* p = m_vIndices.data() + m_vOffsets[i];
+			for(U32 k=0; k < m_vCounts[i]; k++)
+				f(p[k]);
+		}
+
+		for(U32 i=0; i < m_vOverflow.size(); i++) {
+			for(U32 k=0; k < m_vOverflow[i].size(); k++)
+				f(m_vOverflow[i][k]);
+		}
+	}
+
+	//moves all overflow lists back into the packed arrays and drops dead space
+	void compact();
+
+	//layout
+	void setPacked(bool packed);
+	bool isPacked() const { return m_packed;}
+
+	//number of lists currently stored in the overflow area
+	U32 countOverflow() const { return m_vOverflow.size() - m_vFreeSlots.size();}
+
+	//bytes held by this table including heap blocks of overflow lists
+	U64 memoryUsage() const;
+
+private:
+	//moves list i to the overflow area
+	U32 spill(U32 i);
+	void release(U32 i);
+
+private:
+	bool m_packed;
+
+	//packed layout: list i occupies [m_vOffsets[i], m_vOffsets[i] + m_vCounts[i])
+	//and may grow up to m_vOffsets[i + 1]
+	vector<U32> m_vOffsets;
+	vector<U32> m_vCounts;
+	vector<U32> m_vIndices;
+
+	//overflow slot per entity or INVALID_SLOT
+	vector<U32> m_vSlots;
+	vector< vector<U32> > m_vOverflow;
+	vector<U32> m_vFreeSlots;
+};
+
+}
+}
+
+#endif /* INCIDENCETABLE_H_ */
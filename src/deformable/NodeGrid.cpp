@@ -0,0 +1,343 @@
+/*
+ * NodeGrid.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "NodeGrid.h"
+#include "base/Profiler.h"
+#include <algorithm>
+#include <math.h>
+
+//rebuild once the nodes outnumber the buckets by this factor
+#define NODE_GRID_MAX_LOAD 2
+#define NODE_GRID_MIN_BUCKETS 16
+
+//cell coordinates are clamped to keep far away points from overflowing
+#define NODE_GRID_CELL_LIMIT (1 << 28)
+
+//relative padding of the cells when culling them by distance
+#define NODE_GRID_CELL_PAD 0.01
+
+namespace PS {
+namespace MESH {
+
+static inline bool IsSameCell(const vec3i& a, const vec3i& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+NodeGrid::NodeGrid() {
+	reset();
+}
+
+NodeGrid::~NodeGrid() {
+}
+
+void NodeGrid::reset() {
+	m_isValid = false;
+	m_cellSize = 1.0;
+	m_loCell = m_hiCell = vec3i(0, 0, 0);
+	m_vNodeCells.resize(0);
+	m_vBuckets.resize(0);
+}
+
+void NodeGrid::nodeAdded(U32 idxNode, const vec3d& p) {
+	if(!m_isValid)
+		return;
+
+	//nodes are only appended
+	if(idxNode != m_vNodeCells.size() || m_vNodeCells.size() >= NODE_GRID_MAX_LOAD * m_vBuckets.size()) {
+		m_isValid = false;
+		return;
+	}
+
+	vec3i cell = cellOf(p);
+	if(m_vNodeCells.size() == 0)
+		m_loCell = m_hiCell = cell;
+	m_vNodeCells.push_back(cell);
+	insert(idxNode, cell);
+}
+
+void NodeGrid::nodeMoved(U32 idxNode, const vec3d& p) {
+	if(!m_isValid)
+		return;
+
+	if(idxNode >= m_vNodeCells.size()) {
+		m_isValid = false;
+		return;
+	}
+
+	vec3i cell = cellOf(p);
+	if(IsSameCell(cell, m_vNodeCells[idxNode]))
+		return;
+
+	//swap out of the old bucket
+	vector<U32>& bucket = m_vBuckets[bucketOf(m_vNodeCells[idxNode])];
+	for(U32 i=0; i < bucket.size(); i++) {
+		if(bucket[i] == idxNode) {
+			bucket[i] = bucket.back();
+			bucket.pop_back();
+			break;
+		}
+	}
+
+	m_vNodeCells[idxNode] = cell;
+	insert(idxNode, cell);
+}
+
+void NodeGrid::nodeRemoved(U32) {
+	//the handles after the removed node shift down. A full rebuild on the next update is
+	//intended as every stored handle past it would be rewritten anyway.
+	m_isValid = false;
+}
+
+void NodeGrid::update(const NodeStore& nodes) {
+	if(!m_isValid || m_vNodeCells.size() != nodes.size())
+		build(nodes);
+}
+
+void NodeGrid::build(const NodeStore& nodes) {
+
+	ProfileAutoArg("node grid build");
+
+	const U32 ctNodes = nodes.size();
+	m_vNodeCells.resize(ctNodes);
+	m_vBuckets.resize(0);
+
+	//about one node per cell over the bounding box
+	vec3d lo, hi;
+	m_cellSize = 1.0;
+	if(nodes.bounds(lo, hi)) {
+		vec3d ext = hi - lo;
+		double maxExt = std::max(ext.x, std::max(ext.y, ext.z));
+		double volume = ext.x * ext.y * ext.z;
+		if(volume > 0.0)
+			m_cellSize = cbrt(volume / ctNodes);
+		else if(maxExt > 0.0)
+			m_cellSize = maxExt / std::max(cbrt((double)ctNodes), 1.0);
+	}
+
+	U32 ctBuckets = NODE_GRID_MIN_BUCKETS;
+	while(ctBuckets < ctNodes)
+		ctBuckets <<= 1;
+	m_vBuckets.resize(ctBuckets);
+
+	m_isValid = true;
+	if(ctNodes > 0)
+		m_loCell = m_hiCell = cellOf(nodes.pos(0));
+	for(U32 i=0; i < ctNodes; i++) {
+		m_vNodeCells[i] = cellOf(nodes.pos(i));
+		insert(i, m_vNodeCells[i]);
+	}
+}
+
+vec3i NodeGrid::cellOf(const vec3d& p) const {
+	vec3i cell;
+	for(int i=0; i < 3; i++) {
+		double c = floor(p[i] / m_cellSize);
+		if(c < -NODE_GRID_CELL_LIMIT)
+			c = -NODE_GRID_CELL_LIMIT;
+		else if(c > NODE_GRID_CELL_LIMIT)
+			c = NODE_GRID_CELL_LIMIT;
+		cell[i] = (I32)c;
+	}
+
+	return cell;
+}
+
+U32 NodeGrid::bucketOf(const vec3i& cell) const {
+	U32 h = ((U32)cell.x * 73856093u) ^ ((U32)cell.y * 19349663u) ^ ((U32)cell.z * 83492791u);
+	return h & (m_vBuckets.size() - 1);
+}
+
+void NodeGrid::insert(U32 idxNode, const vec3i& cell) {
+	m_vBuckets[bucketOf(cell)].push_back(idxNode);
+	m_loCell = vec3i::minP(m_loCell, cell);
+	m_hiCell = vec3i::maxP(m_hiCell, cell);
+}
+
+void NodeGrid::gatherCell(const vec3i& cell, vector<U32>& outNodes) const {
+	//buckets are shared by the cells hashed to them
+	const vector<U32>& bucket = m_vBuckets[bucketOf(cell)];
+	for(U32 i=0; i < bucket.size(); i++) {
+		if(IsSameCell(m_vNodeCells[bucket[i]], cell))
+			outNodes.push_back(bucket[i]);
+	}
+}
+
+void NodeGrid::gatherBox(const vec3i& lo, const vec3i& hi, vector<U32>& outNodes,
+						 const vec3d* lpQuery, double maxDist2) const {
+	vec3i clo = vec3i::maxP(lo, m_loCell);
+	vec3i chi = vec3i::minP(hi, m_hiCell);
+
+	vec3i cell;
+	for(cell.x = clo.x; cell.x <= chi.x; cell.x++)
+		for(cell.y = clo.y; cell.y <= chi.y; cell.y++)
+			for(cell.z = clo.z; cell.z <= chi.z; cell.z++) {
+				if(lpQuery && cellDistance2(*lpQuery, cell) > maxDist2)
+					continue;
+				gatherCell(cell, outNodes);
+			}
+}
+
+double NodeGrid::cellDistance2(const vec3d& p, const vec3i& cell) const {
+	//cells are padded to cover the rounding of the cell coordinates
+	double pad = NODE_GRID_CELL_PAD * m_cellSize;
+	double dist2 = 0.0;
+	for(int i=0; i < 3; i++) {
+		double lo = cell[i] * m_cellSize - pad;
+		double hi = (cell[i] + 1) * m_cellSize + pad;
+		double d = (p[i] < lo) ? (lo - p[i]) : ((p[i] > hi) ? (p[i] - hi) : 0.0);
+		dist2 += d * d;
+	}
+
+	return dist2;
+}
+
+int NodeGrid::findClosest(const NodeStore& nodes, const vec3d& query, double& dist2) const {
+	dist2 = GetMaxLimit<double>();
+	if(m_vNodeCells.size() == 0)
+		return -1;
+
+	//grow shells of cells around the query until no closer node is possible
+	vec3i qc = cellOf(query);
+	I32 rFirst = 0;
+	I32 rLast = 0;
+	for(int i=0; i < 3; i++) {
+		rFirst = std::max(rFirst, std::max(m_loCell[i] - qc[i], qc[i] - m_hiCell[i]));
+		rLast = std::max(rLast, std::max(qc[i] - m_loCell[i], m_hiCell[i] - qc[i]));
+	}
+
+	int idxFound = -1;
+	vector<U32> vNodes;
+	for(I32 r = rFirst; r <= rLast; r++) {
+		vNodes.resize(0);
+		if(r == 0)
+			gatherCell(qc, vNodes);
+		else {
+			//faces of the shell normal to x then y then z without repeating edges.
+			//cells farther than the closest node so far are skipped.
+			for(int s = -1; s <= 1; s += 2) {
+				gatherBox(vec3i(qc.x + s * r, qc.y - r, qc.z - r), vec3i(qc.x + s * r, qc.y + r, qc.z + r), vNodes, &query, dist2);
+				gatherBox(vec3i(qc.x - r + 1, qc.y + s * r, qc.z - r), vec3i(qc.x + r - 1, qc.y + s * r, qc.z + r), vNodes, &query, dist2);
+				gatherBox(vec3i(qc.x - r + 1, qc.y - r + 1, qc.z + s * r), vec3i(qc.x + r - 1, qc.y + r - 1, qc.z + s * r), vNodes, &query, dist2);
+			}
+		}
+
+		for(U32 i=0; i < vNodes.size(); i++) {
+			double d2 = (query - nodes.pos(vNodes[i])).length2();
+			if(d2 < dist2 || (d2 == dist2 && (int)vNodes[i] < idxFound)) {
+				dist2 = d2;
+				idxFound = vNodes[i];
+			}
+		}
+
+		//nodes beyond shell r are at least r padded cells away
+		double reach = (r - 2 * NODE_GRID_CELL_PAD) * m_cellSize;
+		if(idxFound >= 0 && reach > 0.0 && dist2 < reach * reach)
+			break;
+	}
+
+	return idxFound;
+}
+
+U32 NodeGrid::findInRadius(const NodeStore& nodes, const vec3d& query, double radius, vector<U32>& outNodes) const {
+	outNodes.resize(0);
+	if(m_vNodeCells.size() == 0 || radius < 0.0)
+		return 0;
+
+	vector<U32> vNodes;
+	vec3d ext(radius, radius, radius);
+	gatherBox(cellOf(query - ext) - vec3i(1, 1, 1), cellOf(query + ext) + vec3i(1, 1, 1), vNodes);
+
+	double r2 = radius * radius;
+	for(U32 i=0; i < vNodes.size(); i++) {
+		if((query - nodes.pos(vNodes[i])).length2() <= r2)
+			outNodes.push_back(vNodes[i]);
+	}
+
+	std::sort(outNodes.begin(), outNodes.end());
+	return outNodes.size();
+}
+
+U32 NodeGrid::findAlongRay(const vec3d& origin, const vec3d& dir, double radius, vector<U32>& outNodes) const {
+	outNodes.resize(0);
+	if(m_vNodeCells.size() == 0 || dir.length2() == 0.0)
+		return 0;
+
+	//cells around the ray that may hold a node within radius plus one cell of slack
+	const I32 k = (I32)ceil(radius / m_cellSize) + 1;
+	const vec3i kk(k, k, k);
+	const vec3i lo = m_loCell - kk;
+	const vec3i hi = m_hiCell + kk;
+
+	//clip the ray to the cells around the occupied ones
+	double tEnter = 0.0;
+	double tExit = GetMaxLimit<double>();
+	for(int i=0; i < 3; i++) {
+		double wlo = lo[i] * m_cellSize;
+		double whi = (hi[i] + 1) * m_cellSize;
+		if(dir[i] == 0.0) {
+			if(origin[i] < wlo || origin[i] > whi)
+				return 0;
+			continue;
+		}
+
+		double t0 = (wlo - origin[i]) / dir[i];
+		double t1 = (whi - origin[i]) / dir[i];
+		if(t0 > t1)
+			std::swap(t0, t1);
+		tEnter = std::max(tEnter, t0);
+		tExit = std::min(tExit, t1);
+	}
+
+	if(tEnter > tExit)
+		return 0;
+
+	//walk the cells along the ray. Each step only visits the slab of the
+	//neighborhood that was not covered by the previous cell.
+	vec3i cell = vec3i::minP(vec3i::maxP(cellOf(origin + dir * tEnter), lo), hi);
+	vec3i step;
+	vec3d tMax, tDelta;
+	for(int i=0; i < 3; i++) {
+		step[i] = (dir[i] > 0.0) ? 1 : ((dir[i] < 0.0) ? -1 : 0);
+		if(step[i] == 0) {
+			tMax[i] = GetMaxLimit<double>();
+			tDelta[i] = GetMaxLimit<double>();
+			continue;
+		}
+
+		double boundary = (cell[i] + (step[i] > 0 ? 1 : 0)) * m_cellSize;
+		tMax[i] = (boundary - origin[i]) / dir[i];
+		tDelta[i] = m_cellSize / fabs(dir[i]);
+	}
+
+	gatherBox(cell - kk, cell + kk, outNodes);
+	while(true) {
+		int axis = 0;
+		if(tMax.y < tMax[axis])
+			axis = 1;
+		if(tMax.z < tMax[axis])
+			axis = 2;
+
+		if(tMax[axis] > tExit)
+			break;
+
+		cell[axis] += step[axis];
+		tMax[axis] += tDelta[axis];
+		if(cell[axis] < lo[axis] || cell[axis] > hi[axis])
+			break;
+
+		vec3i slabLo = cell - kk;
+		vec3i slabHi = cell + kk;
+		slabLo[axis] = slabHi[axis] = cell[axis] + step[axis] * k;
+		gatherBox(slabLo, slabHi, outNodes);
+	}
+
+	std::sort(outNodes.begin(), outNodes.end());
+	return outNodes.size();
+}
+
+}
+}
@@ -0,0 +1,100 @@
+/*
+ * NodeGrid.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef NODEGRID_H_
+#define NODEGRID_H_
+
+#include "NodeStore.h"
+#include <vector>
+
+using namespace std;
+
+namespace PS {
+namespace MESH {
+
+/*!
+ * Uniform grid over node positions stored as a spatial hash. The cell size is chosen at
+ * build time for about one node per cell. The owning mesh reports added and moved nodes
+ * which are rebucketed in place. Removals shift the handles so the grid is rebuilt on the
+ * next update, the same as when all nodes move at once.
+ * Queries return the same nodes as a linear scan over the store.
+ */
+class NodeGrid {
+public:
+	NodeGrid();
+	~NodeGrid();
+
+	//drops the grid. The next update rebuilds it.
+	void reset();
+
+	//hooks called by the mesh
+	void nodeAdded(U32 idxNode, const vec3d& p);
+	void nodeMoved(U32 idxNode, const vec3d& p);
+	void nodeRemoved(U32);
+
+	//brings the grid up to date with the store
+	void update(const NodeStore& nodes);
+
+	//true when the grid matches the nodes without rebuilding
+	bool isValid() const { return m_isValid;}
+
+	//queries on an up to date grid
+	/*!
+	 * finds the closest node to the query point. Ties go to the smaller handle.
+	 * @param dist2 squared distance to the closest node
+	 * @return closest node or -1 for an empty store
+	 */
+	int findClosest(const NodeStore& nodes, const vec3d& query, double& dist2) const;
+
+	//collects the nodes within radius of the query point in increasing handle order
+	U32 findInRadius(const NodeStore& nodes, const vec3d& query, double radius, vector<U32>& outNodes) const;
+
+	/*!
+	 * collects the nodes that may lie within radius of the ray origin + t * dir for t >= 0.
+	 * Candidates are a superset of those nodes in increasing handle order.
+	 */
+	U32 findAlongRay(const vec3d& origin, const vec3d& dir, double radius, vector<U32>& outNodes) const;
+
+	//stats
+	double cellSize() const { return m_cellSize;}
+	U32 countBuckets() const { return m_vBuckets.size();}
+
+protected:
+	void build(const NodeStore& nodes);
+
+	vec3i cellOf(const vec3d& p) const;
+	U32 bucketOf(const vec3i& cell) const;
+	void insert(U32 idxNode, const vec3i& cell);
+
+	//appends the nodes stored in a cell
+	void gatherCell(const vec3i& cell, vector<U32>& outNodes) const;
+
+	//visits the cells of [lo, hi] clipped to the occupied cells. With a query point
+	//the cells farther than maxDist2 from it are skipped.
+	void gatherBox(const vec3i& lo, const vec3i& hi, vector<U32>& outNodes,
+				   const vec3d* lpQuery = NULL, double maxDist2 = 0.0) const;
+
+	//squared distance from a point to a cell
+	double cellDistance2(const vec3d& p, const vec3i& cell) const;
+
+private:
+	bool m_isValid;
+	double m_cellSize;
+
+	//bounds of the occupied cells. Grows with the nodes until the next build.
+	vec3i m_loCell;
+	vec3i m_hiCell;
+
+	//cell per node and the nodes per hashed cell
+	vector<vec3i> m_vNodeCells;
+	vector< vector<U32> > m_vBuckets;
+};
+
+}
+}
+
+#endif /* NODEGRID_H_ */
@@ -0,0 +1,213 @@
+/*
+ * NodeStore.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "NodeStore.h"
+#include <string.h>
+
+using namespace PS::MATHSIMD;
+
+//arrays start on a cache line
+#define NODESTORE_PAD	(PS_L1_CACHE_LINE_SIZE / sizeof(double))
+#define NODESTORE_MIN_CAPACITY	64
+
+namespace PS {
+namespace MESH {
+
+NodeStore::NodeStore() {
+	m_count = m_capacity = 0;
+	m_lpBlock = NULL;
+	assignArrays(NULL, 0);
+}
+
+NodeStore::NodeStore(const NodeStore& other) {
+	m_count = m_capacity = 0;
+	m_lpBlock = NULL;
+	assignArrays(NULL, 0);
+	*this = other;
+}
+
+NodeStore::~NodeStore() {
+	FreeAligned(m_lpBlock);
+	m_lpBlock = NULL;
+}
+
+NodeStore& NodeStore::operator = (const NodeStore& other) {
+	if(this == &other)
+		return *this;
+
+	m_count = 0;
+	reserve(other.size());
+	for(int d=0; d < 3; d++) {
+		memcpy(m_lpPos[d], other.m_lpPos[d], other.size() * sizeof(double));
+		memcpy(m_lpRest[d], other.m_lpRest[d], other.size() * sizeof(double));
+	}
+	m_count = other.size();
+	return *this;
+}
+
+void NodeStore::clear() {
+	m_count = 0;
+}
+
+void NodeStore::reserve(U32 ct) {
+	if(ct > m_capacity)
+		grow(ct);
+}
+
+void NodeStore::resize(U32 ct) {
+	reserve(ct);
+	for(int d=0; d < 3; d++) {
+		for(U32 i=m_count; i < ct; i++)
+			m_lpPos[d][i] = m_lpRest[d][i] = 0.0;
+	}
+	m_count = ct;
+}
+
+void NodeStore::push_back(const NODE& n) {
+	if(m_count == m_capacity)
+		grow(m_count + 1);
+	m_count++;
+	set(m_count - 1, n);
+}
+
+void NodeStore::erase(U32 i) {
+	assert(i < m_count);
+
+	U32 ctTail = m_count - i - 1;
+	for(int d=0; d < 3; d++) {
+		memmove(&m_lpPos[d][i], &m_lpPos[d][i + 1], ctTail * sizeof(double));
+		memmove(&m_lpRest[d][i], &m_lpRest[d][i + 1], ctTail * sizeof(double));
+	}
+	m_count--;
+}
+
+void NodeStore::compactByRemap(const vector<U32>& remap, U32 ctAfter) {
+	for(int d=0; d < 3; d++) {
+		double* lpPos = m_lpPos[d];
+		double* lpRest = m_lpRest[d];
+		for(U32 i=0; i < remap.size(); i++) {
+			U32 dst = remap[i];
+			if(dst >= ctAfter || dst == i)
+				continue;
+
+			lpPos[dst] = lpPos[i];
+			lpRest[dst] = lpRest[i];
+		}
+	}
+	m_count = ctAfter;
+}
+
+void NodeStore::permute(const vector<U32>& remap) {
+	assert(remap.size() == m_count);
+
+	vector<double> vTemp(m_count);
+	double* arrays[6] = {m_lpPos[0], m_lpPos[1], m_lpPos[2], m_lpRest[0], m_lpRest[1], m_lpRest[2]};
+	for(int d=0; d < 6; d++) {
+		for(U32 i=0; i < m_count; i++)
+			vTemp[remap[i]] = arrays[d][i];
+		if(m_count > 0)
+			memcpy(arrays[d], vTemp.data(), m_count * sizeof(double));
+	}
+}
+
+void NodeStore::displace(const double* u) {
+	const U32 ctSimd = m_count - (m_count % PS_SIMD_DLEN);
+
+	Double_ ux, uy, uz;
+	for(U32 i=0; i < ctSimd; i += PS_SIMD_DLEN) {
+		SimdLoadVector(&u[i * 3], ux, uy, uz);
+
+		(Double_(&m_lpRest[0][i]) + ux).store(&m_lpPos[0][i]);
+		(Double_(&m_lpRest[1][i]) + uy).store(&m_lpPos[1][i]);
+		(Double_(&m_lpRest[2][i]) + uz).store(&m_lpPos[2][i]);
+	}
+
+	//remainder
+	for(U32 i=ctSimd; i < m_count; i++) {
+		for(int d=0; d < 3; d++)
+			m_lpPos[d][i] = m_lpRest[d][i] + u[i * 3 + d];
+	}
+}
+
+bool NodeStore::bounds(vec3d& lo, vec3d& hi) const {
+	if(m_count == 0)
+		return false;
+
+	double vMin[3], vMax[3];
+	const U32 ctSimd = m_count - (m_count % PS_SIMD_DLEN);
+	for(int d=0; d < 3; d++) {
+		const double* lpPos = m_lpPos[d];
+
+		//lanes start at the first node so that no sentinel values are needed
+		Double_ lanesMin(lpPos[0]);
+		Double_ lanesMax(lpPos[0]);
+		for(U32 i=0; i < ctSimd; i += PS_SIMD_DLEN) {
+			Double_ p(&lpPos[i]);
+			lanesMin = SimdMin(lanesMin, p);
+			lanesMax = SimdMax(lanesMax, p);
+		}
+
+		vMin[d] = SimdhMin(lanesMin);
+		vMax[d] = SimdhMax(lanesMax);
+		for(U32 i=ctSimd; i < m_count; i++) {
+			vMin[d] = MATHMIN(vMin[d], lpPos[i]);
+			vMax[d] = MATHMAX(vMax[d], lpPos[i]);
+		}
+	}
+
+	lo = vec3d(vMin[0], vMin[1], vMin[2]);
+	hi = vec3d(vMax[0], vMax[1], vMax[2]);
+	return true;
+}
+
+void NodeStore::flattenPos(double* lpOutXYZ) const {
+	const U32 ctSimd = m_count - (m_count % PS_SIMD_DLEN);
+	for(U32 i=0; i < ctSimd; i += PS_SIMD_DLEN) {
+		SimdStoreVector(&lpOutXYZ[i * 3],
+						Double_(&m_lpPos[0][i]),
+						Double_(&m_lpPos[1][i]),
+						Double_(&m_lpPos[2][i]));
+	}
+
+	//remainder
+	for(U32 i=ctSimd; i < m_count; i++) {
+		for(int d=0; d < 3; d++)
+			lpOutXYZ[i * 3 + d] = m_lpPos[d][i];
+	}
+}
+
+void NodeStore::grow(U32 ctMin) {
+	U32 capacity = MATHMAX(MATHMAX(ctMin, m_capacity * 2), (U32)NODESTORE_MIN_CAPACITY);
+	capacity = (capacity + NODESTORE_PAD - 1) & ~(NODESTORE_PAD - 1);
+
+	double* lpBlock = AllocAligned<double>(capacity * 6);
+	double* lpOldPos[3] = {m_lpPos[0], m_lpPos[1], m_lpPos[2]};
+	double* lpOldRest[3] = {m_lpRest[0], m_lpRest[1], m_lpRest[2]};
+	double* lpOldBlock = m_lpBlock;
+
+	assignArrays(lpBlock, capacity);
+	for(int d=0; d < 3; d++) {
+		if(m_count > 0) {
+			memcpy(m_lpPos[d], lpOldPos[d], m_count * sizeof(double));
+			memcpy(m_lpRest[d], lpOldRest[d], m_count * sizeof(double));
+		}
+	}
+
+	FreeAligned(lpOldBlock);
+}
+
+void NodeStore::assignArrays(double* lpBlock, U32 capacity) {
+	m_lpBlock = lpBlock;
+	m_capacity = capacity;
+	for(int d=0; d < 3; d++) {
+		m_lpPos[d] = lpBlock ? &lpBlock[d * capacity] : NULL;
+		m_lpRest[d] = lpBlock ? &lpBlock[(d + 3) * capacity] : NULL;
+	}
+}
+
+}
+}
@@ -0,0 +1,110 @@
+/*
+ * NodeStore.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef NODESTORE_H_
+#define NODESTORE_H_
+
+#include "base/SIMDVecN.h"
+#include "VolMeshEntities.h"
+
+namespace PS {
+namespace MESH {
+
+/*!
+ * Structure of arrays storage for mesh nodes. Current and rest positions are kept
+ * as six separate coordinate arrays, each starting on a cache line, so the bulk
+ * kernels below stream through them with aligned SIMD loads and stores.
+ */
+class NodeStore {
+public:
+	NodeStore();
+	NodeStore(const NodeStore& other);
+	~NodeStore();
+
+	NodeStore& operator = (const NodeStore& other);
+
+	//number of nodes
+	U32 size() const { return m_count;}
+	U32 capacity() const { return m_capacity;}
+
+	void clear();
+	void reserve(U32 ct);
+
+	//grows or shrinks the node count. New nodes are at the origin.
+	void resize(U32 ct);
+
+	void push_back(const NODE& n);
+
+	//erases node i. All following nodes shift down by one.
+	void erase(U32 i);
+
+	//keeps node i only if remap[i] is valid and moves it to remap[i]. Remap is increasing.
+	void compactByRemap(const vector<U32>& remap, U32 ctAfter);
+
+	//moves node i to remap[i]. Remap is a permutation of all nodes.
+	void permute(const vector<U32>& remap);
+
+	//element access
+	NODE get(U32 i) const {
+		NODE n;
+		n.pos = pos(i);
+		n.restpos = restpos(i);
+		return n;
+	}
+
+	void set(U32 i, const NODE& n) {
+		setPos(i, n.pos);
+		setRestPos(i, n.restpos);
+	}
+
+	vec3d pos(U32 i) const { return vec3d(m_lpPos[0][i], m_lpPos[1][i], m_lpPos[2][i]);}
+	vec3d restpos(U32 i) const { return vec3d(m_lpRest[0][i], m_lpRest[1][i], m_lpRest[2][i]);}
+
+	void setPos(U32 i, const vec3d& p) {
+		m_lpPos[0][i] = p.x;
+		m_lpPos[1][i] = p.y;
+		m_lpPos[2][i] = p.z;
+	}
+
+	void setRestPos(U32 i, const vec3d& p) {
+		m_lpRest[0][i] = p.x;
+		m_lpRest[1][i] = p.y;
+		m_lpRest[2][i] = p.z;
+	}
+
+	//coordinate arrays: dim 0, 1, 2 for x, y, z
+	const double* posArray(int dim) const { return m_lpPos[dim];}
+	const double* restposArray(int dim) const { return m_lpRest[dim];}
+
+	//SIMD kernels
+	//pos = restpos + u where u is interleaved xyz per node
+	void displace(const double* u);
+
+	//bounds of the current positions. Returns false for an empty store.
+	bool bounds(vec3d& lo, vec3d& hi) const;
+
+	//writes the current positions interleaved as xyz per node
+	void flattenPos(double* lpOutXYZ) const;
+
+private:
+	void grow(U32 ctMin);
+	void assignArrays(double* lpBlock, U32 capacity);
+
+private:
+	U32 m_count;
+	U32 m_capacity;
+
+	//one aligned block holding all six arrays
+	double* m_lpBlock;
+	double* m_lpPos[3];
+	double* m_lpRest[3];
+};
+
+}
+}
+
+#endif /* NODESTORE_H_ */
@@ -7,6 +7,8 @@
 #include "TetSubdivider.h"
 #include "base/Logger.h"
 #include <set>
+#include <fstream>
+#include <algorithm>
 
 using namespace PS;
 using namespace std;
@@ -44,21 +46,38 @@ U32 g_elementTableCaseB[3][6][4] = {
 		{ {4, 10, 12, 0}, {0, 8, 12, 4}, {0, 8, 1, 4}, {3, 9, 13, 5}, {2, 5, 11, 3}, {3, 13, 5, 11}}
 };
 
+//cut edge codes of the hand-written table entries
+static const U8 g_cutEdgeCodesCaseA[4] = {56, 37, 11, 22};
+static const U8 g_cutEdgeCodesCaseB[3] = {46, 51, 29};
+
+//edge i runs from node subedges[i][0] to node subedges[i][3]. Virtual node subedges[i][1]
+//is the mid node copy attached to the start node and subedges[i][2] the one attached to the end.
+static const int g_subedges[6][4] = { {1, 4, 5, 2}, {2, 6, 7, 3}, {3, 9, 8, 1},
+									  {2, 11, 10, 0}, {3, 13, 12, 0}, {0, 14, 15, 1} };
+
+//set bits per nibble
+static const U8 g_bitCount[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+#include "TetSubdividerTable.h"
+
 }
 }
 
-TetSubdivider::TetSubdivider() {
+//tet of the bisection over original nodes (0-3) and edge mid points (4 + edge)
+struct BisectedTet {
+	U8 v[4];
 
-	//case A
-	m_mapCutEdgeCodeToTableEntry[56] = 0;
-	m_mapCutEdgeCodeToTableEntry[37] = 1;
-	m_mapCutEdgeCodeToTableEntry[11] = 2;
-	m_mapCutEdgeCodeToTableEntry[22] = 3;
+	//bit i is set when the tet is on the end node half of edge i
+	U8 halves;
+};
 
-	//case B
-	m_mapCutEdgeCodeToTableEntry[46] = 0;
-	m_mapCutEdgeCodeToTableEntry[51] = 1;
-	m_mapCutEdgeCodeToTableEntry[29] = 2;
+static int FindSide(int sides[4], int x) {
+	while(sides[x] != x)
+		x = sides[x];
+	return x;
+}
+
+TetSubdivider::TetSubdivider() {
 
 	//map cutcase to alphabet
 	m_mapCutCaseToAlpha[cutA] = 'A';
@@ -110,7 +129,7 @@ int TetSubdivider::generateCaseA(VolMesh* pmesh, U32 idxCell, U8 node, double ta
 		if(edge.from == node || edge.to == node) {
 			cutEdgeCode |= (1 << i);
 
-			double dist = vec3d::distance(pmesh->const_nodeAt(edge.from).pos, pmesh->const_nodeAt(edge.to).pos);
+			double dist = vec3d::distance(pmesh->nodePos(edge.from), pmesh->nodePos(edge.to));
 
 			if(edge.from == node)
 				tEdges[i] = targetDistPercentage * dist;
@@ -125,7 +144,7 @@ int TetSubdivider::generateCaseA(VolMesh* pmesh, U32 idxCell, U8 node, double ta
 			middlePoints[ i * 2 + 1 ] = idxNP1;
 
 			//swept surf
-			sweptSurf[res] = pmesh->const_nodeAt(idxNP0).pos;
+			sweptSurf[res] = pmesh->nodePos(idxNP0);
 			res++;
 		}
 	}
@@ -194,7 +213,7 @@ int TetSubdivider::generateCaseB(VolMesh* pmesh, U32 idxCell, U8 enteringface,
 		middlePoints[ edges[i] * 2 + 1 ] = idxNP1;
 
 		//swept surf
-		sweptSurf[i] = pmesh->const_nodeAt(idxNP0).pos;
+		sweptSurf[i] = pmesh->nodePos(idxNP0);
 	}
 
 
@@ -206,6 +225,15 @@ char TetSubdivider::toAlpha(CUTCASE c) {
 	return m_mapCutCaseToAlpha[c];
 }
 
+bool TetSubdivider::canSubdivide(U8 cutEdgeCode, U8 cutNodeCode) const {
+	return (cutEdgeCode < 64) && (cutNodeCode < 16);
+}
+
+bool TetSubdivider::isCutComplete(U8 cutEdgeCode, U8 cutNodeCode) const {
+	U8 cutcase = g_cutCaseTable[PackCutCode(cutEdgeCode, cutNodeCode)].cutcase;
+	return cutcase == cutA || cutcase == cutB || cutcase == cutX || cutcase == cutY || cutcase == cutZ;
+}
+
 TetSubdivider::CUTCASE TetSubdivider::IdentifyCutCase(bool isCutComplete, U8 cutEdgeCode, U8 cutNodeCode) {
 	U8 countCutEdges = 0;
 	U8 countCutNodes = 0;
@@ -214,16 +242,9 @@ TetSubdivider::CUTCASE TetSubdivider::IdentifyCutCase(bool isCutComplete, U8 cut
 
 TetSubdivider::CUTCASE TetSubdivider::IdentifyCutCase(bool isCutComplete, U8 cutEdgeCode,
 													  U8 cutNodeCode, U8& countCutEdges, U8& countCutNodes) {
-	countCutEdges = 0;
-
-	//6 edges per tet
-	for(int i=0; i < 6; i++)
-		countCutEdges += ((cutEdgeCode & (1 << i)) != 0);
-
-	countCutNodes = 0;
-	//4 nodes per tet
-	for(int i=0; i < 4; i++)
-		countCutNodes += ((cutNodeCode & (1 << i)) != 0);
+	//6 edges and 4 nodes per tet
+	countCutEdges = g_bitCount[cutEdgeCode & 0x0F] + g_bitCount[(cutEdgeCode >> 4) & 0x03];
+	countCutNodes = g_bitCount[cutNodeCode & 0x0F];
 
 	if(countCutNodes == 0) {
 		if(isCutComplete) {
@@ -253,25 +274,201 @@ TetSubdivider::CUTCASE TetSubdivider::IdentifyCutCase(bool isCutComplete, U8 cut
 	return cutUnknown;
 }
 
+TetSubdivider::CUTCASE TetSubdivider::generateCutCase(U8 cutEdgeCode, U8 cutNodeCode, vector<U8>& tets) {
+	tets.resize(0);
+	cutEdgeCode &= 0x3F;
+	cutNodeCode &= 0x0F;
+
+	//a node on a cut edge goes with the edge halves
+	for(int i=0; i < COUNT_CELL_EDGES; i++) {
+		if(cutEdgeCode & (1 << i))
+			cutNodeCode &= ~((1 << g_subedges[i][0]) | (1 << g_subedges[i][3]));
+	}
+
+	//a side is the set of nodes joined by uncut edges. Cut nodes lie on the cut and join nothing.
+	int sides[4] = {0, 1, 2, 3};
+	for(int i=0; i < COUNT_CELL_EDGES; i++) {
+		int from = g_subedges[i][0];
+		int to = g_subedges[i][3];
+		if((cutEdgeCode & (1 << i)) || (cutNodeCode & ((1 << from) | (1 << to))))
+			continue;
+
+		int sfrom = FindSide(sides, from);
+		int sto = FindSide(sides, to);
+		sides[std::max(sfrom, sto)] = std::min(sfrom, sto);
+	}
+
+	//complete when every cut edge separates two sides
+	bool isComplete = (cutEdgeCode != 0) || (g_bitCount[cutNodeCode] == 3);
+	for(int i=0; i < COUNT_CELL_EDGES; i++) {
+		if((cutEdgeCode & (1 << i)) && FindSide(sides, g_subedges[i][0]) == FindSide(sides, g_subedges[i][3]))
+			isComplete = false;
+	}
+
+	CUTCASE cutcase = IdentifyCutCase(isComplete, cutEdgeCode, cutNodeCode);
+
+	//nothing to split
+	if(cutEdgeCode == 0)
+		return cutcase;
+
+	//hand-written entries
+	if(cutcase == cutA) {
+		for(int entry = 0; entry < 4; entry++) {
+			if(g_cutEdgeCodesCaseA[entry] == cutEdgeCode)
+				tets.insert(tets.end(), &g_elementTableCaseA[entry][0], &g_elementTableCaseA[entry][0] + 16);
+		}
+		return cutcase;
+	}
+	else if(cutcase == cutB) {
+		for(int entry = 0; entry < 3; entry++) {
+			if(g_cutEdgeCodesCaseB[entry] == cutEdgeCode)
+				tets.insert(tets.end(), &g_elementTableCaseB[entry][0][0], &g_elementTableCaseB[entry][0][0] + 24);
+		}
+		return cutcase;
+	}
+
+	//bisect every tet holding a whole cut edge at the mid point of that edge
+	vector<BisectedTet> vTets(1);
+	for(int i=0; i < 4; i++)
+		vTets[0].v[i] = i;
+	vTets[0].halves = 0;
+
+	for(int i=0; i < COUNT_CELL_EDGES; i++) {
+		if((cutEdgeCode & (1 << i)) == 0)
+			continue;
+
+		U32 ctTets = vTets.size();
+		for(U32 j=0; j < ctTets; j++) {
+			int from = -1;
+			int to = -1;
+			for(int k=0; k < 4; k++) {
+				if(vTets[j].v[k] == g_subedges[i][0])
+					from = k;
+				else if(vTets[j].v[k] == g_subedges[i][3])
+					to = k;
+			}
+
+			if(from < 0 || to < 0)
+				continue;
+
+			BisectedTet half = vTets[j];
+			half.v[from] = 4 + i;
+			half.halves |= (1 << i);
+			vTets[j].v[to] = 4 + i;
+			vTets.push_back(half);
+		}
+	}
+
+	//a tet holds the nodes of one side only, otherwise it would still hold a cut edge.
+	//It takes the mid node copies on that side. Copies of edges within a side or away
+	//from it are taken from the half the tet was bisected into.
+	for(U32 j=0; j < vTets.size(); j++) {
+		int side = -1;
+		for(int k=0; k < 4; k++) {
+			if(vTets[j].v[k] < 4 && (cutNodeCode & (1 << vTets[j].v[k])) == 0)
+				side = FindSide(sides, vTets[j].v[k]);
+		}
+
+		for(int k=0; k < 4; k++) {
+			U8 v = vTets[j].v[k];
+			if(v < 4) {
+				tets.push_back(v);
+				continue;
+			}
+
+			int e = v - 4;
+			bool isFromSide = (side >= 0) && (FindSide(sides, g_subedges[e][0]) == side);
+			bool isToSide = (side >= 0) && (FindSide(sides, g_subedges[e][3]) == side);
+			int half = (vTets[j].halves >> e) & 1;
+			if(isFromSide != isToSide)
+				half = isToSide ? 1 : 0;
+
+			tets.push_back(g_subedges[e][1 + half]);
+		}
+	}
+
+	return cutcase;
+}
+
+bool TetSubdivider::writeLookUpTable(const AnsiStr& strPath) {
+	ofstream fpOut(strPath.cptr());
+	if(!fpOut.is_open()) {
+		LogErrorArg1("Unable to open %s for writing.", strPath.cptr());
+		return false;
+	}
+
+	//codes with the same subdivision share their tets
+	vector<CutCaseEntry> vEntries(COUNT_CUT_CODES);
+	vector<U8> vAllTets;
+	std::map<vector<U8>, U16> mapFirstTet;
+	for(U32 code = 0; code < COUNT_CUT_CODES; code++) {
+		vector<U8> tets;
+		CUTCASE cutcase = generateCutCase(code & 0x3F, code >> 6, tets);
+
+		std::map<vector<U8>, U16>::const_iterator it = mapFirstTet.find(tets);
+		if(it == mapFirstTet.end()) {
+			it = mapFirstTet.insert(std::make_pair(tets, (U16)(vAllTets.size() / 4))).first;
+			vAllTets.insert(vAllTets.end(), tets.begin(), tets.end());
+		}
+
+		vEntries[code].first = it->second;
+		vEntries[code].count = tets.size() / 4;
+		vEntries[code].cutcase = cutcase;
+	}
+
+	fpOut << "/*\n";
+	fpOut << " * TetSubdividerTable.h\n";
+	fpOut << " *\n";
+	fpOut << " *  Generated by TetSubdivider::writeLookUpTable. Do not edit.\n";
+	fpOut << " */\n\n";
+	fpOut << "#ifndef TETSUBDIVIDERTABLE_H_\n";
+	fpOut << "#define TETSUBDIVIDERTABLE_H_\n\n";
+
+	//tets as virtual node indices
+	fpOut << "const U8 g_cutCaseTets[" << vAllTets.size() / 4 << "][4] = {\n";
+	for(U32 i = 0; i < vAllTets.size(); i += 4) {
+		if((i / 4) % 8 == 0)
+			fpOut << "\t\t";
+		fpOut << "{" << (int)vAllTets[i] << ", " << (int)vAllTets[i + 1] << ", "
+			  << (int)vAllTets[i + 2] << ", " << (int)vAllTets[i + 3] << "}";
+		if(i + 4 < vAllTets.size())
+			fpOut << ((i / 4) % 8 == 7 ? ",\n" : ", ");
+	}
+	fpOut << "\n};\n\n";
+
+	//one row per cut node code
+	fpOut << "//{first tet, tets count, cut case} per packed cut code\n";
+	fpOut << "const CutCaseEntry g_cutCaseTable[COUNT_CUT_CODES] = {\n";
+	for(U32 code = 0; code < COUNT_CUT_CODES; code++) {
+		if(code % 64 == 0)
+			fpOut << "\t\t//cut node code " << code / 64 << "\n";
+		if(code % 8 == 0)
+			fpOut << "\t\t";
+		fpOut << "{" << vEntries[code].first << ", " << (int)vEntries[code].count << ", "
+			  << (int)vEntries[code].cutcase << "}";
+		if(code + 1 < COUNT_CUT_CODES)
+			fpOut << (code % 8 == 7 ? ",\n" : ", ");
+	}
+	fpOut << "\n};\n\n";
+	fpOut << "#endif /* TETSUBDIVIDERTABLE_H_ */\n";
+	fpOut.close();
+
+	LogInfoArg2("Wrote %u tets for %u cut codes.", (U32)(vAllTets.size() / 4), COUNT_CUT_CODES);
+	return true;
+}
+
 int TetSubdivider::subdivide(VolMesh* pmesh, U32 idxCell,
 							 U8 cutEdgeCode, U8 cutNodeCode,
 							 U32 midNodes[12]) {
-	//Here an element is subdivided to 4 sub elements depending on the codes
-	U8 ctCutEdges = 0;
-	U8 ctCutNodes = 0;
-
-	TetSubdivider::CUTCASE cutcase = IdentifyCutCase(true, cutEdgeCode, cutNodeCode, ctCutEdges, ctCutNodes);
-	if(cutcase > cutB) {
-		LogErrorArg3("This case is not handled yet! cutEdgeCode = %u, ctCutEdges = %u, ctCutNodes = %u",
-					 cutEdgeCode, ctCutEdges, ctCutNodes);
+	//Here an element is subdivided to the sub elements of its table entry
+	const CutCaseEntry& entry = g_cutCaseTable[PackCutCode(cutEdgeCode, cutNodeCode)];
+	if(entry.count == 0)
 		return 0;
-	}
 
 	//report
-	printf("Cell: %u, Cut type %c:%d, cutEdgeCode: %u, cutNodeCode: %u\n",
-			idxCell, m_mapCutCaseToAlpha[cutcase],
-			m_mapCutEdgeCodeToTableEntry[cutEdgeCode],
-			cutEdgeCode, cutNodeCode);
+	psLog(EventLogger::etInfo, __FILE__, __LINE__, "Cell: %u, Cut type %c:%d, cutEdgeCode: %u, cutNodeCode: %u",
+			idxCell, m_mapCutCaseToAlpha[(CUTCASE)entry.cutcase],
+			entry.count, cutEdgeCode, cutNodeCode);
 
 
 	//fill the array of virtual nodes
@@ -284,120 +481,57 @@ int TetSubdivider::subdivide(VolMesh* pmesh, U32 idxCell,
 	for(int i=0; i<4; i++)
 		vnodes[i] = cell.nodes[i];
 
-	//Mask to map edges indices to new generated node indices
-	const int mapEdgeToMiddleNodes[12] = {4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
-
 	//cell edges
-	if(ctCutEdges > 0) {
-		for(int i=0; i < 6; i++) {
-			bool isCut = ((cutEdgeCode & (1 << i)) != 0);
-			if(isCut) {
-				//generated nodes
-				vnodes[ mapEdgeToMiddleNodes[i*2 + 0] ] = midNodes[i * 2 + 0];
-				vnodes[ mapEdgeToMiddleNodes[i*2 + 1] ] = midNodes[i * 2 + 1];
-			}
+	for(int i=0; i < 6; i++) {
+		bool isCut = ((cutEdgeCode & (1 << i)) != 0);
+		if(isCut) {
+			//generated nodes
+			vnodes[ 4 + i * 2 ] = midNodes[i * 2 + 0];
+			vnodes[ 4 + i * 2 + 1 ] = midNodes[i * 2 + 1];
 		}
 	}
 
 	//check canonical connection of middle nodes wrt original nodes
-	const int subedges[6][4] = { {1, 4, 5, 2}, {2, 6, 7, 3}, {3, 9, 8, 1},
-								 {2, 11, 10, 0}, {3, 13, 12, 0}, {0, 14, 15, 1} };
-
-	if(ctCutEdges > 0) {
-
-		bool res = true;
-		int revised = 0;
-		for(int i=0; i < 6; i++) {
-			bool isCut = ((cutEdgeCode & (1 << i)) != 0);
-			if(isCut) {
-				vec3d n0 = pmesh->const_nodeAt(vnodes [subedges[i][0]]).pos;
-				vec3d n1 = pmesh->const_nodeAt(vnodes [subedges[i][1]]).pos;
-				vec3d n2 = pmesh->const_nodeAt(vnodes [subedges[i][2]]).pos;
-				vec3d n3 = pmesh->const_nodeAt(vnodes [subedges[i][3]]).pos;
-				assert(vec3d::distance(n1, n2) < EPSILON);
-
-//				float deg = vec3d::angleDeg(n1 - n0, n3 - n1);
-//				assert(deg < EPSILON);
-
-				//edge0
-				bool r1 = pmesh->edge_exists(vnodes[ subedges[i][0] ], vnodes[ subedges[i][1] ]);
-				bool r2 = pmesh->edge_exists(vnodes[ subedges[i][2] ], vnodes[ subedges[i][3] ]);
-				if(!r1 || !r2) {
-					r1 = pmesh->edge_exists(vnodes[ subedges[i][0] ], vnodes[ subedges[i][2] ]);
-					r2 = pmesh->edge_exists(vnodes[ subedges[i][1] ], vnodes[ subedges[i][3] ]);
-
-					std::swap(vnodes[ subedges[i][1] ], vnodes[ subedges[i][2] ]);
-					revised++;
-				}
-
-				res &= r1;
-				res &= r2;
+	bool res = true;
+	for(int i=0; i < 6; i++) {
+		bool isCut = ((cutEdgeCode & (1 << i)) != 0);
+		if(isCut) {
+			vec3d n1 = pmesh->nodePos(vnodes [g_subedges[i][1]]);
+			vec3d n2 = pmesh->nodePos(vnodes [g_subedges[i][2]]);
+			assert(vec3d::distance(n1, n2) < EPSILON);
+
+			//edge0
+			bool r1 = pmesh->edge_exists(vnodes[ g_subedges[i][0] ], vnodes[ g_subedges[i][1] ]);
+			bool r2 = pmesh->edge_exists(vnodes[ g_subedges[i][2] ], vnodes[ g_subedges[i][3] ]);
+			if(!r1 || !r2) {
+				r1 = pmesh->edge_exists(vnodes[ g_subedges[i][0] ], vnodes[ g_subedges[i][2] ]);
+				r2 = pmesh->edge_exists(vnodes[ g_subedges[i][1] ], vnodes[ g_subedges[i][3] ]);
+
+				std::swap(vnodes[ g_subedges[i][1] ], vnodes[ g_subedges[i][2] ]);
 			}
-		}
 
-		if(res == false) {
-			cerr << "ERROR SUBDIVIDE: some of the subedges do not exist!" << endl;
-			assert(res);
+			res &= r1;
+			res &= r2;
 		}
 	}
 
-
-	//Case A: 3 cut edges. cutEdgeCodes = { 11, 22, 37, 56 }
-	if(cutcase == cutA) {
-		//Remove the original element
-		pmesh->schedule_remove_cell(idxCell);
-
-		//find the local table entry to handle this case A
-		int entry = m_mapCutEdgeCodeToTableEntry[cutEdgeCode];
-
-
-		//generate 4 new tets
-		for(int e = 0; e < 4; e++) {
-			U32 n[4];
-
-			for(int i = 0; i < 4; i++)
-				n[i] = vnodes[ g_elementTableCaseA[entry][e * 4 + i] ];
-
-			if(!pmesh->insert_cell(n)) {
-				LogErrorArg1("Failed to add element# %d", e);
-			}
-		}
+	if(res == false) {
+		cerr << "ERROR SUBDIVIDE: some of the subedges do not exist!" << endl;
+		assert(res);
 	}
-	//Case B: 4 cut edges. cutEdgeCodes = { 46, 51, 29 }
-	else if(cutcase == cutB) {
-		//Remove the original element
-		pmesh->schedule_remove_cell(idxCell);
 
-		//find the local table entry to handle this case B
-		int entry = m_mapCutEdgeCodeToTableEntry[cutEdgeCode];
+	//Remove the original element
+	pmesh->schedule_remove_cell(idxCell);
 
-		//generate 6 new tets
-		for(int e = 0; e < 6; e++) {
-
-			U32 n[4];
-			for(int i = 0; i < 4; i++)
-				n[i] = vnodes[ g_elementTableCaseB[entry][e][i] ];
-
-			if(!pmesh->insert_cell(n)) {
-				LogErrorArg1("Failed to add element# %d", e);
-			}
+	//generate the new tets
+	const U8 (*tets)[4] = &g_cutCaseTets[entry.first];
+	for(int e = 0; e < entry.count; e++) {
+		U32 n[4] = {vnodes[tets[e][0]], vnodes[tets[e][1]], vnodes[tets[e][2]], vnodes[tets[e][3]]};
+		if(!pmesh->insert_cell(n)) {
+			LogErrorArg1("Failed to add element# %d", e);
 		}
 	}
 
-	//Case X: 2 cut edges and 1 cut node
-//	else if(ctCutEdges == 2 && ctCutNodes == 1) {
-//
-//	}
-//	case Y
-//	else if(ctCutEdges == 1 && ctCutNodes == 2) {
-//
-//	}
-//	case Z
-//	else if(ctCutEdges == 0 && ctCutNodes == 3) {
-//
-//	}
-
-
 	return 1;
 }
 
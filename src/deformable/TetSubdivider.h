@@ -19,7 +19,28 @@ extern U32 g_elementTableCaseA[4][16];
 //case B
 extern U32 g_elementTableCaseB[3][6][4];
 
+//cut codes are packed as edge code in the low 6 bits and node code in the high 4 bits
+#define COUNT_CUT_CODES 1024
 
+//subdivision of a cell for one packed cut code
+struct CutCaseEntry {
+	//first tet in g_cutCaseTets
+	U16 first;
+
+	//tets replacing the cell. zero leaves the cell as is.
+	U8 count;
+
+	//TetSubdivider::CUTCASE
+	U8 cutcase;
+};
+
+//generated tables for all packed cut codes. See TetSubdividerTable.h
+extern const CutCaseEntry g_cutCaseTable[COUNT_CUT_CODES];
+extern const U8 g_cutCaseTets[][4];
+
+inline U32 PackCutCode(U8 cutEdgeCode, U8 cutNodeCode) {
+	return ((U32)(cutNodeCode & 0x0F) << 6) | (cutEdgeCode & 0x3F);
+}
 
 class TetSubdivider : public SGNode {
 public:
@@ -35,6 +56,12 @@ public:
 	static CUTCASE IdentifyCutCase(bool isCutComplete, U8 cutEdgeCode, U8 cutNodeCode);
 	static CUTCASE IdentifyCutCase(bool isCutComplete, U8 cutEdgeCode, U8 cutNodeCode, U8& countCutEdges, U8& countCutNodes);
 
+	//true when the codes have a subdivision table entry
+	bool canSubdivide(U8 cutEdgeCode, U8 cutNodeCode) const;
+
+	//true when the cut separates the cell into two sides
+	bool isCutComplete(U8 cutEdgeCode, U8 cutNodeCode) const;
+
 	int subdivide(VolMesh* pmesh,
 				  U32 idxCell, U8 cutEdgeCode,
 				  U8 cutNodeCode, U32 midNodes[12]);
@@ -64,11 +91,18 @@ public:
 					  U8& cutNodeCode);
 
 
-	bool writeLookUpTable();
-protected:
+	/*!
+	 * \brief generates the subdivision of a cell for one pair of cut codes. Cut edges are
+	 * bisected in order and every resulting tet takes the mid node copies of the side it
+	 * lies on. Cases A and B use their hand-written tables.
+	 * @tets: output virtual node indices, 4 per tet
+	 * @return the cut case of the codes
+	 */
+	static CUTCASE generateCutCase(U8 cutEdgeCode, U8 cutNodeCode, vector<U8>& tets);
 
-	//cut edge code
-	std::map<U8, int> m_mapCutEdgeCodeToTableEntry;
+	//writes the tables for all packed cut codes as a header. See TetSubdividerTable.h
+	static bool writeLookUpTable(const AnsiStr& strPath);
+protected:
 
 	//cut cases
 	std::map<TetSubdivider::CUTCASE, char> m_mapCutCaseToAlpha;
@@ -0,0 +1,201 @@
+/*
+ * TetSubdividerTable.h
+ *
+ *  Generated by TetSubdivider::writeLookUpTable. Do not edit.
+ */
+
+#ifndef TETSUBDIVIDERTABLE_H_
+#define TETSUBDIVIDERTABLE_H_
+
+const U8 g_cutCaseTets[319][4] = {
+		{0, 1, 4, 3}, {0, 5, 2, 3}, {0, 1, 2, 6}, {0, 1, 7, 3}, {0, 1, 4, 3}, {0, 5, 2, 6}, {0, 5, 7, 3}, {0, 9, 2, 3},
+		{0, 1, 2, 8}, {0, 9, 4, 3}, {0, 5, 2, 3}, {0, 1, 4, 8}, {0, 1, 2, 6}, {0, 9, 7, 3}, {0, 1, 7, 8}, {0, 9, 4, 3},
+		{0, 5, 2, 6}, {0, 5, 7, 3}, {0, 1, 4, 8}, {11, 1, 2, 3}, {0, 1, 10, 3}, {0, 1, 4, 3}, {11, 5, 2, 3}, {0, 5, 10, 3},
+		{11, 1, 2, 6}, {0, 1, 7, 3}, {0, 1, 10, 6}, {2, 5, 6, 11}, {3, 7, 10, 4}, {3, 1, 4, 10}, {0, 1, 3, 10}, {11, 9, 2, 3},
+		{11, 1, 2, 8}, {0, 9, 10, 3}, {0, 1, 10, 8}, {0, 9, 4, 3}, {11, 5, 2, 3}, {0, 1, 4, 8}, {0, 5, 10, 3}, {11, 1, 2, 6},
+		{0, 9, 7, 3}, {0, 1, 7, 8}, {0, 1, 10, 6}, {0, 9, 4, 3}, {11, 5, 2, 6}, {0, 4, 7, 3}, {0, 1, 4, 8}, {0, 4, 10, 7},
+		{13, 1, 2, 3}, {0, 1, 2, 12}, {13, 1, 4, 3}, {13, 5, 2, 3}, {0, 1, 4, 12}, {0, 5, 2, 12}, {0, 1, 2, 6}, {13, 1, 7, 3},
+		{0, 1, 7, 12}, {13, 1, 4, 3}, {0, 5, 2, 6}, {13, 5, 7, 3}, {0, 1, 4, 12}, {0, 5, 7, 12}, {13, 9, 2, 3}, {0, 1, 2, 8},
+		{0, 9, 2, 12}, {13, 9, 4, 3}, {13, 5, 2, 3}, {0, 1, 4, 8}, {0, 9, 4, 12}, {0, 5, 2, 12}, {3, 13, 9, 7}, {1, 8, 12, 6},
+		{1, 2, 12, 6}, {0, 1, 2, 12}, {13, 9, 4, 3}, {0, 5, 2, 6}, {13, 5, 7, 3}, {0, 1, 4, 8}, {0, 8, 4, 12}, {0, 5, 6, 12},
+		{11, 1, 2, 3}, {13, 1, 10, 3}, {0, 1, 10, 12}, {13, 1, 4, 3}, {11, 5, 2, 3}, {13, 5, 10, 3}, {0, 1, 4, 12}, {0, 5, 10, 12},
+		{11, 1, 2, 6}, {13, 1, 7, 3}, {0, 1, 10, 6}, {0, 1, 7, 12}, {13, 1, 4, 3}, {11, 5, 2, 6}, {13, 4, 7, 3}, {0, 4, 10, 7},
+		{0, 1, 4, 12}, {0, 4, 7, 12}, {11, 9, 2, 3}, {11, 1, 2, 8}, {13, 9, 10, 3}, {0, 1, 10, 8}, {0, 9, 10, 12}, {4, 10, 12, 0},
+		{0, 8, 12, 4}, {0, 8, 1, 4}, {3, 9, 13, 5}, {2, 5, 11, 3}, {3, 13, 5, 11}, {11, 1, 2, 6}, {13, 9, 7, 3}, {0, 1, 6, 8},
+		{0, 1, 10, 6}, {0, 8, 6, 12}, {13, 9, 4, 3}, {11, 5, 2, 6}, {13, 5, 7, 3}, {0, 1, 4, 8}, {0, 4, 10, 6}, {0, 8, 4, 12},
+		{0, 4, 7, 12}, {0, 14, 2, 3}, {15, 1, 2, 3}, {0, 14, 4, 3}, {0, 5, 2, 3}, {15, 1, 4, 3}, {0, 14, 2, 6}, {0, 14, 7, 3},
+		{15, 1, 2, 6}, {15, 1, 7, 3}, {0, 14, 4, 3}, {0, 5, 2, 6}, {0, 5, 7, 3}, {15, 1, 4, 3}, {0, 9, 2, 3}, {0, 14, 2, 8},
+		{15, 1, 2, 8}, {1, 4, 8, 15}, {3, 9, 5, 14}, {0, 3, 14, 5}, {0, 2, 3, 5}, {0, 14, 2, 6}, {0, 9, 7, 3}, {0, 14, 7, 8},
+		{15, 1, 2, 6}, {15, 1, 7, 8}, {0, 9, 5, 3}, {0, 5, 2, 6}, {0, 5, 7, 3}, {0, 14, 5, 9}, {15, 1, 4, 8}, {11, 1, 2, 3},
+		{0, 14, 10, 3}, {15, 1, 10, 3}, {0, 14, 4, 3}, {11, 5, 2, 3}, {0, 5, 10, 3}, {15, 1, 4, 3}, {11, 1, 2, 6}, {0, 14, 7, 3},
+		{0, 14, 10, 6}, {15, 1, 7, 3}, {15, 1, 10, 6}, {0, 14, 4, 3}, {11, 5, 2, 6}, {0, 4, 7, 3}, {0, 4, 10, 7}, {15, 1, 4, 3},
+		{11, 9, 2, 3}, {11, 1, 2, 8}, {0, 9, 10, 3}, {0, 14, 10, 8}, {15, 1, 10, 8}, {0, 9, 5, 3}, {11, 5, 2, 3}, {0, 14, 5, 9},
+		{0, 5, 10, 3}, {15, 1, 4, 8}, {2, 6, 11, 1}, {8, 11, 15, 1}, {6, 11, 8, 1}, {3, 7, 9, 10}, {3, 10, 0, 9}, {0, 14, 10, 9},
+		{0, 9, 4, 3}, {11, 5, 2, 6}, {0, 5, 7, 3}, {0, 14, 4, 9}, {0, 5, 10, 7}, {15, 1, 4, 8}, {13, 1, 2, 3}, {0, 14, 2, 12},
+		{15, 1, 2, 12}, {13, 1, 4, 3}, {13, 5, 2, 3}, {0, 14, 4, 12}, {0, 5, 2, 12}, {15, 1, 4, 12}, {0, 14, 2, 6}, {13, 1, 7, 3},
+		{0, 14, 7, 12}, {15, 1, 2, 6}, {15, 1, 7, 12}, {3, 7, 13, 15}, {15, 1, 4, 7}, {15, 1, 3, 7}, {0, 12, 14, 6}, {2, 5, 6, 14},
+		{0, 14, 6, 2}, {13, 9, 2, 3}, {0, 14, 2, 8}, {0, 9, 2, 12}, {15, 1, 2, 8}, {13, 9, 5, 3}, {13, 5, 2, 3}, {0, 14, 5, 9},
+		{0, 9, 5, 12}, {0, 5, 2, 12}, {15, 1, 4, 8}, {0, 14, 2, 6}, {13, 9, 7, 3}, {0, 14, 6, 8}, {0, 8, 6, 12}, {15, 1, 2, 6},
+		{15, 1, 6, 8}, {13, 9, 4, 3}, {0, 5, 2, 6}, {13, 5, 7, 3}, {0, 14, 5, 8}, {0, 9, 5, 12}, {0, 5, 6, 12}, {15, 1, 4, 8},
+		{0, 12, 10, 14}, {3, 13, 11, 15}, {3, 1, 15, 11}, {1, 2, 3, 11}, {13, 1, 4, 3}, {11, 5, 2, 3}, {13, 5, 11, 3}, {0, 14, 4, 12},
+		{0, 5, 10, 12}, {15, 1, 4, 13}, {11, 1, 2, 6}, {13, 1, 7, 3}, {0, 14, 10, 6}, {0, 14, 7, 12}, {15, 1, 11, 6}, {15, 1, 7, 13},
+		{13, 1, 4, 3}, {11, 5, 2, 6}, {13, 4, 7, 3}, {0, 5, 10, 6}, {0, 14, 4, 12}, {0, 5, 7, 12}, {15, 1, 4, 13}, {11, 9, 2, 3},
+		{11, 1, 2, 8}, {13, 9, 11, 3}, {0, 14, 10, 8}, {0, 9, 10, 12}, {15, 1, 11, 8}, {13, 9, 5, 3}, {11, 5, 2, 3}, {0, 14, 4, 8},
+		{13, 5, 11, 3}, {0, 9, 4, 12}, {0, 5, 10, 12}, {15, 1, 4, 8}, {11, 1, 2, 6}, {13, 9, 7, 3}, {0, 14, 7, 8}, {0, 14, 10, 6},
+		{0, 9, 7, 12}, {15, 1, 6, 8}, {15, 1, 11, 6}, {13, 9, 4, 3}, {11, 5, 2, 6}, {13, 5, 7, 3}, {0, 14, 4, 8}, {0, 5, 10, 6},
+		{0, 9, 4, 12}, {0, 5, 7, 12}, {15, 1, 4, 8}, {0, 1, 4, 3}, {0, 5, 2, 6}, {0, 4, 7, 3}, {0, 9, 5, 3}, {0, 5, 2, 3},
+		{0, 1, 4, 8}, {0, 1, 2, 6}, {0, 9, 7, 3}, {0, 1, 6, 8}, {11, 1, 2, 6}, {0, 1, 7, 3}, {0, 1, 10, 7}, {0, 1, 2, 6},
+		{13, 1, 7, 3}, {0, 1, 6, 12}, {11, 1, 2, 3}, {13, 1, 11, 3}, {0, 1, 10, 12}, {13, 9, 2, 3}, {0, 1, 2, 8}, {0, 8, 2, 12},
+		{0, 9, 2, 3}, {0, 14, 2, 9}, {15, 1, 2, 8}, {13, 1, 2, 3}, {0, 14, 2, 12}, {15, 1, 2, 13}, {0, 1, 4, 3}, {11, 5, 2, 3},
+		{0, 4, 10, 3}, {0, 14, 5, 3}, {0, 5, 2, 3}, {15, 1, 4, 3}, {11, 1, 2, 3}, {0, 14, 10, 3}, {15, 1, 11, 3}
+};
+
+//{first tet, tets count, cut case} per packed cut code
+const CutCaseEntry g_cutCaseTable[COUNT_CUT_CODES] = {
+		//cut node code 0
+		{0, 0, 8}, {0, 2, 2}, {2, 2, 2}, {4, 3, 3}, {7, 2, 2}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 2}, {21, 3, 3}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 2}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 2}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 1
+		{0, 0, 8}, {0, 2, 8}, {2, 2, 8}, {283, 3, 5}, {7, 2, 8}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 2}, {21, 3, 3}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 2}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 2}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 2
+		{0, 0, 8}, {0, 2, 2}, {2, 2, 8}, {4, 3, 3}, {7, 2, 2}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 8}, {21, 3, 3}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 2}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 3
+		{0, 0, 8}, {0, 2, 8}, {2, 2, 6}, {283, 3, 5}, {7, 2, 8}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 8}, {21, 3, 3}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 2}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 4
+		{0, 0, 8}, {0, 2, 2}, {2, 2, 2}, {4, 3, 3}, {7, 2, 8}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 2}, {21, 3, 3}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 5
+		{0, 0, 8}, {0, 2, 8}, {2, 2, 8}, {283, 3, 5}, {7, 2, 6}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 2}, {21, 3, 3}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 6
+		{0, 0, 8}, {0, 2, 2}, {2, 2, 8}, {4, 3, 3}, {7, 2, 8}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 8}, {21, 3, 3}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 6}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 7
+		{0, 0, 7}, {0, 2, 8}, {2, 2, 6}, {283, 3, 5}, {7, 2, 6}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 8}, {21, 3, 3}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 6}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {123, 3, 3}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{151, 3, 3}, {154, 4, 4}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 8
+		{0, 0, 8}, {0, 2, 8}, {2, 2, 2}, {4, 3, 3}, {7, 2, 2}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 8}, {310, 3, 5}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 2}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 9
+		{0, 0, 8}, {0, 2, 6}, {2, 2, 8}, {283, 3, 5}, {7, 2, 8}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 8}, {310, 3, 5}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 2}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 10
+		{0, 0, 8}, {0, 2, 8}, {2, 2, 8}, {4, 3, 3}, {7, 2, 2}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 6}, {310, 3, 5}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 11
+		{0, 0, 7}, {0, 2, 6}, {2, 2, 6}, {283, 3, 5}, {7, 2, 8}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 6}, {310, 3, 5}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {62, 3, 3}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 8}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {134, 3, 3}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{190, 3, 3}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 4}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 12
+		{0, 0, 8}, {0, 2, 8}, {2, 2, 2}, {4, 3, 3}, {7, 2, 8}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 8}, {310, 3, 5}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 6}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 13
+		{0, 0, 7}, {0, 2, 6}, {2, 2, 8}, {283, 3, 5}, {7, 2, 6}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 8}, {310, 3, 5}, {24, 3, 3}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 8}, {50, 4, 3}, {54, 3, 3}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{80, 3, 3}, {83, 5, 4}, {88, 4, 4}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 6}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 14
+		{0, 0, 7}, {0, 2, 8}, {2, 2, 8}, {4, 3, 3}, {7, 2, 8}, {9, 3, 3}, {12, 3, 3}, {15, 4, 4},
+		{19, 2, 6}, {310, 3, 5}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 6}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 6}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8},
+		//cut node code 15
+		{0, 0, 8}, {0, 2, 6}, {2, 2, 6}, {283, 3, 5}, {7, 2, 6}, {286, 3, 5}, {289, 3, 5}, {15, 4, 8},
+		{19, 2, 6}, {310, 3, 5}, {292, 3, 5}, {27, 4, 0}, {31, 4, 3}, {35, 4, 4}, {39, 4, 4}, {43, 5, 8},
+		{48, 2, 6}, {50, 4, 3}, {295, 3, 5}, {57, 5, 4}, {301, 3, 5}, {65, 5, 4}, {70, 4, 0}, {74, 6, 8},
+		{298, 3, 5}, {83, 5, 4}, {88, 4, 8}, {92, 6, 8}, {98, 5, 4}, {103, 6, 1}, {109, 5, 8}, {114, 7, 8},
+		{121, 2, 6}, {313, 3, 5}, {126, 4, 3}, {130, 4, 4}, {304, 3, 5}, {137, 4, 0}, {141, 5, 4}, {146, 5, 8},
+		{316, 3, 5}, {154, 4, 8}, {158, 5, 4}, {163, 5, 8}, {168, 5, 4}, {173, 5, 8}, {178, 6, 1}, {184, 6, 8},
+		{307, 3, 5}, {193, 5, 4}, {198, 5, 4}, {203, 6, 1}, {209, 4, 8}, {213, 6, 8}, {219, 6, 8}, {225, 7, 8},
+		{232, 4, 0}, {236, 6, 8}, {242, 6, 8}, {248, 7, 8}, {255, 6, 8}, {261, 7, 8}, {268, 7, 8}, {275, 8, 8}
+};
+
+#endif /* TETSUBDIVIDERTABLE_H_ */
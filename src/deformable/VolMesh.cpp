@@ -12,7 +12,9 @@
 #include <base/StringBase.h>
 #include "base/DebugUtils.h"
 #include "base/Profiler.h"
+#include "base/SpaceFillingCurve.h"
 #include <deformable/VolMesh.h>
+#include <deformable/VolMeshBuilder.h>
 #include <graphics/AABB.h>
 #include <graphics/SceneGraph.h>
 
@@ -24,7 +26,6 @@
 #include <iterator>
 #include <map>
 #include <set>
-#include <stack>
 #include <utility>
 #include <vector>
 
@@ -35,6 +36,9 @@ using namespace PS::FILESTRINGUTILS;
 using namespace PS;
 using namespace PS::MESH;
 
+//handles are passed by reference to the containers
+const U32 VolMesh::INVALID_INDEX;
+
 VolMesh::VolMesh() {
 	init();
 }
@@ -77,7 +81,11 @@ VolMesh::VolMesh(const VolMesh& other) {
 	m_flagDrawWireFrameMesh = other.m_flagDrawWireFrameMesh;
 	m_flagDrawNodes = other.m_flagDrawNodes;
 	m_flagFilterOutFlatCells = other.m_flagFilterOutFlatCells;
+	m_flagBulkSetup = other.m_flagBulkSetup;
+	setFlagPackedIncidence(other.m_flagPackedIncidence);
 	m_color = other.m_color;
+	m_gcPolicy = other.m_gcPolicy;
+	m_reorderAfterGC = other.m_reorderAfterGC;
 
 	//set the name
 	setName(other.name());
@@ -104,7 +112,12 @@ void VolMesh::init() {
 	m_flagDrawNodes = false;
 	m_flagDrawWireFrameMesh = false;
 	m_flagFilterOutFlatCells = true;
+	m_flagBulkSetup = true;
+	m_flagPackedIncidence = true;
 	m_color = Color::skin();
+	m_gcPolicy = gcpEraseInPlace;
+	m_reorderAfterGC = sfcNone;
+	m_isFacesIndexDirty = false;
 
 	m_fOnNodeEvent = NULL;
 	m_fOnEdgeEvent = NULL;
@@ -128,6 +141,98 @@ void VolMesh::setOnElemEventCallback(OnCellEvent f) {
 	m_fOnElementEvent = f;
 }
 
+void VolMesh::addNodeEventListener(OnNodeEvent f) {
+	if(f)
+		m_vNodeEventListeners.push_back(f);
+}
+
+void VolMesh::addEdgeEventListener(OnEdgeEvent f) {
+	if(f)
+		m_vEdgeEventListeners.push_back(f);
+}
+
+void VolMesh::addFaceEventListener(OnFaceEvent f) {
+	if(f)
+		m_vFaceEventListeners.push_back(f);
+}
+
+void VolMesh::addElemEventListener(OnCellEvent f) {
+	if(f)
+		m_vElemEventListeners.push_back(f);
+}
+
+void VolMesh::notifyNodeEvent(U32 idxNode, TopologyEvent event) {
+	if(event == teAdded)
+		m_nodeGrid.nodeAdded(idxNode, nodePos(idxNode));
+	else if(event == teRemoved)
+		m_nodeGrid.nodeRemoved(idxNode);
+	else if(isNodeIndex(idxNode))
+		m_nodeGrid.nodeMoved(idxNode, nodePos(idxNode));
+	else
+		m_nodeGrid.reset();
+
+	if(!m_fOnNodeEvent && m_vNodeEventListeners.size() == 0)
+		return;
+
+	NODE node;
+	if(isNodeIndex(idxNode))
+		node = const_nodeAt(idxNode);
+
+	if(m_fOnNodeEvent)
+		m_fOnNodeEvent(node, idxNode, event);
+	for(U32 i=0; i < m_vNodeEventListeners.size(); i++)
+		m_vNodeEventListeners[i](node, idxNode, event);
+}
+
+void VolMesh::notifyEdgeEvent(U32 idxEdge, TopologyEvent event) {
+	if(!m_fOnEdgeEvent && m_vEdgeEventListeners.size() == 0)
+		return;
+
+	EDGE edge;
+	if(isEdgeIndex(idxEdge))
+		edge = const_edgeAt(idxEdge);
+
+	if(m_fOnEdgeEvent)
+		m_fOnEdgeEvent(edge, idxEdge, event);
+	for(U32 i=0; i < m_vEdgeEventListeners.size(); i++)
+		m_vEdgeEventListeners[i](edge, idxEdge, event);
+}
+
+void VolMesh::notifyFaceEvent(U32 idxFace, TopologyEvent event) {
+	if(!m_fOnFaceEvent && m_vFaceEventListeners.size() == 0)
+		return;
+
+	FACE face;
+	if(isFaceIndex(idxFace))
+		face = const_faceAt(idxFace);
+
+	if(m_fOnFaceEvent)
+		m_fOnFaceEvent(face, idxFace, event);
+	for(U32 i=0; i < m_vFaceEventListeners.size(); i++)
+		m_vFaceEventListeners[i](face, idxFace, event);
+}
+
+void VolMesh::notifyElemEvent(U32 idxCell, TopologyEvent event) {
+	if(event == teAdded)
+		m_parts.cellAdded(idxCell);
+	else if(event == teRemoved)
+		m_parts.cellRemoved(idxCell);
+	else if(event == teRenumbered)
+		m_parts.reset();
+
+	if(!m_fOnElementEvent && m_vElemEventListeners.size() == 0)
+		return;
+
+	CELL cell;
+	if(isCellIndex(idxCell))
+		cell = const_cellAt(idxCell);
+
+	if(m_fOnElementEvent)
+		m_fOnElementEvent(cell, idxCell, event);
+	for(U32 i=0; i < m_vElemEventListeners.size(); i++)
+		m_vElemEventListeners[i](cell, idxCell, event);
+}
+
 
 bool VolMesh::setup(const vector<double>& vertices, const vector<U32>& elements) {
 	U32 ctVertices = vertices.size() / 3;
@@ -138,9 +243,20 @@ bool VolMesh::setup(const vector<double>& vertices, const vector<U32>& elements)
 
 bool VolMesh::setup(U32 ctVertices, const double* vertices, U32 ctElements, const U32* elements) {
 
+	//bulk path produces the same mesh as the incremental one below
+	if(m_flagBulkSetup && VolMeshBuilder::build(this, ctVertices, vertices, ctElements, elements)) {
+		compactIncidence();
+		computeAABB();
+		return true;
+	}
+
 	//cleanup to setup the mesh
 	cleanup();
 
+	//a tet mesh has roughly 1.2 edges and 2 faces per element
+	m_hashEdgesIndex.reserve(ctElements * 2);
+	m_hashFacesIndex.reserve(ctElements * 2 + 4);
+
 	//add all vertices first
 	for(U32 i=0; i<ctVertices; i++) {
 		NODE node;
@@ -153,6 +269,8 @@ bool VolMesh::setup(U32 ctVertices, const double* vertices, U32 ctElements, cons
 	for(U32 i=0; i<ctElements; i++)
 		insert_cell(const_cast<U32 *>(&elements[i * 4]));
 
+	//lists grew in random order
+	compactIncidence();
 
 	//Compute AABB
 	computeAABB();
@@ -163,16 +281,24 @@ bool VolMesh::setup(U32 ctVertices, const double* vertices, U32 ctElements, cons
 }
 
 void VolMesh::cleanup() {
-	m_mapEdgesIndex.clear();
+	m_hashEdgesIndex.clear();
+	m_hashFacesIndex.clear();
+	m_isFacesIndexDirty = false;
 	m_pendingToDeleteCells.resize(0);
+	m_parts.reset();
+	m_nodeGrid.reset();
+	m_vNodePermutation.resize(0);
+	m_vCellPermutation.resize(0);
 	m_incident_cells_per_face.resize(0);
 	m_incident_edges_per_node.resize(0);
 	m_incident_faces_per_edge.resize(0);
+	m_incident_cells_per_node.resize(0);
+	m_vCellNeighbors.resize(0);
 
 	m_vCells.resize(0);
 	m_vFaces.resize(0);
 	m_vEdges.resize(0);
-	m_vNodes.resize(0);
+	m_nodes.clear();
 }
 
 void VolMesh::printNodeInfo() const {
@@ -247,7 +373,7 @@ double VolMesh::computeCellDeterminant(U32 idxCell) const {
 	vec3d v[4];
 	const CELL& cell = const_cellAt(idxCell);
 	for(int i=0; i<4; i++)
-		v[i] = const_nodeAt(cell.nodes[i]).pos;
+		v[i] = nodePos(cell.nodes[i]);
 	return ComputeCellDeterminant(v);
 }
 
@@ -255,7 +381,7 @@ double VolMesh::computeCellVolume(U32 idxCell) const {
 	vec3d v[4];
 	const CELL& cell = const_cellAt(idxCell);
 	for(int i=0; i<4; i++)
-		v[i] = const_nodeAt(cell.nodes[i]).pos;
+		v[i] = nodePos(cell.nodes[i]);
 	return ComputeCellVolume(v);
 }
 
@@ -263,7 +389,7 @@ vec3d VolMesh::computeCellCentroid(U32 idxCell) const {
 	vec3d v[4];
 	const CELL& cell = const_cellAt(idxCell);
 	for(int i=0; i<4; i++)
-		v[i] = const_nodeAt(cell.nodes[i]).pos;
+		v[i] = nodePos(cell.nodes[i]);
 
 	return (v[0] + v[1] + v[2] + v[3]) * 0.25;
 }
@@ -288,7 +414,7 @@ double VolMesh::computeInscribedRadius(U32 idxCell) const {
 
 		//fetch face nodes
 		for(int j=0; j < 3; j++)
-			np[j] = const_nodeAt(n[j]).pos;
+			np[j] = nodePos(n[j]);
 
 		vec3d crs = vec3d::cross(np[1] - np[0], np[2] - np[0]);
 		sumsa += (0.5 * crs.length());
@@ -301,7 +427,7 @@ double VolMesh::computeCircumscribedRadius(U32 idxCell) const {
 	vec3d v[4];
 	const CELL& cell = const_cellAt(idxCell);
 	for(int i=0; i<4; i++)
-		v[i] = const_nodeAt(cell.nodes[i]).pos;
+		v[i] = nodePos(cell.nodes[i]);
 	return ComputeCircumscribedRadius(v);
 }
 
@@ -427,10 +553,16 @@ bool VolMesh::insert_cell(const CELL& cell) {
 
 	//update
 	for(int i=0; i < 4; i++)
-		m_incident_cells_per_face[ cell.faces[i] ].push_back(idxCell);
+		m_incident_cells_per_face.push_back(cell.faces[i], idxCell);
+	for(int i=0; i < COUNT_CELL_NODES; i++)
+		m_incident_cells_per_node.push_back(cell.nodes[i], idxCell);
 
-	if(m_fOnElementEvent)
-		m_fOnElementEvent(cell, m_vCells.size() - 1, teAdded);
+	//link to the cells across the faces
+	m_vCellNeighbors.resize(m_vCellNeighbors.size() + COUNT_CELL_FACES, INVALID_INDEX);
+	for(int i=0; i < COUNT_CELL_FACES; i++)
+		linkFaceNeighbors(cell.faces[i]);
+
+	notifyElemEvent(idxCell, teAdded);
 
 	return true;
 }
@@ -448,7 +580,7 @@ bool VolMesh::insert_cell(U32 nodes[4]) {
 	if(m_flagFilterOutFlatCells) {
 		vec3d v[COUNT_CELL_NODES];
 		for (int i = 0; i < COUNT_CELL_NODES; i++) {
-			v[i] = const_nodeAt(nodes[i]).pos;
+			v[i] = nodePos(nodes[i]);
 		}
 		double cellvol = ComputeCellVolume(v);
 		if(cellvol < FLAT_CELL_VOLUME)
@@ -464,9 +596,9 @@ bool VolMesh::insert_cell(U32 nodes[4]) {
 	const int maskTetEdges[6][2] = { {1, 2}, {2, 3}, {3, 1}, {2, 0}, {0, 3}, {0, 1} };
 	//const int edgeMaskNeg[6][2] = { {3, 2}, {2, 1}, {1, 3}, {3, 0}, {0, 2}, {1, 0} };
 
-	//maps for half edges
-	std::map< EdgeKey, EDGE > mapEdges;
-	typedef std::map< EdgeKey, EDGE >::iterator HEITER;
+	//new edges of this cell sorted by key
+	std::pair<U64, EDGE> arrNewEdges[COUNT_CELL_FACES * 3];
+	U32 ctNewEdges = 0;
 
 	//Add element nodes set only for now
 	CELL cell;
@@ -494,10 +626,18 @@ bool VolMesh::insert_cell(U32 nodes[4]) {
 
 			if(edge_exists(from, to) == false) {
 				EdgeKey key(from, to);
-				EDGE edge;
-				edge.from = from;
-				edge.to = to;
-				mapEdges.insert(make_pair(key, edge));
+
+				//each edge is shared by two faces of the cell
+				bool found = false;
+				for(U32 i=0; i < ctNewEdges; i++) {
+					if(arrNewEdges[i].first == key.key) {
+						found = true;
+						break;
+					}
+				}
+
+				if(!found)
+					arrNewEdges[ctNewEdges++] = make_pair(key.key, EDGE(from, to));
 			}
 		}
 	}
@@ -505,18 +645,15 @@ bool VolMesh::insert_cell(U32 nodes[4]) {
 	//add final edges
 	U32 from, to = INVALID_INDEX;
 
-	while(mapEdges.size() > 0) {
-		//add forward
-		HEITER forward = mapEdges.begin();
-		from = forward->second.from;
-		to = forward->second.to;
-
-		insert_edge(forward->second);
-
-		//Remove from map
-		mapEdges.erase(forward);
+	//insert in increasing key order
+	for(U32 i=1; i < ctNewEdges; i++) {
+		for(U32 j=i; j > 0 && arrNewEdges[j].first < arrNewEdges[j - 1].first; j--)
+			std::swap(arrNewEdges[j], arrNewEdges[j - 1]);
 	}
 
+	for(U32 i=0; i < ctNewEdges; i++)
+		insert_edge(arrNewEdges[i].second);
+
 	//add all faces now and finish setting information for all
 	//loop over faces. Per each tet 6 edges or 12 half-edges added
 	for (int f = 0; f < 4; f++) {
@@ -536,9 +673,9 @@ bool VolMesh::insert_cell(U32 nodes[4]) {
 		to = cell.nodes[maskTetEdges[e][1]];
 
 		EdgeKey key(from, to);
-		MAPHEDGEINDEXITER it = m_mapEdgesIndex.find(key);
-		if (it != m_mapEdgesIndex.end())
-			cell.edges[e] = it->second;
+		const U32* pidxEdge = m_hashEdgesIndex.find(key.key);
+		if (pidxEdge)
+			cell.edges[e] = *pidxEdge;
 		else {
 			LogErrorArg2("Setting element edges failed! Unable to find edge <%d, %d>",
 						from, to);
@@ -557,16 +694,10 @@ void VolMesh::set_edge(U32 idxEdge, U32 from, U32 to) {
 	EDGE& e = edgeAt(idxEdge);
 
 	//remove incident edge idxEdge from the list of incident edges of the from node
-	m_incident_edges_per_node[e.from].erase(std::remove(
-			m_incident_edges_per_node[e.from].begin(),
-			m_incident_edges_per_node[e.from].end(),
-			idxEdge), m_incident_edges_per_node[e.from].end());
+	m_incident_edges_per_node.remove(e.from, idxEdge);
 
 	//remove incident edge idxEdge from the list of incident edges of the to node
-	m_incident_edges_per_node[e.to].erase(std::remove(
-			m_incident_edges_per_node[e.to].begin(),
-			m_incident_edges_per_node[e.to].end(),
-			idxEdge), m_incident_edges_per_node[e.to].end());
+	m_incident_edges_per_node.remove(e.to, idxEdge);
 
 	//remove edge from map
 	removeEdgeIndexFromMap(e.from, e.to);
@@ -577,9 +708,11 @@ void VolMesh::set_edge(U32 idxEdge, U32 from, U32 to) {
 	m_vEdges[idxEdge] = e;
 
 	//add to incident edges per node
-	m_incident_edges_per_node[e.from].push_back(idxEdge);
-	m_incident_edges_per_node[e.to].push_back(idxEdge);
+	m_incident_edges_per_node.push_back(e.from, idxEdge);
+	m_incident_edges_per_node.push_back(e.to, idxEdge);
 	insertEdgeIndexToMap(e.from, e.to, idxEdge);
+
+	notifyEdgeEvent(idxEdge, teUpdated);
 }
 
 void VolMesh::set_face(U32 idxFace, U32 edges[3]) {
@@ -587,13 +720,11 @@ void VolMesh::set_face(U32 idxFace, U32 edges[3]) {
 	assert(isFaceIndex(idxFace));
 
 	FACE& face = faceAt(idxFace);
+	removeFaceIndexFromMap(idxFace);
 
 	//remove idxFace from the list of incident faces of faceedge0
 	for(int i=0; i<COUNT_FACE_EDGES; i++) {
-		m_incident_faces_per_edge[ face.edges[i] ].erase(
-				std::remove(m_incident_faces_per_edge[ face.edges[i] ].begin(),
-				m_incident_faces_per_edge[ face.edges[i] ].end(), idxFace),
-				m_incident_faces_per_edge[ face.edges[i] ].end());
+		m_incident_faces_per_edge.remove(face.edges[i], idxFace);
 	}
 
 	//UPDATE
@@ -604,29 +735,41 @@ void VolMesh::set_face(U32 idxFace, U32 edges[3]) {
 
 	//add to incident faces per edge
 	for(int i=0; i<COUNT_FACE_EDGES; i++)
-		m_incident_faces_per_edge[edges[i]].push_back(idxFace);
+		m_incident_faces_per_edge.push_back(edges[i], idxFace);
+	insertFaceIndexToMap(idxFace);
+
+	notifyFaceEvent(idxFace, teUpdated);
 }
 
 void VolMesh::remove_cell_core(U32 idxCell) {
 	assert(isCellIndex(idxCell));
 
-	//1. remove cell from the list of incident cell per face
+	//1. remove cell from the list of incident cell per face and per node
 	const CELL& cell = const_cellAt(idxCell);
 	for(int i=0; i<4; i++) {
-		m_incident_cells_per_face[ cell.faces[i] ].erase(
-				std::remove(m_incident_cells_per_face[ cell.faces[i] ].begin(),
-				m_incident_cells_per_face[ cell.faces[i] ].end(), idxCell),
-				m_incident_cells_per_face[ cell.faces[i] ].end());
+		m_incident_cells_per_face.remove(cell.faces[i], idxCell);
+		linkFaceNeighbors(cell.faces[i]);
 	}
+	for(int i=0; i < COUNT_CELL_NODES; i++)
+		m_incident_cells_per_node.remove(cell.nodes[i], idxCell);
 
 	//2. correct all referenced cell indices
     HandleCorrection corrector(idxCell);
-    std::for_each(m_incident_cells_per_face.begin(),
-                  m_incident_cells_per_face.end(),
-                  std::bind(&HandleCorrection::correctVecValue, &corrector, std::placeholders::_1));
+    m_incident_cells_per_face.for_each_value(
+    			  std::bind(&HandleCorrection::correctValue, &corrector, std::placeholders::_1));
+    m_incident_cells_per_node.for_each_value(
+    			  std::bind(&HandleCorrection::correctValue, &corrector, std::placeholders::_1));
+
+    m_vCellNeighbors.erase(m_vCellNeighbors.begin() + idxCell * COUNT_CELL_FACES,
+    					   m_vCellNeighbors.begin() + (idxCell + 1) * COUNT_CELL_FACES);
+    for(U32 i=0; i < m_vCellNeighbors.size(); i++) {
+    	if(m_vCellNeighbors[i] != INVALID_INDEX && m_vCellNeighbors[i] > idxCell)
+    		m_vCellNeighbors[i]--;
+    }
 //	HandleCorrectionParallel corrector(idxCell, m_incident_cells_per_face);
 //	tbb::parallel_for( blocked_range<U32>(0, countFaces()), corrector);
 
+	notifyElemEvent(idxCell, teRemoved);
 
 	//remove the cell from list
 	m_vCells.erase(m_vCells.begin() + idxCell);
@@ -636,6 +779,7 @@ void VolMesh::remove_face_core(U32 idxFace) {
 	assert(isFaceIndex(idxFace));
 
 	ProfileAutoArg("gc:remove face core");
+	ArenaScope scope(m_scratch);
 
 	//1. remove from incident faces per edge
 	//2. Decrease all face handles > idxFace in incident cells
@@ -648,29 +792,26 @@ void VolMesh::remove_face_core(U32 idxFace) {
 	for(U32 i=0; i < COUNT_FACE_EDGES; i++) {
 		U32 idxEdge = face.edges[i];
 
-		m_incident_faces_per_edge[idxEdge].erase(
-				std::remove( m_incident_faces_per_edge[idxEdge].begin(),
-							 m_incident_faces_per_edge[idxEdge].end(), idxFace),
-				m_incident_faces_per_edge[idxEdge].end());
+		m_incident_faces_per_edge.remove(idxEdge, idxFace);
 	}
 
 	//2. decrease all face handles > idxFace in incident cells
     // Decrease all half-face handles > _h in all cells
     // and delete all half-face handles == _h
-    vector<U32> vCellsToUpdate;
+    ScratchVector vCellsToUpdate(scratchAlloc());
     for(U32 i = idxFace; i < countFaces(); i++ ) {
-    	vCellsToUpdate.insert(vCellsToUpdate.end(), m_incident_cells_per_face[i].begin(), m_incident_cells_per_face[i].end());
+    	vCellsToUpdate.insert(vCellsToUpdate.end(), m_incident_cells_per_face.begin(i), m_incident_cells_per_face.end(i));
     }
 
     //remove dups and sort
-    set<U32> setTemp;
+    ScratchSet setTemp(scratchAlloc());
     for(U32 i=0; i < vCellsToUpdate.size(); i++)
     	setTemp.insert(vCellsToUpdate[i]);
     vCellsToUpdate.assign(setTemp.begin(), setTemp.end());
 
 
     //from set of update_cells unregister cell faces
-    for(vector<U32>::const_iterator c_it = vCellsToUpdate.begin(),
+    for(ScratchVector::const_iterator c_it = vCellsToUpdate.begin(),
             c_end = vCellsToUpdate.end(); c_it != c_end; ++c_it) {
 
     	//check if valid
@@ -679,19 +820,16 @@ void VolMesh::remove_face_core(U32 idxFace) {
 
     	const CELL& cell = const_cellAt(*c_it);
     	for(int i=0; i<COUNT_CELL_FACES; i++) {
-    		m_incident_cells_per_face[ cell.faces[i] ].erase(
-    			std::remove(m_incident_cells_per_face[ cell.faces[i] ].begin(),
-    						m_incident_cells_per_face[ cell.faces[i] ].end(), *c_it),
-    			m_incident_cells_per_face[ cell.faces[i] ].end());
+    		m_incident_cells_per_face.remove(cell.faces[i], *c_it);
     	}
     }
 
     //3.remove the entry from incident cells per face list
-    m_incident_cells_per_face.erase(m_incident_cells_per_face.begin() + idxFace);
+    m_incident_cells_per_face.erase(idxFace);
 
 
     //update faces
-    for(vector<U32>::const_iterator c_it = vCellsToUpdate.begin(),
+    for(ScratchVector::const_iterator c_it = vCellsToUpdate.begin(),
             c_end = vCellsToUpdate.end(); c_it != c_end; ++c_it) {
 
     	//check if valid
@@ -708,27 +846,29 @@ void VolMesh::remove_face_core(U32 idxFace) {
     			cell.faces[i]--;
 
     		//add to list of incident
-    		m_incident_cells_per_face[cell.faces[i]].push_back(*c_it);
+    		m_incident_cells_per_face.push_back(cell.faces[i], *c_it);
     	}
     }
 
 
     //4.decrease all face handles per edge
     HandleCorrection cor(idxFace);
-    std::for_each(m_incident_faces_per_edge.begin(),
-    			  m_incident_faces_per_edge.end(),
-                  std::bind(&HandleCorrection::correctVecValue, &cor, std::placeholders::_1));
+    m_incident_faces_per_edge.for_each_value(
+    			  std::bind(&HandleCorrection::correctValue, &cor, std::placeholders::_1));
 //	HandleCorrectionParallel corrector(idxFace, m_incident_faces_per_edge);
 //	tbb::parallel_for( blocked_range<U32>(0, countEdges()), corrector);
 
 
     //4.delete face
+    m_isFacesIndexDirty = true;
+    notifyFaceEvent(idxFace, teRemoved);
     m_vFaces.erase(m_vFaces.begin() + idxFace);
 
 }
 
 void VolMesh::remove_edge_core(U32 idxEdge) {
 	assert(isEdgeIndex(idxEdge));
+	ArenaScope scope(m_scratch);
 
 	//1. Delete bottom-up links from incident edges per node
 	//2. Decrease all edge handles > idxEdge in incident faces per edge
@@ -740,20 +880,16 @@ void VolMesh::remove_edge_core(U32 idxEdge) {
 
 	//1. bottomup links
 	//remove idxEdge from the list of start node
-	m_incident_edges_per_node[edge.from].erase(std::remove(m_incident_edges_per_node[edge.from].begin(),
-											   m_incident_edges_per_node[edge.from].end(), idxEdge),
-											   m_incident_edges_per_node[edge.from].end());
+	m_incident_edges_per_node.remove(edge.from, idxEdge);
 
 	//remove idxEdge from the list of end node
-	m_incident_edges_per_node[edge.to].erase(std::remove(m_incident_edges_per_node[edge.to].begin(),
-											   m_incident_edges_per_node[edge.to].end(), idxEdge),
-											   m_incident_edges_per_node[edge.to].end());
+	m_incident_edges_per_node.remove(edge.to, idxEdge);
 
 	//2. decrease all edge handles > idxEdge in incident faces per edge
-	std::set<U32> setFacesToUpdate;
+	ScratchSet setFacesToUpdate(scratchAlloc());
 	for(U32 i=idxEdge; i < countEdges(); i++) {
-		for(std::vector<U32>::const_iterator f_it = m_incident_faces_per_edge[i].begin();
-			f_it != m_incident_faces_per_edge[i].end(); f_it++) {
+		for(IncidenceTable::const_iterator f_it = m_incident_faces_per_edge.begin(i);
+			f_it != m_incident_faces_per_edge.end(i); f_it++) {
 
 			if(isFaceIndex(*f_it))
 				setFacesToUpdate.insert(*f_it);
@@ -761,25 +897,22 @@ void VolMesh::remove_edge_core(U32 idxEdge) {
 	}
 
 	//un-register all face edges
-	for(std::set<U32>::iterator f_it = setFacesToUpdate.begin(),
+	for(ScratchSet::iterator f_it = setFacesToUpdate.begin(),
 		f_end = setFacesToUpdate.end(); f_it != f_end; ++f_it) {
 
     	FACE& face = faceAt(*f_it);
 
     	//remove idxFace from the list of incident faces of face edges
     	for(int i=0; i<COUNT_FACE_EDGES; i++) {
-    		m_incident_faces_per_edge[ face.edges[i] ].erase(
-    				std::remove(m_incident_faces_per_edge[ face.edges[i] ].begin(),
-    				m_incident_faces_per_edge[ face.edges[i] ].end(), *f_it),
-    				m_incident_faces_per_edge[ face.edges[i] ].end());
+    		m_incident_faces_per_edge.remove(face.edges[i], *f_it);
     	}
 	}
 
 	//3. delete incident entry
-	m_incident_faces_per_edge.erase(m_incident_faces_per_edge.begin() + idxEdge);
+	m_incident_faces_per_edge.erase(idxEdge);
 
 	//update-faces
-	for(std::set<U32>::iterator f_it = setFacesToUpdate.begin(),
+	for(ScratchSet::iterator f_it = setFacesToUpdate.begin(),
 		f_end = setFacesToUpdate.end(); f_it != f_end; ++f_it) {
 
     	FACE& face = faceAt(*f_it);
@@ -792,16 +925,16 @@ void VolMesh::remove_edge_core(U32 idxEdge) {
     			face.edges[i]--;
 
     		//add to list of incident
-    		m_incident_faces_per_edge[face.edges[i]].push_back(*f_it);
+    		m_incident_faces_per_edge.push_back(face.edges[i], *f_it);
     	}
 	}
 
 
 	//update cells
-	set<U32> setCellsToUpdate;
+	ScratchSet setCellsToUpdate(scratchAlloc());
 	get_incident_cells(setFacesToUpdate, setCellsToUpdate);
 
-	for (std::set<U32>::iterator c_it = setCellsToUpdate.begin(), c_end =
+	for (ScratchSet::iterator c_it = setCellsToUpdate.begin(), c_end =
 			setCellsToUpdate.end(); c_it != c_end; ++c_it)
 	{
 		CELL& cell = cellAt(*c_it);
@@ -820,23 +953,27 @@ void VolMesh::remove_edge_core(U32 idxEdge) {
 
     //4.decrease all edges handles per node
     HandleCorrection cor(idxEdge);
-    std::for_each(m_incident_edges_per_node.begin(),
-    			  m_incident_edges_per_node.end(),
-                  std::bind(&HandleCorrection::correctVecValue, &cor, std::placeholders::_1));
+    m_incident_edges_per_node.for_each_value(
+    			  std::bind(&HandleCorrection::correctValue, &cor, std::placeholders::_1));
 
     //5.update map edges
     removeEdgeIndexFromMap(edge.from, edge.to);
-    for(MAPHEDGEINDEXITER it = m_mapEdgesIndex.begin(); it != m_mapEdgesIndex.end(); it++) {
-    	if(it->second > idxEdge)
-    		it->second --;
-    }
+    m_hashEdgesIndex.for_each([idxEdge](U64 key, U32& value) {
+    	if(value > idxEdge)
+    		value --;
+    });
+
+    //face keys are built from edge handles
+    m_isFacesIndexDirty = true;
 
     //6.delete edge itself
+    notifyEdgeEvent(idxEdge, teRemoved);
     m_vEdges.erase(m_vEdges.begin() + idxEdge);
 }
 
 void VolMesh::remove_node_core(U32 idxNode) {
 	assert(isNodeIndex(idxNode));
+	ArenaScope scope(m_scratch);
 
 	//1. Decrease all vertex handles > idxNode in incident edges per node
 	//2. Delete entry in bottom-up list: incident edges per node
@@ -844,10 +981,10 @@ void VolMesh::remove_node_core(U32 idxNode) {
 	//4. Delete property entry
 
 	//1.
-	set<U32> setEdgesToUpdate;
+	ScratchSet setEdgesToUpdate(scratchAlloc());
 	for(U32 i = idxNode; i < countNodes(); i++) {
-		for(std::vector<U32>::const_iterator e_it = m_incident_edges_per_node[i].begin();
-			e_it != m_incident_edges_per_node[i].end(); e_it++) {
+		for(IncidenceTable::const_iterator e_it = m_incident_edges_per_node.begin(i);
+			e_it != m_incident_edges_per_node.end(i); e_it++) {
 
 			if(isEdgeIndex(*e_it))
 				setEdgesToUpdate.insert(*e_it);
@@ -855,32 +992,27 @@ void VolMesh::remove_node_core(U32 idxNode) {
 	}
 
 	//un-register all edges incident to the given node
-	for (std::set<U32>::iterator e_it = setEdgesToUpdate.begin(), c_end =
+	for (ScratchSet::iterator e_it = setEdgesToUpdate.begin(), c_end =
 			setEdgesToUpdate.end(); e_it != c_end; ++e_it) {
 
 		const EDGE& e = const_edgeAt(*e_it);
 
 		//remove incident edge idxEdge from the list of incident edges of the from node
-		m_incident_edges_per_node[e.from].erase(
-				std::remove(m_incident_edges_per_node[e.from].begin(),
-						m_incident_edges_per_node[e.from].end(), *e_it),
-				m_incident_edges_per_node[e.from].end());
+		m_incident_edges_per_node.remove(e.from, *e_it);
 
 		//remove incident edge idxEdge from the list of incident edges of the to node
-		m_incident_edges_per_node[e.to].erase(
-				std::remove(m_incident_edges_per_node[e.to].begin(),
-						m_incident_edges_per_node[e.to].end(), *e_it),
-				m_incident_edges_per_node[e.to].end());
+		m_incident_edges_per_node.remove(e.to, *e_it);
 
 		//remove edge from map
 		removeEdgeIndexFromMap(e.from, e.to);
 	}
 
 	//delete from incident edges per node
-	m_incident_edges_per_node.erase(m_incident_edges_per_node.begin() + idxNode);
+	m_incident_edges_per_node.erase(idxNode);
+	m_incident_cells_per_node.erase(idxNode);
 
 	//update-edges
-	for (std::set<U32>::iterator e_it = setEdgesToUpdate.begin(), c_end =
+	for (ScratchSet::iterator e_it = setEdgesToUpdate.begin(), c_end =
 			setEdgesToUpdate.end(); e_it != c_end; ++e_it) {
 
 		EDGE& e = edgeAt(*e_it);
@@ -898,21 +1030,21 @@ void VolMesh::remove_node_core(U32 idxNode) {
 			e.to--;
 
 		//add to list of incidents
-		m_incident_edges_per_node[e.from].push_back(*e_it);
-		m_incident_edges_per_node[e.to].push_back(*e_it);
+		m_incident_edges_per_node.push_back(e.from, *e_it);
+		m_incident_edges_per_node.push_back(e.to, *e_it);
 		insertEdgeIndexToMap(e.from, e.to, *e_it);
 	}
 
 	//update cells
-	set<U32> setCellsToUpdate;
+	ScratchSet setCellsToUpdate(scratchAlloc());
 	{
-		set<U32> setFacesToUpdate;
+		ScratchSet setFacesToUpdate(scratchAlloc());
 		get_incident_faces(setEdgesToUpdate, setFacesToUpdate);
 		get_incident_cells(setFacesToUpdate, setCellsToUpdate);
 	}
 
 	//setUpdateCells
-	for(set<U32>::iterator c_it = setCellsToUpdate.begin(); c_it != setCellsToUpdate.end(); c_it ++) {
+	for(ScratchSet::iterator c_it = setCellsToUpdate.begin(); c_it != setCellsToUpdate.end(); c_it ++) {
 		CELL& cell = cellAt(*c_it);
 
 		for(U32 i = 0; i < COUNT_CELL_NODES; i++) {
@@ -925,7 +1057,8 @@ void VolMesh::remove_node_core(U32 idxNode) {
 
 
 	//3. delete vertex
-	m_vNodes.erase(m_vNodes.begin() + idxNode);
+	notifyNodeEvent(idxNode, teRemoved);
+	m_nodes.erase(idxNode);
 
 }
 
@@ -933,54 +1066,22 @@ int VolMesh::get_disjoint_parts(vector<vector<U32>>& cellgroups) {
 
 	ProfileAutoArg("get_disjoint_parts");
 
-	std::set<U32> setCells;
-
-	for(U32 i=0; i < m_vCells.size(); i++)
-		setCells.insert(i);
-
-	while(setCells.size() > 0) {
+	U32 ctParts = update_cell_parts();
+	const vector<U32>& vLabels = m_parts.const_labels();
 
-		set<U32> curPart;
-
-		std::stack<U32> stkCurrentCells;
-		stkCurrentCells.push(* setCells.begin());
-
-		while(stkCurrentCells.size() > 0) {
-			U32 idxCell = stkCurrentCells.top();
-
-			//remove from local stack
-			stkCurrentCells.pop();
-
-			//remove from global set of cells
-			setCells.erase(idxCell);
-
-			//add to mesh parts
-			curPart.insert(idxCell);
-
-			//current cell
-			const CELL& cell = const_cellAt(idxCell);
-
-			set<U32> setCurFaces;
-			for(U32 i=0; i < 4; i++)
-				setCurFaces.insert(cell.faces[i]);
-
-			set<U32> incidentCells;
-			if(get_incident_cells(setCurFaces, incidentCells) > 0) {
-				for(set<U32>::const_iterator it = incidentCells.begin(); it != incidentCells.end(); it++) {
-					if((*it != idxCell) && curPart.find(*it) == curPart.end())
-						stkCurrentCells.push(*it);
-				}
-			}
-		}
-
-		//push back part to cells
-		vector<U32> vCurPart(curPart.begin(), curPart.end());
-		cellgroups.push_back(vCurPart);
-	}
+	//cells are visited in order so every group comes out sorted
+	U32 idxFirst = cellgroups.size();
+	cellgroups.resize(idxFirst + ctParts);
+	for(U32 i=0; i < vLabels.size(); i++)
+		cellgroups[idxFirst + vLabels[i]].push_back(i);
 
 	return cellgroups.size();
 }
 
+U32 VolMesh::update_cell_parts() {
+	return m_parts.update(this);
+}
+
 void VolMesh::printParts() {
 
 	vector<vector<U32>> parts;
@@ -1021,9 +1122,10 @@ void VolMesh::remove_face(U32 idxFace) {
 //	for(set<U32>::const_iterator it = outsetCells.begin(); it != outsetCells.end(); it++)
 //		remove_cell_core(*it);
 
-	//remove all incident cells
+	//remove all incident cells. Higher handles first since every removal shifts the ones above it.
 	vector<U32> vCellsToDelete;
-	vCellsToDelete.assign(m_incident_cells_per_face[idxFace].begin(), m_incident_cells_per_face[idxFace].end());
+	vCellsToDelete.assign(m_incident_cells_per_face.begin(idxFace), m_incident_cells_per_face.end(idxFace));
+	std::sort(vCellsToDelete.begin(), vCellsToDelete.end(), std::greater<U32>());
 	for(U32 i=0; i < vCellsToDelete.size(); i++) {
 		if(isCellIndex(vCellsToDelete[i]))
 			remove_cell_core(vCellsToDelete[i]);
@@ -1034,19 +1136,20 @@ void VolMesh::remove_face(U32 idxFace) {
 }
 
 void VolMesh::remove_edge(U32 idxEdge) {
+	ArenaScope scope(m_scratch);
 	vector<U32> vedges;
 	vedges.push_back(idxEdge);
 
 	//get incident faces to the input edge
-	set<U32> outsetFaces;
+	ScratchSet outsetFaces(scratchAlloc());
 	get_incident_faces(vedges, outsetFaces);
 
 	//get incident cells to the outset faces
-	set<U32> outsetCells;
+	ScratchSet outsetCells(scratchAlloc());
 	get_incident_cells(outsetFaces, outsetCells);
 
 	//delete cells
-	for(std::set<U32>::const_reverse_iterator c_it = outsetCells.rbegin(),
+	for(ScratchSet::const_reverse_iterator c_it = outsetCells.rbegin(),
 	    c_end = outsetCells.rend(); c_it != c_end; ++c_it ) {
 
 		//remove cell
@@ -1054,7 +1157,7 @@ void VolMesh::remove_edge(U32 idxEdge) {
 	}
 
 	//delete faces
-	for(std::set<U32>::const_reverse_iterator f_it = outsetFaces.rbegin(),
+	for(ScratchSet::const_reverse_iterator f_it = outsetFaces.rbegin(),
 	    c_end = outsetFaces.rend(); f_it != c_end; ++f_it ) {
 
 		//remove face
@@ -1065,23 +1168,24 @@ void VolMesh::remove_edge(U32 idxEdge) {
 }
 
 void VolMesh::remove_node(U32 idxNode) {
+	ArenaScope scope(m_scratch);
 	vector<U32> vnodes;
 	vnodes.push_back(idxNode);
 
 	//get incident edges
-	set<U32> outsetEdges;
+	ScratchSet outsetEdges(scratchAlloc());
 	get_incident_edges(vnodes, outsetEdges);
 
 	//get incident faces
-	set<U32> outsetFaces;
+	ScratchSet outsetFaces(scratchAlloc());
 	get_incident_faces(outsetEdges, outsetFaces);
 
 	//get incident cells
-	set<U32> outsetCells;
+	ScratchSet outsetCells(scratchAlloc());
 	get_incident_cells(outsetFaces, outsetCells);
 
 	//delete cells
-	for(std::set<U32>::const_reverse_iterator c_it = outsetCells.rbegin(),
+	for(ScratchSet::const_reverse_iterator c_it = outsetCells.rbegin(),
 	    c_end = outsetCells.rend(); c_it != c_end; ++c_it ) {
 
 		//remove cell
@@ -1089,7 +1193,7 @@ void VolMesh::remove_node(U32 idxNode) {
 	}
 
 	//delete faces
-	for(std::set<U32>::const_reverse_iterator f_it = outsetFaces.rbegin(),
+	for(ScratchSet::const_reverse_iterator f_it = outsetFaces.rbegin(),
 	    c_end = outsetFaces.rend(); f_it != c_end; ++f_it ) {
 
 		//remove face
@@ -1097,7 +1201,7 @@ void VolMesh::remove_node(U32 idxNode) {
 	}
 
 	//delete edges
-	for(std::set<U32>::const_reverse_iterator e_it = outsetEdges.rbegin(),
+	for(ScratchSet::const_reverse_iterator e_it = outsetEdges.rbegin(),
 	    e_end = outsetEdges.rend(); e_it != e_end; ++e_it ) {
 
 		//remove edge
@@ -1111,10 +1215,13 @@ void VolMesh::remove_node(U32 idxNode) {
 
 
 U32 VolMesh::insert_node(const NODE& n) {
-	m_vNodes.push_back(n);
+	m_nodes.push_back(n);
 	m_incident_edges_per_node.resize(countNodes());
+	m_incident_cells_per_node.resize(countNodes());
 
-	return countNodes() - 1;
+	U32 idxNode = countNodes() - 1;
+	notifyNodeEvent(idxNode, teAdded);
+	return idxNode;
 }
 
 U32 VolMesh::insert_edge(const EDGE& e) {
@@ -1126,13 +1233,14 @@ U32 VolMesh::insert_edge(const EDGE& e) {
 	U32 idxEdge = countEdges() - 1;
 
 	//update incident edges per vertex
-	m_incident_edges_per_node[e.from].push_back(idxEdge);
-	m_incident_edges_per_node[e.to].push_back(idxEdge);
+	m_incident_edges_per_node.push_back(e.from, idxEdge);
+	m_incident_edges_per_node.push_back(e.to, idxEdge);
 
 
 	//insert the forward halfedge into map
 	insertEdgeIndexToMap(e.from, e.to, idxEdge);
 
+	notifyEdgeEvent(idxEdge, teAdded);
 	return idxEdge;
 }
 
@@ -1154,9 +1262,9 @@ U32 VolMesh::insert_face(U32 nodes[3]) {
 		to = nodes[(e + 1) % 3];
 
 		EdgeKey key(from, to);
-		MAPHEDGEINDEXITER it = m_mapEdgesIndex.find(key);
-		if (it != m_mapEdgesIndex.end()) {
-			face.edges[e] = it->second;
+		const U32* pidxEdge = m_hashEdgesIndex.find(key.key);
+		if (pidxEdge) {
+			face.edges[e] = *pidxEdge;
 		}
 		else {
 			LogErrorArg2("Setting face edges failed! Unable to find edge <%d, %d>",
@@ -1173,8 +1281,10 @@ U32 VolMesh::insert_face(U32 nodes[3]) {
 
 	//update
 	for(int i=0; i < COUNT_FACE_EDGES; i++)
-		m_incident_faces_per_edge[face.edges[i]].push_back(idxFace);
+		m_incident_faces_per_edge.push_back(face.edges[i], idxFace);
+	insertFaceIndexToMap(idxFace);
 
+	notifyFaceEvent(idxFace, teAdded);
 	return idxFace;
 }
 
@@ -1183,11 +1293,42 @@ void VolMesh::garbage_collection() {
 	ProfileAutoArg("gc");
 
 	//acquire lock to mesh
-	//if(m_verbose)
-	printf("GC BEGIN\n");
+	if(m_verbose)
+		LogInfo("GC BEGIN");
 
-	//1.delete all pending cells
 	U32 ctRemovedCells = 0;
+	U32 ctRemovedFaces = 0;
+	U32 ctRemovedEdges = 0;
+	U32 ctRemovedNodes = 0;
+
+	if(m_gcPolicy == gcpDeferredCompaction)
+		gc_deferred_compaction(ctRemovedCells, ctRemovedFaces, ctRemovedEdges, ctRemovedNodes);
+	else
+		gc_erase_in_place(ctRemovedCells, ctRemovedFaces, ctRemovedEdges, ctRemovedNodes);
+
+	//lists touched by the last cut live in the overflow area
+	compactIncidence();
+
+	psLog(EventLogger::etInfo, __FILE__, __LINE__, "garbage collection removed: Cells# %u, Faces# %u, Edges# %u, Nodes# %u",
+			ctRemovedCells, ctRemovedFaces, ctRemovedEdges, ctRemovedNodes);
+
+	//entities added by the last cut are at the end of the containers
+	if(m_reorderAfterGC != sfcNone && ctRemovedCells + ctRemovedFaces + ctRemovedEdges + ctRemovedNodes > 0)
+		reorder(m_reorderAfterGC);
+
+	//release lock
+//	test_cells_topology();
+//	test_incidents();
+
+	if(m_verbose)
+		LogInfo("GC END");
+}
+
+void VolMesh::gc_erase_in_place(U32& ctRemovedCells, U32& ctRemovedFaces, U32& ctRemovedEdges, U32& ctRemovedNodes) {
+	ArenaScope scope(m_scratch);
+
+	//1.delete all pending cells
+	ctRemovedCells = 0;
 	{
 		ProfileAutoArg("gc:cells");
 		if(m_pendingToDeleteCells.size() > 0) {
@@ -1199,12 +1340,12 @@ void VolMesh::garbage_collection() {
 
 	//2.faces
 	//most expensive
-	U32 ctRemovedFaces = 0;
+	ctRemovedFaces = 0;
 	{
 		ProfileAutoArg("gc:faces");
-		std::set<U32> setToBeRemoved;
+		ScratchSet setToBeRemoved(scratchAlloc());
 		for(U32 i = 0; i < countFaces(); i++) {
-			if(m_incident_cells_per_face[i].size() == 0) {
+			if(m_incident_cells_per_face.count(i) == 0) {
 				setToBeRemoved.insert(i);
 
 				if(m_verbose)
@@ -1219,12 +1360,12 @@ void VolMesh::garbage_collection() {
 
 
 	//3.edges
-	U32 ctRemovedEdges = 0;
+	ctRemovedEdges = 0;
 	{
 		ProfileAutoArg("gc:edges");
-		std::set<U32> setToBeRemoved;
+		ScratchSet setToBeRemoved(scratchAlloc());
 		for(U32 i = 0; i < countEdges(); i++) {
-			if(m_incident_faces_per_edge[i].size() == 0) {
+			if(m_incident_faces_per_edge.count(i) == 0) {
 				setToBeRemoved.insert(i);
 
 				if(m_verbose)
@@ -1239,12 +1380,12 @@ void VolMesh::garbage_collection() {
 
 
 	//4.nodes
-	U32 ctRemovedNodes = 0;
+	ctRemovedNodes = 0;
 	{
 		ProfileAutoArg("gc:nodes");
-		std::set<U32> setToBeRemoved;
+		ScratchSet setToBeRemoved(scratchAlloc());
 		for(U32 i = 0; i < countNodes(); i++) {
-			if(m_incident_edges_per_node[i].size() == 0) {
+			if(m_incident_edges_per_node.count(i) == 0) {
 				setToBeRemoved.insert(i);
 
 				if(m_verbose)
@@ -1256,17 +1397,351 @@ void VolMesh::garbage_collection() {
 		remove_nodes(setToBeRemoved);
 		ctRemovedNodes = setToBeRemoved.size();
 	}
+}
 
+//compacts a container by moving all live entries to their new handles
+template <typename T>
+static void CompactByRemap(vector<T>& container, const vector<U32>& remap, U32 ctAlive) {
+	for(U32 i=0; i < remap.size(); i++) {
+		if(remap[i] != VolMesh::INVALID_INDEX && remap[i] != i)
+			std::swap(container[remap[i]], container[i]);
+	}
+	container.resize(ctAlive);
+}
 
-	printf("garbage collection removed: Cells# %u, Faces# %u, Edges# %u, Nodes# %u\n",
-			ctRemovedCells, ctRemovedFaces, ctRemovedEdges, ctRemovedNodes);
+//moves stride entries from i to remap[i] for a one to one remap
+template <typename T>
+static void PermuteByRemap(vector<T>& container, const vector<U32>& remap, U32 ctAfter, U32 stride = 1) {
+	vector<T> vMoved(ctAfter * stride);
+	for(U32 i=0; i < remap.size(); i++) {
+		if(remap[i] == VolMesh::INVALID_INDEX)
+			continue;
+		for(U32 j=0; j < stride; j++)
+			vMoved[remap[i] * stride + j] = container[i * stride + j];
+	}
+	container.swap(vMoved);
+}
 
-	//release lock
-//	test_cells_topology();
-//	test_incidents();
+//builds the old to new handle table from the dead flags
+static U32 ComputeRemap(const vector<U8>& dead, vector<U32>& remap) {
+	remap.resize(dead.size());
+	U32 ctAlive = 0;
+	for(U32 i=0; i < dead.size(); i++) {
+		if(dead[i])
+			remap[i] = VolMesh::INVALID_INDEX;
+		else
+			remap[i] = ctAlive++;
+	}
+	return ctAlive;
+}
+
+void VolMesh::gc_deferred_compaction(U32& ctRemovedCells, U32& ctRemovedFaces, U32& ctRemovedEdges, U32& ctRemovedNodes) {
 
-	//if(m_verbose)
-	printf("GC END\n");
+	//1.Mark all dead entities. Dead cells are un-registered from their faces so that
+	//the faces, edges and nodes they leave behind are caught in the same sweep.
+	vector<U8> vDeadCells(countCells(), 0);
+	vector<U8> vDeadFaces(countFaces(), 0);
+	vector<U8> vDeadEdges(countEdges(), 0);
+	vector<U8> vDeadNodes(countNodes(), 0);
+
+	ctRemovedCells = ctRemovedFaces = ctRemovedEdges = ctRemovedNodes = 0;
+	{
+		ProfileAutoArg("gc:mark");
+
+		//cells
+		for(U32 i=0; i < m_pendingToDeleteCells.size(); i++) {
+			U32 idxCell = m_pendingToDeleteCells[i];
+			if(!isCellIndex(idxCell) || vDeadCells[idxCell])
+				continue;
+
+			vDeadCells[idxCell] = 1;
+			ctRemovedCells++;
+
+			const CELL& cell = const_cellAt(idxCell);
+			for(int j=0; j < COUNT_CELL_FACES; j++) {
+				if(!isFaceIndex(cell.faces[j]))
+					continue;
+
+				m_incident_cells_per_face.remove(cell.faces[j], idxCell);
+				linkFaceNeighbors(cell.faces[j]);
+			}
+			for(int j=0; j < COUNT_CELL_NODES; j++) {
+				if(isNodeIndex(cell.nodes[j]))
+					m_incident_cells_per_node.remove(cell.nodes[j], idxCell);
+			}
+		}
+		m_pendingToDeleteCells.resize(0);
+
+		//faces
+		for(U32 i=0; i < countFaces(); i++) {
+			if(m_incident_cells_per_face.count(i) > 0)
+				continue;
+
+			vDeadFaces[i] = 1;
+			ctRemovedFaces++;
+
+			const FACE& face = const_faceAt(i);
+			for(int j=0; j < COUNT_FACE_EDGES; j++) {
+				if(!isEdgeIndex(face.edges[j]))
+					continue;
+
+				m_incident_faces_per_edge.remove(face.edges[j], i);
+			}
+		}
+
+		//edges
+		for(U32 i=0; i < countEdges(); i++) {
+			if(m_incident_faces_per_edge.count(i) > 0)
+				continue;
+
+			vDeadEdges[i] = 1;
+			ctRemovedEdges++;
+
+			const EDGE& edge = const_edgeAt(i);
+			U32 nodes[2] = {edge.from, edge.to};
+			for(int j=0; j < 2; j++) {
+				if(!isNodeIndex(nodes[j]))
+					continue;
+
+				m_incident_edges_per_node.remove(nodes[j], i);
+			}
+		}
+
+		//nodes
+		for(U32 i=0; i < countNodes(); i++) {
+			if(m_incident_edges_per_node.count(i) > 0)
+				continue;
+
+			vDeadNodes[i] = 1;
+			ctRemovedNodes++;
+		}
+	}
+
+	if(ctRemovedCells + ctRemovedFaces + ctRemovedEdges + ctRemovedNodes == 0)
+		return;
+
+	//2.Fire removal events in decreasing handle order. The handles reported
+	//are identical to the ones reported by erasing in place.
+	for(int i = (int)countCells() - 1; i >= 0; i--)
+		if(vDeadCells[i])
+			notifyElemEvent(i, teRemoved);
+	for(int i = (int)countFaces() - 1; i >= 0; i--)
+		if(vDeadFaces[i])
+			notifyFaceEvent(i, teRemoved);
+	for(int i = (int)countEdges() - 1; i >= 0; i--)
+		if(vDeadEdges[i])
+			notifyEdgeEvent(i, teRemoved);
+	for(int i = (int)countNodes() - 1; i >= 0; i--)
+		if(vDeadNodes[i])
+			notifyNodeEvent(i, teRemoved);
+
+	//3.Compact: one remap table per entity type and a single pass over every handle array
+	{
+		ProfileAutoArg("gc:compact");
+
+		vector<U32> vCellRemap, vFaceRemap, vEdgeRemap, vNodeRemap;
+		U32 ctCells = ComputeRemap(vDeadCells, vCellRemap);
+		U32 ctFaces = ComputeRemap(vDeadFaces, vFaceRemap);
+		U32 ctEdges = ComputeRemap(vDeadEdges, vEdgeRemap);
+		U32 ctNodes = ComputeRemap(vDeadNodes, vNodeRemap);
+
+		//entities
+		CompactByRemap(m_vCells, vCellRemap, ctCells);
+		CompactByRemap(m_vFaces, vFaceRemap, ctFaces);
+		CompactByRemap(m_vEdges, vEdgeRemap, ctEdges);
+		m_nodes.compactByRemap(vNodeRemap, ctNodes);
+
+		//bottom-up lists
+		m_incident_cells_per_face.compactByRemap(vFaceRemap, ctFaces);
+		m_incident_faces_per_edge.compactByRemap(vEdgeRemap, ctEdges);
+		m_incident_edges_per_node.compactByRemap(vNodeRemap, ctNodes);
+		m_incident_cells_per_node.compactByRemap(vNodeRemap, ctNodes);
+
+		//neighbor slots move with their cells
+		for(U32 i=0; i < vCellRemap.size(); i++) {
+			U32 idxNew = vCellRemap[i];
+			if(idxNew == INVALID_INDEX || idxNew == i)
+				continue;
+			for(int j=0; j < COUNT_CELL_FACES; j++)
+				m_vCellNeighbors[idxNew * COUNT_CELL_FACES + j] = m_vCellNeighbors[i * COUNT_CELL_FACES + j];
+		}
+		m_vCellNeighbors.resize(ctCells * COUNT_CELL_FACES);
+
+		//rewrite handles
+		remapHandles(vCellRemap, vFaceRemap, vEdgeRemap, vNodeRemap);
+	}
+}
+
+void VolMesh::remapHandles(const vector<U32>& vCellRemap, const vector<U32>& vFaceRemap,
+						   const vector<U32>& vEdgeRemap, const vector<U32>& vNodeRemap) {
+	HandleRemap cellRemapper(vCellRemap);
+	HandleRemap faceRemapper(vFaceRemap);
+	HandleRemap edgeRemapper(vEdgeRemap);
+	HandleRemap nodeRemapper(vNodeRemap);
+
+	for(U32 i=0; i < countCells(); i++) {
+		CELL& cell = m_vCells[i];
+		for(int j=0; j < COUNT_CELL_NODES; j++)
+			nodeRemapper.remapValue(cell.nodes[j]);
+		for(int j=0; j < COUNT_CELL_FACES; j++)
+			faceRemapper.remapValue(cell.faces[j]);
+		for(int j=0; j < COUNT_CELL_EDGES; j++)
+			edgeRemapper.remapValue(cell.edges[j]);
+	}
+
+	for(U32 i=0; i < countFaces(); i++) {
+		FACE& face = m_vFaces[i];
+		for(int j=0; j < COUNT_FACE_EDGES; j++)
+			edgeRemapper.remapValue(face.edges[j]);
+	}
+
+	for(U32 i=0; i < countEdges(); i++) {
+		nodeRemapper.remapValue(m_vEdges[i].from);
+		nodeRemapper.remapValue(m_vEdges[i].to);
+	}
+
+	m_incident_cells_per_face.for_each_value(
+				  std::bind(&HandleRemap::remapValue, &cellRemapper, std::placeholders::_1));
+	m_incident_cells_per_node.for_each_value(
+				  std::bind(&HandleRemap::remapValue, &cellRemapper, std::placeholders::_1));
+	cellRemapper.remapVecValue(m_vCellNeighbors);
+	cellRemapper.remapVecValue(m_pendingToDeleteCells);
+	m_incident_faces_per_edge.for_each_value(
+				  std::bind(&HandleRemap::remapValue, &faceRemapper, std::placeholders::_1));
+	m_incident_edges_per_node.for_each_value(
+				  std::bind(&HandleRemap::remapValue, &edgeRemapper, std::placeholders::_1));
+
+	//edge keys are built from node handles and face keys from edge handles
+	m_hashEdgesIndex.clear();
+	for(U32 i=0; i < countEdges(); i++)
+		insertEdgeIndexToMap(m_vEdges[i].from, m_vEdges[i].to, i);
+	m_isFacesIndexDirty = true;
+}
+
+//key of a point along the curve on a grid anchored at lo
+static U64 ComputeCurveKey(VolMesh::SpaceFillingCurve curve, const vec3d& p, const vec3d& lo, double scale) {
+	const double maxCoord = (double)((1 << SFC_BITS_PER_AXIS) - 1);
+	double v[3] = {(p.x - lo.x) * scale, (p.y - lo.y) * scale, (p.z - lo.z) * scale};
+
+	U32 q[3];
+	for(int i=0; i < 3; i++) {
+		Clamp<double>(v[i], 0.0, maxCoord);
+		q[i] = (U32)v[i];
+	}
+
+	if(curve == VolMesh::sfcMorton)
+		return MortonKey3(q[0], q[1], q[2]);
+	return HilbertKey3(q[0], q[1], q[2]);
+}
+
+//old to new handles that sort the keys. Equal keys keep their handle order.
+static void ComputeKeyOrder(const vector<U64>& vKeys, vector<U32>& remap) {
+	vector< pair<U64, U32> > vSorted(vKeys.size());
+	for(U32 i=0; i < vKeys.size(); i++)
+		vSorted[i] = std::make_pair(vKeys[i], i);
+	std::sort(vSorted.begin(), vSorted.end());
+
+	remap.resize(vKeys.size());
+	for(U32 i=0; i < vSorted.size(); i++)
+		remap[vSorted[i].second] = i;
+}
+
+bool VolMesh::reorder(SpaceFillingCurve curve) {
+	vec3d lo, hi;
+	if(curve == sfcNone || countCells() == 0 || !m_nodes.bounds(lo, hi))
+		return false;
+
+	ProfileAutoArg("reorder");
+
+	//one scale for all axes keeps the curve cells cubic
+	vec3d ext = hi - lo;
+	double maxExt = MATHMAX(MATHMAX(ext.x, ext.y), ext.z);
+	double scale = (maxExt > 0.0) ? (double)((1 << SFC_BITS_PER_AXIS) - 1) / maxExt : 0.0;
+
+	const U32 ctCells = countCells();
+	const U32 ctFaces = countFaces();
+	const U32 ctEdges = countEdges();
+	const U32 ctNodes = countNodes();
+
+	//nodes and cells along the curve
+	vector<U32> vNodeRemap, vCellRemap;
+	{
+		vector<U64> vKeys(ctNodes);
+		parallel_for(blocked_range<U32>(0, ctNodes), [&](const blocked_range<U32>& r) {
+			for(U32 i = r.begin(); i != r.end(); i++)
+				vKeys[i] = ComputeCurveKey(curve, nodePos(i), lo, scale);
+		});
+		ComputeKeyOrder(vKeys, vNodeRemap);
+
+		vKeys.resize(ctCells);
+		parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+			for(U32 i = r.begin(); i != r.end(); i++)
+				vKeys[i] = ComputeCurveKey(curve, computeCellCentroid(i), lo, scale);
+		});
+		ComputeKeyOrder(vKeys, vCellRemap);
+	}
+
+	//faces and edges in the order the renumbered cells use them first
+	vector<U32> vFaceRemap(ctFaces, INVALID_INDEX);
+	vector<U32> vEdgeRemap(ctEdges, INVALID_INDEX);
+	{
+		vector<U32> vCellOrder(ctCells);
+		for(U32 i=0; i < ctCells; i++)
+			vCellOrder[vCellRemap[i]] = i;
+
+		U32 ctNextFace = 0;
+		U32 ctNextEdge = 0;
+		for(U32 i=0; i < ctCells; i++) {
+			const CELL& cell = const_cellAt(vCellOrder[i]);
+			for(int j=0; j < COUNT_CELL_FACES; j++) {
+				if(isFaceIndex(cell.faces[j]) && vFaceRemap[cell.faces[j]] == INVALID_INDEX)
+					vFaceRemap[cell.faces[j]] = ctNextFace++;
+			}
+			for(int j=0; j < COUNT_CELL_EDGES; j++) {
+				if(isEdgeIndex(cell.edges[j]) && vEdgeRemap[cell.edges[j]] == INVALID_INDEX)
+					vEdgeRemap[cell.edges[j]] = ctNextEdge++;
+			}
+		}
+
+		//entities no cell uses until the next gc keep their order at the end
+		for(U32 i=0; i < ctFaces; i++)
+			if(vFaceRemap[i] == INVALID_INDEX)
+				vFaceRemap[i] = ctNextFace++;
+		for(U32 i=0; i < ctEdges; i++)
+			if(vEdgeRemap[i] == INVALID_INDEX)
+				vEdgeRemap[i] = ctNextEdge++;
+	}
+
+	//entities
+	PermuteByRemap(m_vCells, vCellRemap, ctCells);
+	PermuteByRemap(m_vFaces, vFaceRemap, ctFaces);
+	PermuteByRemap(m_vEdges, vEdgeRemap, ctEdges);
+	m_nodes.permute(vNodeRemap);
+
+	//bottom-up lists and neighbor slots
+	m_incident_cells_per_face.compactByRemap(vFaceRemap, ctFaces);
+	m_incident_faces_per_edge.compactByRemap(vEdgeRemap, ctEdges);
+	m_incident_edges_per_node.compactByRemap(vNodeRemap, ctNodes);
+	m_incident_cells_per_node.compactByRemap(vNodeRemap, ctNodes);
+	PermuteByRemap(m_vCellNeighbors, vCellRemap, ctCells, COUNT_CELL_FACES);
+
+	remapHandles(vCellRemap, vFaceRemap, vEdgeRemap, vNodeRemap);
+
+	//entities picked for display
+	if(isCellIndex(m_elemToShow))
+		m_elemToShow = vCellRemap[m_elemToShow];
+	if(isNodeIndex(m_nodeToShow))
+		m_nodeToShow = vNodeRemap[m_nodeToShow];
+
+	m_vNodePermutation.swap(vNodeRemap);
+	m_vCellPermutation.swap(vCellRemap);
+
+	notifyElemEvent(INVALID_INDEX, teRenumbered);
+	notifyFaceEvent(INVALID_INDEX, teRenumbered);
+	notifyEdgeEvent(INVALID_INDEX, teRenumbered);
+	notifyNodeEvent(INVALID_INDEX, teRenumbered);
+
+	return true;
 }
 
 bool VolMesh::getFaceNodes(U32 idxFace, U32 (&nodes)[3]) const {
@@ -1275,22 +1750,19 @@ bool VolMesh::getFaceNodes(U32 idxFace, U32 (&nodes)[3]) const {
 
 	const FACE& face = const_faceAt(idxFace);
 
-	std::set<U32> setFaceNodes;
+	//distinct nodes in increasing order
+	U32 arrNodes[6];
 	for(int i=0; i < 3; i++) {
-		setFaceNodes.insert(edge_from_node(face.edges[i]));
-		setFaceNodes.insert(edge_to_node(face.edges[i]));
+		arrNodes[i * 2] = edge_from_node(face.edges[i]);
+		arrNodes[i * 2 + 1] = edge_to_node(face.edges[i]);
 	}
+	std::sort(arrNodes, arrNodes + 6);
+	U32 ctNodes = std::unique(arrNodes, arrNodes + 6) - arrNodes;
 
-	int i = 0;
-	for(std::set<U32>::const_iterator it = setFaceNodes.begin(); it != setFaceNodes.end(); ++it) {
-		nodes[i] = *it;
-		i++;
+	for(U32 i=0; i < COUNT_FACE_EDGES && i < ctNodes; i++)
+		nodes[i] = arrNodes[i];
 
-		if(i == COUNT_FACE_EDGES)
-			break;
-	}
-
-	return (setFaceNodes.size() == COUNT_FACE_EDGES);
+	return (ctNodes == COUNT_FACE_EDGES);
 }
 
 bool VolMesh::isNodeOfCell(U32 idxNode, U32 idxCell) const {
@@ -1320,9 +1792,9 @@ bool VolMesh::isEdgeOfCell(U32 idxEdge, U32 idxCell) const {
 		return false;
 
 	EdgeKey key(edge.from, edge.to);
-	MAPHEDGEINDEXCONSTITER it = m_mapEdgesIndex.find(key);
-	if(it != m_mapEdgesIndex.end())
-		if(it->second != idxEdge)
+	const U32* pidxEdge = m_hashEdgesIndex.find(key.key);
+	if(pidxEdge)
+		if(*pidxEdge != idxEdge)
 			return false;
 
 	return true;
@@ -1344,9 +1816,16 @@ EDGE& VolMesh::edgeAt(U32 i) {
 	return m_vEdges[i];
 }
 
-NODE& VolMesh::nodeAt(U32 i) {
+void VolMesh::setNode(U32 i, const NODE& n) {
+	assert(isNodeIndex(i));
+	m_nodes.set(i, n);
+	m_nodeGrid.nodeMoved(i, n.pos);
+}
+
+void VolMesh::setNodePos(U32 i, const vec3d& p) {
 	assert(isNodeIndex(i));
-	return m_vNodes[i];
+	m_nodes.setPos(i, p);
+	m_nodeGrid.nodeMoved(i, p);
 }
 
 
@@ -1380,33 +1859,57 @@ U32 VolMesh::edge_to_node(U32 idxEdge) const {
 U32 VolMesh::countIncidentCells(U32 idxFace) const {
 	if(!isFaceIndex(idxFace))
 		return 0;
-	return m_incident_cells_per_face[idxFace].size();
+	return m_incident_cells_per_face.count(idxFace);
 }
 
 U32 VolMesh::countIncidentFaces(U32 idxEdge) const {
 	if(!isEdgeIndex(idxEdge))
 		return 0;
-	return m_incident_faces_per_edge[idxEdge].size();
+	return m_incident_faces_per_edge.count(idxEdge);
 
 }
 
 U32 VolMesh::countIncidentEdges(U32 idxNode) const {
 	if(!isNodeIndex(idxNode))
 		return 0;
-	return m_incident_edges_per_node[idxNode].size();
+	return m_incident_edges_per_node.count(idxNode);
+}
+
+
+void VolMesh::compactIncidence() {
+	ProfileAutoArg("compactIncidence");
+	m_incident_edges_per_node.compact();
+	m_incident_faces_per_edge.compact();
+	m_incident_cells_per_face.compact();
+	m_incident_cells_per_node.compact();
+}
+
+U64 VolMesh::getIncidenceMemoryUsage() const {
+	return m_incident_edges_per_node.memoryUsage() +
+		   m_incident_faces_per_edge.memoryUsage() +
+		   m_incident_cells_per_face.memoryUsage() +
+		   m_incident_cells_per_node.memoryUsage() +
+		   m_vCellNeighbors.capacity() * sizeof(U32);
 }
 
+void VolMesh::setFlagPackedIncidence(bool flag) {
+	m_flagPackedIncidence = flag;
+	m_incident_edges_per_node.setPacked(flag);
+	m_incident_faces_per_edge.setPacked(flag);
+	m_incident_cells_per_face.setPacked(flag);
+	m_incident_cells_per_node.setPacked(flag);
+}
 
 U32 VolMesh::get_node_neighbors(U32 idxNode, vector<U32>& nbors) const {
 	assert(isNodeIndex(idxNode));
 
-	vector<U32> edges;
-	edges.assign(m_incident_edges_per_node[idxNode].begin(), m_incident_edges_per_node[idxNode].end());
+	IncidenceTable::const_iterator edges = m_incident_edges_per_node.begin(idxNode);
+	U32 ctEdges = m_incident_edges_per_node.count(idxNode);
 
-	nbors.reserve(edges.size());
-	for(U32 i=0; i < edges.size(); i++) {
+	nbors.reserve(ctEdges);
+	for(U32 i=0; i < ctEdges; i++) {
 
-		const EDGE& e = const_edgeAt(i);
+		const EDGE& e = const_edgeAt(edges[i]);
 		if(e.from == idxNode)
 			nbors.push_back(e.to);
 		else if(e.to == idxNode)
@@ -1416,9 +1919,9 @@ U32 VolMesh::get_node_neighbors(U32 idxNode, vector<U32>& nbors) const {
 	return nbors.size();
 }
 
-const NODE& VolMesh::const_nodeAt(U32 i) const {
+NODE VolMesh::const_nodeAt(U32 i) const {
 	assert(isNodeIndex(i));
-	return m_vNodes[i];
+	return m_nodes.get(i);
 }
 
 void VolMesh::displace(U32 countDegreesOfFreedom, const double * u) {
@@ -1431,10 +1934,9 @@ void VolMesh::displace(U32 countDegreesOfFreedom, const double * u) {
 		return;
 	}
 
-	for(U32 i=0; i < countNodes(); i++) {
-		m_vNodes[i].pos = m_vNodes[i].restpos + vec3d(&u[i * 3]);
-	}
+	m_nodes.displace(u);
 
+	notifyNodeEvent(INVALID_INDEX, teUpdated);
 	computeAABB();
 }
 
@@ -1450,19 +1952,13 @@ bool VolMesh::insertEdgeIndexToMap(U32 from, U32 to, U32 idxEdge) {
 	}
 
 	EdgeKey key(from, to);
-	m_mapEdgesIndex.insert( std::make_pair( key, idxEdge) );
+	m_hashEdgesIndex.insert(key.key, idxEdge);
 	return true;
 }
 
 bool VolMesh::removeEdgeIndexFromMap(U32 from, U32 to) {
 	EdgeKey key(from, to);
-	MAPHEDGEINDEXITER it = m_mapEdgesIndex.find(key);
-	if(it == m_mapEdgesIndex.end())
-		return false;
-	else {
-		m_mapEdgesIndex.erase(it);
-		return true;
-	}
+	return m_hashEdgesIndex.erase(key.key);
 }
 
 EdgeKey VolMesh::computeEdgeKey(U32 idxEdge) const {
@@ -1480,9 +1976,9 @@ bool VolMesh::edge_exists(U32 from, U32 to) {
 
 U32 VolMesh::edge_handle(U32 from, U32 to) {
 	EdgeKey key(from, to);
-	MAPHEDGEINDEXITER it = m_mapEdgesIndex.find(key);
-	if(it != m_mapEdgesIndex.end())
-		return it->second;
+	const U32* pidxEdge = m_hashEdgesIndex.find(key.key);
+	if(pidxEdge)
+		return *pidxEdge;
 	else
 		return INVALID_INDEX;
 }
@@ -1501,10 +1997,26 @@ U32 VolMesh::face_handle_by_edges(U32 edges[3]) const {
 	assert(isEdgeIndex(edges[0]) && isEdgeIndex(edges[1]) && isEdgeIndex(edges[2]));
 	FaceKey query(&edges[0]);
 
-	vector<U32> facesIncidentToEdge0;
-	facesIncidentToEdge0.assign(m_incident_faces_per_edge[ edges[0] ].begin(), m_incident_faces_per_edge[ edges[0] ].end());
+	if(m_isFacesIndexDirty)
+		rebuildFacesIndex();
+
+	//the key packs 21 bits per edge so confirm the match on larger meshes
+	const U32* pidxFace = m_hashFacesIndex.find(query.key());
+	if(pidxFace) {
+		const FACE& face = const_faceAt(*pidxFace);
+		U32 a[3] = {face.edges[0], face.edges[1], face.edges[2]};
+		U32 b[3] = {edges[0], edges[1], edges[2]};
+		FaceKey::order_lo2hi(a[0], a[1], a[2]);
+		FaceKey::order_lo2hi(b[0], b[1], b[2]);
+		if(a[0] == b[0] && a[1] == b[1] && a[2] == b[2])
+			return *pidxFace;
+	}
+	else if(countEdges() <= FACE_BITMASK)
+		return INVALID_INDEX;
 
-	for(U32 i = 0; i < facesIncidentToEdge0.size(); i++) {
+	//fallback: scan the faces incident to edge0
+	IncidenceTable::const_iterator facesIncidentToEdge0 = m_incident_faces_per_edge.begin(edges[0]);
+	for(U32 i = 0; i < m_incident_faces_per_edge.count(edges[0]); i++) {
 
 		const FACE& face = const_faceAt(facesIncidentToEdge0[i]);
 		FaceKey faceKey(const_cast<U32 *>(&face.edges[0]));
@@ -1516,6 +2028,40 @@ U32 VolMesh::face_handle_by_edges(U32 edges[3]) const {
 	return INVALID_INDEX;
 }
 
+void VolMesh::insertFaceIndexToMap(U32 idxFace) {
+	if(m_isFacesIndexDirty)
+		return;
+
+	const FACE& face = const_faceAt(idxFace);
+	FaceKey key(const_cast<U32 *>(&face.edges[0]));
+	m_hashFacesIndex.insert(key.key(), idxFace);
+}
+
+void VolMesh::removeFaceIndexFromMap(U32 idxFace) {
+	if(m_isFacesIndexDirty)
+		return;
+
+	const FACE& face = const_faceAt(idxFace);
+	FaceKey key(const_cast<U32 *>(&face.edges[0]));
+
+	//only drop the entry if it belongs to this face
+	const U32* pidxFace = m_hashFacesIndex.find(key.key());
+	if(pidxFace && *pidxFace == idxFace)
+		m_hashFacesIndex.erase(key.key());
+}
+
+void VolMesh::rebuildFacesIndex() const {
+	m_hashFacesIndex.clear();
+	m_hashFacesIndex.reserve(countFaces());
+	for(U32 i=0; i < countFaces(); i++) {
+		const FACE& face = const_faceAt(i);
+		FaceKey key(const_cast<U32 *>(&face.edges[0]));
+		m_hashFacesIndex.insert(key.key(), i);
+	}
+
+	m_isFacesIndexDirty = false;
+}
+
 U32 VolMesh::face_handle_by_nodes(U32 nodes[3])  {
 
 	assert(isNodeIndex(nodes[0]) && isNodeIndex(nodes[1]) && isNodeIndex(nodes[2]));
@@ -1528,66 +2074,112 @@ U32 VolMesh::face_handle_by_nodes(U32 nodes[3])  {
 	return face_handle_by_edges(edges);
 }
 
-template <class ContainerT>
-int VolMesh::get_incident_cells(const ContainerT& in_faces, set<U32>& out_cells) const {
+void VolMesh::linkFaceNeighbors(U32 idxFace) {
+	IncidenceTable::const_iterator c_begin = m_incident_cells_per_face.begin(idxFace);
+	IncidenceTable::const_iterator c_end = m_incident_cells_per_face.end(idxFace);
+
+	//while a cut is in progress a face may hold a cell pending removal and its
+	//replacement. Each cell links to the most recent other one.
+	for(IncidenceTable::const_iterator c_it = c_begin; c_it != c_end; ++c_it) {
+		U32 idxOther = INVALID_INDEX;
+		for(IncidenceTable::const_iterator o_it = c_begin; o_it != c_end; ++o_it) {
+			if(*o_it != *c_it)
+				idxOther = *o_it;
+		}
+
+		const CELL& cell = const_cellAt(*c_it);
+		for(int i=0; i < COUNT_CELL_FACES; i++) {
+			if(cell.faces[i] == idxFace)
+				m_vCellNeighbors[*c_it * COUNT_CELL_FACES + i] = idxOther;
+		}
+	}
+}
+
+void VolMesh::buildCellAdjacency() {
+	const U32 ctCells = countCells();
+
+	//cells per node
+	vector<U32> vCapacity(countNodes(), 0);
+	for(U32 i=0; i < ctCells; i++)
+		for(int j=0; j < COUNT_CELL_NODES; j++)
+			vCapacity[m_vCells[i].nodes[j]]++;
+	m_incident_cells_per_node.reserve_lists(vCapacity);
+
+	for(U32 i=0; i < ctCells; i++)
+		for(int j=0; j < COUNT_CELL_NODES; j++)
+			m_incident_cells_per_node.push_back(m_vCells[i].nodes[j], i);
+
+	//face neighbors
+	m_vCellNeighbors.assign(ctCells * COUNT_CELL_FACES, INVALID_INDEX);
+	for(U32 i=0; i < ctCells; i++) {
+		const CELL& cell = m_vCells[i];
+		for(int j=0; j < COUNT_CELL_FACES; j++) {
+			for(IncidenceTable::const_iterator c_it = m_incident_cells_per_face.begin(cell.faces[j]),
+					c_end = m_incident_cells_per_face.end(cell.faces[j]); c_it != c_end; ++c_it) {
+				if(*c_it != i)
+					m_vCellNeighbors[i * COUNT_CELL_FACES + j] = *c_it;
+			}
+		}
+	}
+}
+
+template <class ContainerT, class SetT>
+int VolMesh::get_incident_cells(const ContainerT& in_faces, SetT& out_cells) const {
 
-	vector<U32> vTempCells;
 	for(typename ContainerT::const_iterator f_it = in_faces.begin(),
             f_end = in_faces.end(); f_it != f_end; ++f_it) {
 
-		vTempCells.assign(m_incident_cells_per_face[*f_it].begin(), m_incident_cells_per_face[*f_it].end());
-
-		for(U32 j=0; j < vTempCells.size(); j++) {
-			U32 idxCell = vTempCells[j];
-			if(isCellIndex(idxCell))
-				out_cells.insert(idxCell);
+		for(IncidenceTable::const_iterator c_it = m_incident_cells_per_face.begin(*f_it),
+				c_end = m_incident_cells_per_face.end(*f_it); c_it != c_end; ++c_it) {
+			if(isCellIndex(*c_it))
+				out_cells.insert(*c_it);
 		}
 	}
 
 	return (int)out_cells.size();
 }
 
-template <class ContainerT>
-int VolMesh::get_incident_faces(const ContainerT& in_edges, set<U32>& out_faces) const {
-	vector<U32> vTempFaces;
-
+template <class ContainerT, class SetT>
+int VolMesh::get_incident_faces(const ContainerT& in_edges, SetT& out_faces) const {
 	for(typename ContainerT::const_iterator e_it = in_edges.begin(),
             e_end = in_edges.end(); e_it != e_end; ++e_it) {
 
-		vTempFaces.assign(m_incident_faces_per_edge[*e_it].begin(), m_incident_faces_per_edge[*e_it].end());
-		for(U32 j=0; j < vTempFaces.size(); j++) {
-			U32 idxFace = vTempFaces[j];
-			if(isFaceIndex(idxFace))
-				out_faces.insert(idxFace);
+		for(IncidenceTable::const_iterator f_it = m_incident_faces_per_edge.begin(*e_it),
+				f_end = m_incident_faces_per_edge.end(*e_it); f_it != f_end; ++f_it) {
+			if(isFaceIndex(*f_it))
+				out_faces.insert(*f_it);
 		}
 	}
 
 	return (int)out_faces.size();
 }
 
-template <class ContainerT>
-int VolMesh::get_incident_edges(const ContainerT& in_nodes, set<U32>& out_edges) const {
-	vector<U32> vTempEdges;
+template <class ContainerT, class SetT>
+int VolMesh::get_incident_edges(const ContainerT& in_nodes, SetT& out_edges) const {
 	for(typename ContainerT::const_iterator n_it = in_nodes.begin(),
 	            n_end = in_nodes.end(); n_it != n_end; ++n_it) {
 
-		vTempEdges.assign(m_incident_edges_per_node[*n_it].begin(), m_incident_edges_per_node[*n_it].end());
-		for(U32 j=0; j < vTempEdges.size(); j++) {
-			U32 idxEdge = vTempEdges[j];
-			if(isNodeIndex(idxEdge))
-				out_edges.insert(idxEdge);
+		for(IncidenceTable::const_iterator e_it = m_incident_edges_per_node.begin(*n_it),
+				e_end = m_incident_edges_per_node.end(*n_it); e_it != e_end; ++e_it) {
+			if(isEdgeIndex(*e_it))
+				out_edges.insert(*e_it);
 		}
 	}
 
 	return (int)out_edges.size();
 }
 
+//instantiations used by derived meshes
+template int VolMesh::get_incident_cells(const set<U32>& in_faces, set<U32>& out_cells) const;
+template int VolMesh::get_incident_faces(const vector<U32>& in_edges, set<U32>& out_faces) const;
+
 template <class ContainerT>
 void VolMesh::remove_cells(const ContainerT& cells) {
 	if(cells.size() == 0)
 		return;
 
-	std::vector<U32> vToBeRemoved;
+	ArenaScope scope(m_scratch);
+	ScratchVector vToBeRemoved(scratchAlloc());
 	vToBeRemoved.resize(cells.size());
 	std::copy(cells.begin(), cells.end(), vToBeRemoved.begin());
 	std::sort(vToBeRemoved.begin(), vToBeRemoved.end(), std::greater<U32>());
@@ -1595,12 +2187,12 @@ void VolMesh::remove_cells(const ContainerT& cells) {
 	//print order
 	/*
 	printf("cells remove order: ");
-	for(std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
+	for(ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
 		printf("%u, ", *it);
 	printf("\n");
 	*/
 
-	for(std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
+	for(ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
 		remove_cell(*it);
 	}
 }
@@ -1610,22 +2202,21 @@ void VolMesh::remove_faces(const ContainerT& faces) {
 	if(faces.size() == 0)
 		return;
 
-	std::vector<U32> vToBeRemoved;
+	ArenaScope scope(m_scratch);
+	ScratchVector vToBeRemoved(scratchAlloc());
 	vToBeRemoved.resize(faces.size());
 	std::copy(faces.begin(), faces.end(), vToBeRemoved.begin());
 	std::sort(vToBeRemoved.begin(), vToBeRemoved.end(), std::greater<U32>());
 
 	//print order
 //	printf("faces remove order [count = %lu]: ", vToBeRemoved.size());
-//	for (std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
+//	for (ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
 //		printf("%u, ", *it);
 //	printf("\n");
 
-	for (std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
-		AnsiStr strMsg = printToAStr("Remove face %u", *it);
-		ProfileAutoArg(strMsg.cptr());
+	ProfileAutoArg("remove faces");
+	for (ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
 		remove_face(*it);
-	}
 
 }
 
@@ -1634,7 +2225,8 @@ void VolMesh::remove_edges(const ContainerT& edges) {
 	if(edges.size() == 0)
 		return;
 
-	std::vector<U32> vToBeRemoved;
+	ArenaScope scope(m_scratch);
+	ScratchVector vToBeRemoved(scratchAlloc());
 	vToBeRemoved.resize(edges.size());
 	std::copy(edges.begin(), edges.end(), vToBeRemoved.begin());
 	std::sort(vToBeRemoved.begin(), vToBeRemoved.end(), std::greater<U32>());
@@ -1642,12 +2234,12 @@ void VolMesh::remove_edges(const ContainerT& edges) {
 	//print order
 	/*
 	printf("edges remove order: ");
-	for (std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
+	for (ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
 		printf("%u, ", *it);
 	printf("\n");
 	*/
 
-	for (std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
+	for (ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
 		remove_edge(*it);
 	}
 }
@@ -1657,7 +2249,8 @@ void VolMesh::remove_nodes(const ContainerT& nodes) {
 	if(nodes.size() == 0)
 		return;
 
-	std::vector<U32> vToBeRemoved;
+	ArenaScope scope(m_scratch);
+	ScratchVector vToBeRemoved(scratchAlloc());
 	vToBeRemoved.resize(nodes.size());
 	std::copy(nodes.begin(), nodes.end(), vToBeRemoved.begin());
 	std::sort(vToBeRemoved.begin(), vToBeRemoved.end(), std::greater<U32>());
@@ -1665,12 +2258,12 @@ void VolMesh::remove_nodes(const ContainerT& nodes) {
 	//print order
 	/*
 	printf("nodes remove order: ");
-	for (std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
+	for (ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++)
 		printf("%u, ", *it);
 	printf("\n");
 	*/
 
-	for (std::vector<U32>::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
+	for (ScratchVector::const_iterator it = vToBeRemoved.begin(); it != vToBeRemoved.end(); it++) {
 		remove_node(*it);
 	}
 }
@@ -1683,8 +2276,8 @@ bool VolMesh::cut_edge(int idxEdge, double distance, U32* poutIndexNP0, U32* pou
 	U32 from = edge_from_node(idxEdge);
 	U32 to = edge_to_node(idxEdge);
 
-	const NODE& p0 = const_nodeAt(from);
-	const NODE& p1 = const_nodeAt(to);
+	NODE p0 = const_nodeAt(from);
+	NODE p1 = const_nodeAt(to);
 
 	//add two new points np0 and np1
 	NODE np0;
@@ -1720,10 +2313,28 @@ int VolMesh::getNodeIncidentEdges(U32 idxNode, vector<U32>& incidentEdges) const
 	if(!isNodeIndex(idxNode))
 		return 0;
 
-	incidentEdges.assign(m_incident_edges_per_node[idxNode].begin(), m_incident_edges_per_node[idxNode].end());
+	incidentEdges.assign(m_incident_edges_per_node.begin(idxNode), m_incident_edges_per_node.end(idxNode));
 	return (int)incidentEdges.size();
 }
 
+int VolMesh::getEdgeIncidentFaces(U32 idxEdge, vector<U32>& incidentFaces) const {
+
+	if(!isEdgeIndex(idxEdge))
+		return 0;
+
+	incidentFaces.assign(m_incident_faces_per_edge.begin(idxEdge), m_incident_faces_per_edge.end(idxEdge));
+	return (int)incidentFaces.size();
+}
+
+int VolMesh::getNodeIncidentCells(U32 idxNode, vector<U32>& incidentCells) const {
+
+	if(!isNodeIndex(idxNode))
+		return 0;
+
+	incidentCells.assign(m_incident_cells_per_node.begin(idxNode), m_incident_cells_per_node.end(idxNode));
+	return (int)incidentCells.size();
+}
+
 int VolMesh::getNodeIncidentNodes(U32 idxNode, vector<U32>& incidentNodes) const {
 	vector<U32> edges;
 	getNodeIncidentEdges(idxNode, edges);
@@ -1839,10 +2450,8 @@ void VolMesh::draw() {
 		glPointSize(3.0f);
 		glColor3f(1.0f, 0.0f, 0.0f);
 		glBegin(GL_POINTS);
-		for (U32 i = 0; i < m_vNodes.size(); i++) {
-			NODE n = const_nodeAt(i);
-			glVertex3dv(n.pos.cptr());
-		}
+		for (U32 i = 0; i < countNodes(); i++)
+			glVertex3dv(nodePos(i).cptr());
 		glEnd();
 	}
 
@@ -1850,7 +2459,7 @@ void VolMesh::draw() {
 	if(isNodeIndex(m_nodeToShow)) {
 		vector<U32> incidentNodes;
 		getNodeIncidentNodes(m_nodeToShow, incidentNodes);
-		vec3d pos = const_nodeAt(m_nodeToShow).pos;
+		vec3d pos = nodePos(m_nodeToShow);
 		glPointSize(7.0f);
 		glColor3f(0.0, 1.0, 0.0);
 		glBegin(GL_POINTS);
@@ -1863,7 +2472,7 @@ void VolMesh::draw() {
 		glBegin(GL_LINES);
 		for(U32 i=0; i < incidentNodes.size(); i++) {
 			glVertex3dv(pos.cptr());
-			glVertex3dv(const_nodeAt(incidentNodes[i]).pos.cptr());
+			glVertex3dv(nodePos(incidentNodes[i]).cptr());
 		}
 		glEnd();
 
@@ -1885,9 +2494,9 @@ void VolMesh::drawElement(U32 i) const {
 			U32 nodes[3];
 			getFaceNodes(cell.faces[f], nodes);
 
-			vec3d p0 = const_nodeAt(nodes[0]).pos;
-			vec3d p1 = const_nodeAt(nodes[1]).pos;
-			vec3d p2 = const_nodeAt(nodes[2]).pos;
+			vec3d p0 = nodePos(nodes[0]);
+			vec3d p1 = nodePos(nodes[1]);
+			vec3d p2 = nodePos(nodes[2]);
 
 			vec3d n = vec3d::cross(p1 - p0, p2 - p0).normalized();
 			vec3f cp = TheSceneGraph::Instance().camera().getPos();
@@ -1911,34 +2520,14 @@ void VolMesh::drawElement(U32 i) const {
 }
 
 AABB VolMesh::computeNodalAABB() const {
-	double vMin[3], vMax[3];
-	vMin[0] = vMin[1] = vMin[2] = GetMaxLimit<double>();
-	vMax[0] = vMax[1] = vMax[2] = GetMinLimit<double>();
-
-	for(U32 i=0; i < countNodes(); i++) {
-		const NODE& n = const_nodeAt(i);
-		vec3d p = n.pos;
-
-		if(i == 0) {
-			vMin[0] = vMax[0] = p[0];
-			vMin[1] = vMax[1] = p[1];
-			vMin[2] = vMax[2] = p[2];
-		}
-		else {
-			vMin[0] = MATHMIN(vMin[0], p[0]);
-			vMin[1] = MATHMIN(vMin[1], p[1]);
-			vMin[2] = MATHMIN(vMin[2], p[2]);
-
-			vMax[0] = MATHMAX(vMax[0], p[0]);
-			vMax[1] = MATHMAX(vMax[1], p[1]);
-			vMax[2] = MATHMAX(vMax[2], p[2]);
-		}
-	}
+	vec3d lo(GetMaxLimit<double>());
+	vec3d hi(GetMinLimit<double>());
+	m_nodes.bounds(lo, hi);
 
 	//set AABB
 	AABB aabb;
-	aabb.set(vec3f((float)vMin[0], (float)vMin[1], (float)vMin[2]),
-			 vec3f((float)vMax[0], (float)vMax[1], (float)vMax[2]));
+	aabb.set(vec3f((float)lo.x, (float)lo.y, (float)lo.z),
+			 vec3f((float)hi.x, (float)hi.y, (float)hi.z));
 
 	return aabb;
 }
@@ -1951,12 +2540,19 @@ AABB VolMesh::computeAABB() {
 int VolMesh::selectNode(const Ray& ray) const {
 
 	vec3f expand(0.05);
+
+	//only nodes near the ray can have their box hit
+	vector<U32> vCandidates;
+	vec3d origin(ray.start.x, ray.start.y, ray.start.z);
+	vec3d dir(ray.direction.x, ray.direction.y, ray.direction.z);
+	const_node_grid().findAlongRay(origin, dir, expand.x * sqrt(3.0), vCandidates);
+
 	int idxVertex = -1;
 	double tMin = FLT_MAX;
-	for (int i = 0; i < (int)countNodes(); i++) {
+	for (U32 i = 0; i < vCandidates.size(); i++) {
 		AABB aabb;
 
-		vec3d pos = const_nodeAt(i).pos;
+		vec3d pos = nodePos(vCandidates[i]);
 		vec3f posF = vec3f((float) pos.x, (float) pos.y, (float) pos.z);
 		aabb.set(posF - expand, posF + expand);
 
@@ -1967,7 +2563,7 @@ int VolMesh::selectNode(const Ray& ray) const {
 
 			if(hit.lower() < tMin) {
 				tMin = hit.lower();
-				idxVertex = i;
+				idxVertex = vCandidates[i];
 			}
 		}
 	}
@@ -1975,6 +2571,22 @@ int VolMesh::selectNode(const Ray& ray) const {
 	return idxVertex;
 }
 
+int VolMesh::findClosestNode(const vec3d& query, double& dist) const {
+	double dist2;
+	int idxFound = const_node_grid().findClosest(m_nodes, query, dist2);
+	dist = sqrt(dist2);
+	return idxFound;
+}
+
+U32 VolMesh::findNodesInRadius(const vec3d& query, double radius, vector<U32>& outNodes) const {
+	return const_node_grid().findInRadius(m_nodes, query, radius, outNodes);
+}
+
+const NodeGrid& VolMesh::const_node_grid() const {
+	m_nodeGrid.update(m_nodes);
+	return m_nodeGrid;
+}
+
 bool VolMesh::test_cell_topology(U32 idxCell) {
 	if(!isCellIndex(idxCell))
 		return false;
@@ -2040,7 +2652,7 @@ bool VolMesh::test_incident_edges() {
 	U32 ctErrors = 0;
 	for(U32 i=0; i < countNodes(); i++) {
 
-		vector<U32> edges = m_incident_edges_per_node[i];
+		vector<U32> edges(m_incident_edges_per_node.begin(i), m_incident_edges_per_node.end(i));
 		if(edges.size() == 0) {
 			printf("TEST: Node %u has zero incident edges and can be removed!\n", i);
 		}
@@ -2050,7 +2662,8 @@ bool VolMesh::test_incident_edges() {
 
 			//test edge map
 			EdgeKey key(edge.from, edge.to);
-			if(m_mapEdgesIndex[key] != edges[j]) {
+			const U32* pidxEdge = m_hashEdgesIndex.find(key.key);
+			if(pidxEdge == NULL || *pidxEdge != edges[j]) {
 				printf("TEST: Invalid edge key found for edge: %u\n", edges[j]);
 				ctErrors++;
 			}
@@ -2073,7 +2686,7 @@ bool VolMesh::test_incident_faces() const {
 
 	for(U32 i=0; i < countEdges(); i++) {
 
-		vector<U32> faces = m_incident_faces_per_edge[i];
+		vector<U32> faces(m_incident_faces_per_edge.begin(i), m_incident_faces_per_edge.end(i));
 		if(faces.size() == 0) {
 			printf("TEST: Edge %u has zero incident faces and can be removed!\n", i);
 		}
@@ -2107,7 +2720,7 @@ bool VolMesh::test_incident_cells() const {
 
 	for(U32 i=0; i < countFaces(); i++) {
 
-		vector<U32> cells = m_incident_cells_per_face[i];
+		vector<U32> cells(m_incident_cells_per_face.begin(i), m_incident_cells_per_face.end(i));
 		if(cells.size() == 0) {
 			printf("TEST: Face %u has zero incident cells and can be removed!\n", i);
 		}
@@ -2131,6 +2744,35 @@ bool VolMesh::test_incident_cells() const {
 		}
 	}
 
+	//face neighbors and cells per node
+	for(U32 i=0; i < countCells(); i++) {
+		const CELL& cell = const_cellAt(i);
+		for(U32 k = 0; k < COUNT_CELL_FACES; k++) {
+			//a neighbor links back through the shared face
+			U32 idxNeighbor = cell_neighbor(i, k);
+			bool valid = (countIncidentCells(cell.faces[k]) == 1);
+			if(idxNeighbor != INVALID_INDEX && isCellIndex(idxNeighbor)) {
+				const CELL& other = const_cellAt(idxNeighbor);
+				valid = false;
+				for(U32 l = 0; l < COUNT_CELL_FACES; l++)
+					if(other.faces[l] == cell.faces[k])
+						valid = (cell_neighbor(idxNeighbor, l) == i);
+			}
+			if(!valid) {
+				printf("TEST: Invalid face neighbor for cell: %u, face: %u\n", i, cell.faces[k]);
+				ctErrors++;
+			}
+		}
+
+		for(U32 k = 0; k < COUNT_CELL_NODES; k++) {
+			if(std::find(m_incident_cells_per_node.begin(cell.nodes[k]),
+						 m_incident_cells_per_node.end(cell.nodes[k]), i) == m_incident_cells_per_node.end(cell.nodes[k])) {
+				printf("TEST: Cell %u is missing from the incident cells of node: %u\n", i, cell.nodes[k]);
+				ctErrors++;
+			}
+		}
+	}
+
 	return (ctErrors == 0);
 }
 
@@ -10,8 +10,14 @@
 
 #include <base/Vec.h>
 #include <base/Color.h>
+#include <base/FlatHashMap.h>
+#include <base/MemoryArena.h>
 #include "graphics/SGNode.h"
 #include "VolMeshEntities.h"
+#include "IncidenceTable.h"
+#include "NodeStore.h"
+#include "VolMeshParts.h"
+#include "NodeGrid.h"
 #include <functional>
 #include <set>
 
@@ -41,11 +47,15 @@ namespace MESH {
 
 
 
+class VolMeshBuilder;
+
 //template <typename T>
 class VolMesh : public SGNode {
+	friend class VolMeshBuilder;
+	friend class VolMeshIO;
 public:
 	static const U32 INVALID_INDEX = -1;
-	enum TopologyEvent {teAdded, teRemoved, teUpdated};
+	enum TopologyEvent {teAdded, teRemoved, teUpdated, teRenumbered};
 
 	enum ErrorCodes {
 		err_op_failed = -1,
@@ -55,11 +65,24 @@ public:
 		err_node_not_found = -5,
 	};
 
+	//garbage collection policies
+	enum GCPolicy {
+		gcpEraseInPlace,		//erase each entity and decrement all higher handles right away
+		gcpDeferredCompaction	//mark entities dead and compact all containers in a single pass
+	};
+
+	//space filling curves to renumber the mesh along
+	enum SpaceFillingCurve {sfcNone, sfcMorton, sfcHilbert};
+
 
 	typedef std::function<void(NODE, U32 handle, TopologyEvent event)> OnNodeEvent;
 	typedef std::function<void(EDGE, U32 handle, TopologyEvent event)> OnEdgeEvent;
 	typedef std::function<void(FACE, U32 handle, TopologyEvent event)> OnFaceEvent;
 	typedef std::function<void(CELL, U32 handle, TopologyEvent event)> OnCellEvent;
+
+	//scratch containers of a single topology edit drawing from the mesh arena
+	typedef std::set<U32, std::less<U32>, ArenaAllocator<U32> > ScratchSet;
+	typedef std::vector<U32, ArenaAllocator<U32> > ScratchVector;
 public:
 	VolMesh();
 	VolMesh(const VolMesh& other);
@@ -73,6 +96,13 @@ public:
 	void setOnFaceEventCallback(OnFaceEvent f);
 	void setOnElemEventCallback(OnCellEvent f);
 
+	//Topology listeners: notified after the callbacks above. Used by the acceleration
+	//structures that have to stay in sync with the mesh.
+	void addNodeEventListener(OnNodeEvent f);
+	void addEdgeEventListener(OnEdgeEvent f);
+	void addFaceEventListener(OnFaceEvent f);
+	void addElemEventListener(OnCellEvent f);
+
 	//Build
 	bool setup(const vector<double>& vertices, const vector<U32>& elements);
 	bool setup(U32 ctVertices, const double* vertices, U32 ctElements, const U32* elements);
@@ -110,7 +140,7 @@ public:
 	inline bool isCellIndex(U32 i) const { return (i < m_vCells.size());}
 	inline bool isFaceIndex(U32 i) const { return (i < m_vFaces.size());}
 	inline bool isEdgeIndex(U32 i) const { return (i < m_vEdges.size());}
-	inline bool isNodeIndex(U32 i) const { return (i < m_vNodes.size());}
+	inline bool isNodeIndex(U32 i) const { return (i < m_nodes.size());}
 
 	//access
 	bool getFaceNodes(U32 idxFace, U32 (&nodes)[3]) const;
@@ -119,24 +149,42 @@ public:
 
 	CELL& cellAt(U32 i);
 	FACE& faceAt(U32 i);
-	NODE& nodeAt(U32 i);
 	EDGE& edgeAt(U32 i);
 
 	const CELL& const_cellAt(U32 i) const;
 	const FACE& const_faceAt(U32 i) const;
-	const NODE& const_nodeAt(U32 i) const;
+	NODE const_nodeAt(U32 i) const;
 	const EDGE& const_edgeAt(U32 i) const;
 
+	//nodes are stored as coordinate arrays. Positions are read and written by value.
+	inline vec3d nodePos(U32 i) const { assert(isNodeIndex(i)); return m_nodes.pos(i);}
+	inline vec3d nodeRestPos(U32 i) const { assert(isNodeIndex(i)); return m_nodes.restpos(i);}
+	void setNode(U32 i, const NODE& n);
+	void setNodePos(U32 i, const vec3d& p);
+	const NodeStore& const_nodes() const { return m_nodes;}
+
 	inline U32 countCells() const { return m_vCells.size();}
 	inline U32 countFaces() const {return m_vFaces.size();}
 	inline U32 countEdges() const {return m_vEdges.size();}
-	inline U32 countNodes() const {return m_vNodes.size();}
+	inline U32 countNodes() const {return m_nodes.size();}
 
 	//count incidents
 	U32 countIncidentCells(U32 idxFace) const;
 	U32 countIncidentFaces(U32 idxEdge) const;
 	U32 countIncidentEdges(U32 idxNode) const;
 
+	//cell sharing the i-th face of a cell, INVALID_INDEX on the boundary
+	inline U32 cell_neighbor(U32 idxCell, int i) const {
+		assert(isCellIndex(idxCell));
+		return m_vCellNeighbors[idxCell * COUNT_CELL_FACES + i];
+	}
+
+	//packs the incidence lists touched since the last call back into CSR form
+	void compactIncidence();
+
+	//bytes held by the incidence tables
+	U64 getIncidenceMemoryUsage() const;
+
 	//edge-wise funcs
 	bool edge_exists(U32 from, U32 to);
 	U32 edge_handle(U32 from, U32 to);
@@ -146,6 +194,10 @@ public:
 
 	U32 get_node_neighbors(U32 idxNode, vector<U32>& nbors) const;
 
+	//face-wise funcs
+	U32 face_handle_by_edges(U32 edges[3]) const;
+	U32 face_handle_by_nodes(U32 nodes[3]);
+
 
 	//displace all nodes by a displacement array
 	void displace(U32 countDegreesOfFreedom, const double * u);
@@ -166,6 +218,11 @@ public:
 
 	//mesh disjoint parts
 	int get_disjoint_parts(vector<vector<U32>>& cellgroups);
+
+	//labels the disjoint parts and returns their count. Only the parts touched since
+	//the previous call are relabelled.
+	U32 update_cell_parts();
+	const vector<U32>& const_cell_parts() const { return m_parts.const_labels();}
 	void printParts();
 
 	//schedule a cell removal at the next GC
@@ -195,6 +252,26 @@ public:
 	//erases all objects marked removed
 	void garbage_collection();
 
+	//garbage collection policy
+	void setGCPolicy(GCPolicy policy) { m_gcPolicy = policy;}
+	GCPolicy getGCPolicy() const { return m_gcPolicy;}
+
+	/*!
+	 * renumbers the nodes along a space filling curve through their positions and the cells
+	 * along the same curve through their centroids. Edges and faces follow the first cell
+	 * using them. All handles held outside the mesh are stale afterwards so listeners get
+	 * one teRenumbered event with an invalid handle per entity type.
+	 */
+	bool reorder(SpaceFillingCurve curve = sfcHilbert);
+
+	//old to new handles of the last reorder for solvers that keep per node or per cell data
+	const vector<U32>& const_node_permutation() const { return m_vNodePermutation;}
+	const vector<U32>& const_cell_permutation() const { return m_vCellPermutation;}
+
+	//reorders the mesh after every garbage collection that removed entities
+	void setReorderAfterGC(SpaceFillingCurve curve) { m_reorderAfterGC = curve;}
+	SpaceFillingCurve getReorderAfterGC() const { return m_reorderAfterGC;}
+
 
 	/*!
 	 * cuts an edge completely. Two new nodes are created at the point of cut with no hedges between them.
@@ -204,7 +281,9 @@ public:
 
 	//algorithmic functions
 	int getNodeIncidentEdges(U32 idxNode, vector<U32>& incidentEdges) const;
+	int getEdgeIncidentFaces(U32 idxEdge, vector<U32>& incidentFaces) const;
 	int getNodeIncidentNodes(U32 idxNode, vector<U32>& incidentNodes) const;
+	int getNodeIncidentCells(U32 idxNode, vector<U32>& incidentCells) const;
 	bool getCellFacesExpensive(U32 idxCell, U32 (&faces)[4]);
 	bool getCellEdgesExpensive(U32 idxCell, U32 (&edges)[6]);
 
@@ -224,6 +303,14 @@ public:
 	void setFlagFilterOutFlatCells(bool flag) { m_flagFilterOutFlatCells = flag;}
 	bool getFlagFilterOutFlatCells() const {return m_flagFilterOutFlatCells;}
 
+	//setup builds the mesh in parallel passes instead of inserting cells one by one
+	void setFlagBulkSetup(bool flag) { m_flagBulkSetup = flag;}
+	bool getFlagBulkSetup() const {return m_flagBulkSetup;}
+
+	//incidence lists are stored in packed CSR arrays instead of one vector per entity
+	void setFlagPackedIncidence(bool flag);
+	bool getFlagPackedIncidence() const {return m_flagPackedIncidence;}
+
 
 	//set base color
 	Color getColor() const {return m_color;}
@@ -241,6 +328,11 @@ public:
 	//selects a node using a ray intersection test
 	int selectNode(const Ray& ray) const;
 
+	//node queries over a spatial grid that is rebuilt lazily after removals
+	int findClosestNode(const vec3d& query, double& dist) const;
+	U32 findNodesInRadius(const vec3d& query, double radius, vector<U32>& outNodes) const;
+	const NodeGrid& const_node_grid() const;
+
 	bool verbose() const { return m_verbose;}
 	void setVerbose(bool b) { m_verbose = b;}
 
@@ -252,21 +344,27 @@ protected:
 
 	inline EdgeKey computeEdgeKey(U32 idxEdge) const;
 
+	//face index
+	void insertFaceIndexToMap(U32 idxFace);
+	void removeFaceIndexFromMap(U32 idxFace);
+	void rebuildFacesIndex() const;
+
 	inline bool face_exists_by_edges(U32 edges[3]) const;
 	inline bool face_exists_by_nodes(U32 nodes[3]);
 
-	U32 face_handle_by_edges(U32 edges[3]) const;
-	U32 face_handle_by_nodes(U32 nodes[3]);
+	//cell adjacency
+	void linkFaceNeighbors(U32 idxFace);
+	void buildCellAdjacency();
 
 	//incident entities
-	template <class ContainerT>
-	int get_incident_cells(const ContainerT& in_faces, set<U32>& out_cells) const;
+	template <class ContainerT, class SetT>
+	int get_incident_cells(const ContainerT& in_faces, SetT& out_cells) const;
 
-	template <class ContainerT>
-	int get_incident_faces(const ContainerT& in_edges, set<U32>& out_faces) const;
+	template <class ContainerT, class SetT>
+	int get_incident_faces(const ContainerT& in_edges, SetT& out_faces) const;
 
-	template <class ContainerT>
-	int get_incident_edges(const ContainerT& in_nodes, set<U32>& out_edges) const;
+	template <class ContainerT, class SetT>
+	int get_incident_edges(const ContainerT& in_nodes, SetT& out_edges) const;
 
 
 	bool test_cell_topology(U32 idxCell);
@@ -278,6 +376,14 @@ protected:
 	bool test_incidents();
 
 	AABB computeNodalAABB() const;
+
+	//fire topology events. A node event with an invalid handle and teUpdated
+	//means that all node positions have changed. Renumbering events always
+	//carry an invalid handle.
+	void notifyNodeEvent(U32 idxNode, TopologyEvent event);
+	void notifyEdgeEvent(U32 idxEdge, TopologyEvent event);
+	void notifyFaceEvent(U32 idxFace, TopologyEvent event);
+	void notifyElemEvent(U32 idxCell, TopologyEvent event);
 protected:
 	//remove core functions
 	void remove_cell_core(U32 idxCell);
@@ -285,6 +391,17 @@ protected:
 	void remove_edge_core(U32 idxEdge);
 	void remove_node_core(U32 idxNode);
 
+	//garbage collection policies
+	void gc_erase_in_place(U32& ctRemovedCells, U32& ctRemovedFaces, U32& ctRemovedEdges, U32& ctRemovedNodes);
+	void gc_deferred_compaction(U32& ctRemovedCells, U32& ctRemovedFaces, U32& ctRemovedEdges, U32& ctRemovedNodes);
+
+	//allocator for scratch containers. Scopes rewind the arena with ArenaScope.
+	ArenaAllocator<U32> scratchAlloc() { return ArenaAllocator<U32>(&m_scratch);}
+
+	//rewrites every stored handle through the old to new tables after the containers moved
+	void remapHandles(const vector<U32>& vCellRemap, const vector<U32>& vFaceRemap,
+					  const vector<U32>& vEdgeRemap, const vector<U32>& vNodeRemap);
+
 protected:
 	U32 m_elemToShow;
 	U32 m_nodeToShow;
@@ -292,34 +409,60 @@ protected:
 	bool m_flagDrawWireFrameMesh;
 	bool m_flagDrawNodes;
 	bool m_flagFilterOutFlatCells;
+	bool m_flagBulkSetup;
+	bool m_flagPackedIncidence;
 	Color m_color;
+	GCPolicy m_gcPolicy;
+	SpaceFillingCurve m_reorderAfterGC;
 
 	//topology events
 	OnNodeEvent m_fOnNodeEvent;
 	OnEdgeEvent m_fOnEdgeEvent;
 	OnFaceEvent m_fOnFaceEvent;
 	OnCellEvent m_fOnElementEvent;
+	vector<OnNodeEvent> m_vNodeEventListeners;
+	vector<OnEdgeEvent> m_vEdgeEventListeners;
+	vector<OnFaceEvent> m_vFaceEventListeners;
+	vector<OnCellEvent> m_vElemEventListeners;
 
 	//containers
 	vector<CELL> m_vCells;
 	vector<FACE> m_vFaces;
 	vector<EDGE> m_vEdges;
-	vector<NODE> m_vNodes;
+	NodeStore m_nodes;
 
 	//marked cells to be deleted at the next GC
 	vector<U32> m_pendingToDeleteCells;
 
 	//top-down access
-	vector< vector<U32> > m_incident_edges_per_node;
-	vector< vector<U32> > m_incident_faces_per_edge;
-	vector< vector<U32> > m_incident_cells_per_face;
+	IncidenceTable m_incident_edges_per_node;
+	IncidenceTable m_incident_faces_per_edge;
+	IncidenceTable m_incident_cells_per_face;
+
+	//cell adjacency: 4 face neighbors per cell and the cells around each node
+	vector<U32> m_vCellNeighbors;
+	IncidenceTable m_incident_cells_per_node;
 
 	//maps a half-edge from-to pair to the corresponding hedge handle
-	std::map< EdgeKey, U32 > m_mapEdgesIndex;
+	FlatHashMap<U32> m_hashEdgesIndex;
+
+	//maps the edges of a face to the face handle. Handles shift after removals
+	//so the index is rebuilt lazily on the next lookup.
+	mutable FlatHashMap<U32> m_hashFacesIndex;
+	mutable bool m_isFacesIndexDirty;
+
+	//part id per cell
+	VolMeshParts m_parts;
+
+	//spatial index over node positions
+	mutable NodeGrid m_nodeGrid;
+
+	//old to new handles of the last reorder
+	vector<U32> m_vNodePermutation;
+	vector<U32> m_vCellPermutation;
 
-	//iterators
-	typedef std::map< EdgeKey, U32 >::iterator MAPHEDGEINDEXITER;
-	typedef std::map< EdgeKey, U32 >::const_iterator MAPHEDGEINDEXCONSTITER;
+	//scratch memory of topology edits and garbage collection
+	MemoryArena m_scratch;
 };
 
 }
@@ -0,0 +1,283 @@
+/*
+ * VolMeshBVH.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "VolMeshBVH.h"
+#include "base/Logger.h"
+#include "base/Profiler.h"
+#include <algorithm>
+
+//rebuild the tree once the pending list grows beyond this fraction of the edges
+#define BVH_PENDING_REBUILD_RATIO 0.25
+#define BVH_PENDING_REBUILD_MIN 64
+
+using namespace std;
+using namespace std::placeholders;
+
+namespace PS {
+namespace MESH {
+
+//orders primitives by their centroid along one axis
+class CentroidAxisCompare {
+public:
+	CentroidAxisCompare(const vector<vec3d>& centroids, int axis):
+		m_centroids(centroids), m_axis(axis) {}
+
+	bool operator()(U32 a, U32 b) const {
+		return m_centroids[a][m_axis] < m_centroids[b][m_axis];
+	}
+
+private:
+	const vector<vec3d>& m_centroids;
+	int m_axis;
+};
+
+VolMeshBVH::VolMeshBVH() {
+	m_lpMesh = NULL;
+	m_isDirty = true;
+	m_needsRefit = false;
+}
+
+VolMeshBVH::VolMeshBVH(VolMesh* pmesh) {
+	m_lpMesh = NULL;
+	m_isDirty = true;
+	m_needsRefit = false;
+	attach(pmesh);
+}
+
+VolMeshBVH::~VolMeshBVH() {
+	m_vNodes.resize(0);
+	m_vPrims.resize(0);
+	m_vPending.resize(0);
+	m_vIsPending.resize(0);
+}
+
+void VolMeshBVH::attach(VolMesh* pmesh) {
+	m_lpMesh = pmesh;
+	m_isDirty = true;
+	if(m_lpMesh == NULL)
+		return;
+
+	m_lpMesh->addNodeEventListener(std::bind(&VolMeshBVH::onNodeEvent, this, _2, _3));
+	m_lpMesh->addEdgeEventListener(std::bind(&VolMeshBVH::onEdgeEvent, this, _2, _3));
+}
+
+void VolMeshBVH::onNodeEvent(U32 handle, VolMesh::TopologyEvent event) {
+	//new nodes are not referenced by any edge yet and removed nodes are
+	//always preceded by the removal of their edges
+	if(event == VolMesh::teUpdated)
+		m_needsRefit = true;
+}
+
+void VolMeshBVH::onEdgeEvent(U32 handle, VolMesh::TopologyEvent event) {
+	if(m_isDirty)
+		return;
+
+	if(event == VolMesh::teRemoved || event == VolMesh::teRenumbered)
+		m_isDirty = true;
+	else
+		addPending(handle);
+}
+
+void VolMeshBVH::addPending(U32 idxEdge) {
+	if(idxEdge >= m_vIsPending.size())
+		m_vIsPending.resize(idxEdge + 1, 0);
+
+	if(m_vIsPending[idxEdge])
+		return;
+	m_vIsPending[idxEdge] = 1;
+	m_vPending.push_back(idxEdge);
+
+	//too many edges to scan linearly
+	U32 ctMaxPending = MATHMAX((U32)(BVH_PENDING_REBUILD_RATIO * m_vPrims.size()), (U32)BVH_PENDING_REBUILD_MIN);
+	if(m_vPending.size() > ctMaxPending)
+		m_isDirty = true;
+}
+
+void VolMeshBVH::computeEdgeBox(U32 idxEdge, vec3d& lo, vec3d& hi) const {
+	const EDGE& e = m_lpMesh->const_edgeAt(idxEdge);
+	const vec3d& p0 = m_lpMesh->nodePos(e.from);
+	const vec3d& p1 = m_lpMesh->nodePos(e.to);
+
+	lo = vec3d::minP(p0, p1);
+	hi = vec3d::maxP(p0, p1);
+}
+
+void VolMeshBVH::build() {
+	m_vNodes.resize(0);
+	m_vPrims.resize(0);
+	m_vPending.resize(0);
+	m_vIsPending.resize(0);
+	m_isDirty = false;
+	m_needsRefit = false;
+
+	if(m_lpMesh == NULL || m_lpMesh->countEdges() == 0)
+		return;
+
+	ProfileAutoArg("bvh build");
+
+	U32 ctEdges = m_lpMesh->countEdges();
+	m_vPrims.resize(ctEdges);
+	m_vIsPending.resize(ctEdges, 0);
+
+	vector<vec3d> centroids;
+	centroids.resize(ctEdges);
+	for(U32 i=0; i < ctEdges; i++) {
+		const EDGE& e = m_lpMesh->const_edgeAt(i);
+		centroids[i] = (m_lpMesh->nodePos(e.from) + m_lpMesh->nodePos(e.to)) * 0.5;
+		m_vPrims[i] = i;
+	}
+
+	//a binary tree with leaves of at least one primitive has less than 2n nodes
+	m_vNodes.reserve(2 * (ctEdges / LEAF_SIZE + 1));
+	buildRecursive(0, ctEdges, centroids);
+}
+
+U32 VolMeshBVH::buildRecursive(U32 first, U32 count, vector<vec3d>& centroids) {
+
+	U32 idxNode = m_vNodes.size();
+	m_vNodes.push_back(BVHNode());
+
+	//bounds
+	vec3d lo, hi, elo, ehi;
+	computeEdgeBox(m_vPrims[first], lo, hi);
+	vec3d clo = centroids[m_vPrims[first]];
+	vec3d chi = clo;
+	for(U32 i = first + 1; i < first + count; i++) {
+		computeEdgeBox(m_vPrims[i], elo, ehi);
+		lo = vec3d::minP(lo, elo);
+		hi = vec3d::maxP(hi, ehi);
+
+		clo = vec3d::minP(clo, centroids[m_vPrims[i]]);
+		chi = vec3d::maxP(chi, centroids[m_vPrims[i]]);
+	}
+
+	m_vNodes[idxNode].lo = lo;
+	m_vNodes[idxNode].hi = hi;
+
+	//leaf
+	if(count <= LEAF_SIZE) {
+		m_vNodes[idxNode].offset = first;
+		m_vNodes[idxNode].count = count;
+		return idxNode;
+	}
+
+	//split at the median along the longest axis of the centroids
+	vec3d ext = chi - clo;
+	int axis = 0;
+	if(ext.y > ext.x)
+		axis = 1;
+	if(ext.z > ext[axis])
+		axis = 2;
+
+	U32 half = count / 2;
+	std::nth_element(m_vPrims.begin() + first,
+					 m_vPrims.begin() + first + half,
+					 m_vPrims.begin() + first + count,
+					 CentroidAxisCompare(centroids, axis));
+
+	buildRecursive(first, half, centroids);
+	U32 idxRight = buildRecursive(first + half, count - half, centroids);
+
+	m_vNodes[idxNode].offset = idxRight;
+	m_vNodes[idxNode].count = 0;
+	return idxNode;
+}
+
+void VolMeshBVH::refit() {
+	m_needsRefit = false;
+	if(m_isDirty || m_vNodes.size() == 0)
+		return;
+
+	ProfileAutoArg("bvh refit");
+
+	//children are always stored after their parent
+	vec3d elo, ehi;
+	for(int i = (int)m_vNodes.size() - 1; i >= 0; i--) {
+		BVHNode& node = m_vNodes[i];
+
+		if(node.count > 0) {
+			computeEdgeBox(m_vPrims[node.offset], node.lo, node.hi);
+			for(U32 j = node.offset + 1; j < node.offset + node.count; j++) {
+				computeEdgeBox(m_vPrims[j], elo, ehi);
+				node.lo = vec3d::minP(node.lo, elo);
+				node.hi = vec3d::maxP(node.hi, ehi);
+			}
+		}
+		else {
+			const BVHNode& left = m_vNodes[i + 1];
+			const BVHNode& right = m_vNodes[node.offset];
+			node.lo = vec3d::minP(left.lo, right.lo);
+			node.hi = vec3d::maxP(left.hi, right.hi);
+		}
+	}
+}
+
+bool VolMeshBVH::Overlaps(const vec3d& lo1, const vec3d& hi1, const vec3d& lo2, const vec3d& hi2) {
+	return !((lo1.x > hi2.x) || (lo2.x > hi1.x) ||
+			 (lo1.y > hi2.y) || (lo2.y > hi1.y) ||
+			 (lo1.z > hi2.z) || (lo2.z > hi1.z));
+}
+
+int VolMeshBVH::query(const vec3d& lo, const vec3d& hi, vector<U32>& outEdges) {
+	outEdges.resize(0);
+	if(m_lpMesh == NULL)
+		return 0;
+
+	if(m_isDirty)
+		build();
+	else if(m_needsRefit)
+		refit();
+
+	if(m_vNodes.size() == 0)
+		return 0;
+
+	vec3d elo, ehi;
+
+	//traverse
+	vector<U32> stkNodes;
+	stkNodes.reserve(64);
+	stkNodes.push_back(0);
+	while(stkNodes.size() > 0) {
+		const BVHNode& node = m_vNodes[stkNodes.back()];
+		U32 idxNode = stkNodes.back();
+		stkNodes.pop_back();
+
+		if(!Overlaps(lo, hi, node.lo, node.hi))
+			continue;
+
+		if(node.count == 0) {
+			stkNodes.push_back(node.offset);
+			stkNodes.push_back(idxNode + 1);
+			continue;
+		}
+
+		for(U32 i = node.offset; i < node.offset + node.count; i++) {
+			U32 idxEdge = m_vPrims[i];
+
+			//pending edges are tested below
+			if(m_vIsPending[idxEdge])
+				continue;
+
+			computeEdgeBox(idxEdge, elo, ehi);
+			if(Overlaps(lo, hi, elo, ehi))
+				outEdges.push_back(idxEdge);
+		}
+	}
+
+	//edges added or changed since the last build
+	for(U32 i=0; i < m_vPending.size(); i++) {
+		computeEdgeBox(m_vPending[i], elo, ehi);
+		if(Overlaps(lo, hi, elo, ehi))
+			outEdges.push_back(m_vPending[i]);
+	}
+
+	std::sort(outEdges.begin(), outEdges.end());
+	return (int)outEdges.size();
+}
+
+}
+}
@@ -0,0 +1,103 @@
+/*
+ * VolMeshBVH.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef VOLMESHBVH_H_
+#define VOLMESHBVH_H_
+
+#include "VolMesh.h"
+
+namespace PS {
+namespace MESH {
+
+/*!
+ * Bounding volume hierarchy over the edges of a volume mesh. The tree is built lazily
+ * on the first query and is kept in sync with the mesh through the topology listeners:
+ * 1. Moved nodes: the boxes are refitted before the next query
+ * 2. Added or updated edges: tested linearly from a pending list until the next rebuild
+ * 3. Removed edges: handles shift after a removal so the tree is rebuilt on the next query
+ * Cells are not indexed. The cut cells follow from the cut edges and nodes, which are
+ * already found through this tree, and are reached through the incidence tables.
+ */
+class VolMeshBVH {
+public:
+	//maximum number of edges per leaf
+	static const U32 LEAF_SIZE = 4;
+
+	struct BVHNode {
+		vec3d lo;
+		vec3d hi;
+
+		//inner nodes: index of the right child. The left child is always the next node.
+		//leaf nodes: first primitive
+		U32 offset;
+
+		//number of primitives. Zero for inner nodes
+		U32 count;
+	};
+
+public:
+	VolMeshBVH();
+	explicit VolMeshBVH(VolMesh* pmesh);
+	virtual ~VolMeshBVH();
+
+	//binds the hierarchy to a mesh and registers for its topology events
+	void attach(VolMesh* pmesh);
+
+	//builds the tree from scratch
+	void build();
+
+	//refits all boxes to the current node positions
+	void refit();
+
+	//flags
+	void setDirty() { m_isDirty = true;}
+	bool isDirty() const {return m_isDirty;}
+	void setNeedsRefit() { m_needsRefit = true;}
+
+	/*!
+	 * collects all edges whose bounding boxes overlap the query box.
+	 * @param lo lower corner of the query box
+	 * @param hi upper corner of the query box
+	 * @param outEdges edge handles in increasing order
+	 * @return number of edges found
+	 */
+	int query(const vec3d& lo, const vec3d& hi, vector<U32>& outEdges);
+
+	//stats
+	U32 countNodes() const { return m_vNodes.size();}
+	U32 countPendingEdges() const { return m_vPending.size();}
+
+protected:
+	void onNodeEvent(U32 handle, VolMesh::TopologyEvent event);
+	void onEdgeEvent(U32 handle, VolMesh::TopologyEvent event);
+
+	void computeEdgeBox(U32 idxEdge, vec3d& lo, vec3d& hi) const;
+	U32 buildRecursive(U32 first, U32 count, vector<vec3d>& centroids);
+	void addPending(U32 idxEdge);
+
+	static bool Overlaps(const vec3d& lo1, const vec3d& hi1, const vec3d& lo2, const vec3d& hi2);
+
+private:
+	VolMesh* m_lpMesh;
+	bool m_isDirty;
+	bool m_needsRefit;
+
+	//flattened tree in depth first order
+	vector<BVHNode> m_vNodes;
+
+	//edge handles referenced by leaves
+	vector<U32> m_vPrims;
+
+	//edges added or changed after the last build
+	vector<U32> m_vPending;
+	vector<U8> m_vIsPending;
+};
+
+}
+}
+
+#endif /* VOLMESHBVH_H_ */
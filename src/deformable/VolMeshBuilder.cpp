@@ -0,0 +1,367 @@
+/*
+ * VolMeshBuilder.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "VolMeshBuilder.h"
+#include "base/Logger.h"
+#include "base/Profiler.h"
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+using namespace tbb;
+
+namespace PS {
+namespace MESH {
+
+//same masks as VolMesh::insert_cell
+static const int g_maskTetFaceNodes[4][3] = { {1, 2, 3}, {2, 0, 3}, {3, 0, 1}, {1, 0, 2} };
+
+//each cell visits 12 half-edges: 3 per face in face order. The first half-edge of
+//each cell edge {1,2},{2,3},{3,1},{2,0},{0,3},{0,1} is found at these slots which
+//keeps the orientation and order of the incremental path.
+static const int g_maskTetEdgeSlots[6] = {0, 1, 2, 3, 4, 7};
+
+//maps a half-edge slot to its cell edge
+static const int g_maskTetSlotEdges[12] = {0, 1, 2, 3, 4, 1, 4, 5, 2, 5, 3, 0};
+
+//edge of a cell keyed by its edge key
+struct HEdgeEntry {
+	U64 key;
+	U32 rank;	//cell order * 6 + cell edge
+
+	bool operator<(const HEdgeEntry& rhs) const {
+		return (key < rhs.key) || (key == rhs.key && rank < rhs.rank);
+	}
+};
+
+//face of a cell keyed by its sorted nodes: lo packs the two smaller ones
+struct FaceEntry {
+	U64 lo;
+	U32 hi;
+	U32 rank;	//cell order * 4 + face
+
+	bool sameFace(const FaceEntry& rhs) const {
+		return (lo == rhs.lo) && (hi == rhs.hi);
+	}
+
+	bool operator<(const FaceEntry& rhs) const {
+		if(lo != rhs.lo)
+			return lo < rhs.lo;
+		if(hi != rhs.hi)
+			return hi < rhs.hi;
+		return rank < rhs.rank;
+	}
+};
+
+//first occurrence of a unique entity and the range of its entries
+struct UniqueEntry {
+	U32 cell;
+	U64 key;
+	U32 first;
+	U32 count;
+
+	bool operator<(const UniqueEntry& rhs) const {
+		return (cell < rhs.cell) || (cell == rhs.cell && key < rhs.key);
+	}
+};
+
+/*!
+ * sorts entries with a counting pass over the buckets followed by small per-bucket
+ * sorts in parallel. Entries of a bucket are kept in their input order before sorting.
+ */
+template <typename Entry, typename BucketFunc>
+static void BucketSort(vector<Entry>& entries, U32 ctBuckets, BucketFunc bucketOf) {
+	vector<U32> vOffsets(ctBuckets + 1, 0);
+	for(U32 i=0; i < entries.size(); i++)
+		vOffsets[bucketOf(entries[i]) + 1]++;
+	for(U32 i=0; i < ctBuckets; i++)
+		vOffsets[i + 1] += vOffsets[i];
+
+	vector<Entry> vSorted(entries.size());
+	{
+		vector<U32> vCursor(vOffsets.begin(), vOffsets.end() - 1);
+		for(U32 i=0; i < entries.size(); i++)
+			vSorted[vCursor[bucketOf(entries[i])]++] = entries[i];
+	}
+
+	parallel_for(blocked_range<U32>(0, ctBuckets), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			if(vOffsets[i + 1] - vOffsets[i] > 1)
+				std::sort(vSorted.begin() + vOffsets[i], vSorted.begin() + vOffsets[i + 1]);
+		}
+	});
+
+	entries.swap(vSorted);
+}
+
+static inline void GetHEdgeNodes(const U32* nodes, U32 slot, U32& from, U32& to) {
+	U32 f = slot / 3;
+	U32 e = slot % 3;
+	from = nodes[g_maskTetFaceNodes[f][e]];
+	to = nodes[g_maskTetFaceNodes[f][(e + 1) % 3]];
+}
+
+bool VolMeshBuilder::build(VolMesh* pmesh,
+						   U32 ctVertices, const double* vertices,
+						   U32 ctElements, const U32* elements) {
+	if(pmesh == NULL)
+		return false;
+
+	ProfileAutoArg("bulk setup");
+
+	//1.classify cells
+	const bool filterFlatCells = pmesh->getFlagFilterOutFlatCells();
+	vector<U8> vStatus(ctElements, 0);
+	enum CellStatus {csValid = 0, csInvalidNode = 1, csFlat = 2, csRepeatedNodes = 3};
+
+	parallel_for(blocked_range<U32>(0, ctElements), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			const U32* nodes = &elements[i * 4];
+
+			bool valid = true;
+			for(int j=0; j < COUNT_CELL_NODES; j++)
+				valid &= (nodes[j] < ctVertices);
+			if(!valid) {
+				vStatus[i] = csInvalidNode;
+				continue;
+			}
+
+			if(filterFlatCells) {
+				vec3d v[COUNT_CELL_NODES];
+				for(int j=0; j < COUNT_CELL_NODES; j++)
+					v[j] = vec3d(&vertices[nodes[j] * 3]);
+
+				if(VolMesh::ComputeCellVolume(v) < FLAT_CELL_VOLUME)
+					vStatus[i] = csFlat;
+			}
+			else {
+				for(int j=0; j < COUNT_CELL_NODES; j++)
+					for(int k=j+1; k < COUNT_CELL_NODES; k++)
+						if(nodes[j] == nodes[k])
+							vStatus[i] = csRepeatedNodes;
+			}
+		}
+	});
+
+	vector<U32> vCells;
+	vCells.reserve(ctElements);
+	for(U32 i=0; i < ctElements; i++) {
+		if(vStatus[i] == csRepeatedNodes) {
+			LogErrorArg1("Bulk setup is not possible. Cell %u has repeated nodes.", i);
+			return false;
+		}
+		else if(vStatus[i] == csInvalidNode)
+			LogErrorArg1("Invalid node index passed in. Cell %u is skipped.", i);
+		else if(vStatus[i] == csValid)
+			vCells.push_back(i);
+	}
+
+	const U32 ctCells = vCells.size();
+	pmesh->cleanup();
+
+	//2.nodes
+	pmesh->m_nodes.resize(ctVertices);
+	parallel_for(blocked_range<U32>(0, ctVertices), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			vec3d p(&vertices[i * 3]);
+			pmesh->m_nodes.setPos(i, p);
+			pmesh->m_nodes.setRestPos(i, p);
+		}
+	});
+
+	//3.edges: sort all cell half-edges by key. The first entry of each group is the
+	//earliest half-edge that would have created the edge incrementally.
+	vector<U32> vCellEdgeHandles(ctCells * COUNT_CELL_EDGES);
+	{
+		ProfileAutoArg("bulk setup:edges");
+		vector<HEdgeEntry> vEntries(ctCells * COUNT_CELL_EDGES);
+		parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+			for(U32 i = r.begin(); i != r.end(); i++) {
+				const U32* nodes = &elements[vCells[i] * 4];
+				for(U32 j=0; j < COUNT_CELL_EDGES; j++) {
+					U32 from, to;
+					GetHEdgeNodes(nodes, g_maskTetEdgeSlots[j], from, to);
+
+					HEdgeEntry& entry = vEntries[i * COUNT_CELL_EDGES + j];
+					entry.key = EdgeKey(from, to).key;
+					entry.rank = i * COUNT_CELL_EDGES + j;
+				}
+			}
+		});
+		BucketSort(vEntries, ctVertices, [](const HEdgeEntry& e) { return (U32)(e.key & HEDGE_BITMASK); });
+
+		//unique edges
+		vector<UniqueEntry> vUnique;
+		vUnique.reserve(ctCells * 2);
+		for(U32 i=0; i < vEntries.size(); i++) {
+			if(i == 0 || vEntries[i].key != vEntries[i-1].key) {
+				UniqueEntry u;
+				u.cell = vEntries[i].rank / COUNT_CELL_EDGES;
+				u.key = vEntries[i].key;
+				u.first = i;
+				u.count = 0;
+				vUnique.push_back(u);
+			}
+			vUnique.back().count++;
+		}
+
+		//new edges of a cell are inserted in increasing key order
+		BucketSort(vUnique, ctCells, [](const UniqueEntry& u) { return u.cell; });
+
+		const U32 ctEdges = vUnique.size();
+		pmesh->m_vEdges.resize(ctEdges);
+		parallel_for(blocked_range<U32>(0, ctEdges), [&](const blocked_range<U32>& r) {
+			for(U32 i = r.begin(); i != r.end(); i++) {
+				const UniqueEntry& u = vUnique[i];
+
+				//orientation of the first half-edge
+				U32 rank = vEntries[u.first].rank;
+				EDGE& e = pmesh->m_vEdges[i];
+				GetHEdgeNodes(&elements[vCells[rank / COUNT_CELL_EDGES] * 4],
+							  g_maskTetEdgeSlots[rank % COUNT_CELL_EDGES], e.from, e.to);
+
+				for(U32 j = u.first; j < u.first + u.count; j++)
+					vCellEdgeHandles[vEntries[j].rank] = i;
+			}
+		});
+
+		//edge index and incident edges per node. Lists are sized up front so
+		//they fill their packed slots in place.
+		vector<U32> vCapacity(ctVertices, 0);
+		for(U32 i=0; i < ctEdges; i++) {
+			vCapacity[pmesh->m_vEdges[i].from]++;
+			vCapacity[pmesh->m_vEdges[i].to]++;
+		}
+		pmesh->m_incident_edges_per_node.reserve_lists(vCapacity);
+
+		pmesh->m_hashEdgesIndex.reserve(ctEdges);
+		for(U32 i=0; i < ctEdges; i++) {
+			const EDGE& e = pmesh->m_vEdges[i];
+			pmesh->m_incident_edges_per_node.push_back(e.from, i);
+			pmesh->m_incident_edges_per_node.push_back(e.to, i);
+			pmesh->m_hashEdgesIndex.insert(vUnique[i].key, i);
+		}
+	}
+
+	//4.faces: same scheme keyed on the sorted face nodes
+	vector<U32> vCellFaceHandles(ctCells * COUNT_CELL_FACES);
+	{
+		ProfileAutoArg("bulk setup:faces");
+		vector<FaceEntry> vEntries(ctCells * COUNT_CELL_FACES);
+		parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+			for(U32 i = r.begin(); i != r.end(); i++) {
+				const U32* nodes = &elements[vCells[i] * 4];
+				for(U32 f=0; f < COUNT_CELL_FACES; f++) {
+					U32 a = nodes[g_maskTetFaceNodes[f][0]];
+					U32 b = nodes[g_maskTetFaceNodes[f][1]];
+					U32 c = nodes[g_maskTetFaceNodes[f][2]];
+					FaceKey::order_lo2hi(a, b, c);
+
+					FaceEntry& entry = vEntries[i * COUNT_CELL_FACES + f];
+					entry.lo = ((U64)a << 32) | b;
+					entry.hi = c;
+					entry.rank = i * COUNT_CELL_FACES + f;
+				}
+			}
+		});
+		BucketSort(vEntries, ctVertices, [](const FaceEntry& e) { return (U32)(e.lo >> 32); });
+
+		//unique faces in order of their first appearance
+		vector<UniqueEntry> vUnique;
+		vUnique.reserve(ctCells * 2 + 4);
+		for(U32 i=0; i < vEntries.size(); i++) {
+			if(i == 0 || !vEntries[i].sameFace(vEntries[i-1])) {
+				UniqueEntry u;
+				u.cell = vEntries[i].rank;
+				u.key = 0;
+				u.first = i;
+				u.count = 0;
+				vUnique.push_back(u);
+			}
+			vUnique.back().count++;
+		}
+		BucketSort(vUnique, ctCells * COUNT_CELL_FACES, [](const UniqueEntry& u) { return u.cell; });
+
+		const U32 ctFaces = vUnique.size();
+		pmesh->m_vFaces.resize(ctFaces);
+		parallel_for(blocked_range<U32>(0, ctFaces), [&](const blocked_range<U32>& r) {
+			for(U32 i = r.begin(); i != r.end(); i++) {
+				const UniqueEntry& u = vUnique[i];
+
+				//face edges are the half-edges of the first cell face
+				FACE& face = pmesh->m_vFaces[i];
+				U32 cell = u.cell / COUNT_CELL_FACES;
+				U32 f = u.cell % COUNT_CELL_FACES;
+				for(int e=0; e < COUNT_FACE_EDGES; e++)
+					face.edges[e] = vCellEdgeHandles[cell * COUNT_CELL_EDGES + g_maskTetSlotEdges[f * 3 + e]];
+
+				for(U32 j = u.first; j < u.first + u.count; j++)
+					vCellFaceHandles[vEntries[j].rank] = i;
+			}
+		});
+
+		//incident faces per edge
+		vector<U32> vCapacity(pmesh->countEdges(), 0);
+		for(U32 i=0; i < ctFaces; i++)
+			for(int e=0; e < COUNT_FACE_EDGES; e++)
+				vCapacity[pmesh->m_vFaces[i].edges[e]]++;
+		pmesh->m_incident_faces_per_edge.reserve_lists(vCapacity);
+
+		for(U32 i=0; i < ctFaces; i++) {
+			const FACE& face = pmesh->m_vFaces[i];
+			for(int e=0; e < COUNT_FACE_EDGES; e++)
+				pmesh->m_incident_faces_per_edge.push_back(face.edges[e], i);
+		}
+
+		//each unique face counted the cell faces sharing it
+		vCapacity.assign(ctFaces, 0);
+		for(U32 i=0; i < ctFaces; i++)
+			vCapacity[i] = vUnique[i].count;
+		pmesh->m_incident_cells_per_face.reserve_lists(vCapacity);
+		pmesh->m_isFacesIndexDirty = true;
+	}
+
+	//5.cells
+	pmesh->m_vCells.resize(ctCells);
+	parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			CELL& cell = pmesh->m_vCells[i];
+			const U32* nodes = &elements[vCells[i] * 4];
+
+			for(int j=0; j < COUNT_CELL_NODES; j++)
+				cell.nodes[j] = nodes[j];
+			for(int j=0; j < COUNT_CELL_FACES; j++)
+				cell.faces[j] = vCellFaceHandles[i * COUNT_CELL_FACES + j];
+			for(int j=0; j < COUNT_CELL_EDGES; j++)
+				cell.edges[j] = vCellEdgeHandles[i * COUNT_CELL_EDGES + j];
+		}
+	});
+
+	for(U32 i=0; i < ctCells; i++) {
+		const CELL& cell = pmesh->m_vCells[i];
+		for(int j=0; j < COUNT_CELL_FACES; j++)
+			pmesh->m_incident_cells_per_face.push_back(cell.faces[j], i);
+	}
+	pmesh->buildCellAdjacency();
+
+	//6.topology events in handle order
+	{
+		ProfileAutoArg("bulk setup:events");
+		for(U32 i=0; i < pmesh->countNodes(); i++)
+			pmesh->notifyNodeEvent(i, VolMesh::teAdded);
+		for(U32 i=0; i < pmesh->countEdges(); i++)
+			pmesh->notifyEdgeEvent(i, VolMesh::teAdded);
+		for(U32 i=0; i < pmesh->countFaces(); i++)
+			pmesh->notifyFaceEvent(i, VolMesh::teAdded);
+		for(U32 i=0; i < pmesh->countCells(); i++)
+			pmesh->notifyElemEvent(i, VolMesh::teAdded);
+	}
+
+	return true;
+}
+
+}
+}
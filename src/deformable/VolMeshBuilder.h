@@ -0,0 +1,39 @@
+/*
+ * VolMeshBuilder.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef VOLMESHBUILDER_H_
+#define VOLMESHBUILDER_H_
+
+#include "VolMesh.h"
+
+namespace PS {
+namespace MESH {
+
+/*!
+ * Builds a volume mesh from flat vertex and element arrays in a few parallel
+ * sort and scan passes instead of inserting the tets one at a time.
+ * The result is identical to the incremental path in VolMesh::setup:
+ * 1. Edges are numbered by the first cell using them and then by their key
+ * 2. Faces are numbered by the first cell and cell face using them
+ * 3. All incidence lists are in increasing handle order
+ */
+class VolMeshBuilder {
+public:
+	/*!
+	 * builds the mesh from scratch. Previous content is cleaned up.
+	 * @return false if the input contains cells that only the incremental path
+	 * can reproduce (repeated nodes in a cell with the flat cell filter off)
+	 */
+	static bool build(VolMesh* pmesh,
+					  U32 ctVertices, const double* vertices,
+					  U32 ctElements, const U32* elements);
+};
+
+}
+}
+
+#endif /* VOLMESHBUILDER_H_ */
@@ -144,6 +144,24 @@ namespace MESH {
 	    U32 m_key;
 	};
 
+	//maps old handles to new ones after a compaction. Removed handles map to INVALID.
+	class HandleRemap {
+	public:
+		HandleRemap(const vector<U32>& remap) : m_remap(remap) {}
+
+		void remapVecValue(std::vector<U32>& _vec) {
+			std::for_each(_vec.begin(), _vec.end(), std::bind(&HandleRemap::remapValue, this, std::placeholders::_1));
+		}
+
+		void remapValue(U32& rhs) {
+			if(rhs < m_remap.size())
+				rhs = m_remap[rhs];
+		}
+
+	private:
+		const vector<U32>& m_remap;
+	};
+
 	//handles index correction in parallel
 	class HandleCorrectionParallel {
 	public:
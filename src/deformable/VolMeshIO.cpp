@@ -8,14 +8,187 @@
 #include "VolMeshIO.h"
 #include "base/FileDirectory.h"
 #include "base/Logger.h"
+#include "base/Profiler.h"
 #include "base/FlatArray.h"
 #include "graphics/Mesh.h"
 #include <fstream>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 using namespace std;
 using namespace PS::MESH;
 using namespace PS::FILESTRINGUTILS;
 
+//binary format
+#define VMB_MAGIC	0x4D565350	//PSVM
+#define VMB_VERSION	1
+#define VMB_ALIGNMENT	64
+
+enum VMBFlags {vmbfTopology = 1};
+
+enum VMBSections {
+	vmbsNodePos, vmbsNodeRestPos,
+	vmbsCellNodes, vmbsCellFaces, vmbsCellEdges,
+	vmbsEdges, vmbsFaces,
+	vmbsEdgesPerNodeOffsets, vmbsEdgesPerNode,
+	vmbsFacesPerEdgeOffsets, vmbsFacesPerEdge,
+	vmbsCellsPerFaceOffsets, vmbsCellsPerFace,
+	vmbsCount
+};
+
+struct VMBSection {
+	U64 offset;
+	U64 size;
+};
+
+struct VMBHeader {
+	U32 magic;
+	U32 version;
+	U32 flags;
+	U32 szHeader;
+	U32 ctNodes;
+	U32 ctEdges;
+	U32 ctFaces;
+	U32 ctCells;
+	U64 szFile;
+	VMBSection sections[vmbsCount];
+};
+
+//read-only view of a whole file. Mapped where the platform allows it.
+class MappedFile {
+public:
+	MappedFile():m_lpData(NULL), m_szFile(0), m_isMapped(false) {}
+	~MappedFile() { close();}
+
+	bool open(const AnsiStr& strPath) {
+#ifdef _WIN32
+		ifstream fpIn(strPath.cptr(), ios::binary | ios::ate);
+		if(!fpIn.is_open())
+			return false;
+
+		m_szFile = fpIn.tellg();
+		m_vBuffer.resize(m_szFile);
+		fpIn.seekg(0, ios::beg);
+		fpIn.read(&m_vBuffer[0], m_szFile);
+		m_lpData = reinterpret_cast<const U8*>(m_vBuffer.data());
+		return fpIn.good();
+#else
+		int fd = ::open(strPath.cptr(), O_RDONLY);
+		if(fd < 0)
+			return false;
+
+		struct stat st;
+		if(fstat(fd, &st) != 0 || st.st_size == 0) {
+			::close(fd);
+			return false;
+		}
+
+		m_szFile = st.st_size;
+		void* lpMap = mmap(NULL, m_szFile, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if(lpMap == MAP_FAILED)
+			return false;
+
+		m_lpData = reinterpret_cast<const U8*>(lpMap);
+		m_isMapped = true;
+		return true;
+#endif
+	}
+
+	void close() {
+#ifndef _WIN32
+		if(m_isMapped)
+			munmap(const_cast<U8*>(m_lpData), m_szFile);
+#endif
+		m_lpData = NULL;
+		m_szFile = 0;
+		m_isMapped = false;
+		m_vBuffer.resize(0);
+	}
+
+	const U8* data() const { return m_lpData;}
+	U64 size() const { return m_szFile;}
+
+private:
+	const U8* m_lpData;
+	U64 m_szFile;
+	bool m_isMapped;
+	vector<char> m_vBuffer;
+};
+
+//returns the section if it fits in the file and holds count elements
+template <typename T>
+static const T* GetSection(const MappedFile& mf, const VMBHeader& header, int idxSection, U64 count) {
+	const VMBSection& sec = header.sections[idxSection];
+	if(sec.size != count * sizeof(T) || (sec.offset % VMB_ALIGNMENT) != 0)
+		return NULL;
+	//no sum, a huge offset would wrap around
+	if(sec.offset > mf.size() || sec.size > mf.size() - sec.offset)
+		return NULL;
+
+	return reinterpret_cast<const T*>(mf.data() + sec.offset);
+}
+
+static bool IsValidHandleArray(const U32* lpHandles, U64 count, U32 ctEntities) {
+	for(U64 i=0; i < count; i++)
+		if(lpHandles[i] >= ctEntities)
+			return false;
+	return true;
+}
+
+static bool IsValidOffsets(const U32* lpOffsets, U32 ctLists, U64 ctValues) {
+	if(lpOffsets[0] != 0 || lpOffsets[ctLists] != ctValues)
+		return false;
+
+	for(U32 i=0; i < ctLists; i++)
+		if(lpOffsets[i] > lpOffsets[i + 1])
+			return false;
+	return true;
+}
+
+//writes a section padded to the alignment and records its location
+static void WriteSection(ofstream& fpOut, VMBHeader& header, int idxSection, const void* lpData, U64 szBytes) {
+	static const char zeros[VMB_ALIGNMENT] = {0};
+
+	U64 offset = fpOut.tellp();
+	header.sections[idxSection].offset = offset;
+	header.sections[idxSection].size = szBytes;
+	if(szBytes > 0)
+		fpOut.write(reinterpret_cast<const char*>(lpData), szBytes);
+
+	U64 pad = (VMB_ALIGNMENT - (szBytes % VMB_ALIGNMENT)) % VMB_ALIGNMENT;
+	fpOut.write(zeros, pad);
+}
+
+//flattens an incidence table to CSR
+static void FlattenIncidence(const IncidenceTable& table, vector<U32>& offsets, vector<U32>& values) {
+	offsets.resize(table.size() + 1);
+	values.resize(0);
+	offsets[0] = 0;
+	for(U32 i=0; i < table.size(); i++) {
+		values.insert(values.end(), table.begin(i), table.end(i));
+		offsets[i + 1] = values.size();
+	}
+}
+
+static void LoadIncidence(IncidenceTable& table, U32 ctLists, const U32* lpOffsets, const U32* lpValues) {
+	vector<U32> vCapacity(ctLists);
+	for(U32 i=0; i < ctLists; i++)
+		vCapacity[i] = lpOffsets[i + 1] - lpOffsets[i];
+
+	table.reserve_lists(vCapacity);
+	for(U32 i=0; i < ctLists; i++) {
+		for(U32 k=lpOffsets[i]; k < lpOffsets[i + 1]; k++)
+			table.push_back(i, lpValues[k]);
+	}
+}
+
 bool VolMeshIO::readVega(VolMesh* vm, const AnsiStr& strPath) {
 
 	if ((vm == NULL) || !FileExists(strPath))
@@ -187,7 +360,7 @@ bool VolMeshIO::writeVega(const VolMesh* vm, const AnsiStr& strPath) {
 	fpOut << vm->countNodes() << " 3 0 0\n";
 
 	for (U32 i = 0; i < vm->countNodes(); i++) {
-		vec3d v = vm->const_nodeAt(i).pos;
+		vec3d v = vm->nodePos(i);
 
 		//VEGA expects one based index for everything
 		fpOut << i + 1 << " " << v.x << " " << v.y << " " << v.z << "\n";
@@ -223,6 +396,286 @@ bool VolMeshIO::writeVega(const VolMesh* vm, const AnsiStr& strPath) {
 	return true;
 }
 
+bool VolMeshIO::readBinary(VolMesh* vm, const AnsiStr& strPath) {
+	if(vm == NULL)
+		return false;
+
+	ProfileAutoArg("read binary mesh");
+
+	MappedFile mf;
+	if(!mf.open(strPath)) {
+		LogErrorArg1("Unable to open binary mesh file: %s", strPath.cptr());
+		return false;
+	}
+
+	//header
+	if(mf.size() < sizeof(VMBHeader)) {
+		LogErrorArg1("Binary mesh file is truncated: %s", strPath.cptr());
+		return false;
+	}
+
+	VMBHeader header;
+	memcpy(&header, mf.data(), sizeof(VMBHeader));
+	if(header.magic != VMB_MAGIC || header.szHeader != sizeof(VMBHeader)) {
+		LogErrorArg1("Not a binary mesh file or wrong byte order: %s", strPath.cptr());
+		return false;
+	}
+
+	if(header.version != VMB_VERSION) {
+		LogErrorArg2("Unsupported binary mesh version %u. Expected %u.", header.version, VMB_VERSION);
+		return false;
+	}
+
+	if(header.szFile != mf.size()) {
+		LogErrorArg2("Binary mesh file size mismatch. Expected %llu, GOT: %llu",
+					 (unsigned long long)header.szFile, (unsigned long long)mf.size());
+		return false;
+	}
+
+	//nodes and cells are always present
+	const U32 ctNodes = header.ctNodes;
+	const U32 ctCells = header.ctCells;
+	const double* lpPos = GetSection<double>(mf, header, vmbsNodePos, (U64)ctNodes * 3);
+	const double* lpRestPos = GetSection<double>(mf, header, vmbsNodeRestPos, (U64)ctNodes * 3);
+	const U32* lpCellNodes = GetSection<U32>(mf, header, vmbsCellNodes, (U64)ctCells * COUNT_CELL_NODES);
+	if(!lpPos || !lpRestPos || !lpCellNodes ||
+	   !IsValidHandleArray(lpCellNodes, (U64)ctCells * COUNT_CELL_NODES, ctNodes)) {
+		LogErrorArg1("Invalid nodes or cells in binary mesh file: %s", strPath.cptr());
+		return false;
+	}
+
+	//without topology the mesh is built from nodes and cells
+	if((header.flags & vmbfTopology) == 0) {
+		if(!vm->setup(ctNodes, lpPos, ctCells, lpCellNodes))
+			return false;
+
+		for(U32 i=0; i < ctNodes; i++)
+			vm->m_nodes.setRestPos(i, vec3d(&lpRestPos[i * 3]));
+		vm->setName(ExtractFileTitleOnly(strPath).cptr());
+		return true;
+	}
+
+	//topology
+	const U32 ctEdges = header.ctEdges;
+	const U32 ctFaces = header.ctFaces;
+	const U32* lpCellFaces = GetSection<U32>(mf, header, vmbsCellFaces, (U64)ctCells * COUNT_CELL_FACES);
+	const U32* lpCellEdges = GetSection<U32>(mf, header, vmbsCellEdges, (U64)ctCells * COUNT_CELL_EDGES);
+	const U32* lpEdges = GetSection<U32>(mf, header, vmbsEdges, (U64)ctEdges * 2);
+	const U32* lpFaces = GetSection<U32>(mf, header, vmbsFaces, (U64)ctFaces * COUNT_FACE_EDGES);
+	const U32* lpEdgesPerNodeOffsets = GetSection<U32>(mf, header, vmbsEdgesPerNodeOffsets, (U64)ctNodes + 1);
+	const U32* lpFacesPerEdgeOffsets = GetSection<U32>(mf, header, vmbsFacesPerEdgeOffsets, (U64)ctEdges + 1);
+	const U32* lpCellsPerFaceOffsets = GetSection<U32>(mf, header, vmbsCellsPerFaceOffsets, (U64)ctFaces + 1);
+	if(!lpCellFaces || !lpCellEdges || !lpEdges || !lpFaces ||
+	   !lpEdgesPerNodeOffsets || !lpFacesPerEdgeOffsets || !lpCellsPerFaceOffsets) {
+		LogErrorArg1("Missing topology sections in binary mesh file: %s", strPath.cptr());
+		return false;
+	}
+
+	const U64 ctEdgesPerNode = header.sections[vmbsEdgesPerNode].size / sizeof(U32);
+	const U64 ctFacesPerEdge = header.sections[vmbsFacesPerEdge].size / sizeof(U32);
+	const U64 ctCellsPerFace = header.sections[vmbsCellsPerFace].size / sizeof(U32);
+	const U32* lpEdgesPerNode = GetSection<U32>(mf, header, vmbsEdgesPerNode, ctEdgesPerNode);
+	const U32* lpFacesPerEdge = GetSection<U32>(mf, header, vmbsFacesPerEdge, ctFacesPerEdge);
+	const U32* lpCellsPerFace = GetSection<U32>(mf, header, vmbsCellsPerFace, ctCellsPerFace);
+
+	bool valid = lpEdgesPerNode && lpFacesPerEdge && lpCellsPerFace;
+	valid = valid && IsValidHandleArray(lpCellFaces, (U64)ctCells * COUNT_CELL_FACES, ctFaces);
+	valid = valid && IsValidHandleArray(lpCellEdges, (U64)ctCells * COUNT_CELL_EDGES, ctEdges);
+	valid = valid && IsValidHandleArray(lpEdges, (U64)ctEdges * 2, ctNodes);
+	valid = valid && IsValidHandleArray(lpFaces, (U64)ctFaces * COUNT_FACE_EDGES, ctEdges);
+	valid = valid && IsValidOffsets(lpEdgesPerNodeOffsets, ctNodes, ctEdgesPerNode);
+	valid = valid && IsValidOffsets(lpFacesPerEdgeOffsets, ctEdges, ctFacesPerEdge);
+	valid = valid && IsValidOffsets(lpCellsPerFaceOffsets, ctFaces, ctCellsPerFace);
+	valid = valid && IsValidHandleArray(lpEdgesPerNode, ctEdgesPerNode, ctEdges);
+	valid = valid && IsValidHandleArray(lpFacesPerEdge, ctFacesPerEdge, ctFaces);
+	valid = valid && IsValidHandleArray(lpCellsPerFace, ctCellsPerFace, ctCells);
+	for(U32 i=0; valid && i < ctEdges; i++)
+		valid = (lpEdges[i * 2] != lpEdges[i * 2 + 1]);
+
+	if(!valid) {
+		LogErrorArg1("Invalid topology in binary mesh file: %s", strPath.cptr());
+		return false;
+	}
+
+	//copy into the containers
+	vm->cleanup();
+
+	vm->m_nodes.resize(ctNodes);
+	for(U32 i=0; i < ctNodes; i++) {
+		vm->m_nodes.setPos(i, vec3d(&lpPos[i * 3]));
+		vm->m_nodes.setRestPos(i, vec3d(&lpRestPos[i * 3]));
+	}
+
+	vm->m_vEdges.resize(ctEdges);
+	vm->m_hashEdgesIndex.reserve(ctEdges);
+	for(U32 i=0; i < ctEdges; i++) {
+		EDGE& e = vm->m_vEdges[i];
+		e.from = lpEdges[i * 2];
+		e.to = lpEdges[i * 2 + 1];
+		if(!vm->m_hashEdgesIndex.insert(EdgeKey(e.from, e.to).key, i)) {
+			LogErrorArg1("Duplicate edge %u in binary mesh file.", i);
+			vm->cleanup();
+			return false;
+		}
+	}
+
+	vm->m_vFaces.resize(ctFaces);
+	for(U32 i=0; i < ctFaces; i++) {
+		for(int j=0; j < COUNT_FACE_EDGES; j++)
+			vm->m_vFaces[i].edges[j] = lpFaces[i * COUNT_FACE_EDGES + j];
+	}
+
+	vm->m_vCells.resize(ctCells);
+	for(U32 i=0; i < ctCells; i++) {
+		CELL& cell = vm->m_vCells[i];
+		for(int j=0; j < COUNT_CELL_NODES; j++)
+			cell.nodes[j] = lpCellNodes[i * COUNT_CELL_NODES + j];
+		for(int j=0; j < COUNT_CELL_FACES; j++)
+			cell.faces[j] = lpCellFaces[i * COUNT_CELL_FACES + j];
+		for(int j=0; j < COUNT_CELL_EDGES; j++)
+			cell.edges[j] = lpCellEdges[i * COUNT_CELL_EDGES + j];
+	}
+
+	LoadIncidence(vm->m_incident_edges_per_node, ctNodes, lpEdgesPerNodeOffsets, lpEdgesPerNode);
+	LoadIncidence(vm->m_incident_faces_per_edge, ctEdges, lpFacesPerEdgeOffsets, lpFacesPerEdge);
+	LoadIncidence(vm->m_incident_cells_per_face, ctFaces, lpCellsPerFaceOffsets, lpCellsPerFace);
+	vm->buildCellAdjacency();
+	vm->m_isFacesIndexDirty = true;
+
+	//topology events in handle order
+	for(U32 i=0; i < vm->countNodes(); i++)
+		vm->notifyNodeEvent(i, VolMesh::teAdded);
+	for(U32 i=0; i < vm->countEdges(); i++)
+		vm->notifyEdgeEvent(i, VolMesh::teAdded);
+	for(U32 i=0; i < vm->countFaces(); i++)
+		vm->notifyFaceEvent(i, VolMesh::teAdded);
+	for(U32 i=0; i < vm->countCells(); i++)
+		vm->notifyElemEvent(i, VolMesh::teAdded);
+
+	vm->computeAABB();
+	vm->setName(ExtractFileTitleOnly(strPath).cptr());
+	return true;
+}
+
+bool VolMeshIO::writeBinary(const VolMesh* vm, const AnsiStr& strPath, bool includeTopology) {
+	if(vm == NULL)
+		return false;
+
+	if (vm->countNodes() == 0 || vm->countCells() == 0)
+		return false;
+
+	ofstream fpOut(strPath.cptr(), ios::binary | ios::trunc);
+	if(!fpOut.is_open())
+		return false;
+
+	VMBHeader header;
+	memset(&header, 0, sizeof(VMBHeader));
+	header.magic = VMB_MAGIC;
+	header.version = VMB_VERSION;
+	header.flags = includeTopology ? vmbfTopology : 0;
+	header.szHeader = sizeof(VMBHeader);
+	header.ctNodes = vm->countNodes();
+	header.ctEdges = includeTopology ? vm->countEdges() : 0;
+	header.ctFaces = includeTopology ? vm->countFaces() : 0;
+	header.ctCells = vm->countCells();
+
+	//header is rewritten once all sections are placed
+	static const char zeros[VMB_ALIGNMENT] = {0};
+	fpOut.write(reinterpret_cast<const char*>(&header), sizeof(VMBHeader));
+	fpOut.write(zeros, (VMB_ALIGNMENT - (sizeof(VMBHeader) % VMB_ALIGNMENT)) % VMB_ALIGNMENT);
+
+	//nodes
+	const U32 ctNodes = vm->countNodes();
+	vector<double> vFlat(ctNodes * 3);
+	vm->const_nodes().flattenPos(vFlat.data());
+	WriteSection(fpOut, header, vmbsNodePos, vFlat.data(), vFlat.size() * sizeof(double));
+
+	for(U32 i=0; i < ctNodes; i++) {
+		vec3d p = vm->nodeRestPos(i);
+		for(int d=0; d < 3; d++)
+			vFlat[i * 3 + d] = p[d];
+	}
+	WriteSection(fpOut, header, vmbsNodeRestPos, vFlat.data(), vFlat.size() * sizeof(double));
+
+	//cells
+	const U32 ctCells = vm->countCells();
+	vector<U32> vData(ctCells * COUNT_CELL_NODES);
+	for(U32 i=0; i < ctCells; i++)
+		for(int j=0; j < COUNT_CELL_NODES; j++)
+			vData[i * COUNT_CELL_NODES + j] = vm->const_cellAt(i).nodes[j];
+	WriteSection(fpOut, header, vmbsCellNodes, vData.data(), vData.size() * sizeof(U32));
+
+	if(includeTopology) {
+		vData.resize(ctCells * COUNT_CELL_FACES);
+		for(U32 i=0; i < ctCells; i++)
+			for(int j=0; j < COUNT_CELL_FACES; j++)
+				vData[i * COUNT_CELL_FACES + j] = vm->const_cellAt(i).faces[j];
+		WriteSection(fpOut, header, vmbsCellFaces, vData.data(), vData.size() * sizeof(U32));
+
+		vData.resize(ctCells * COUNT_CELL_EDGES);
+		for(U32 i=0; i < ctCells; i++)
+			for(int j=0; j < COUNT_CELL_EDGES; j++)
+				vData[i * COUNT_CELL_EDGES + j] = vm->const_cellAt(i).edges[j];
+		WriteSection(fpOut, header, vmbsCellEdges, vData.data(), vData.size() * sizeof(U32));
+
+		//edges and faces
+		vData.resize(vm->countEdges() * 2);
+		for(U32 i=0; i < vm->countEdges(); i++) {
+			vData[i * 2] = vm->const_edgeAt(i).from;
+			vData[i * 2 + 1] = vm->const_edgeAt(i).to;
+		}
+		WriteSection(fpOut, header, vmbsEdges, vData.data(), vData.size() * sizeof(U32));
+
+		vData.resize(vm->countFaces() * COUNT_FACE_EDGES);
+		for(U32 i=0; i < vm->countFaces(); i++)
+			for(int j=0; j < COUNT_FACE_EDGES; j++)
+				vData[i * COUNT_FACE_EDGES + j] = vm->const_faceAt(i).edges[j];
+		WriteSection(fpOut, header, vmbsFaces, vData.data(), vData.size() * sizeof(U32));
+
+		//incidence lists in CSR form
+		vector<U32> vOffsets;
+		FlattenIncidence(vm->m_incident_edges_per_node, vOffsets, vData);
+		WriteSection(fpOut, header, vmbsEdgesPerNodeOffsets, vOffsets.data(), vOffsets.size() * sizeof(U32));
+		WriteSection(fpOut, header, vmbsEdgesPerNode, vData.data(), vData.size() * sizeof(U32));
+
+		FlattenIncidence(vm->m_incident_faces_per_edge, vOffsets, vData);
+		WriteSection(fpOut, header, vmbsFacesPerEdgeOffsets, vOffsets.data(), vOffsets.size() * sizeof(U32));
+		WriteSection(fpOut, header, vmbsFacesPerEdge, vData.data(), vData.size() * sizeof(U32));
+
+		FlattenIncidence(vm->m_incident_cells_per_face, vOffsets, vData);
+		WriteSection(fpOut, header, vmbsCellsPerFaceOffsets, vOffsets.data(), vOffsets.size() * sizeof(U32));
+		WriteSection(fpOut, header, vmbsCellsPerFace, vData.data(), vData.size() * sizeof(U32));
+	}
+
+	header.szFile = fpOut.tellp();
+	fpOut.seekp(0, ios::beg);
+	fpOut.write(reinterpret_cast<const char*>(&header), sizeof(VMBHeader));
+	fpOut.close();
+
+	return !fpOut.fail();
+}
+
+bool VolMeshIO::convertVegaToBinary(const AnsiStr& strVegaFP, const AnsiStr& strBinaryFP) {
+	VolMesh temp;
+	temp.setFlagFilterOutFlatCells(false);
+	if(!readVega(&temp, strVegaFP)) {
+		LogErrorArg1("Unable to read vega file: %s", strVegaFP.cptr());
+		return false;
+	}
+
+	AnsiStr strOutput = strBinaryFP;
+	if(strOutput.length() == 0)
+		strOutput = ChangeFileExt(strVegaFP, ".vmb");
+
+	if(!writeBinary(&temp, strOutput, true)) {
+		LogErrorArg1("Unable to write binary mesh file: %s", strOutput.cptr());
+		return false;
+	}
+
+	LogInfoArg2("Converted %s to %s", strVegaFP.cptr(), strOutput.cptr());
+	return true;
+}
+
 bool VolMeshIO::writeObj(const VolMesh* vm, const AnsiStr& strPath) {
 
 	if(vm == NULL)
@@ -233,7 +686,7 @@ bool VolMeshIO::writeObj(const VolMesh* vm, const AnsiStr& strPath) {
 
 	//output nodes
 	for (U32 i = 0; i < vm->countNodes(); i++) {
-		vec3d v = vm->const_nodeAt(i).pos;
+		vec3d v = vm->nodePos(i);
 
 		aNode->addVertex(vec3f(v.x, v.y, v.z));
 	}
@@ -275,7 +728,7 @@ bool VolMeshIO::fitmesh(VolMesh* vm, const AABB& toBox) {
 bool VolMeshIO::fitmesh(VolMesh* vm, const vec3d& scale, const vec3d& translate) {
 	//first translate all nodes
 	for(U32 i=0; i < vm->countNodes(); i++) {
-		NODE& p = vm->nodeAt(i);
+		NODE p = vm->const_nodeAt(i);
 
 		//translate
 		p.pos = p.pos + translate;
@@ -284,6 +737,7 @@ bool VolMeshIO::fitmesh(VolMesh* vm, const vec3d& scale, const vec3d& translate)
 		//scale
 		p.pos = vec3d::mul(p.pos, scale);
 		p.restpos = vec3d::mul(p.restpos, scale);
+		vm->setNode(i, p);
 	}
 
 	return true;
@@ -297,10 +751,11 @@ bool VolMeshIO::rotatemesh(VolMesh* vm, const quatd& quat) {
 
 	//first translate all nodes
 	for(U32 i=0; i < vm->countNodes(); i++) {
-		NODE& p = vm->nodeAt(i);
+		NODE p = vm->const_nodeAt(i);
 
 		p.pos = quat.transform(qInv, p.pos);
 		p.restpos = quat.transform(qInv, p.restpos);
+		vm->setNode(i, p);
 	}
 
 	return true;
@@ -19,6 +19,18 @@ public:
 	static bool readVega(VolMesh* vm, const AnsiStr& strPath);
 	static bool writeVega(const VolMesh* vm, const AnsiStr& strPath);
 
+	/*!
+	 * Versioned binary format (.vmb). All sections start on a cache line so the file
+	 * is mapped and copied into the mesh containers after validation. With topology
+	 * the edges, faces and incidence lists are stored as well and nothing is rebuilt
+	 * on load. Rest positions are kept, so a cut mesh can be snapshotted and reloaded.
+	 */
+	static bool readBinary(VolMesh* vm, const AnsiStr& strPath);
+	static bool writeBinary(const VolMesh* vm, const AnsiStr& strPath, bool includeTopology = true);
+
+	//converts a vega file to the binary format. Output defaults to the input path with .vmb extension.
+	static bool convertVegaToBinary(const AnsiStr& strVegaFP, const AnsiStr& strBinaryFP = AnsiStr(""));
+
 	//only export to obj file for inspection purposes
 	static bool writeObj(const VolMesh* vm, const AnsiStr& strPath);
 
@@ -0,0 +1,275 @@
+/*
+ * VolMeshParts.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#include "VolMeshParts.h"
+#include "VolMesh.h"
+#include "base/Profiler.h"
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+using namespace tbb;
+
+namespace PS {
+namespace MESH {
+
+typedef std::atomic<U32> AtomicHandle;
+
+//label of cells added since the last update
+static const U32 INVALID_PART = VolMesh::INVALID_INDEX;
+
+//parents only ever point to smaller handles so every root is the smallest cell of its set
+static U32 FindRoot(AtomicHandle* parents, U32 x) {
+	U32 p = parents[x].load();
+	while(p != x) {
+		//path halving
+		U32 gp = parents[p].load();
+		if(gp != p) {
+			U32 expected = p;
+			parents[x].compare_exchange_weak(expected, gp);
+		}
+
+		x = gp;
+		p = parents[x].load();
+	}
+
+	return x;
+}
+
+static void UniteSets(AtomicHandle* parents, U32 a, U32 b) {
+	while(true) {
+		a = FindRoot(parents, a);
+		b = FindRoot(parents, b);
+		if(a == b)
+			return;
+
+		//link the larger root under the smaller one
+		if(a < b)
+			std::swap(a, b);
+
+		U32 expected = a;
+		if(parents[a].compare_exchange_strong(expected, b))
+			return;
+	}
+}
+
+VolMeshParts::VolMeshParts() {
+	reset();
+}
+
+VolMeshParts::~VolMeshParts() {
+}
+
+void VolMeshParts::reset() {
+	m_vLabels.resize(0);
+	m_vDirtyParts.resize(0);
+	m_vRemoved.resize(0);
+	m_ctDirty = 0;
+	m_ctAdded = 0;
+	m_ctParts = 0;
+	m_isValid = false;
+}
+
+void VolMeshParts::cellAdded(U32 idxCell) {
+	if(!m_isValid)
+		return;
+
+	flushRemoved();
+
+	//cells are only appended
+	if(idxCell != m_vLabels.size()) {
+		m_isValid = false;
+		return;
+	}
+
+	m_vLabels.push_back(INVALID_PART);
+	m_ctAdded++;
+}
+
+void VolMeshParts::cellRemoved(U32 idxCell) {
+	if(!m_isValid)
+		return;
+
+	//pending handles are only valid while removals keep decreasing
+	if(m_vRemoved.size() > 0 && idxCell >= m_vRemoved.back())
+		flushRemoved();
+
+	if(idxCell >= m_vLabels.size()) {
+		m_isValid = false;
+		return;
+	}
+
+	//the neighbors of a removed cell share its part so only that part may split
+	U32 idxPart = m_vLabels[idxCell];
+	if(idxPart == INVALID_PART)
+		m_ctAdded--;
+	else
+		markDirty(idxPart);
+
+	m_vRemoved.push_back(idxCell);
+}
+
+void VolMeshParts::flushRemoved() {
+	if(m_vRemoved.size() == 0)
+		return;
+
+	//pending handles are in decreasing order
+	U32 ctLabels = m_vLabels.size();
+	U32 idxDst = m_vRemoved.back();
+	U32 idxNext = m_vRemoved.size() - 1;
+	for(U32 i = idxDst; i < ctLabels; i++) {
+		if(idxNext < m_vRemoved.size() && m_vRemoved[idxNext] == i) {
+			idxNext--;
+			continue;
+		}
+
+		m_vLabels[idxDst++] = m_vLabels[i];
+	}
+
+	m_vLabels.resize(idxDst);
+	m_vRemoved.resize(0);
+}
+
+void VolMeshParts::markDirty(U32 idxPart) {
+	if(idxPart < m_vDirtyParts.size() && !m_vDirtyParts[idxPart]) {
+		m_vDirtyParts[idxPart] = 1;
+		m_ctDirty++;
+	}
+}
+
+U32 VolMeshParts::update(const VolMesh* pmesh) {
+	flushRemoved();
+
+	if(!m_isValid || m_vLabels.size() != pmesh->countCells())
+		return labelAll(pmesh);
+
+	if(m_ctDirty == 0 && m_ctAdded == 0)
+		return m_ctParts;
+
+	return labelDirty(pmesh);
+}
+
+U32 VolMeshParts::labelAll(const VolMesh* pmesh) {
+
+	ProfileAutoArg("parts:label all");
+
+	const U32 ctCells = pmesh->countCells();
+	std::unique_ptr<AtomicHandle[]> parents(new AtomicHandle[ctCells]);
+
+	tbb::parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++)
+			parents[i].store(i);
+	});
+
+	//every interior face is visited from its smaller cell
+	tbb::parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			for(int j = 0; j < COUNT_CELL_FACES; j++) {
+				U32 idxNeighbor = pmesh->cell_neighbor(i, j);
+				if(idxNeighbor > i && idxNeighbor < ctCells)
+					UniteSets(parents.get(), i, idxNeighbor);
+			}
+		}
+	});
+
+	vector<U32> vRoots(ctCells);
+	tbb::parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++)
+			vRoots[i] = FindRoot(parents.get(), i);
+	});
+
+	return renumber(vRoots, ctCells);
+}
+
+U32 VolMeshParts::labelDirty(const VolMesh* pmesh) {
+
+	ProfileAutoArg("parts:label dirty");
+
+	//region is the new cells and all cells of the parts that lost a cell
+	const U32 ctCells = pmesh->countCells();
+	vector<U8> vInRegion(ctCells, 0);
+	vector<U32> vRegion;
+	for(U32 i = 0; i < ctCells; i++) {
+		U32 idxPart = m_vLabels[i];
+		if(idxPart == INVALID_PART || m_vDirtyParts[idxPart]) {
+			vInRegion[i] = 1;
+			vRegion.push_back(i);
+		}
+	}
+
+	//not worth it when the cut touched the largest part
+	if(vRegion.size() * 2 > ctCells)
+		return labelAll(pmesh);
+
+	std::unique_ptr<AtomicHandle[]> parents(new AtomicHandle[ctCells]);
+	for(U32 i = 0; i < vRegion.size(); i++)
+		parents[vRegion[i]].store(vRegion[i]);
+
+	//a region cell facing a clean part means two parts merged. New cells have the largest
+	//handles, so clean neighbours are checked on both sides of the handle order.
+	std::atomic<bool> isEscaped(false);
+	tbb::parallel_for(blocked_range<U32>(0, vRegion.size()), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			U32 idxCell = vRegion[i];
+			for(int j = 0; j < COUNT_CELL_FACES; j++) {
+				U32 idxNeighbor = pmesh->cell_neighbor(idxCell, j);
+				if(idxNeighbor >= ctCells)
+					continue;
+
+				if(!vInRegion[idxNeighbor])
+					isEscaped = true;
+				else if(idxNeighbor > idxCell)
+					UniteSets(parents.get(), idxCell, idxNeighbor);
+			}
+		}
+	});
+
+	if(isEscaped)
+		return labelAll(pmesh);
+
+	//clean cells keep their part, region cells are keyed by their root after them
+	vector<U32> vKeys(ctCells);
+	const U32 ctOldParts = m_ctParts;
+	tbb::parallel_for(blocked_range<U32>(0, ctCells), [&](const blocked_range<U32>& r) {
+		for(U32 i = r.begin(); i != r.end(); i++) {
+			if(vInRegion[i])
+				vKeys[i] = ctOldParts + FindRoot(parents.get(), i);
+			else
+				vKeys[i] = m_vLabels[i];
+		}
+	});
+
+	return renumber(vKeys, ctOldParts + ctCells);
+}
+
+U32 VolMeshParts::renumber(const vector<U32>& vKeys, U32 ctKeys) {
+	vector<U32> vPartIds(ctKeys, INVALID_PART);
+
+	//the first cell seen per key is the smallest one of its part
+	U32 ctParts = 0;
+	m_vLabels.resize(vKeys.size());
+	for(U32 i = 0; i < vKeys.size(); i++) {
+		U32& idxPart = vPartIds[vKeys[i]];
+		if(idxPart == INVALID_PART)
+			idxPart = ctParts++;
+		m_vLabels[i] = idxPart;
+	}
+
+	//labels are in sync with the mesh
+	m_ctParts = ctParts;
+	m_vDirtyParts.assign(ctParts, 0);
+	m_ctDirty = 0;
+	m_ctAdded = 0;
+	m_isValid = true;
+
+	return m_ctParts;
+}
+
+}
+}
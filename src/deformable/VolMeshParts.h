@@ -0,0 +1,79 @@
+/*
+ * VolMeshParts.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: pourya
+ */
+
+#ifndef VOLMESHPARTS_H_
+#define VOLMESHPARTS_H_
+
+#include "base/MathBase.h"
+#include <vector>
+
+using namespace std;
+
+namespace PS {
+namespace MESH {
+
+class VolMesh;
+
+/*!
+ * Dense per-cell part labels for the connected components of a volume mesh. Two cells
+ * belong to the same part when they share a face. Parts are numbered in increasing
+ * order of their smallest cell handle which is the order a serial flood fill visits them.
+ * Labelling is a lock-free union-find over the cell face neighbors and runs in parallel.
+ * The owning mesh reports cell additions and removals so that the next update only
+ * relabels the parts touched since the previous one.
+ */
+class VolMeshParts {
+public:
+	VolMeshParts();
+	~VolMeshParts();
+
+	//drops all labels. The next update labels the whole mesh.
+	void reset();
+
+	//topology hooks called by the mesh
+	void cellAdded(U32 idxCell);
+	void cellRemoved(U32 idxCell);
+
+	//brings the labels up to date and returns the number of parts
+	U32 update(const VolMesh* pmesh);
+
+	//labels computed by the last update
+	U32 countParts() const { return m_ctParts;}
+	const vector<U32>& const_labels() const { return m_vLabels;}
+
+	//true when the labels match the mesh without relabelling
+	bool isValid() const { return m_isValid && m_vRemoved.size() == 0 && m_ctDirty == 0;}
+
+protected:
+	void flushRemoved();
+	void markDirty(U32 idxPart);
+
+	U32 labelAll(const VolMesh* pmesh);
+	U32 labelDirty(const VolMesh* pmesh);
+
+	//assigns part ids in the order of the smallest cell per part
+	U32 renumber(const vector<U32>& vKeys, U32 ctKeys);
+
+private:
+	//part id per cell, invalid for cells added since the last update
+	vector<U32> m_vLabels;
+
+	//parts that lost a cell since the last update
+	vector<U8> m_vDirtyParts;
+	U32 m_ctDirty;
+	U32 m_ctAdded;
+	U32 m_ctParts;
+	bool m_isValid;
+
+	//removals arrive in decreasing handle order and are erased in one pass
+	vector<U32> m_vRemoved;
+};
+
+}
+}
+
+#endif /* VOLMESHPARTS_H_ */
@@ -7,6 +7,7 @@
 
 #include <deformable/VolMeshRender.h>
 #include "base/FlatArray.h"
+#include <algorithm>
 #include "graphics/SceneGraph.h"
 #include "graphics/selectgl.h"
 
@@ -38,6 +39,52 @@ private:
 
 };
 
+//slack on buffer capacities so that cuts append in place
+#define RENDER_CAPACITY_SLACK	1.5
+#define RENDER_MIN_CAPACITY	1024
+
+//dirty ranges closer than this are uploaded as one
+#define RENDER_UPLOAD_MERGE_GAP	32
+
+using namespace std::placeholders;
+
+//uploads the sorted dirty elements in merged runs to all buffers
+static void UploadRuns(const vector<U32>& vSorted, U32 szElement, const void* lpData,
+					   GLBufferType attribType, GLMeshBuffer* const* lpBuffers, int ctBuffers) {
+	if(vSorted.size() == 0)
+		return;
+
+	const U8* lpBytes = reinterpret_cast<const U8*>(lpData);
+	U32 start = vSorted[0];
+	U32 end = start + 1;
+	for(U32 i=1; i <= vSorted.size(); i++) {
+		if(i < vSorted.size() && vSorted[i] <= end + RENDER_UPLOAD_MERGE_GAP) {
+			end = MATHMAX(end, vSorted[i] + 1);
+			continue;
+		}
+
+		for(int j=0; j < ctBuffers; j++)
+			lpBuffers[j]->modifyBuffer(attribType, start * szElement, (end - start) * szElement, &lpBytes[start * szElement]);
+
+		if(i < vSorted.size()) {
+			start = vSorted[i];
+			end = start + 1;
+		}
+	}
+}
+
+//no gl context, e.g. benchmarks
+static bool g_isHeadless = false;
+
+//camera position for flipping the face normals
+static vec3d GetCameraPos() {
+	if(g_isHeadless)
+		return vec3d(0.0, 0.0, 0.0);
+
+	vec3f cp = TheSceneGraph::Instance().camera().getPos();
+	return vec3d(cp.x, cp.y, cp.z);
+}
+
 ///////////////////////////////////////////////////////////////////////
 VolMeshRender::VolMeshRender() {
 	init();
@@ -55,113 +102,130 @@ VolMeshRender::~VolMeshRender() {
 }
 
 void VolMeshRender::init() {
+	m_lpMesh = NULL;
+	m_isDirty = true;
+	m_isAllNodesDirty = false;
+	m_capacityNodes = m_capacitySlots = m_ctSlots = 0;
+	m_idxFirstShiftedNode = VolMesh::INVALID_INDEX;
+
 	resetTransform();
-	if(TheShaderManager::Instance().has("volmeshphong")) {
+	if(!g_isHeadless && TheShaderManager::Instance().has("volmeshphong")) {
         m_spEffect = SmartPtrSGEffect(new VolMeshEffect(TheShaderManager::Instance().get("volmeshphong")));
     }
 }
 
+void VolMeshRender::attach(VolMesh* pmesh) {
+	m_lpMesh = pmesh;
+	m_isDirty = true;
+	if(m_lpMesh == NULL)
+		return;
+
+	m_lpMesh->addNodeEventListener(std::bind(&VolMeshRender::onNodeEvent, this, _2, _3));
+	m_lpMesh->addEdgeEventListener(std::bind(&VolMeshRender::onEdgeEvent, this, _2, _3));
+	m_lpMesh->addFaceEventListener(std::bind(&VolMeshRender::onFaceEvent, this, _2, _3));
+	m_lpMesh->addElemEventListener(std::bind(&VolMeshRender::onElemEvent, this, _1, _3));
+}
+
 bool VolMeshRender::sync(const VolMesh* pmesh) {
 	if(pmesh == NULL)
 		return false;
 
+	if(pmesh != m_lpMesh || m_isDirty)
+		return syncAll(pmesh);
+
+	return syncChanges(pmesh);
+}
+
+bool VolMeshRender::syncAll(const VolMesh* pmesh) {
+
 	//cleanup the mesh
 	cleanup();
 
+	U32 ctNodes = pmesh->countNodes();
+	U32 ctFaces = pmesh->countFaces();
+	m_capacityNodes = MATHMAX((U32)(ctNodes * RENDER_CAPACITY_SLACK), (U32)RENDER_MIN_CAPACITY);
+	m_capacitySlots = MATHMAX((U32)(ctFaces * RENDER_CAPACITY_SLACK), (U32)RENDER_MIN_CAPACITY);
+	m_ctSlots = ctFaces;
+
 	//nodes
-	vector<double> vFlatNodes;
-	vector<double> vFlatNodeNormals;
-	vFlatNodes.resize(pmesh->countNodes() * 3);
-	vFlatNodeNormals.resize(pmesh->countNodes() * 3);
+	m_vFlatNodes.assign(m_capacityNodes * 3, 0.0);
+	m_vFlatNodeNormals.assign(m_capacityNodes * 3, 0.0);
 
 	//render for high performance
-	for(U32 i=0; i < pmesh->countNodes(); i++) {
-		const NODE& n = pmesh->const_nodeAt(i);
-
-		n.pos.store(&vFlatNodes[i * 3]);
-	}
+	pmesh->const_nodes().flattenPos(m_vFlatNodes.data());
 
 	//per node normals
 	vector<vec3d> vNodeNormals;
-	vNodeNormals.resize(pmesh->countNodes());
-
-	//per node normal update count
-	vector<U32> vNodalCount;
-	vNodalCount.resize(pmesh->countNodes());
-	std::fill(vNodalCount.begin(), vNodalCount.end(), 0);
+	vNodeNormals.assign(ctNodes, vec3d(0.0, 0.0, 0.0));
 
-	//copy all face indices
-	vector<U32> vIndices;
-	vIndices.resize(pmesh->countFaces() * 3);
+	//copy all face indices. Each face starts in the slot of its handle.
+	m_vIndices.assign(m_capacitySlots * 3, 0);
+	m_vSlotNormals.assign(m_capacitySlots, vec3d(0.0, 0.0, 0.0));
+	m_vFaceSlots.resize(ctFaces);
+	m_vFreeSlots.resize(0);
+	m_vRemovedFaces.resize(0);
+	m_vRemovedNodes.resize(0);
+	m_idxFirstShiftedNode = VolMesh::INVALID_INDEX;
 
 	//get camera position
-	vec3f cp = TheSceneGraph::Instance().camera().getPos();
-	vec3d cpd = vec3d(cp.x, cp.y, cp.z);
+	vec3d cpd = GetCameraPos();
 
 	//compute face normals using surface triangles
-	for (U32 idxFace = 0; idxFace < pmesh->countFaces(); idxFace++) {
+	for (U32 idxFace = 0; idxFace < ctFaces; idxFace++) {
 		U32 nodes[3];
-		pmesh->getFaceNodes(idxFace, nodes);
-
-		vec3d p0 = pmesh->const_nodeAt(nodes[0]).pos;
-		vec3d p1 = pmesh->const_nodeAt(nodes[1]).pos;
-		vec3d p2 = pmesh->const_nodeAt(nodes[2]).pos;
-
-		vec3d n = vec3d::cross(p1 - p0, p2 - p0).normalized();
-		vec3d cd = (cpd - p0).normalized();
-		if (vec3d::dot(cd, n) < 0)
-		{
-			n = n * -1.0;
-		}
-
+		vec3d n = computeFaceNormal(pmesh, idxFace, cpd, nodes);
 
 		//store nodes
 		for (int j = 0; j < 3; j++)
-			vIndices[idxFace * 3 + j] = nodes[j];
-
-
-		//if this is a surface triangle
-		U32 ctCells = pmesh->countIncidentCells(idxFace);
-		if(ctCells == 1)
-		{
-			for (int j = 0; j < 3; j++) {
-				U32 nj = nodes[j];
-				if (vNodalCount[nj] == 0)
-					vNodeNormals[nj] = n;
-				else
-					vNodeNormals[nj] = vNodeNormals[nj] + n;
+			m_vIndices[idxFace * 3 + j] = nodes[j];
+		m_vFaceSlots[idxFace] = idxFace;
+		m_vSlotNormals[idxFace] = n;
 
-				vNodalCount[nj]++;
-			}
-		}
+		for (int j = 0; j < 3; j++)
+			vNodeNormals[nodes[j]] = vNodeNormals[nodes[j]] + n;
 	}
 
 	//normals
-	for (U32 i = 0; i < pmesh->countNodes(); i++)
+	for (U32 i = 0; i < ctNodes; i++) {
 		vNodeNormals[i].normalize();
+		for(int d = 0; d < 3; d++)
+			m_vFlatNodeNormals[i * 3 + d] = vNodeNormals[i][d];
+	}
 
-	//flat vec3
-	FlattenVec3(vNodeNormals, vFlatNodeNormals);
+	//nothing pending
+	m_vIsFaceDirty.assign(ctFaces, 0);
+	m_vIsNodeDirty.assign(ctNodes, 0);
+	m_vIsSlotDirty.assign(m_capacitySlots, 0);
+	m_vDirtyFaces.resize(0);
+	m_vDirtyNodes.resize(0);
+	m_vDirtySlots.resize(0);
+	m_isAllNodesDirty = false;
+	m_isDirty = false;
 
+	if(g_isHeadless)
+		return true;
 
 	//setup surface mesh
-	setupVertexAttribsT<double>(GL_DOUBLE, vFlatNodes, 3, gbtPosition);
-	setupVertexAttribsT<double>(GL_DOUBLE, vFlatNodeNormals, 3, gbtNormal);
-	setupPerVertexColorT<float>(GL_FLOAT, pmesh->getColor(), pmesh->countNodes(), 3);
-	setupFaceIndexBufferT<U32>(GL_UNSIGNED_INT, vIndices, ftTriangles);
+	setupVertexAttribsT<double>(GL_DOUBLE, m_vFlatNodes, 3, gbtPosition, gbuDynamicDraw);
+	setupVertexAttribsT<double>(GL_DOUBLE, m_vFlatNodeNormals, 3, gbtNormal, gbuDynamicDraw);
+	setupPerVertexColorT<float>(GL_FLOAT, pmesh->getColor(), m_capacityNodes, 3);
+	setupFaceIndexBufferT<U32>(GL_UNSIGNED_INT, m_vIndices, ftTriangles, gbuDynamicDraw);
+	setFaceElementsCount(m_ctSlots * 3);
 
 	//setup wireframe
 	m_sgWireFrame.clearAllBuffers();
-	m_sgWireFrame.setupVertexAttribsT<double>(GL_DOUBLE, vFlatNodes, 3, gbtPosition);
-	m_sgWireFrame.setupPerVertexColorT<float>(GL_FLOAT, Color(0, 0, 0, 100), pmesh->countNodes(), 4);
-	m_sgWireFrame.setupFaceIndexBufferT<U32>(GL_UNSIGNED_INT, vIndices, ftTriangles);
+	m_sgWireFrame.setupVertexAttribsT<double>(GL_DOUBLE, m_vFlatNodes, 3, gbtPosition, gbuDynamicDraw);
+	m_sgWireFrame.setupPerVertexColorT<float>(GL_FLOAT, Color(0, 0, 0, 100), m_capacityNodes, 4);
+	m_sgWireFrame.setupFaceIndexBufferT<U32>(GL_UNSIGNED_INT, m_vIndices, ftTriangles, gbuDynamicDraw);
+	m_sgWireFrame.setFaceElementsCount(m_ctSlots * 3);
 	m_sgWireFrame.setWireFrameMode(true);
 
 	//setup nodes
 	m_sgVertices.clearAllBuffers();
-	m_sgVertices.setupVertexAttribsT<double>(GL_DOUBLE, vFlatNodes, 3, gbtPosition);
-	m_sgVertices.setupPerVertexColorT<float>(GL_FLOAT, Color::red(), pmesh->countNodes(), 3);
+	m_sgVertices.setupVertexAttribsT<double>(GL_DOUBLE, m_vFlatNodes, 3, gbtPosition, gbuDynamicDraw);
+	m_sgVertices.setupPerVertexColorT<float>(GL_FLOAT, Color::red(), m_capacityNodes, 3);
 	m_sgVertices.setFaceMode(GLFaceType::ftPoints);
+	m_sgVertices.setFaceElementsCount(ctNodes);
 
 	//setup normals
 	/*
@@ -169,7 +233,7 @@ bool VolMeshRender::sync(const VolMesh* pmesh) {
 		vector<vec3d> vNormalSegments;
 		vNormalSegments.resize(pmesh->countNodes() * 2);
 		for(U32 i=0; i < pmesh->countNodes(); i++) {
-			vec3d p = pmesh->const_nodeAt(i).pos;
+			vec3d p = pmesh->nodePos(i);
 			vec3d n = vNodeNormals[i];
 
 			vNormalSegments[i * 2] = p;
@@ -189,6 +253,417 @@ bool VolMeshRender::sync(const VolMesh* pmesh) {
 	return true;
 }
 
+bool VolMeshRender::syncChanges(const VolMesh* pmesh) {
+
+	flushRemoved();
+
+	//appended past the slack
+	if(pmesh->countNodes() > m_capacityNodes || m_ctSlots > m_capacitySlots ||
+	   m_vFaceSlots.size() != pmesh->countFaces() || m_vIsNodeDirty.size() != pmesh->countNodes())
+		return syncAll(pmesh);
+
+	//all nodes moved
+	bool isAllNodesDirty = m_isAllNodesDirty;
+	if(isAllNodesDirty) {
+		for(U32 i=0; i < pmesh->countFaces(); i++)
+			markFaceDirty(i);
+		for(U32 i=0; i < pmesh->countNodes(); i++)
+			markNodeDirty(i);
+		m_isAllNodesDirty = false;
+	}
+
+	//get camera position
+	vec3d cpd = GetCameraPos();
+
+	//faces near the cut. Nodes of the old and new triangle need new normals.
+	for(U32 i=0; i < m_vDirtyFaces.size(); i++) {
+		U32 idxFace = m_vDirtyFaces[i];
+		U32 slot = m_vFaceSlots[idxFace];
+		m_vIsFaceDirty[idxFace] = 0;
+
+		for(int j=0; j < 3; j++)
+			markNodeDirty(m_vIndices[slot * 3 + j]);
+
+		U32 nodes[3];
+		m_vSlotNormals[slot] = computeFaceNormal(pmesh, idxFace, cpd, nodes);
+		for(int j=0; j < 3; j++) {
+			m_vIndices[slot * 3 + j] = nodes[j];
+			markNodeDirty(nodes[j]);
+		}
+
+		markSlotDirty(slot);
+	}
+	m_vDirtyFaces.resize(0);
+
+	//all normals are summed in one pass over the slots
+	vector<vec3d> vNodeNormals;
+	if(isAllNodesDirty) {
+		vNodeNormals.assign(pmesh->countNodes(), vec3d(0.0, 0.0, 0.0));
+		for(U32 slot=0; slot < m_ctSlots; slot++) {
+			for(int j=0; j < 3; j++) {
+				U32 nj = m_vIndices[slot * 3 + j];
+				vNodeNormals[nj] = vNodeNormals[nj] + m_vSlotNormals[slot];
+			}
+		}
+	}
+
+	//nodes: positions and normals summed over the incident surface faces
+	vector<U32> vCells;
+	for(U32 i=0; i < m_vDirtyNodes.size(); i++) {
+		U32 idxNode = m_vDirtyNodes[i];
+		m_vIsNodeDirty[idxNode] = 0;
+
+		vec3d p = pmesh->nodePos(idxNode);
+		for(int d = 0; d < 3; d++)
+			m_vFlatNodes[idxNode * 3 + d] = p[d];
+
+		vec3d n(0.0, 0.0, 0.0);
+		if(isAllNodesDirty)
+			n = vNodeNormals[idxNode];
+		else {
+			//face k of a cell is opposite to node k. A surface face has a single cell
+			//so it is reached exactly once.
+			pmesh->getNodeIncidentCells(idxNode, vCells);
+			for(U32 j=0; j < vCells.size(); j++) {
+				const CELL& cell = pmesh->const_cellAt(vCells[j]);
+				for(int k=0; k < COUNT_CELL_FACES; k++) {
+					if(cell.nodes[k] != idxNode && pmesh->countIncidentCells(cell.faces[k]) == 1)
+						n = n + m_vSlotNormals[m_vFaceSlots[cell.faces[k]]];
+				}
+			}
+		}
+
+		n.normalize();
+		for(int d = 0; d < 3; d++)
+			m_vFlatNodeNormals[idxNode * 3 + d] = n[d];
+	}
+
+	//upload
+	std::sort(m_vDirtyNodes.begin(), m_vDirtyNodes.end());
+	std::sort(m_vDirtySlots.begin(), m_vDirtySlots.end());
+
+	GLMeshBuffer* arrPosBuffers[3] = {this, &m_sgWireFrame, &m_sgVertices};
+	GLMeshBuffer* arrFaceBuffers[2] = {this, &m_sgWireFrame};
+
+	//nodes shifted by removals are uploaded as one range
+	if(m_idxFirstShiftedNode < pmesh->countNodes()) {
+		U32 ctDirty = m_vDirtyNodes.size();
+		for(U32 i=0; i < ctDirty; i++) {
+			if(m_vDirtyNodes[i] >= m_idxFirstShiftedNode) {
+				ctDirty = i;
+				break;
+			}
+		}
+
+		m_vDirtyNodes.resize(ctDirty);
+		for(U32 i=m_idxFirstShiftedNode; i < pmesh->countNodes(); i++)
+			m_vDirtyNodes.push_back(i);
+	}
+	m_idxFirstShiftedNode = VolMesh::INVALID_INDEX;
+
+	if(!g_isHeadless) {
+		UploadRuns(m_vDirtyNodes, 3 * sizeof(double), m_vFlatNodes.data(), gbtPosition, arrPosBuffers, 3);
+		UploadRuns(m_vDirtyNodes, 3 * sizeof(double), m_vFlatNodeNormals.data(), gbtNormal, arrPosBuffers, 1);
+		UploadRuns(m_vDirtySlots, 3 * sizeof(U32), m_vIndices.data(), gbtFaceIndex, arrFaceBuffers, 2);
+	}
+
+	setFaceElementsCount(m_ctSlots * 3);
+	m_sgWireFrame.setFaceElementsCount(m_ctSlots * 3);
+	m_sgVertices.setFaceElementsCount(pmesh->countNodes());
+
+	for(U32 i=0; i < m_vDirtySlots.size(); i++)
+		m_vIsSlotDirty[m_vDirtySlots[i]] = 0;
+	m_vDirtyNodes.resize(0);
+	m_vDirtySlots.resize(0);
+
+	return true;
+}
+
+vec3d VolMeshRender::computeFaceNormal(const VolMesh* pmesh, U32 idxFace, const vec3d& campos, U32 (&nodes)[3]) const {
+	pmesh->getFaceNodes(idxFace, nodes);
+
+	//only surface triangles contribute
+	if(pmesh->countIncidentCells(idxFace) != 1)
+		return vec3d(0.0, 0.0, 0.0);
+
+	vec3d p0 = pmesh->nodePos(nodes[0]);
+	vec3d p1 = pmesh->nodePos(nodes[1]);
+	vec3d p2 = pmesh->nodePos(nodes[2]);
+
+	vec3d n = vec3d::cross(p1 - p0, p2 - p0).normalized();
+	vec3d cd = (campos - p0).normalized();
+	if (vec3d::dot(cd, n) < 0)
+	{
+		n = n * -1.0;
+	}
+
+	return n;
+}
+
+void VolMeshRender::onNodeEvent(U32 handle, VolMesh::TopologyEvent event) {
+	if(m_isDirty)
+		return;
+
+	//every handle changed
+	if(event == VolMesh::teRenumbered) {
+		m_isDirty = true;
+		return;
+	}
+
+	if(event == VolMesh::teAdded) {
+		//new nodes are appended
+		flushRemoved();
+		if(handle != m_vIsNodeDirty.size() || handle >= m_capacityNodes) {
+			m_isDirty = true;
+			return;
+		}
+
+		m_vIsNodeDirty.push_back(0);
+		markNodeDirty(handle);
+	}
+	else if(event == VolMesh::teRemoved) {
+		//removed nodes are orphans. Same batching as faces.
+		flushRemovedFaces();
+		if(m_vRemovedNodes.size() > 0 && handle >= m_vRemovedNodes.back())
+			flushRemovedNodes();
+
+		if(handle >= m_vIsNodeDirty.size()) {
+			m_isDirty = true;
+			return;
+		}
+
+		m_vRemovedNodes.push_back(handle);
+	}
+	else if(handle == VolMesh::INVALID_INDEX) {
+		m_isAllNodesDirty = true;
+	}
+	else {
+		flushRemoved();
+		markNodeDirty(handle);
+
+		vector<U32> vEdges;
+		vector<U32> vFaces;
+		m_lpMesh->getNodeIncidentEdges(handle, vEdges);
+		for(U32 i=0; i < vEdges.size(); i++) {
+			m_lpMesh->getEdgeIncidentFaces(vEdges[i], vFaces);
+			for(U32 j=0; j < vFaces.size(); j++)
+				markFaceDirty(vFaces[j]);
+		}
+	}
+}
+
+void VolMeshRender::onEdgeEvent(U32 handle, VolMesh::TopologyEvent event) {
+	if(m_isDirty || event != VolMesh::teUpdated)
+		return;
+
+	//the faces of a split edge now reference a new node
+	flushRemoved();
+	vector<U32> vFaces;
+	m_lpMesh->getEdgeIncidentFaces(handle, vFaces);
+	for(U32 i=0; i < vFaces.size(); i++)
+		markFaceDirty(vFaces[i]);
+}
+
+void VolMeshRender::onFaceEvent(U32 handle, VolMesh::TopologyEvent event) {
+	if(m_isDirty)
+		return;
+
+	//every handle changed
+	if(event == VolMesh::teRenumbered) {
+		m_isDirty = true;
+		return;
+	}
+
+	if(event == VolMesh::teRemoved) {
+		//removals arrive in decreasing handle order before each erase
+		flushRemovedNodes();
+		if(m_vRemovedFaces.size() > 0 && handle >= m_vRemovedFaces.back())
+			flushRemovedFaces();
+
+		if(handle >= m_vFaceSlots.size()) {
+			m_isDirty = true;
+			return;
+		}
+
+		//free the slot with a degenerate triangle
+		U32 slot = m_vFaceSlots[handle];
+		for(int j=0; j < 3; j++) {
+			markNodeDirty(m_vIndices[slot * 3 + j]);
+			m_vIndices[slot * 3 + j] = 0;
+		}
+		m_vSlotNormals[slot] = vec3d(0.0, 0.0, 0.0);
+		markSlotDirty(slot);
+
+		m_vFreeSlots.push_back(slot);
+		m_vRemovedFaces.push_back(handle);
+		return;
+	}
+
+	flushRemoved();
+	if(event == VolMesh::teAdded) {
+		//new faces are appended
+		if(handle != m_vFaceSlots.size()) {
+			m_isDirty = true;
+			return;
+		}
+
+		U32 slot;
+		if(m_vFreeSlots.size() > 0) {
+			slot = m_vFreeSlots.back();
+			m_vFreeSlots.pop_back();
+		}
+		else {
+			slot = m_ctSlots++;
+			if(m_ctSlots > m_capacitySlots) {
+				m_isDirty = true;
+				return;
+			}
+		}
+
+		m_vFaceSlots.push_back(slot);
+		m_vIsFaceDirty.push_back(0);
+	}
+
+	markFaceDirty(handle);
+}
+
+void VolMeshRender::onElemEvent(const CELL& cell, VolMesh::TopologyEvent event) {
+	if(m_isDirty)
+		return;
+
+	//every handle changed
+	if(event == VolMesh::teRenumbered) {
+		m_isDirty = true;
+		return;
+	}
+
+	//surface faces change with the incident cells
+	flushRemoved();
+	for(int i=0; i < COUNT_CELL_FACES; i++)
+		markFaceDirty(cell.faces[i]);
+}
+
+void VolMeshRender::flushRemoved() {
+	flushRemovedFaces();
+	flushRemovedNodes();
+}
+
+void VolMeshRender::flushRemovedNodes() {
+	if(m_vRemovedNodes.size() == 0)
+		return;
+
+	//remap in one pass. The nodes after the first removed one shift down.
+	U32 idxFirst = m_vRemovedNodes.back();
+	vector<U32> vRemap(m_vIsNodeDirty.size(), 0);
+	for(U32 i=0; i < m_vRemovedNodes.size(); i++)
+		vRemap[m_vRemovedNodes[i]] = VolMesh::INVALID_INDEX;
+
+	U32 ctKept = 0;
+	for(U32 i=0; i < m_vIsNodeDirty.size(); i++) {
+		if(vRemap[i] == VolMesh::INVALID_INDEX)
+			continue;
+
+		vRemap[i] = ctKept;
+		if(ctKept != i) {
+			m_vIsNodeDirty[ctKept] = m_vIsNodeDirty[i];
+			for(int d = 0; d < 3; d++) {
+				m_vFlatNodes[ctKept * 3 + d] = m_vFlatNodes[i * 3 + d];
+				m_vFlatNodeNormals[ctKept * 3 + d] = m_vFlatNodeNormals[i * 3 + d];
+			}
+		}
+		ctKept++;
+	}
+	m_vIsNodeDirty.resize(ctKept);
+
+	U32 ctDirty = 0;
+	for(U32 i=0; i < m_vDirtyNodes.size(); i++) {
+		U32 idxNode = vRemap[m_vDirtyNodes[i]];
+		if(idxNode != VolMesh::INVALID_INDEX)
+			m_vDirtyNodes[ctDirty++] = idxNode;
+	}
+	m_vDirtyNodes.resize(ctDirty);
+
+	//triangles referencing shifted nodes. Free slots point to node zero.
+	for(U32 slot=0; slot < m_ctSlots; slot++) {
+		for(int j=0; j < 3; j++) {
+			U32 idxNode = m_vIndices[slot * 3 + j];
+			if(idxNode < idxFirst)
+				continue;
+
+			idxNode = vRemap[idxNode];
+			m_vIndices[slot * 3 + j] = (idxNode == VolMesh::INVALID_INDEX) ? 0 : idxNode;
+			markSlotDirty(slot);
+		}
+	}
+
+	m_idxFirstShiftedNode = MATHMIN(m_idxFirstShiftedNode, idxFirst);
+	m_vRemovedNodes.resize(0);
+}
+
+void VolMeshRender::flushRemovedFaces() {
+	if(m_vRemovedFaces.size() == 0)
+		return;
+
+	//remap in one pass
+	vector<U32> vRemap(m_vFaceSlots.size(), 0);
+	for(U32 i=0; i < m_vRemovedFaces.size(); i++)
+		vRemap[m_vRemovedFaces[i]] = VolMesh::INVALID_INDEX;
+
+	U32 ctKept = 0;
+	for(U32 i=0; i < m_vFaceSlots.size(); i++) {
+		if(vRemap[i] == VolMesh::INVALID_INDEX)
+			continue;
+
+		vRemap[i] = ctKept;
+		m_vFaceSlots[ctKept] = m_vFaceSlots[i];
+		m_vIsFaceDirty[ctKept] = m_vIsFaceDirty[i];
+		ctKept++;
+	}
+	m_vFaceSlots.resize(ctKept);
+	m_vIsFaceDirty.resize(ctKept);
+
+	U32 ctDirty = 0;
+	for(U32 i=0; i < m_vDirtyFaces.size(); i++) {
+		U32 idxFace = vRemap[m_vDirtyFaces[i]];
+		if(idxFace != VolMesh::INVALID_INDEX)
+			m_vDirtyFaces[ctDirty++] = idxFace;
+	}
+	m_vDirtyFaces.resize(ctDirty);
+	m_vRemovedFaces.resize(0);
+}
+
+void VolMeshRender::markFaceDirty(U32 idxFace) {
+	if(idxFace >= m_vIsFaceDirty.size() || m_vIsFaceDirty[idxFace])
+		return;
+
+	m_vIsFaceDirty[idxFace] = 1;
+	m_vDirtyFaces.push_back(idxFace);
+}
+
+void VolMeshRender::markNodeDirty(U32 idxNode) {
+	if(idxNode >= m_vIsNodeDirty.size() || m_vIsNodeDirty[idxNode])
+		return;
+
+	m_vIsNodeDirty[idxNode] = 1;
+	m_vDirtyNodes.push_back(idxNode);
+}
+
+void VolMeshRender::markSlotDirty(U32 slot) {
+	if(slot >= m_vIsSlotDirty.size() || m_vIsSlotDirty[slot])
+		return;
+
+	m_vIsSlotDirty[slot] = 1;
+	m_vDirtySlots.push_back(slot);
+}
+
+void VolMeshRender::setHeadless(bool headless) {
+	g_isHeadless = headless;
+}
+
+bool VolMeshRender::isHeadless() {
+	return g_isHeadless;
+}
+
 void VolMeshRender::draw() {
 	glDisable(GL_CULL_FACE);
 
@@ -14,19 +14,56 @@
 namespace PS {
 namespace MESH {
 
+/*!
+ * Renders the surface, wireframe and nodes of a volume mesh. Once attached to a mesh
+ * the renderer listens to its topology events and sync only patches the buffer ranges
+ * of the nodes and faces that changed. Buffers are allocated with slack so that cuts
+ * can append nodes and faces without reallocating them.
+ */
 class VolMeshRender: public SG::SGMesh {
 public:
 	VolMeshRender();
 	VolMeshRender(const VolMesh* pmesh);
 	virtual ~VolMeshRender();
 
+	//registers the topology listeners. Syncs of other meshes always rebuild.
+	void attach(VolMesh* pmesh);
+
 	bool sync(const VolMesh* pmesh);
 
 	void draw();
 
+	//headless renderers keep the cpu copies of the buffers up to date and make no gl calls
+	static void setHeadless(bool headless);
+	static bool isHeadless();
+
 protected:
 	void init();
 
+	//rebuilds and uploads all buffers
+	bool syncAll(const VolMesh* pmesh);
+
+	//uploads the changes recorded since the last sync
+	bool syncChanges(const VolMesh* pmesh);
+
+	//topology listeners
+	void onNodeEvent(U32 handle, VolMesh::TopologyEvent event);
+	void onEdgeEvent(U32 handle, VolMesh::TopologyEvent event);
+	void onFaceEvent(U32 handle, VolMesh::TopologyEvent event);
+	void onElemEvent(const CELL& cell, VolMesh::TopologyEvent event);
+
+	//removed faces and nodes are batched and dropped from the handle arrays in one pass
+	void flushRemoved();
+	void flushRemovedFaces();
+	void flushRemovedNodes();
+
+	void markFaceDirty(U32 idxFace);
+	void markNodeDirty(U32 idxNode);
+	void markSlotDirty(U32 slot);
+
+	//normal of a surface face flipped towards the camera. Zero for interior faces.
+	vec3d computeFaceNormal(const VolMesh* pmesh, U32 idxFace, const vec3d& campos, U32 (&nodes)[3]) const;
+
 private:
 //	bool m_flagDrawSurface;
 //	bool m_flagDrawWireframe;
@@ -34,6 +71,36 @@ private:
 	SGMesh m_sgWireFrame;
 	SGMesh m_sgVertices;
 	SGMesh m_sgNormals;
+
+	VolMesh* m_lpMesh;
+	bool m_isDirty;
+	bool m_isAllNodesDirty;
+
+	//buffer capacities in nodes and face slots
+	U32 m_capacityNodes;
+	U32 m_capacitySlots;
+	U32 m_ctSlots;
+
+	//cpu copies of the buffers
+	vector<double> m_vFlatNodes;
+	vector<double> m_vFlatNodeNormals;
+	vector<U32> m_vIndices;
+	vector<vec3d> m_vSlotNormals;
+
+	//face handle to slot in the index buffer. Free slots hold degenerate triangles.
+	vector<U32> m_vFaceSlots;
+	vector<U32> m_vFreeSlots;
+	vector<U32> m_vRemovedFaces;
+	vector<U32> m_vRemovedNodes;
+	U32 m_idxFirstShiftedNode;
+
+	//changes since the last sync
+	vector<U8> m_vIsFaceDirty;
+	vector<U32> m_vDirtyFaces;
+	vector<U8> m_vIsNodeDirty;
+	vector<U32> m_vDirtyNodes;
+	vector<U8> m_vIsSlotDirty;
+	vector<U32> m_vDirtySlots;
 };
 
 } /* namespace MESH */
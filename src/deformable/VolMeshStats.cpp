@@ -6,6 +6,7 @@
  */
 
 #include <deformable/VolMeshStats.h>
+#include "base/Logger.h"
 
 namespace PS {
 namespace MESH {
@@ -21,25 +22,33 @@ VolMeshStats::~VolMeshStats() {
 
 void VolMeshStats::printAllStats(const VolMesh* pmesh) {
 
+	//the stats walk the whole mesh so skip them when nobody reads them
+	if(!TheEventLogger::Instance().isEnabled(EventLogger::etInfo))
+		return;
+
 	double volMin = 0.0;
 	double volMax = 0.0;
 	double edgeLenMin = 0.0;
 	double edgeLenMax = 0.0;
 	double minAR = 0.0;
-	printf("===========================begin mesh stats============================\n");
+	LogInfo("===========================begin mesh stats============================");
 
 	//compute
-	assert(computeVolMaxMin(pmesh, volMax, volMin));
-	assert(computeEdgeLenMaxMin(pmesh, edgeLenMax, edgeLenMin));
-	assert(computeMinAspectRatio(pmesh, minAR));
+	bool isValid = computeVolMaxMin(pmesh, volMax, volMin);
+	isValid &= computeEdgeLenMaxMin(pmesh, edgeLenMax, edgeLenMin);
+	isValid &= computeMinAspectRatio(pmesh, minAR);
+	assert(isValid);
+	PS_UNUSED(isValid);
 	double vMaxFvMin = (volMin == 0.0) ? volMax : (volMax/volMin);
 	double edgeMaxFedgeMin = (edgeLenMin == 0.0) ? edgeLenMax : (edgeLenMax/edgeLenMin);
 
 	//print
-	printf("INFO: Vol Max: %.8f, Min: %.8f, max/min: %.8f \n", volMax, volMin, vMaxFvMin);
-	printf("INFO: EdgeLen Max: %.8f, Min: %.8f, max/min: %.8f \n", edgeLenMax, edgeLenMin, edgeMaxFedgeMin);
-	printf("INFO: minAspectRatio: %.8f\n", minAR);
-	printf("============================end mesh stats=============================\n");
+	LogInfoArg3("Vol Max: %.8f, Min: %.8f, max/min: %.8f", volMax, volMin, vMaxFvMin);
+	LogInfoArg3("EdgeLen Max: %.8f, Min: %.8f, max/min: %.8f", edgeLenMax, edgeLenMin, edgeMaxFedgeMin);
+	LogInfoArg1("minAspectRatio: %.8f", minAR);
+	LogInfoArg2("Incidence lists: %.2f MB, packed: %d",
+		   (double)pmesh->getIncidenceMemoryUsage() / (1024.0 * 1024.0), pmesh->getFlagPackedIncidence());
+	LogInfo("============================end mesh stats=============================");
 }
 
 bool VolMeshStats::computeVolMaxMin(const VolMesh* pmesh, double& outVolMax, double& outVolMin) {
@@ -68,8 +77,8 @@ bool VolMeshStats::computeEdgeLenMaxMin(const VolMesh* pmesh, double& outEdgeLen
 	outEdgeLenMin = GetMaxLimit<double>();
 	for(U32 i=0; i < pmesh->countEdges(); i++) {
 		const PS::MESH::EDGE& edge = pmesh->const_edgeAt(i);
-		vec3d s0 = pmesh->const_nodeAt(edge.from).pos;
-		vec3d s1 = pmesh->const_nodeAt(edge.to).pos;
+		vec3d s0 = pmesh->nodePos(edge.from);
+		vec3d s1 = pmesh->nodePos(edge.to);
 		double d = vec3d::distance(s0, s1);
 
 		if(d > MIN_EDGE_LENGTH) {
@@ -7,9 +7,23 @@
 
 
 #include "test_VolMesh.h"
+#include "VolMeshIO.h"
+#include "VolMeshSamples.h"
+#include "VolMeshParts.h"
+#include "VolMeshRender.h"
+#include "CuttableMesh.h"
+#include "NodeGrid.h"
+#include "graphics/Intersections.h"
 #include "base/Logger.h"
 #include "base/Profiler.h"
+#include "base/MemoryArena.h"
+#include "base/DenseIndexMap.h"
+#include "base/LatencyHistogram.h"
 #include <map>
+#include <fstream>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
 
 using namespace std;
 using namespace PS;
@@ -215,23 +229,24 @@ bool TestVolMesh::tst_unused_mesh_fields(VolMesh* pmesh) {
 			countUnusedFaces++;
 	}
 
-	printf("============================mesh field usage begin===========================\n");
-	printf("Node Usage. Min: %u, Max: %u\n", minNodeUsage, maxNodeUsage);
+	LogInfo("============================mesh field usage begin===========================");
+	LogInfoArg2("Node Usage. Min: %u, Max: %u", minNodeUsage, maxNodeUsage);
 	if(minNodeUsage == 0) {
-		printf(">>list of %u unused nodes:\n", countUnusedNodes);
+		LogInfoArg1(">>list of %u unused nodes:", countUnusedNodes);
 		for(U32 i=0; i < vUsedNodes.size(); i++) {
 			if(vUsedNodes[i] == 0) {
-				vec3d p = pmesh->const_nodeAt(i).pos;
-				printf(">>NODE %u = [%.3f, %.3f, %.3f], used %u times.\n", i, p.x, p.y, p.z, vUsedNodes[i]);
+				vec3d p = pmesh->nodePos(i);
+				psLog(EventLogger::etInfo, __FILE__, __LINE__, ">>NODE %u = [%.3f, %.3f, %.3f], used %u times.",
+					  i, p.x, p.y, p.z, vUsedNodes[i]);
 			}
 		}
 	}
 
 
 
-	printf("Face Usage. Min: %u, Max: %u\n", minFaceUsage, maxFaceUsage);
+	LogInfoArg2("Face Usage. Min: %u, Max: %u", minFaceUsage, maxFaceUsage);
 	if(minFaceUsage == 0) {
-		printf(">>list of %u unused faces will follow:\n", countUnusedFaces);
+		LogInfoArg1(">>list of %u unused faces will follow:", countUnusedFaces);
 		for(U32 i=0; i < vUsedFaces.size(); i++) {
 			if(vUsedFaces[i] == 0) {
 				const FACE& face = pmesh->const_faceAt(i);
@@ -244,13 +259,13 @@ bool TestVolMesh::tst_unused_mesh_fields(VolMesh* pmesh) {
 				U32 nodes[3];
 				pmesh->getFaceNodes(i, nodes);
 
-				printf(">>FACE %u = Nodes [%u, %u, %u], Edges [%u, %u, %u].\n",
-						i, nodes[0], nodes[1], nodes[2], edges[0], edges[1], edges[2]);
+				psLog(EventLogger::etInfo, __FILE__, __LINE__, ">>FACE %u = Nodes [%u, %u, %u], Edges [%u, %u, %u].",
+					  i, nodes[0], nodes[1], nodes[2], edges[0], edges[1], edges[2]);
 			}
 		}
 	}
 
-	printf("============================mesh field usage end============================\n");
+	LogInfo("============================mesh field usage end============================");
 
 	if(ctErrors == 0)
 		LogInfoArg1("PASS: %s", __FUNCTION__);
@@ -265,27 +280,730 @@ bool TestVolMesh::tst_connectivity(VolMesh* pmesh) {
 
 
 
+static bool ReadFileBytes(const AnsiStr& strPath, vector<char>& bytes) {
+	ifstream fpIn(strPath.cptr(), ios::binary | ios::ate);
+	if(!fpIn.is_open())
+		return false;
+
+	bytes.resize(fpIn.tellg());
+	fpIn.seekg(0, ios::beg);
+	fpIn.read(&bytes[0], bytes.size());
+	return fpIn.good();
+}
+
+static bool WriteFileBytes(const AnsiStr& strPath, const vector<char>& bytes, U64 szBytes) {
+	ofstream fpOut(strPath.cptr(), ios::binary | ios::trunc);
+	if(!fpOut.is_open())
+		return false;
+
+	fpOut.write(&bytes[0], szBytes);
+	return fpOut.good();
+}
+
+bool TestVolMesh::tst_binary_io(const AnsiStr& strTempFP) {
+	VolMesh* lpMesh = VolMeshSamples::CreateTruthCube(6, 6, 6, 0.2);
+	if(lpMesh == NULL)
+		return false;
+
+	//rest positions differ from the positions as in a deformed mesh
+	for(U32 i=0; i < lpMesh->countNodes(); i++)
+		lpMesh->setNodePos(i, lpMesh->nodePos(i) + vec3d(0.01 * i, 0.5, -0.25));
+
+	U32 ctErrors = 0;
+	vector<char> bytes;
+	if(!VolMeshIO::writeBinary(lpMesh, strTempFP, true) || !ReadFileBytes(strTempFP, bytes)) {
+		LogErrorArg1("Unable to write binary mesh file: %s", strTempFP.cptr());
+		SAFE_DELETE(lpMesh);
+		return false;
+	}
+
+	//round trip
+	{
+		VolMesh temp;
+		if(!VolMeshIO::readBinary(&temp, strTempFP) ||
+		   temp.countNodes() != lpMesh->countNodes() || temp.countEdges() != lpMesh->countEdges() ||
+		   temp.countFaces() != lpMesh->countFaces() || temp.countCells() != lpMesh->countCells()) {
+			LogError("Binary mesh round trip changed the mesh counts.");
+			ctErrors++;
+		}
+		else {
+			for(U32 i=0; i < lpMesh->countNodes(); i++) {
+				if((temp.nodePos(i) - lpMesh->nodePos(i)).length2() > 0.0 ||
+				   (temp.nodeRestPos(i) - lpMesh->nodeRestPos(i)).length2() > 0.0) {
+					LogErrorArg1("Binary mesh round trip changed node %u.", i);
+					ctErrors++;
+					break;
+				}
+			}
+		}
+	}
+
+	//truncated copies
+	U64 arrSizes[] = {bytes.size() - 1, bytes.size() / 2, 16};
+	for(U32 i=0; i < sizeof(arrSizes) / sizeof(arrSizes[0]); i++) {
+		VolMesh temp;
+		WriteFileBytes(strTempFP, bytes, arrSizes[i]);
+		if(VolMeshIO::readBinary(&temp, strTempFP)) {
+			LogErrorArg1("Accepted a binary mesh truncated to %llu bytes.", (unsigned long long)arrSizes[i]);
+			ctErrors++;
+		}
+	}
+
+	//corrupt magic
+	{
+		VolMesh temp;
+		vector<char> corrupt = bytes;
+		corrupt[0] ^= 0x5A;
+		WriteFileBytes(strTempFP, corrupt, corrupt.size());
+		if(VolMeshIO::readBinary(&temp, strTempFP)) {
+			LogError("Accepted a binary mesh with a corrupt magic.");
+			ctErrors++;
+		}
+	}
+
+	//huge aligned words over the header. Offsets and sizes near 2^64 must not wrap past the bounds checks.
+	const U64 huge = 0xFFFFFFFFFFFFFFC0ULL;
+	U32 szScan = (U32)MATHMIN(bytes.size(), (size_t)512);
+	for(U32 pos = 0; pos + sizeof(U64) <= szScan; pos += sizeof(U64)) {
+		VolMesh temp;
+		vector<char> corrupt = bytes;
+		memcpy(&corrupt[pos], &huge, sizeof(U64));
+		WriteFileBytes(strTempFP, corrupt, corrupt.size());
+
+		//accepting is fine only when the word was not part of the layout
+		if(VolMeshIO::readBinary(&temp, strTempFP) &&
+		   (temp.countNodes() != lpMesh->countNodes() || temp.countCells() != lpMesh->countCells())) {
+			LogErrorArg1("Accepted a binary mesh with a corrupt word at byte %u.", pos);
+			ctErrors++;
+		}
+	}
+
+	remove(strTempFP.cptr());
+	SAFE_DELETE(lpMesh);
+
+	if(ctErrors == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctErrors == 0);
+}
+
+//the incremental labels have to match a labelling of the whole mesh
+static bool SameAsFullLabelling(VolMesh* pmesh, const char* lpStep) {
+	U32 ctParts = pmesh->update_cell_parts();
+
+	VolMeshParts full;
+	U32 ctFullParts = full.update(pmesh);
+	if(ctParts != ctFullParts || pmesh->const_cell_parts() != full.const_labels()) {
+		LogErrorArg3("Incremental part labels differ after %s. parts %u, full labelling %u.", lpStep, ctParts, ctFullParts);
+		return false;
+	}
+
+	return true;
+}
+
+//scalpel stroke in a plane of constant z from above the mesh down to depth y
+static int CutAtZ(CuttableMesh* pmesh, double z, double y) {
+	vector<vec3d> segments(2);
+	vector<vec3d> quadstrips(4);
+	segments[0] = quadstrips[1] = vec3d(-9, y, z);
+	segments[1] = quadstrips[3] = vec3d(9, y, z);
+	quadstrips[0] = vec3d(-9, 9, z);
+	quadstrips[2] = vec3d(9, 9, z);
+
+	int res = pmesh->cut(segments, quadstrips, true);
+	pmesh->clearCutContext();
+	return res;
+}
+
+bool TestVolMesh::tst_incremental_parts() {
+	//no gl context
+	bool isHeadless = VolMeshRender::isHeadless();
+	VolMeshRender::setHeadless(true);
+
+	VolMesh* temp = VolMeshSamples::CreateTruthCube(8, 8, 8, 0.2);
+	CuttableMesh* lpMesh = new CuttableMesh(*temp);
+	SAFE_DELETE(temp);
+	lpMesh->setFlagSplitMeshAfterCut(false);
+
+	U32 ctErrors = 0;
+	if(!SameAsFullLabelling(lpMesh, "load"))
+		ctErrors++;
+
+	//a cut through splits the cube, a partial one only subdivides
+	if(CutAtZ(lpMesh, 0.037, -1.0) <= 0 || !SameAsFullLabelling(lpMesh, "a cut through"))
+		ctErrors++;
+	if(CutAtZ(lpMesh, -0.351, 0.75) <= 0 || !SameAsFullLabelling(lpMesh, "a partial cut"))
+		ctErrors++;
+
+	//a new cell on a boundary face of a clean part belongs to that part. Its neighbour has
+	//a smaller handle.
+	lpMesh->update_cell_parts();
+	U32 idxCell = VolMesh::INVALID_INDEX;
+	int idxFace = 0;
+	for(U32 i=0; i < lpMesh->countCells() && idxCell == VolMesh::INVALID_INDEX; i++) {
+		for(int j=0; j < COUNT_CELL_FACES; j++) {
+			if(lpMesh->cell_neighbor(i, j) == VolMesh::INVALID_INDEX) {
+				idxCell = i;
+				idxFace = j;
+				break;
+			}
+		}
+	}
+
+	if(idxCell == VolMesh::INVALID_INDEX) {
+		LogError("No boundary face to attach a cell to.");
+		ctErrors++;
+	}
+	else {
+		//face j is opposite to node j. Mirror that node over the face.
+		const int maskFaceNodes[4][3] = { {1, 2, 3}, {2, 0, 3}, {3, 0, 1}, {1, 0, 2} };
+		const CELL& cell = lpMesh->const_cellAt(idxCell);
+		U32 nodes[4];
+		vec3d c(0, 0, 0);
+		for(int k=0; k < 3; k++) {
+			nodes[k] = cell.nodes[maskFaceNodes[idxFace][k]];
+			c = c + lpMesh->nodePos(nodes[k]) * (1.0 / 3.0);
+		}
+
+		NODE node;
+		node.pos = node.restpos = c * 2.0 - lpMesh->nodePos(cell.nodes[idxFace]);
+		nodes[3] = lpMesh->insert_node(node);
+
+		if(!lpMesh->insert_cell(nodes) || !SameAsFullLabelling(lpMesh, "attaching a cell"))
+			ctErrors++;
+	}
+
+	SAFE_DELETE(lpMesh);
+	VolMeshRender::setHeadless(isHeadless);
+
+	if(ctErrors == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctErrors == 0);
+}
+
+static vec3d RandVec3d(double lo, double hi) {
+	return vec3d(RandRangeT<double>(lo, hi), RandRangeT<double>(lo, hi), RandRangeT<double>(lo, hi));
+}
+
+//batched results must be bitwise equal to the scalar test per segment and per triangle
+static U32 CompareSegmentTriangleBatches(const vector<vec3d>& vS0, const vector<vec3d>& vS1, const vec3d tri[3]) {
+	using namespace PS::INTERSECTIONS;
+	U32 count = vS0.size();
+	vector<int> res(count, -1);
+	vector<double> t(count, 0.0);
+	vector<vec3d> uvw(count), xyz(count);
+	IntersectSegmentsTriangle(count, &vS0[0], &vS1[0], tri, &res[0], &t[0], &uvw[0], &xyz[0]);
+
+	U32 ctMismatch = 0;
+	for(U32 i=0; i < count; i++) {
+		double t1 = 0.0;
+		vec3d uvw1, xyz1;
+		int res1 = IntersectSegmentTriangle(vS0[i], vS1[i], tri, t1, uvw1, xyz1);
+		if(res1 != res[i] || (res1 > 0 && (t1 != t[i] || (uvw1 - uvw[i]).length2() != 0.0 || (xyz1 - xyz[i]).length2() != 0.0)))
+			ctMismatch++;
+
+		//the same triangle repeated, one segment against many
+		vec3d tris[9] = {tri[0], tri[1], tri[2], tri[0], tri[1], tri[2], tri[0], tri[1], tri[2]};
+		int resT[3] = {-1, -1, -1};
+		double tT[3];
+		vec3d uvwT[3], xyzT[3];
+		IntersectSegmentTriangles(vS0[i], vS1[i], 3, tris, resT, tT, uvwT, xyzT);
+		for(int j=0; j < 3; j++) {
+			if(resT[j] != res1 || (res1 > 0 && (tT[j] != t1 || (uvwT[j] - uvw1).length2() != 0.0)))
+				ctMismatch++;
+		}
+	}
+
+	return ctMismatch;
+}
+
+bool TestVolMesh::tst_batched_segment_triangle() {
+	srand(17);
+	U32 ctMismatch = 0;
+	U32 ctCases = 0;
+	const U32 ctBatch = 7;
+
+	//random segments around random triangles. The batch is not a multiple of the lane width.
+	for(U32 k=0; k < 3000; k++) {
+		vec3d tri[3] = {RandVec3d(-1, 1), RandVec3d(-1, 1), RandVec3d(-1, 1)};
+		vector<vec3d> vS0(ctBatch), vS1(ctBatch);
+		for(U32 i=0; i < ctBatch; i++) {
+			vS0[i] = RandVec3d(-2, 2);
+			vS1[i] = RandVec3d(-2, 2);
+		}
+		ctMismatch += CompareSegmentTriangleBatches(vS0, vS1, tri);
+		ctCases += ctBatch;
+	}
+
+	//grazing cases: through the vertices and along the edges of the triangle, ending on its
+	//plane, lying in its plane and of zero length
+	for(U32 k=0; k < 500; k++) {
+		vec3d tri[3] = {RandVec3d(-1, 1), RandVec3d(-1, 1), RandVec3d(-1, 1)};
+		vec3d n = vec3d::cross(tri[1] - tri[0], tri[2] - tri[0]).normalized();
+		double u = RandRangeT<double>(0.0, 1.0);
+
+		vec3d targets[7] = {tri[0], tri[1], tri[2],
+							tri[0] + (tri[1] - tri[0]) * u,
+							tri[1] + (tri[2] - tri[1]) * u,
+							tri[2] + (tri[0] - tri[2]) * u,
+							(tri[0] + tri[1] + tri[2]) * (1.0 / 3.0)};
+
+		vector<vec3d> vS0, vS1;
+		for(int i=0; i < 7; i++) {
+			vS0.push_back(targets[i] + n);
+			vS1.push_back(targets[i] - n);
+
+			vS0.push_back(targets[i] + n);
+			vS1.push_back(targets[i]);
+
+			vS0.push_back(targets[i] - (tri[1] - tri[0]));
+			vS1.push_back(targets[i] + (tri[1] - tri[0]));
+
+			vS0.push_back(targets[i]);
+			vS1.push_back(targets[i]);
+		}
+		ctMismatch += CompareSegmentTriangleBatches(vS0, vS1, tri);
+		ctCases += vS0.size();
+	}
+
+	if(ctMismatch > 0)
+		LogErrorArg2("Batched segment triangle tests differ from the scalar test in %u of %u cases.", ctMismatch, ctCases);
+
+	if(ctMismatch == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctMismatch == 0);
+}
+
+//brute force radius query over the store in increasing handle order
+static void FindInRadiusLinear(const NodeStore& nodes, const vec3d& query, double radius, vector<U32>& outNodes) {
+	outNodes.resize(0);
+	for(U32 i=0; i < nodes.size(); i++) {
+		if((query - nodes.pos(i)).length2() <= radius * radius)
+			outNodes.push_back(i);
+	}
+}
+
+static U32 CompareRadiusQueries(const NodeStore& nodes, const NodeGrid& grid, U32 ctQueries) {
+	U32 ctMismatch = 0;
+	vector<U32> vGrid, vLinear;
+	for(U32 i=0; i < ctQueries; i++) {
+		//queries inside and around the nodes, from empty up to the whole store
+		vec3d query = RandVec3d(-1.5, 1.5);
+		double radius = RandRangeT<double>(0.0, 1.0) * RandRangeT<double>(0.0, 2.0);
+
+		//a query centered on a node with its exact distance to another one
+		if(i % 4 == 0 && nodes.size() > 1) {
+			query = nodes.pos(i % nodes.size());
+			radius = (query - nodes.pos((i * 7 + 1) % nodes.size())).length();
+		}
+
+		grid.findInRadius(nodes, query, radius, vGrid);
+		FindInRadiusLinear(nodes, query, radius, vLinear);
+		if(vGrid != vLinear)
+			ctMismatch++;
+	}
+
+	return ctMismatch;
+}
+
+bool TestVolMesh::tst_node_grid_radius() {
+	srand(29);
+	U32 ctErrors = 0;
+
+	NodeStore nodes;
+	NODE n;
+	for(U32 i=0; i < 500; i++) {
+		n.pos = n.restpos = RandVec3d(-1, 1);
+		nodes.push_back(n);
+	}
+
+	NodeGrid grid;
+	grid.update(nodes);
+	if(CompareRadiusQueries(nodes, grid, 400) > 0) {
+		LogError("Node grid radius query differs from the linear scan after a build.");
+		ctErrors++;
+	}
+
+	//moved and appended nodes are rebucketed in place
+	for(U32 i=0; i < 100; i++) {
+		U32 idxNode = (i * 13) % nodes.size();
+		nodes.setPos(idxNode, RandVec3d(-1.2, 1.2));
+		grid.nodeMoved(idxNode, nodes.pos(idxNode));
+	}
+	for(U32 i=0; i < 20; i++) {
+		n.pos = n.restpos = RandVec3d(-1.4, 1.4);
+		nodes.push_back(n);
+		grid.nodeAdded(nodes.size() - 1, n.pos);
+	}
+	grid.update(nodes);
+	if(CompareRadiusQueries(nodes, grid, 400) > 0) {
+		LogError("Node grid radius query differs from the linear scan after moving and adding nodes.");
+		ctErrors++;
+	}
+
+	//removals shift the handles and rebuild the grid
+	nodes.erase(3);
+	grid.nodeRemoved(3);
+	if(grid.isValid()) {
+		LogError("Node grid is still valid after a node removal.");
+		ctErrors++;
+	}
+	grid.update(nodes);
+	if(CompareRadiusQueries(nodes, grid, 400) > 0) {
+		LogError("Node grid radius query differs from the linear scan after removing a node.");
+		ctErrors++;
+	}
+
+	//all nodes on a plane
+	NodeStore flat;
+	for(U32 i=0; i < 200; i++) {
+		n.pos = n.restpos = vec3d(RandRangeT<double>(-1, 1), RandRangeT<double>(-1, 1), 0.25);
+		flat.push_back(n);
+	}
+	NodeGrid flatGrid;
+	flatGrid.update(flat);
+	if(CompareRadiusQueries(flat, flatGrid, 400) > 0) {
+		LogError("Node grid radius query differs from the linear scan for planar nodes.");
+		ctErrors++;
+	}
+
+	if(ctErrors == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctErrors == 0);
+}
+
+bool TestVolMesh::tst_memory_arena() {
+	srand(31);
+	U32 ctErrors = 0;
+	const size_t szBlock = 4096;
+	MemoryArena arena(szBlock);
+
+	//every power of two alignment up to a cache line with odd sizes in between
+	vector<U8*> vFirst;
+	for(U32 i=0; i < 2000; i++) {
+		size_t alignment = (size_t)1 << (i % 7);
+		size_t sz = 1 + (rand() % 97);
+		U8* lpData = reinterpret_cast<U8*>(arena.allocate(sz, alignment));
+		if(((size_t)lpData & (alignment - 1)) != 0) {
+			LogErrorArg2("Arena allocation %u is not aligned to %u bytes.", i, (U32)alignment);
+			ctErrors++;
+		}
+		memset(lpData, i & 0xFF, sz);
+		vFirst.push_back(lpData);
+	}
+
+	//larger than a block gets its own block
+	U8* lpLarge = reinterpret_cast<U8*>(arena.allocate(3 * szBlock, PS_L1_CACHE_LINE_SIZE));
+	if(((size_t)lpLarge & (PS_L1_CACHE_LINE_SIZE - 1)) != 0) {
+		LogError("Arena allocation larger than a block is not aligned to a cache line.");
+		ctErrors++;
+	}
+	memset(lpLarge, 0, 3 * szBlock);
+
+	//reset keeps the blocks and hands out the same addresses again
+	const U32 ctBlocks = arena.countBlocks();
+	const size_t szReserved = arena.bytesReserved();
+	arena.reset();
+	if(arena.bytesUsed() != 0 || arena.countBlocks() != ctBlocks || arena.bytesReserved() != szReserved) {
+		LogError("Arena reset did not keep its blocks or did not drop its allocations.");
+		ctErrors++;
+	}
+
+	srand(31);
+	for(U32 i=0; i < vFirst.size(); i++) {
+		size_t alignment = (size_t)1 << (i % 7);
+		size_t sz = 1 + (rand() % 97);
+		if(arena.allocate(sz, alignment) != vFirst[i]) {
+			LogErrorArg1("Arena allocation %u moved after a reset.", i);
+			ctErrors++;
+			break;
+		}
+	}
+	if(arena.countBlocks() != ctBlocks) {
+		LogError("Arena allocated new blocks after a reset.");
+		ctErrors++;
+	}
+
+	//rewinding to a marker drops the allocations made after it
+	arena.reset();
+	arena.allocate(100, 8);
+	MemoryArena::Marker marker = arena.mark();
+	const size_t szUsed = arena.bytesUsed();
+	void* lpAfter = arena.allocate(200, 16);
+	arena.allocate(2 * szBlock, 8);
+	arena.rewind(marker);
+	if(arena.bytesUsed() != szUsed || arena.allocate(200, 16) != lpAfter) {
+		LogError("Arena rewind did not restore the marker.");
+		ctErrors++;
+	}
+
+	arena.release();
+	if(arena.countBlocks() != 0 || arena.bytesReserved() != 0 || arena.bytesUsed() != 0) {
+		LogError("Arena release kept some blocks.");
+		ctErrors++;
+	}
+
+	if(ctErrors == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctErrors == 0);
+}
+
+//the dense map must hold exactly the entries of the reference map
+static bool SameAsReferenceMap(const DenseIndexMap<int>& dmap, const std::map<U32, int>& ref, U32 maxKey) {
+	if(dmap.size() != ref.size())
+		return false;
+
+	for(U32 key=0; key < maxKey; key++) {
+		std::map<U32, int>::const_iterator it = ref.find(key);
+		const int* lpValue = dmap.find(key);
+		if(dmap.contains(key) != (it != ref.end()) || (lpValue == NULL) != (it == ref.end()))
+			return false;
+		if(lpValue && *lpValue != it->second)
+			return false;
+	}
+
+	//iteration visits every entry once
+	std::map<U32, int> visited;
+	for(DenseIndexMap<int>::const_iterator it = dmap.begin(); it != dmap.end(); ++it) {
+		if(!visited.insert(*it).second)
+			return false;
+	}
+
+	return visited == ref;
+}
+
+bool TestVolMesh::tst_dense_index_map() {
+	srand(37);
+	U32 ctErrors = 0;
+	const U32 maxKey = 300;
+
+	DenseIndexMap<int> dmap;
+	std::map<U32, int> ref;
+
+	//entries stay in insertion order until an erase
+	for(U32 i=0; i < 50; i++)
+		dmap.insert((i * 37) % maxKey, i);
+	for(U32 i=0; i < dmap.size(); i++) {
+		if(dmap.entryAt(i).first != (i * 37) % maxKey || dmap.entryAt(i).second != (int)i) {
+			LogError("Dense map entries are not in insertion order.");
+			ctErrors++;
+			break;
+		}
+	}
+
+	//existing keys are not overwritten
+	if(dmap.insert(0, -1) || *dmap.find(0) != 0) {
+		LogError("Dense map insert overwrote an existing key.");
+		ctErrors++;
+	}
+
+	//erasing moves the last entry into the gap
+	U32 lastKey = dmap.entryAt(dmap.size() - 1).first;
+	dmap.erase(dmap.entryAt(3).first);
+	if(dmap.entryAt(3).first != lastKey || dmap.erase(maxKey + 5)) {
+		LogError("Dense map erase did not move the last entry into the gap.");
+		ctErrors++;
+	}
+
+	dmap.clear();
+	if(!dmap.empty() || dmap.contains(0) || dmap.countKeys() == 0) {
+		LogError("Dense map clear kept some entries or dropped its slots.");
+		ctErrors++;
+	}
+
+	//random inserts, erases and clears against std::map. Keys grow past the reserved slots.
+	dmap.reserveKeys(maxKey / 4);
+	for(U32 i=0; i < 20000; i++) {
+		U32 key = rand() % maxKey;
+		int op = rand() % 100;
+		if(op < 55) {
+			int value = rand();
+			bool isNew = ref.insert(std::make_pair(key, value)).second;
+			if(dmap.insert(key, value) != isNew)
+				ctErrors++;
+		}
+		else if(op < 99) {
+			bool isFound = (ref.erase(key) > 0);
+			if(dmap.erase(key) != isFound)
+				ctErrors++;
+		}
+		else {
+			ref.clear();
+			dmap.clear();
+		}
+
+		if(i % 97 == 0 && !SameAsReferenceMap(dmap, ref, maxKey + 1)) {
+			LogErrorArg1("Dense map differs from std::map after operation %u.", i);
+			ctErrors++;
+			break;
+		}
+	}
+
+	if(!SameAsReferenceMap(dmap, ref, maxKey + 1)) {
+		LogError("Dense map differs from std::map after the random operations.");
+		ctErrors++;
+	}
+
+	if(ctErrors == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctErrors == 0);
+}
+
+bool TestVolMesh::tst_latency_histogram() {
+	srand(41);
+	U32 ctErrors = 0;
+
+	//small values are exact
+	for(U64 v=0; v < 2 * LATENCY_SUB_BUCKETS; v++) {
+		if(LatencyHistogram::BucketIndex(v) != v || LatencyHistogram::BucketHighestValue((U32)v) != v) {
+			LogErrorArg1("Latency bucket of the small value %u is not exact.", (U32)v);
+			ctErrors++;
+		}
+	}
+
+	//buckets are contiguous, the next value after a bucket opens the next one
+	for(U32 i=0; i + 1 < LATENCY_BUCKETS; i++) {
+		U64 hi = LatencyHistogram::BucketHighestValue(i);
+		if(LatencyHistogram::BucketIndex(hi) != i || LatencyHistogram::BucketIndex(hi + 1) != i + 1) {
+			LogErrorArg1("Latency bucket %u does not end where the next one starts.", i);
+			ctErrors++;
+			break;
+		}
+	}
+
+	const U64 maxValue = 0xFFFFFFFFFFFFFFFFULL;
+	if(LatencyHistogram::BucketIndex(maxValue) != LATENCY_BUCKETS - 1 ||
+	   LatencyHistogram::BucketHighestValue(LATENCY_BUCKETS - 1) != maxValue) {
+		LogError("The last latency bucket does not end at the largest value.");
+		ctErrors++;
+	}
+
+	//powers of two and their neighbours stay within 1/32 of the value
+	for(U32 b=1; b < 64; b++) {
+		U64 values[3] = {((U64)1 << b) - 1, (U64)1 << b, ((U64)1 << b) + 1};
+		for(int k=0; k < 3; k++) {
+			U64 hi = LatencyHistogram::BucketHighestValue(LatencyHistogram::BucketIndex(values[k]));
+			if(hi < values[k] || hi - values[k] > values[k] / LATENCY_SUB_BUCKETS) {
+				LogErrorArg1("Latency bucket of 2^%u is wider than its precision.", b);
+				ctErrors++;
+			}
+		}
+	}
+
+	//percentiles of random values over a wide range against the sorted values
+	LatencyHistogram hist, histLo, histHi;
+	if(hist.valueAtPercentile(50.0) != 0 || hist.count() != 0 || hist.lowest() != 0) {
+		LogError("An empty latency histogram is not zero.");
+		ctErrors++;
+	}
+
+	vector<U64> vValues;
+	U64 total = 0;
+	for(U32 i=0; i < 5000; i++) {
+		U64 v = (U64)rand() << (rand() % 24);
+		vValues.push_back(v);
+		total += v;
+		hist.record(v);
+		if(i % 2 == 0)
+			histLo.record(v);
+		else
+			histHi.record(v);
+	}
+	std::sort(vValues.begin(), vValues.end());
+
+	if(hist.count() != vValues.size() || hist.total() != total ||
+	   hist.lowest() != vValues.front() || hist.highest() != vValues.back()) {
+		LogError("Latency histogram count, total or extremes are wrong.");
+		ctErrors++;
+	}
+
+	//merged halves match the whole
+	LatencyHistogram merged(histLo);
+	merged.merge(histHi);
+
+	const double percents[] = {0.0, 0.1, 1.0, 10.0, 25.0, 50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+	for(U32 i=0; i < sizeof(percents) / sizeof(percents[0]); i++) {
+		U64 target = (U64)ceil(percents[i] * 0.01 * (double)vValues.size());
+		target = MATHMAX(target, (U64)1);
+		U64 expected = vValues[target - 1];
+		U64 value = hist.valueAtPercentile(percents[i]);
+		if(value < expected || value - expected > expected / LATENCY_SUB_BUCKETS) {
+			LogErrorArg1("Latency percentile %.2f is outside the bucket precision.", percents[i]);
+			ctErrors++;
+		}
+
+		if(merged.valueAtPercentile(percents[i]) != value) {
+			LogErrorArg1("Merged latency percentile %.2f differs from the whole.", percents[i]);
+			ctErrors++;
+		}
+	}
+
+	//both ends are exact
+	if(hist.valueAtPercentile(0.0) != vValues.front() || hist.valueAtPercentile(100.0) != vValues.back()) {
+		LogError("Latency percentiles 0 and 100 are not the extremes.");
+		ctErrors++;
+	}
+
+	hist.reset();
+	if(hist.count() != 0 || hist.total() != 0 || hist.highest() != 0 || hist.valueAtPercentile(99.0) != 0) {
+		LogError("Latency histogram reset kept some values.");
+		ctErrors++;
+	}
+
+	if(ctErrors == 0)
+		LogInfoArg1("PASS: %s", __FUNCTION__);
+	else
+		LogInfoArg1("FAILED!: %s", __FUNCTION__);
+	return (ctErrors == 0);
+}
+
+bool TestVolMesh::tst_units(const AnsiStr& strTempFP) {
+	U32 ctFailed = 0;
+	ctFailed += !tst_binary_io(strTempFP);
+	ctFailed += !tst_incremental_parts();
+	ctFailed += !tst_batched_segment_triangle();
+	ctFailed += !tst_node_grid_radius();
+	ctFailed += !tst_memory_arena();
+	ctFailed += !tst_dense_index_map();
+	ctFailed += !tst_latency_histogram();
+
+	if(ctFailed > 0)
+		LogErrorArg1("%u unit tests failed.", ctFailed);
+	return (ctFailed == 0);
+}
+
 bool TestVolMesh::tst_all(VolMesh* pmesh) {
 	ProfileAutoArg("testall");
 
 	U32 idxTest = 0;
 	const U32 maxTest = 4;
-	printf("============================begin mesh tests===========================\n");
-	printf("Test %u of %u\n", ++idxTest, maxTest);
+	LogInfo("============================begin mesh tests===========================");
+	LogInfoArg2("Test %u of %u", ++idxTest, maxTest);
 	//tst_report_mesh_info(pmesh);
 
-	printf("Test %u of %u\n", ++idxTest, maxTest);
+	LogInfoArg2("Test %u of %u", ++idxTest, maxTest);
 	tst_correct_elements(pmesh);
 
-	printf("Test %u of %u\n", ++idxTest, maxTest);
+	LogInfoArg2("Test %u of %u", ++idxTest, maxTest);
 	tst_unused_mesh_fields(pmesh);
 
-	printf("Test %u of %u\n", ++idxTest, maxTest);
+	LogInfoArg2("Test %u of %u", ++idxTest, maxTest);
 	tst_connectivity(pmesh);
 
 //	printf("Test %u of %u\n", ++idxTest, maxTest);
 //	assert(tst_meshFacesAndOrder(pmesh));
-	printf("============================end mesh tests=============================\n");
+	LogInfo("============================end mesh tests=============================");
 
 	return true;
 }
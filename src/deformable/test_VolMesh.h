@@ -9,6 +9,7 @@
 #define TEST_HALFEDGETETMESH_H_
 
 #include "VolMesh.h"
+#include "base/String.h"
 
 using namespace PS::MESH;
 
@@ -26,6 +27,40 @@ public:
 
 	static bool tst_connectivity(VolMesh* pmesh);
 
+	/*!
+	 * writes a displaced truth cube to the binary format at strTempFP and reads it back.
+	 * Truncated copies and copies with corrupt header words must be rejected or read
+	 * within the file.
+	 */
+	static bool tst_binary_io(const AnsiStr& strTempFP);
+
+	/*!
+	 * cuts a truth cube through and partially and attaches a cell to a clean part. The part
+	 * labels after each step must match a labelling of the whole mesh.
+	 */
+	static bool tst_incremental_parts();
+
+	/*!
+	 * random and grazing segments against random triangles. The batched tests must match
+	 * the scalar IntersectSegmentTriangle bit for bit.
+	 */
+	static bool tst_batched_segment_triangle();
+
+	//node grid radius queries against a linear scan after builds, moves, additions and removals
+	static bool tst_node_grid_radius();
+
+	//arena alignment, reuse of the blocks after a reset, rewinding and release
+	static bool tst_memory_arena();
+
+	//dense map insert, erase, clear and iteration against std::map
+	static bool tst_dense_index_map();
+
+	//latency bucket boundaries and precision, percentiles against sorted values and merging
+	static bool tst_latency_histogram();
+
+	//runs the tests above that need no input mesh. strTempFP is a scratch file.
+	static bool tst_units(const AnsiStr& strTempFP);
+
 	static bool tst_all(VolMesh* pmesh);
 };
 
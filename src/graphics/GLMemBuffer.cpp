@@ -173,7 +173,7 @@ bool GLMemoryBuffer::modify(U32 offset, U32 szTotal, const void* lpData) {
 	if(!m_isValid)
 		return false;
 
-	if(szTotal != m_szBuffer || lpData == NULL)
+	if(offset + szTotal > m_szBuffer || lpData == NULL)
 		return false;
 
 	//Bind Buffer
@@ -41,7 +41,7 @@ public:
 	void drawElements(int faceMode, int ctElements);
 
 	/*!
-	 * Modifies the buffer for changes
+	 * Modifies the range [offset, offset + szTotal) of the buffer in bytes
 	 */
 	bool modify(U32 offset, U32 szTotal, const void* lpData);
 	bool readBack(U32 szOutBuffer, void* lpOutBuffer) const;
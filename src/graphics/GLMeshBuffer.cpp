@@ -91,6 +91,10 @@ bool GLMeshBuffer::modifyVertexBuffer(U32 offset, U32 szTotal, const void* lpDat
 	return m_gmbVertex.modify(offset, szTotal, lpData);
 }
 
+bool GLMeshBuffer::modifyBuffer(GLBufferType attribType, U32 offset, U32 szTotal, const void* lpData) {
+	return m_vBuffers[attribType]->modify(offset, szTotal, lpData);
+}
+
 
 bool GLMeshBuffer::isBufferValid(GLBufferType attribType) const {
 	return m_vBuffers[attribType]->isValid();
@@ -53,7 +53,8 @@ public:
 	void setupPerVertexColorT(int glType, const Color& color, U32 ctVertices, int step = 4);
 
 	template <typename T>
-	void setupFaceIndexBufferT(int glType, const vector<T>& arrIndex, GLFaceType faceMode = ftTriangles);
+	void setupFaceIndexBufferT(int glType, const vector<T>& arrIndex, GLFaceType faceMode = ftTriangles,
+							   GLBufferUsage usage = gbuStaticDraw);
 
 	template <typename T>
 	bool readbackFaceBuffer(int glType, U32& count, vector<T>& indices) const;
@@ -69,6 +70,9 @@ public:
 	U32 countVertices() const {return m_ctVertices;}
 	U32 countFaces() const {return m_ctFaceElements/m_gmbFaces.step();}
 
+	//number of elements drawn. Buffers may hold more than that.
+	void setFaceElementsCount(U32 ctElements) { m_ctFaceElements = ctElements;}
+
 
 	//Validity
 	bool isBufferValid(GLBufferType attribType = gbtPosition) const;
@@ -78,6 +82,7 @@ public:
 
 	//update
 	bool modifyVertexBuffer(U32 offset, U32 szTotal, const void* lpData);
+	bool modifyBuffer(GLBufferType attribType, U32 offset, U32 szTotal, const void* lpData);
 
 	//clears all buffers
 	void clearAllBuffers() { GLMeshBuffer::cleanup();}
@@ -127,7 +132,7 @@ void GLMeshBuffer::setupVertexAttribsT(int glType, const vector<T>& arrAttribs,
 									   GLBufferType attribKind,
 									   GLBufferUsage usage) {
 	U32 szTotal = arrAttribs.size() * sizeof(T);
-	m_vBuffers[attribKind]->setup(attribKind, step, glType, szTotal, &arrAttribs[0]);
+	m_vBuffers[attribKind]->setup(attribKind, step, glType, szTotal, &arrAttribs[0], usage);
 	if(attribKind == gbtPosition)
 		m_ctVertices = arrAttribs.size() / step;
 }
@@ -149,12 +154,13 @@ void GLMeshBuffer::setupPerVertexColorT(int glType, const Color& color, U32 ctVe
 }
 
 template <typename T>
-void GLMeshBuffer::setupFaceIndexBufferT(int glType, const vector<T>& arrIndex, GLFaceType faceMode) {
+void GLMeshBuffer::setupFaceIndexBufferT(int glType, const vector<T>& arrIndex, GLFaceType faceMode,
+										 GLBufferUsage usage) {
 
 	int step = FaceStepSizeFromMode(faceMode);
 	m_faceMode = faceMode;
 	m_ctFaceElements = arrIndex.size();
-	m_gmbFaces.setup(gbtFaceIndex, step, glType, arrIndex.size() * sizeof(T), &arrIndex[0]);
+	m_gmbFaces.setup(gbtFaceIndex, step, glType, arrIndex.size() * sizeof(T), &arrIndex[0], usage);
 }
 
 template <typename T>
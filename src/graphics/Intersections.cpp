@@ -4,8 +4,11 @@
  *  Created on: Sep 26, 2013
  *      Author: pourya
  */
+#include "base/SIMDVecN.h"
 #include "Intersections.h"
 
+using namespace PS::MATHSIMD;
+
 namespace PS {
 namespace INTERSECTIONS {
 
@@ -119,6 +122,165 @@ int IntersectRayTriangle(const vec3d& ro, const vec3d& rd, const vec3d p[3], vec
 
 	return 1;
 }
+
+//segment triangle test over PS_SIMD_DLEN lanes in SOA layout. Every operation follows
+//IntersectSegmentTriangle and IntersectRayTriangle in the same order so lanes round alike.
+//returns the mask of lanes that hit.
+static int IntersectSegmentTriangleLanes(const Double_ s0[3], const Double_ s1[3],
+										 const Double_ p0[3], const Double_ p1[3], const Double_ p2[3],
+										 Double_& t, Double_ uvw[3], Double_ xyz[3]) {
+	const Double_ zero(0.0);
+	const Double_ one(1.0);
+
+	//normalized direction. zero length segments miss like in the scalar path.
+	Double_ delta[3] = {s1[0] - s0[0], s1[1] - s0[1], s1[2] - s0[2]};
+	Double_ len = SimdSqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+	Double_ dInv = one / len;
+	Double_ rd[3] = {delta[0] * dInv, delta[1] * dInv, delta[2] * dInv};
+
+	Double_ e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+	Double_ e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+	Double_ q[3] = {rd[1] * e2[2] - rd[2] * e2[1],
+					rd[2] * e2[0] - rd[0] * e2[2],
+					rd[0] * e2[1] - rd[1] * e2[0]};
+
+	//determinant
+	Double_ a = e1[0] * q[0] + e1[1] * q[1] + e1[2] * q[2];
+	Double_ f = one / a;
+
+	//u
+	Double_ s[3] = {s0[0] - p0[0], s0[1] - p0[1], s0[2] - p0[2]};
+	Double_ u = f * (s[0] * q[0] + s[1] * q[1] + s[2] * q[2]);
+
+	//v
+	Double_ r[3] = {s[1] * e1[2] - s[2] * e1[1],
+					s[2] * e1[0] - s[0] * e1[2],
+					s[0] * e1[1] - s[1] * e1[0]};
+	Double_ v = f * (rd[0] * r[0] + rd[1] * r[1] + rd[2] * r[2]);
+
+	//t
+	t = f * (e2[0] * r[0] + e2[1] * r[1] + e2[2] * r[2]);
+
+	int mask = SimdMaskGT(len, zero);
+	mask &= ~(SimdMaskLT(a, Double_(EPSILON)) & SimdMaskGT(a, Double_(-EPSILON)));
+	mask &= ~SimdMaskLT(u, zero);
+	mask &= ~(SimdMaskLT(v, zero) | SimdMaskGT(u + v, one));
+	mask &= SimdMaskGE(t, zero) & SimdMaskLE(t, len);
+	if(mask == 0)
+		return 0;
+
+	uvw[0] = u;
+	uvw[1] = v;
+	uvw[2] = one - u - v;
+	for(int i=0; i < 3; i++)
+		xyz[i] = s0[i] + rd[i] * t;
+
+	return mask;
+}
+
+//writes the hit lanes of a batch starting at idxFirst
+static U32 StoreHitLanes(int mask, U32 idxFirst, const Double_& t, const Double_ uvw[3], const Double_ xyz[3],
+						 int* res, double* outT, vec3d* outUVW, vec3d* outXYZ) {
+	double PS_SIMD_ALIGN(arrT[PS_SIMD_DLEN]);
+	double PS_SIMD_ALIGN(arrUVW[PS_SIMD_DLEN * 3]);
+	double PS_SIMD_ALIGN(arrXYZ[PS_SIMD_DLEN * 3]);
+	if(mask != 0) {
+		Double_(t).store(arrT);
+		SimdStoreVector(arrUVW, uvw[0], uvw[1], uvw[2]);
+		SimdStoreVector(arrXYZ, xyz[0], xyz[1], xyz[2]);
+	}
+
+	U32 ctHits = 0;
+	for(int i=0; i < PS_SIMD_DLEN; i++) {
+		if((mask & (1 << i)) == 0) {
+			res[idxFirst + i] = 0;
+			continue;
+		}
+
+		res[idxFirst + i] = 1;
+		outT[idxFirst + i] = arrT[i];
+		outUVW[idxFirst + i] = vec3d(&arrUVW[i * 3]);
+		outXYZ[idxFirst + i] = vec3d(&arrXYZ[i * 3]);
+		ctHits++;
+	}
+
+	return ctHits;
+}
+
+U32 IntersectSegmentsTriangle(U32 count, const vec3d* s0, const vec3d* s1, const vec3d p[3],
+							  int* res, double* t, vec3d* uvw, vec3d* xyz) {
+	//the triangle is shared by all lanes
+	Double_ p0[3], p1[3], p2[3];
+	for(int i=0; i < 3; i++) {
+		p0[i] = Double_(p[0][i]);
+		p1[i] = Double_(p[1][i]);
+		p2[i] = Double_(p[2][i]);
+	}
+
+	U32 ctHits = 0;
+	const U32 ctSimd = count - count % PS_SIMD_DLEN;
+	for(U32 i=0; i < ctSimd; i += PS_SIMD_DLEN) {
+		Double_ ss0[3], ss1[3];
+		SimdLoadVector(s0[i].cptr(), ss0[0], ss0[1], ss0[2]);
+		SimdLoadVector(s1[i].cptr(), ss1[0], ss1[1], ss1[2]);
+
+		Double_ lanesT, lanesUVW[3], lanesXYZ[3];
+		int mask = IntersectSegmentTriangleLanes(ss0, ss1, p0, p1, p2, lanesT, lanesUVW, lanesXYZ);
+		ctHits += StoreHitLanes(mask, i, lanesT, lanesUVW, lanesXYZ, res, t, uvw, xyz);
+	}
+
+	//remainder
+	for(U32 i=ctSimd; i < count; i++) {
+		res[i] = IntersectSegmentTriangle(s0[i], s1[i], p, t[i], uvw[i], xyz[i]);
+		if(res[i])
+			ctHits++;
+	}
+
+	return ctHits;
+}
+
+U32 IntersectSegmentTriangles(const vec3d& s0, const vec3d& s1, U32 count, const vec3d* tris,
+							  int* res, double* t, vec3d* uvw, vec3d* xyz) {
+	//the segment is shared by all lanes
+	Double_ ss0[3], ss1[3];
+	for(int i=0; i < 3; i++) {
+		ss0[i] = Double_(s0[i]);
+		ss1[i] = Double_(s1[i]);
+	}
+
+	U32 ctHits = 0;
+	const U32 ctSimd = count - count % PS_SIMD_DLEN;
+	for(U32 i=0; i < ctSimd; i += PS_SIMD_DLEN) {
+
+		//triangle vertices are strided so lanes are gathered
+		double PS_SIMD_ALIGN(arrLanes[9][PS_SIMD_DLEN]);
+		for(int j=0; j < PS_SIMD_DLEN; j++) {
+			const vec3d* tri = &tris[(i + j) * 3];
+			for(int k=0; k < 9; k++)
+				arrLanes[k][j] = tri[k / 3][k % 3];
+		}
+
+		Double_ p0[3], p1[3], p2[3];
+		for(int k=0; k < 3; k++) {
+			p0[k] = Double_(arrLanes[k]);
+			p1[k] = Double_(arrLanes[3 + k]);
+			p2[k] = Double_(arrLanes[6 + k]);
+		}
+
+		Double_ lanesT, lanesUVW[3], lanesXYZ[3];
+		int mask = IntersectSegmentTriangleLanes(ss0, ss1, p0, p1, p2, lanesT, lanesUVW, lanesXYZ);
+		ctHits += StoreHitLanes(mask, i, lanesT, lanesUVW, lanesXYZ, res, t, uvw, xyz);
+	}
+
+	//remainder
+	for(U32 i=ctSimd; i < count; i++) {
+		res[i] = IntersectSegmentTriangle(s0, s1, &tris[i * 3], t[i], uvw[i], xyz[i]);
+		if(res[i])
+			ctHits++;
+	}
+
+	return ctHits;
+}
 }
 }
 
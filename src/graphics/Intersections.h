@@ -241,6 +241,22 @@ int IntersectBoxTriangle(T boxcenter[3], T boxhalfsize[3], T triverts[3][3]) {
 int IntersectSegmentTriangle(const vec3d& s0, const vec3d& s1, const vec3d p[3], double& t, vec3d& uvw, vec3d& xyz);
 int IntersectSegmentTriangleF(const vec3f& s0, const vec3f& s1, const vec3f p[3], float& t, vec3f& uvw, vec3f& xyz);
 
+/*!
+ * Batched segment triangle intersection. Tests count segments against one triangle,
+ * PS_SIMD_DLEN segments per SIMD step. Without FP contraction res[i] and the outputs of
+ * every hit are bitwise equal to IntersectSegmentTriangle on segment i. Outputs of missed
+ * segments are left as is. Returns the number of hits.
+ */
+U32 IntersectSegmentsTriangle(U32 count, const vec3d* s0, const vec3d* s1, const vec3d p[3],
+							  int* res, double* t, vec3d* uvw, vec3d* xyz);
+
+/*!
+ * Batched segment triangle intersection. Tests one segment against count triangles
+ * stored as three consecutive vertices each. Same results as the scalar test per triangle.
+ */
+U32 IntersectSegmentTriangles(const vec3d& s0, const vec3d& s1, U32 count, const vec3d* tris,
+							  int* res, double* t, vec3d* uvw, vec3d* xyz);
+
 /*!
  * Ray triangle intersection
  */
@@ -21,6 +21,7 @@
 #include "deformable/VolMeshSamples.h"
 #include "deformable/VolMeshIO.h"
 #include "deformable/VolMeshStats.h"
+#include "deformable/test_VolMesh.h"
 
 using namespace tbb;
 using namespace PS;
@@ -37,12 +38,15 @@ IAvatar* g_lpAvatar = NULL;
 CuttableMesh* g_lpTissue = NULL;
 CmdLineParser g_parser;
 AnsiStr g_strFilePath;
+CutTrajectory g_recorder;
+AnsiStr g_strRecordPath;
 U32 g_current = 3;
 U32 g_cutCase = 0;
 
 //funcs
 void resetMesh();
 void cutFinished();
+void finishCuts();
 void runTestSubDivide(int current);
 void handleElementEvent(CELL element, U32 handle, VolMesh::TopologyEvent event);
 
@@ -55,12 +59,26 @@ void draw() {
 }
 
 void timestep() {
+	//background cuts are committed in the tissue timestep
+	U32 generation = g_lpTissue ? g_lpTissue->generation() : 0;
+	CuttableMesh* lpTissue = g_lpTissue;
+
 	TheSceneGraph::Instance().timestep();
 	TheGizmoManager::Instance().timestep();
+
+	if(g_lpTissue != lpTissue || (g_lpTissue && g_lpTissue->generation() != generation))
+		glutPostRedisplay();
+}
+
+//the mesh is read directly after this. Blocks the gl thread until the queued cuts are committed.
+void finishCuts() {
+	if(g_lpTissue)
+		g_lpTissue->finishBackgroundCuts();
 }
 
 void MousePress(int button, int state, int x, int y)
 {
+    finishCuts();
     TheSceneGraph::Instance().mousePress(button, state, x, y);
     TheGizmoManager::Instance().mousePress(button, state, x, y);
 
@@ -106,6 +124,7 @@ void SaveAsObj() {
 
 void NormalKey(unsigned char key, int x, int y)
 {
+	finishCuts();
 	switch(key)
 	{
 
@@ -255,6 +274,10 @@ void NormalKey(unsigned char key, int x, int y)
 									  g_lpTissue->name().c_str(),
 									  g_lpTissue->countCompletedCuts());
 
+		AnsiStr strBinOutput = strOutput + printToAStr("%s_cuts%d.vmb",
+									  g_lpTissue->name().c_str(),
+									  g_lpTissue->countCompletedCuts());
+
 		LogInfoArg1("Attempt to store at %s. Make sure all the required directories are present!", strVegOutput.cptr());
 		if(VolMeshIO::writeVega(g_lpTissue, strVegOutput))
 			LogInfoArg1("Stored the mesh at: %s", strVegOutput.cptr());
@@ -262,6 +285,11 @@ void NormalKey(unsigned char key, int x, int y)
 		LogInfoArg1("Attempt to store at %s. Make sure all the required directories are present!", strObjOutput.cptr());
 		if(VolMeshIO::writeObj(g_lpTissue, strObjOutput))
 			LogInfoArg1("Stored the mesh at: %s", strObjOutput.cptr());
+
+		//snapshot with topology and rest positions
+		LogInfoArg1("Attempt to store at %s. Make sure all the required directories are present!", strBinOutput.cptr());
+		if(VolMeshIO::writeBinary(g_lpTissue, strBinOutput))
+			LogInfoArg1("Stored the mesh at: %s", strBinOutput.cptr());
 	}
 	break;
 
@@ -285,6 +313,7 @@ void NormalKey(unsigned char key, int x, int y)
 
 void SpecialKey(int key, int x, int y)
 {
+	finishCuts();
 	switch(key)
 	{
 		case(GLUT_KEY_F1):
@@ -410,9 +439,17 @@ void closeApp() {
 	TheGizmoManager::Instance().writeConfig();
 	TheSceneGraph::Instance().writeConfig();
 
+	//recorded strokes for replay in the cut benchmark
+	if(g_strRecordPath.length() > 0 && g_recorder.countStrokes() > 0) {
+		if(g_recorder.write(g_strRecordPath))
+			LogInfoArg2("Recorded %u strokes to: %s", g_recorder.countStrokes(), g_strRecordPath.cptr());
+	}
+
+	finishCuts();
 	SAFE_DELETE(g_lpScalpel);
 	SAFE_DELETE(g_lpRing);
 	SAFE_DELETE(g_lpTissue);
+	TheEventLogger::Instance().flush();
 }
 
 void handleElementEvent(CELL element, U32 handle, VolMesh::TopologyEvent event) {
@@ -424,25 +461,36 @@ void handleElementEvent(CELL element, U32 handle, VolMesh::TopologyEvent event)
 }
 
 void resetMesh() {
+	finishCuts();
+
 	//remove it from scenegraph
 	TheSceneGraph::Instance().remove(g_lpTissue);
 	SAFE_DELETE(g_lpTissue);
 
-	VolMesh* temp = NULL;
 	if(FileExists(g_strFilePath)) {
-		temp = new PS::MESH::VolMesh();
-		temp->setFlagFilterOutFlatCells(false);
-		temp->setVerbose(g_parser.value<int>("verbose"));
-		LogInfoArg1("Begin to read vega file from: %s", g_strFilePath.cptr());
-		bool res = PS::MESH::VolMeshIO::readVega(temp, g_strFilePath);
+		//read into the tissue. A copy would rebuild the topology and reset the rest positions.
+		g_lpTissue = new CuttableMesh();
+		g_lpTissue->setFlagFilterOutFlatCells(false);
+		g_lpTissue->setVerbose(g_parser.value<int>("verbose"));
+		bool res = false;
+		if(ExtractFileExt(g_strFilePath) == AnsiStr("vmb")) {
+			LogInfoArg1("Begin to read binary mesh file from: %s", g_strFilePath.cptr());
+			res = PS::MESH::VolMeshIO::readBinary(g_lpTissue, g_strFilePath);
+		}
+		else {
+			LogInfoArg1("Begin to read vega file from: %s", g_strFilePath.cptr());
+			res = PS::MESH::VolMeshIO::readVega(g_lpTissue, g_strFilePath);
+		}
 		if(!res)
 			LogErrorArg1("Unable to load mesh from: %s", g_strFilePath.cptr());
 
-//		U32 ctRemoved = temp->removeZeroVolumeCells();
+//		U32 ctRemoved = g_lpTissue->removeZeroVolumeCells();
 //		if(ctRemoved > 0)
 //			LogInfoArg1("Managed to remove %u flat cells in the mesh", ctRemoved);
+		g_lpTissue->setup();
 	}
 	else {
+		VolMesh* temp = NULL;
 		AnsiStr strExample = g_parser.value<AnsiStr>("example");
 		int pos = -1;
 		if(strExample == "one")
@@ -464,18 +512,32 @@ void resetMesh() {
 		}
 		else
 			temp = PS::MESH::VolMeshSamples::CreateOneTetra();
-	}
 
+		g_lpTissue = new CuttableMesh(*temp);
+		SAFE_DELETE(temp);
+	}
 
-	LogInfo("Loaded mesh to temp");
-	g_lpTissue = new CuttableMesh(*temp);
+	LogInfo("Loaded mesh");
 	g_lpTissue->setFlagSplitMeshAfterCut(true);
 	g_lpTissue->setFlagDrawNodes(true);
 	g_lpTissue->setFlagDrawWireFrame(false);
 	g_lpTissue->setColor(Color::skin());
 	g_lpTissue->setVerbose(g_parser.value<int>("verbose") != 0);
+	if(g_parser.value<int>("compactgc"))
+		g_lpTissue->setGCPolicy(VolMesh::gcpDeferredCompaction);
+	if(g_parser.value<int>("nestedincidence"))
+		g_lpTissue->setFlagPackedIncidence(false);
+	g_lpTissue->setFlagProgressiveCut(g_parser.value<int>("progressivecut") != 0);
+	g_lpTissue->setFlagNodeSignCut(g_parser.value<int>("nodesigncut") != 0);
+	g_lpTissue->setFlagBackgroundCut(g_parser.value<int>("synccut") == 0);
+
+	AnsiStr strReorder = g_parser.value<AnsiStr>("reorder");
+	if(strReorder == "morton" || strReorder == "hilbert") {
+		VolMesh::SpaceFillingCurve curve = (strReorder == "morton") ? VolMesh::sfcMorton : VolMesh::sfcHilbert;
+		g_lpTissue->reorder(curve);
+		g_lpTissue->setReorderAfterGC(curve);
+	}
 	g_lpTissue->syncRender();
-	SAFE_DELETE(temp);
 
 	TheSceneGraph::Instance().add(g_lpTissue);
 	if(g_parser.value<int>("ringscalpel") == 1)
@@ -528,6 +590,9 @@ void cutFinished() {
 	for(U32 i=0; i < vMeshes.size(); i++) {
 		vMeshes[i]->computeAABB();
 		vMeshes[i]->setElemToShow(0);
+		vMeshes[i]->setFlagProgressiveCut(g_lpTissue->getFlagProgressiveCut());
+		vMeshes[i]->setFlagNodeSignCut(g_lpTissue->getFlagNodeSignCut());
+		vMeshes[i]->setFlagBackgroundCut(g_lpTissue->getFlagBackgroundCut());
 		TheSceneGraph::Instance().add(vMeshes[i]);
 
 		if(vMeshes[i]->countCells() > ctMaxCells) {
@@ -552,13 +617,49 @@ int main(int argc, char* argv[]) {
  	g_parser.add_toggle("disjoint", "converts splitted part to disjoint meshes");
  	g_parser.add_toggle("ringscalpel", "If the switch presents then the ring scalpel will be used");
  	g_parser.add_toggle("verbose", "prints detailed description.");
- 	g_parser.add_option("input", "[filepath] set input file in vega format", Value(AnsiStr("internal")));
+ 	g_parser.add_option("input", "[filepath] set input file in vega or binary (.vmb) format", Value(AnsiStr("internal")));
 	g_parser.add_option("example", "[one, two, cube, eggshell] set an internal example", Value(AnsiStr("two")));
 	g_parser.add_option("gizmo", "loads a file to set gizmo location and orientation", Value(AnsiStr("gizmo.ini")));
 
+	//registered after the options above so those keep their shortcuts
+ 	g_parser.add_toggle("compactgc", "garbage collection marks removed entities and compacts the mesh in a single pass");
+ 	g_parser.add_toggle("nestedincidence", "keeps one heap list per entity for incidences instead of packed arrays");
+ 	g_parser.add_toggle("progressivecut", "cuts the tissue while the scalpel moves inside it instead of at the end of the stroke");
+ 	g_parser.add_toggle("synclog", "writes log entries on the interaction thread instead of a background writer");
+ 	g_parser.add_toggle("synccut", "cuts the tissue on the interaction thread instead of a background task while the last cut is drawn");
+ 	g_parser.add_toggle("nodesigncut", "finds cut-edges from node sides against all swept quads in one pass instead of testing every edge per quad");
+	g_parser.add_option("convert", "[filepath] converts a vega file to the binary (.vmb) format and exits", Value(AnsiStr("")), AnsiStr("cv"));
+	g_parser.add_option("reorder", "[none, morton, hilbert] renumbers nodes and cells along a space filling curve at load time and after each garbage collection", Value(AnsiStr("none")), AnsiStr("ro"));
+	g_parser.add_option("record", "[filepath] records the tool strokes that cut the tissue and writes them on exit", Value(AnsiStr("")), AnsiStr("rc"));
+	g_parser.add_toggle("testbinary", "checks the binary mesh reader on a round trip and on truncated and corrupt files and exits");
+	g_parser.add_toggle("testunits", "runs the mesh and container tests that need no input mesh and exits");
+
 	if(g_parser.parse(argc, argv) < 0)
 		exit(0);
 
+	//log i/o stays off the interaction thread
+	if(!g_parser.value<int>("synclog"))
+		TheEventLogger::Instance().setWriteFlags(PS_LOG_WRITE_EVENTTYPE | PS_LOG_WRITE_SOURCE | PS_LOG_WRITE_TO_SCREEN | PS_LOG_WRITE_ASYNC);
+
+	//binary mesh reader test only
+	if(g_parser.value<int>("testbinary")) {
+		bool res = TestVolMesh::tst_binary_io(ExtractFilePath(GetExePath()) + AnsiStr("tst_binary_io.vmb"));
+		exit(res ? 0 : 1);
+	}
+
+	//unit tests only
+	if(g_parser.value<int>("testunits")) {
+		bool res = TestVolMesh::tst_units(ExtractFilePath(GetExePath()) + AnsiStr("tst_units.vmb"));
+		exit(res ? 0 : 1);
+	}
+
+	//convert only
+	AnsiStr strConvert = g_parser.value<AnsiStr>("convert");
+	if(strConvert.length() > 0) {
+		bool res = VolMeshIO::convertVegaToBinary(ExtractFilePath(GetExePath()) + strConvert);
+		exit(res ? 0 : 1);
+	}
+
 	//file path
 	g_strFilePath = ExtractFilePath(GetExePath()) + g_parser.value<AnsiStr>("input");
 	if(FileExists(g_strFilePath))
@@ -666,6 +767,14 @@ int main(int argc, char* argv[]) {
 
 	g_lpAvatar->setTissue(g_lpTissue);
 	g_lpAvatar->setOnCutFinishedEventHandler(cutFinished);
+
+	//record strokes
+	AnsiStr strRecord = g_parser.value<AnsiStr>("record");
+	if(strRecord.length() > 0) {
+		g_strRecordPath = ExtractFilePath(GetExePath()) + strRecord;
+		g_lpScalpel->setRecorder(&g_recorder);
+		g_lpRing->setRecorder(&g_recorder);
+	}
 	TheGizmoManager::Instance().setFocusedNode(g_lpAvatar);
 
 
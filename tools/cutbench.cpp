@@ -0,0 +1,339 @@
+/*!
+ * \brief cutbench - headless cutting benchmark. Replays tool strokes on a mesh and reports
+ * the wall time of the cut stages and the peak memory as json.
+ * \author Pourya Shirazian
+ */
+#include <iostream>
+#include <fstream>
+#include <tbb/task_scheduler_init.h>
+#include <sys/resource.h>
+#include "base/FileDirectory.h"
+#include "base/Logger.h"
+#include "base/CmdLineParser.h"
+#include "base/Profiler.h"
+
+#include "deformable/CuttableMesh.h"
+#include "deformable/CutTrajectory.h"
+#include "deformable/VolMeshRender.h"
+#include "deformable/VolMeshSamples.h"
+#include "deformable/VolMeshIO.h"
+
+using namespace tbb;
+using namespace PS;
+using namespace PS::MESH;
+using namespace PS::FILESTRINGUTILS;
+
+using namespace std;
+
+CmdLineParser g_parser;
+
+//paths are relative to the executable as in the app unless absolute
+AnsiStr resolvePath(const AnsiStr& strPath) {
+	if(strPath.length() > 0 && strPath.firstChar() == '/')
+		return strPath;
+	return ExtractFilePath(GetExePath()) + strPath;
+}
+
+//peak resident memory in KB since the last reset
+void resetPeakMemory() {
+#if defined(PS_OS_LINUX)
+	ofstream ofs("/proc/self/clear_refs");
+	if(ofs.is_open())
+		ofs << "5" << endl;
+#endif
+}
+
+U64 peakMemoryKB() {
+#if defined(PS_OS_LINUX)
+	ifstream ifs("/proc/self/status");
+	string strLine;
+	while(std::getline(ifs, strLine)) {
+		U64 kb = 0;
+		if(sscanf(strLine.c_str(), "VmHWM: %llu kB", &kb) == 1)
+			return kb;
+	}
+#endif
+
+	//process wide peak
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (U64)usage.ru_maxrss;
+}
+
+double elapsedMS(const tick& t0) {
+	return (Profiler::GetTickCount() - t0).seconds() * 1000.0;
+}
+
+//loads the input mesh. The internal cube is built at the given resolution. Files are read
+//into the tissue so the stored rest positions and topology are kept.
+CuttableMesh* loadTissue(const AnsiStr& strInput, U32 resolution) {
+	if(strInput == "cube") {
+		VolMesh* temp = VolMeshSamples::CreateTruthCube(resolution, resolution, resolution, 0.2);
+		if(temp == NULL)
+			return NULL;
+
+		CuttableMesh* lpTissue = new CuttableMesh(*temp);
+		SAFE_DELETE(temp);
+		return lpTissue;
+	}
+
+	AnsiStr strPath = resolvePath(strInput);
+	CuttableMesh* lpTissue = new CuttableMesh();
+	lpTissue->setFlagFilterOutFlatCells(false);
+
+	bool res = false;
+	if(ExtractFileExt(strPath) == AnsiStr("vmb"))
+		res = VolMeshIO::readBinary(lpTissue, strPath);
+	else
+		res = VolMeshIO::readVega(lpTissue, strPath);
+
+	if(!res) {
+		LogErrorArg1("Unable to load mesh from: %s", strPath.cptr());
+		SAFE_DELETE(lpTissue);
+		return NULL;
+	}
+
+	lpTissue->setup();
+	return lpTissue;
+}
+
+//sets up the tissue the same way as the app
+void setupTissue(CuttableMesh* lpTissue) {
+	lpTissue->setFlagSplitMeshAfterCut(true);
+	lpTissue->setVerbose(false);
+	if(g_parser.value<int>("compactgc"))
+		lpTissue->setGCPolicy(VolMesh::gcpDeferredCompaction);
+	lpTissue->setFlagProgressiveCut(g_parser.value<int>("progressivecut") != 0);
+	lpTissue->setFlagNodeSignCut(g_parser.value<int>("nodesigncut") != 0);
+
+	AnsiStr strReorder = g_parser.value<AnsiStr>("reorder");
+	if(strReorder == "morton" || strReorder == "hilbert") {
+		VolMesh::SpaceFillingCurve curve = (strReorder == "morton") ? VolMesh::sfcMorton : VolMesh::sfcHilbert;
+		lpTissue->reorder(curve);
+		lpTissue->setReorderAfterGC(curve);
+	}
+}
+
+//recorded strokes or a generated one fitted to the mesh
+bool buildTrajectory(CuttableMesh* lpTissue, CutTrajectory& trajectory) {
+	AnsiStr strTrajectory = g_parser.value<AnsiStr>("trajectory");
+	U32 ctFrames = (U32)(MATHMAX(g_parser.value<int>("frames"), 2));
+	double depth = atof(g_parser.value<AnsiStr>("depth").cptr());
+
+	trajectory.clear();
+	if(strTrajectory == "scalpel")
+		trajectory.addScalpelStroke(lpTissue->computeAABB(), ctFrames, depth);
+	else if(strTrajectory == "ring")
+		trajectory.addRingStroke(lpTissue->computeAABB(), ctFrames, (U32)(MATHMAX(g_parser.value<int>("sectors"), 3)), depth);
+	else if(!trajectory.read(resolvePath(strTrajectory)))
+		return false;
+
+	return (trajectory.countStrokes() > 0);
+}
+
+void writeStroke(ostream& out, U32 idxStroke, int res, double msWall, const CuttableMesh* lpTissue) {
+	const CuttableMesh::CutStats& stats = lpTissue->lastCutStats();
+
+	out << "\t\t\t\t{\"stroke\": " << idxStroke << ", \"result\": " << res;
+	out << ", \"wall_ms\": " << msWall << ", \"total_ms\": " << stats.total();
+	out << ", \"intersect_ms\": " << stats.msIntersect;
+	out << ", \"classify_ms\": " << stats.msClassify;
+	out << ", \"edgecut_ms\": " << stats.msEdgeCut;
+	out << ", \"subdivide_ms\": " << stats.msSubdivide;
+	out << ", \"gc_ms\": " << stats.msGC;
+	out << ", \"splitparts_ms\": " << stats.msSplitParts;
+	out << ", \"stats_ms\": " << stats.msStats;
+	out << ", \"rendersync_ms\": " << stats.msRenderSync;
+	out << ", \"cut_edges\": " << stats.ctCutEdges;
+	out << ", \"cut_cells\": " << stats.ctCutCells;
+	out << ", \"subdivided_tets\": " << stats.ctSubdividedTets;
+	out << ", \"nodes\": " << lpTissue->countNodes();
+	out << ", \"cells\": " << lpTissue->countCells() << "}";
+}
+
+/*!
+ * one run: loads the mesh, replays all strokes and writes the run record.
+ * @return false if the mesh or the trajectory could not be loaded or the cut modes disagree
+ */
+bool runOnce(ostream& out, U32 resolution, U32 idxRepeat) {
+	resetPeakMemory();
+
+	tick t0 = Profiler::GetTickCount();
+	CuttableMesh* lpTissue = loadTissue(g_parser.value<AnsiStr>("input"), resolution);
+	if(lpTissue == NULL)
+		return false;
+
+	setupTissue(lpTissue);
+	lpTissue->syncRender();
+	double msLoad = elapsedMS(t0);
+
+	CutTrajectory trajectory;
+	if(!buildTrajectory(lpTissue, trajectory)) {
+		LogError("No strokes to replay.");
+		SAFE_DELETE(lpTissue);
+		return false;
+	}
+
+	out << "\t\t{\"resolution\": " << resolution << ", \"repeat\": " << idxRepeat;
+	out << ", \"load_ms\": " << msLoad;
+	out << ", \"nodes\": " << lpTissue->countNodes() << ", \"cells\": " << lpTissue->countCells();
+	out << ", \"strokes\": [" << endl;
+
+	//the same strokes in the other cut mode on a second copy of the mesh
+	CuttableMesh* lpOther = NULL;
+	if(g_parser.value<int>("comparemodes")) {
+		lpOther = loadTissue(g_parser.value<AnsiStr>("input"), resolution);
+		if(lpOther == NULL) {
+			SAFE_DELETE(lpTissue);
+			return false;
+		}
+
+		setupTissue(lpOther);
+		lpOther->setFlagProgressiveCut(!lpTissue->getFlagProgressiveCut());
+	}
+
+	double msTotal = 0.0;
+	bool isMatched = true;
+	for(U32 i=0; i < trajectory.countStrokes(); i++) {
+		tick t1 = Profiler::GetTickCount();
+		int res = trajectory.replay(lpTissue, i);
+		double msWall = elapsedMS(t1);
+		msTotal += msWall;
+
+		writeStroke(out, i, res, msWall, lpTissue);
+
+		//both modes have to agree on whether the stroke cut the mesh
+		if(lpOther) {
+			int resOther = trajectory.replay(lpOther, i);
+			if((res > 0) != (resOther > 0)) {
+				LogErrorArg3("Stroke %u subdivided %d elements but %d in the other cut mode.", i, res, resOther);
+				isMatched = false;
+			}
+		}
+		out << ((i + 1 < trajectory.countStrokes()) ? "," : "") << endl;
+	}
+
+	out << "\t\t\t], \"cut_ms\": " << msTotal;
+	out << ", \"peak_rss_kb\": " << peakMemoryKB() << "}";
+
+	SAFE_DELETE(lpOther);
+	SAFE_DELETE(lpTissue);
+	return isMatched;
+}
+
+int main(int argc, char* argv[]) {
+
+	//parser
+	g_parser.add_toggle("progressivecut", "cuts at every frame of a stroke instead of at its end");
+	g_parser.add_toggle("nodesigncut", "finds cut-edges from node sides against all swept quads in one pass");
+	g_parser.add_toggle("compactgc", "garbage collection marks removed entities and compacts the mesh in a single pass");
+	g_parser.add_toggle("quiet", "logs warnings and errors only");
+	g_parser.add_toggle("synclog", "writes log entries on the cutting thread instead of a background writer");
+	g_parser.add_option("input", "[cube, filepath] internal truth cube or a mesh file in vega or binary (.vmb) format", Value(AnsiStr("cube")));
+	g_parser.add_option("resolutions", "[n0,n1,...] nodes per side of the internal cube", Value(AnsiStr("8,16,24")));
+	g_parser.add_option("trajectory", "[scalpel, ring, filepath] generated stroke or strokes recorded by the app", Value(AnsiStr("scalpel")));
+	g_parser.add_option("frames", "tool positions of a generated stroke", Value((int)32));
+	g_parser.add_option("depth", "depth of a generated stroke relative to the mesh height. Above 1 cuts through.", Value(AnsiStr("0.5")));
+	g_parser.add_option("sectors", "ring sectors of a generated ring stroke", Value((int)16));
+	g_parser.add_option("reorder", "[none, morton, hilbert] renumbers nodes and cells along a space filling curve", Value(AnsiStr("none")));
+	g_parser.add_option("repeats", "runs per resolution. Every run starts from a fresh mesh.", Value((int)1));
+	g_parser.add_option("threads", "worker threads. 0 for all cores.", Value((int)0));
+	g_parser.add_option("output", "[filepath] json report", Value(AnsiStr("cutbench.json")));
+	g_parser.add_option("trace", "[filepath] writes the profiled scopes of the last events in chrome trace format", Value(AnsiStr("")), AnsiStr("tr"));
+	g_parser.add_option("latency", "[filepath] writes the latency percentiles of the profiled scopes. Compare two with latencydiff.", Value(AnsiStr("")));
+	g_parser.add_toggle("comparemodes", "replays the strokes in batch and progressive cut mode and fails when only one of them cuts");
+
+	if(g_parser.parse(argc, argv) < 0)
+		exit(1);
+
+	//log i/o off the timed path as in the app
+	EventLogger& logger = TheEventLogger::Instance();
+	if(!g_parser.value<int>("synclog"))
+		logger.setWriteFlags(PS_LOG_WRITE_EVENTTYPE | PS_LOG_WRITE_SOURCE | PS_LOG_WRITE_TO_SCREEN | PS_LOG_WRITE_ASYNC);
+	if(g_parser.value<int>("quiet"))
+		logger.setEventFilter(EventLogger::emWarning | EventLogger::emError);
+
+	int ctThreads = g_parser.value<int>("threads");
+	if(ctThreads <= 0)
+		ctThreads = tbb::task_scheduler_init::default_num_threads();
+	tbb::task_scheduler_init init(ctThreads);
+
+	//no gl context
+	VolMeshRender::setHeadless(true);
+
+	//resolutions apply to the internal cube only
+	vector<U32> vResolutions;
+	AnsiStr strInput = g_parser.value<AnsiStr>("input");
+	if(strInput == "cube") {
+		AnsiStr strResolutions = g_parser.value<AnsiStr>("resolutions");
+		const char* lpStr = strResolutions.cptr();
+		while(*lpStr) {
+			U32 res = 0;
+			int len = 0;
+			if(sscanf(lpStr, "%u%n", &res, &len) != 1)
+				break;
+			if(res > 0)
+				vResolutions.push_back(res);
+			lpStr += len;
+			while(*lpStr == ',' || *lpStr == ' ')
+				lpStr++;
+		}
+	}
+	else
+		vResolutions.push_back(0);
+
+	if(vResolutions.size() == 0) {
+		LogError("No valid resolutions.");
+		return 1;
+	}
+
+	AnsiStr strOutput = resolvePath(g_parser.value<AnsiStr>("output"));
+	ofstream out(strOutput.cptr());
+	if(!out.is_open()) {
+		LogErrorArg1("Unable to write the report to: %s", strOutput.cptr());
+		return 1;
+	}
+
+	out << "{\"benchmark\": \"cutbench\", \"threads\": " << ctThreads;
+	out << ", \"input\": \"" << strInput.cptr() << "\"";
+	out << ", \"trajectory\": \"" << g_parser.value<AnsiStr>("trajectory").cptr() << "\"";
+	out << ", \"progressive\": " << (g_parser.value<int>("progressivecut") ? "true" : "false");
+	out << ", \"nodesigncut\": " << (g_parser.value<int>("nodesigncut") ? "true" : "false");
+	out << ", \"compactgc\": " << (g_parser.value<int>("compactgc") ? "true" : "false");
+	out << ", \"reorder\": \"" << g_parser.value<AnsiStr>("reorder").cptr() << "\"," << endl;
+	out << "\t\"runs\": [" << endl;
+
+	int ctRepeats = MATHMAX(g_parser.value<int>("repeats"), 1);
+	for(U32 i=0; i < vResolutions.size(); i++) {
+		for(int r=0; r < ctRepeats; r++) {
+			if(!runOnce(out, vResolutions[i], r))
+				return 1;
+
+			bool isLast = (i + 1 == vResolutions.size()) && (r + 1 == ctRepeats);
+			out << (isLast ? "" : ",") << endl;
+		}
+	}
+
+	out << "\t]" << endl << "}" << endl;
+	out.close();
+
+	LogInfoArg1("Benchmark report written to: %s", strOutput.cptr());
+
+	//profiled scopes for a timeline view
+	AnsiStr strTrace = g_parser.value<AnsiStr>("trace");
+	if(strTrace.length() > 0) {
+		strTrace = resolvePath(strTrace);
+		if(TheProfiler::Instance().writeChromeTrace(strTrace))
+			LogInfoArg1("Trace written to: %s", strTrace.cptr());
+	}
+
+	//tail latencies over all runs
+	AnsiStr strLatency = g_parser.value<AnsiStr>("latency");
+	if(strLatency.length() > 0) {
+		strLatency = resolvePath(strLatency);
+		if(TheProfiler::Instance().writeLatencyStats(strLatency))
+			LogInfoArg1("Latency stats written to: %s", strLatency.cptr());
+	}
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*!
+ * \brief latencydiff - compares the latency stats of two runs written by the profiler and
+ * reports the labels whose p99 grew beyond a threshold. Averages hide the slow end of
+ * strokes so the tail is what is compared.
+ * \author Pourya Shirazian
+ */
+#include <iostream>
+#include <stdio.h>
+#include "base/FileDirectory.h"
+#include "base/Logger.h"
+#include "base/CmdLineParser.h"
+#include "base/Profiler.h"
+
+using namespace PS;
+using namespace PS::FILESTRINGUTILS;
+
+using namespace std;
+
+CmdLineParser g_parser;
+
+//paths are relative to the executable as in the app unless absolute
+AnsiStr resolvePath(const AnsiStr& strPath) {
+	if(strPath.length() > 0 && strPath.firstChar() == '/')
+		return strPath;
+	return ExtractFilePath(GetExePath()) + strPath;
+}
+
+const ProfileLatency* findLabel(const vector<ProfileLatency>& vStats, const AnsiStr& strLabel) {
+	for(U32 i=0; i < vStats.size(); i++) {
+		if(vStats[i].strLabel == strLabel)
+			return &vStats[i];
+	}
+	return NULL;
+}
+
+/*!
+ * compares the p99 of the labels both runs have with enough events.
+ * @return number of labels slower than the baseline by more than the threshold percent
+ */
+int compareStats(const vector<ProfileLatency>& vBase, const vector<ProfileLatency>& vCur, double threshold, U32 ctMinEvents) {
+	int ctRegressions = 0;
+	U32 ctMatched = 0;
+	U32 ctSkipped = 0;
+
+	printf("%-48s %10s %12s %12s %12s %9s\n", "label", "count", "base p99", "cur p99", "cur max", "change");
+	for(U32 i=0; i < vCur.size(); i++) {
+		const ProfileLatency& cur = vCur[i];
+		const ProfileLatency* lpBase = findLabel(vBase, cur.strLabel);
+		if(lpBase == NULL)
+			continue;
+
+		//too few events for a stable tail
+		if(cur.count < ctMinEvents || lpBase->count < ctMinEvents) {
+			ctSkipped++;
+			continue;
+		}
+
+		double change = (lpBase->p99MS > 0.0) ? 100.0 * (cur.p99MS - lpBase->p99MS) / lpBase->p99MS : 0.0;
+		bool isRegression = (change > threshold);
+		if(isRegression)
+			ctRegressions++;
+		ctMatched++;
+
+		printf("%-48s %10llu %12.4f %12.4f %12.4f %+8.1f%%%s\n", cur.strLabel.cptr(), (unsigned long long)cur.count,
+				lpBase->p99MS, cur.p99MS, cur.highestMS, change, isRegression ? " REGRESSION" : "");
+	}
+
+	printf("compared %u labels, skipped %u with fewer than %u events. %d with p99 slower than %.1f%%.\n",
+			ctMatched, ctSkipped, ctMinEvents, ctRegressions, threshold);
+	return ctRegressions;
+}
+
+int main(int argc, char* argv[]) {
+
+	//parser
+	g_parser.add_option("baseline", "[filepath] latency stats to compare against", Value(AnsiStr("")));
+	g_parser.add_option("current", "[filepath] latency stats of the run to check", Value(AnsiStr("")));
+	g_parser.add_option("threshold", "p99 slowdown in percent reported as a regression", Value((int)10));
+	g_parser.add_option("mincount", "labels with fewer events in either run are skipped", Value((int)20));
+
+	if(g_parser.parse(argc, argv) < 0)
+		exit(1);
+
+	AnsiStr strBaseline = g_parser.value<AnsiStr>("baseline");
+	AnsiStr strCurrent = g_parser.value<AnsiStr>("current");
+	if(strBaseline.length() == 0 || strCurrent.length() == 0) {
+		LogError("Both the baseline and the current latency stats are needed.");
+		return 1;
+	}
+
+	vector<ProfileLatency> vBase, vCur;
+	if(!Profiler::ReadLatencyStats(resolvePath(strBaseline), vBase) ||
+	   !Profiler::ReadLatencyStats(resolvePath(strCurrent), vCur))
+		return 1;
+
+	double threshold = (double)g_parser.value<int>("threshold");
+	U32 ctMinEvents = (U32)(MATHMAX(g_parser.value<int>("mincount"), 1));
+	return (compareStats(vBase, vCur, threshold, ctMinEvents) > 0) ? 2 : 0;
+}
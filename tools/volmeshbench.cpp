@@ -0,0 +1,571 @@
+/*!
+ * \brief volmeshbench - microbenchmarks of the VolMesh topology primitives on truth cubes of
+ * growing resolution. Results are written as json and two reports can be compared against a
+ * threshold to catch regressions.
+ * \author Pourya Shirazian
+ */
+#include <iostream>
+#include <fstream>
+#include <string.h>
+#include <algorithm>
+#include <tbb/task_scheduler_init.h>
+#include "base/FileDirectory.h"
+#include "base/Logger.h"
+#include "base/CmdLineParser.h"
+#include "base/Profiler.h"
+
+#include "deformable/VolMesh.h"
+#include "deformable/VolMeshSamples.h"
+
+using namespace tbb;
+using namespace PS;
+using namespace PS::MESH;
+using namespace PS::FILESTRINGUTILS;
+
+using namespace std;
+
+#define BENCH_SEED 1021
+#define BENCH_CELL_SIZE 0.2
+
+CmdLineParser g_parser;
+
+//timing of one primitive at one resolution
+struct BENCHRESULT {
+	string primitive;
+	U32 resolution;
+	U32 ops;
+	U32 repeats;
+	double bestNS;
+	double meanNS;
+
+	BENCHRESULT() {
+		resolution = ops = repeats = 0;
+		bestNS = meanNS = 0.0;
+	}
+};
+
+typedef void (*FnPrimitive)(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns);
+
+//paths are relative to the executable as in the app unless absolute
+AnsiStr resolvePath(const AnsiStr& strPath) {
+	if(strPath.length() > 0 && strPath.firstChar() == '/')
+		return strPath;
+	return ExtractFilePath(GetExePath()) + strPath;
+}
+
+double elapsedNS(const tick& t0) {
+	return (Profiler::GetTickCount() - t0).seconds() * 1.0e9;
+}
+
+//comma separated list
+vector<string> splitList(const AnsiStr& strList) {
+	vector<string> vItems;
+	string strCur;
+	for(const char* lpStr = strList.cptr(); ; lpStr++) {
+		if(*lpStr == ',' || *lpStr == 0) {
+			if(strCur.length() > 0)
+				vItems.push_back(strCur);
+			strCur.clear();
+			if(*lpStr == 0)
+				break;
+		}
+		else if(*lpStr != ' ')
+			strCur += *lpStr;
+	}
+
+	return vItems;
+}
+
+//sample count of the primitives that are cheap per call
+U32 countSamples(U32 ctAvailable) {
+	return MATHMIN((U32)g_parser.value<int>("samples"), ctAvailable);
+}
+
+//sample count of the primitives that touch the whole mesh per call
+U32 countDestructiveSamples(U32 ctAvailable) {
+	return MATHMIN((U32)g_parser.value<int>("destructivesamples"), ctAvailable);
+}
+
+//calls that touch the whole mesh stop once the time budget is spent. One call is always made.
+bool isOverBudget(const tick& t0) {
+	return elapsedNS(t0) > 1.0e9 * (double)g_parser.value<int>("budget");
+}
+
+//fresh copy for primitives that change the mesh
+VolMesh* cloneMesh(const VolMesh* lpBase) {
+	VolMesh* lpMesh = new VolMesh(*lpBase);
+	lpMesh->setVerbose(false);
+	if(g_parser.value<int>("compactgc"))
+		lpMesh->setGCPolicy(VolMesh::gcpDeferredCompaction);
+	return lpMesh;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+//primitives. Each one times its calls only and returns the number of calls made.
+void benchInsertCell(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = new VolMesh();
+	lpMesh->setVerbose(false);
+	for(U32 i=0; i < lpBase->countNodes(); i++)
+		lpMesh->insert_node(lpBase->const_nodeAt(i));
+
+	vector<U32> vElements(lpBase->countCells() * 4);
+	for(U32 i=0; i < lpBase->countCells(); i++)
+		memcpy(&vElements[i * 4], lpBase->const_cellAt(i).nodes, sizeof(U32) * 4);
+
+	ops = lpBase->countCells();
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++)
+		lpMesh->insert_cell(&vElements[i * 4]);
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+void benchEdgeHandle(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = const_cast<VolMesh*>(lpBase);
+
+	//random order so the lookups do not follow the hash layout
+	ops = countSamples(lpMesh->countEdges());
+	vector<U32> vQueries(ops * 2);
+	srand(BENCH_SEED + idxRepeat);
+	for(U32 i=0; i < ops; i++) {
+		const EDGE& e = lpMesh->const_edgeAt(rand() % lpMesh->countEdges());
+		vQueries[i * 2] = e.from;
+		vQueries[i * 2 + 1] = e.to;
+	}
+
+	U32 ctFound = 0;
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++)
+		ctFound += lpMesh->isEdgeIndex(lpMesh->edge_handle(vQueries[i * 2], vQueries[i * 2 + 1]));
+	ns = elapsedNS(t0);
+
+	if(ctFound != ops)
+		LogErrorArg2("edge_handle found %u out of %u edges.", ctFound, ops);
+}
+
+void benchFaceHandleByNodes(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = const_cast<VolMesh*>(lpBase);
+
+	ops = countSamples(lpMesh->countFaces());
+	vector<U32> vQueries(ops * 3);
+	srand(BENCH_SEED + idxRepeat);
+	for(U32 i=0; i < ops; i++) {
+		U32 nodes[3];
+		lpMesh->getFaceNodes(rand() % lpMesh->countFaces(), nodes);
+		memcpy(&vQueries[i * 3], nodes, sizeof(U32) * 3);
+	}
+
+	U32 ctFound = 0;
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++)
+		ctFound += lpMesh->isFaceIndex(lpMesh->face_handle_by_nodes(&vQueries[i * 3]));
+	ns = elapsedNS(t0);
+
+	if(ctFound != ops)
+		LogErrorArg2("face_handle_by_nodes found %u out of %u faces.", ctFound, ops);
+}
+
+void benchCutEdge(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+
+	//cut_edge appends nodes and edges so the sampled handles stay valid
+	ops = countSamples(lpMesh->countEdges());
+	vector<U32> vEdges(ops);
+	vector<double> vDist(ops);
+	srand(BENCH_SEED + idxRepeat);
+	for(U32 i=0; i < ops; i++) {
+		vEdges[i] = rand() % lpMesh->countEdges();
+		const EDGE& e = lpMesh->const_edgeAt(vEdges[i]);
+		vDist[i] = 0.5 * (lpMesh->const_nodeAt(e.to).pos - lpMesh->const_nodeAt(e.from).pos).length();
+	}
+
+	//an edge is cut once
+	std::sort(vEdges.begin(), vEdges.end());
+	vEdges.erase(std::unique(vEdges.begin(), vEdges.end()), vEdges.end());
+	ops = vEdges.size();
+
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++)
+		lpMesh->cut_edge(vEdges[i], vDist[i]);
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+//removals erase in place and shift handles so every call draws from the current range
+void benchRemoveCell(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+	ops = countDestructiveSamples(lpMesh->countCells() / 2);
+
+	srand(BENCH_SEED + idxRepeat);
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++) {
+		lpMesh->remove_cell(rand() % lpMesh->countCells());
+		if(isOverBudget(t0)) {
+			ops = i + 1;
+			break;
+		}
+	}
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+void benchRemoveFace(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+	ops = countDestructiveSamples(lpMesh->countFaces() / 2);
+
+	srand(BENCH_SEED + idxRepeat);
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++) {
+		lpMesh->remove_face(rand() % lpMesh->countFaces());
+		if(isOverBudget(t0)) {
+			ops = i + 1;
+			break;
+		}
+	}
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+void benchRemoveEdge(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+	ops = countDestructiveSamples(lpMesh->countEdges() / 2);
+
+	srand(BENCH_SEED + idxRepeat);
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++) {
+		lpMesh->remove_edge(rand() % lpMesh->countEdges());
+		if(isOverBudget(t0)) {
+			ops = i + 1;
+			break;
+		}
+	}
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+void benchRemoveNode(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+	ops = countDestructiveSamples(lpMesh->countNodes() / 2);
+
+	srand(BENCH_SEED + idxRepeat);
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++) {
+		lpMesh->remove_node(rand() % lpMesh->countNodes());
+		if(isOverBudget(t0)) {
+			ops = i + 1;
+			break;
+		}
+	}
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+//one collection of a batch of scheduled cells
+void benchGarbageCollection(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+	U32 ctRemove = countDestructiveSamples(lpMesh->countCells() / 2);
+
+	vector<U32> vCells(lpMesh->countCells());
+	for(U32 i=0; i < vCells.size(); i++)
+		vCells[i] = i;
+	srand(BENCH_SEED + idxRepeat);
+	for(U32 i=0; i < ctRemove; i++) {
+		std::swap(vCells[i], vCells[i + rand() % (vCells.size() - i)]);
+		lpMesh->schedule_remove_cell(vCells[i]);
+	}
+
+	ops = 1;
+	tick t0 = Profiler::GetTickCount();
+	lpMesh->garbage_collection();
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+//labels every part from scratch on a fresh copy
+void benchGetDisjointParts(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = cloneMesh(lpBase);
+	vector<vector<U32> > vCellGroups;
+
+	ops = 1;
+	tick t0 = Profiler::GetTickCount();
+	lpMesh->get_disjoint_parts(vCellGroups);
+	ns = elapsedNS(t0);
+
+	SAFE_DELETE(lpMesh);
+}
+
+void benchGetNodeIncidentEdges(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	ops = countSamples(lpBase->countNodes());
+	vector<U32> vNodes(ops);
+	srand(BENCH_SEED + idxRepeat);
+	for(U32 i=0; i < ops; i++)
+		vNodes[i] = rand() % lpBase->countNodes();
+
+	vector<U32> vEdges;
+	U64 ctEdges = 0;
+	tick t0 = Profiler::GetTickCount();
+	for(U32 i=0; i < ops; i++)
+		ctEdges += lpBase->getNodeIncidentEdges(vNodes[i], vEdges);
+	ns = elapsedNS(t0);
+
+	if(ctEdges == 0)
+		LogError("getNodeIncidentEdges found no edges.");
+}
+
+//whole mesh displacement. Odd repeats move the nodes back.
+void benchDisplace(const VolMesh* lpBase, U32 idxRepeat, U32& ops, double& ns) {
+	VolMesh* lpMesh = const_cast<VolMesh*>(lpBase);
+	double sign = (idxRepeat % 2 == 0) ? 1.0 : -1.0;
+
+	vector<double> vU(lpMesh->countNodes() * 3);
+	for(U32 i=0; i < vU.size(); i++)
+		vU[i] = sign * 0.001 * BENCH_CELL_SIZE * (double)(i % 7);
+
+	ops = 1;
+	tick t0 = Profiler::GetTickCount();
+	lpMesh->displace(vU.size(), &vU[0]);
+	ns = elapsedNS(t0);
+}
+
+struct PRIMITIVE {
+	const char* name;
+	FnPrimitive fn;
+};
+
+//in run order. displace moves the shared mesh so it runs last.
+static const PRIMITIVE g_primitives[] = {
+	{"insert_cell", benchInsertCell},
+	{"edge_handle", benchEdgeHandle},
+	{"face_handle_by_nodes", benchFaceHandleByNodes},
+	{"getNodeIncidentEdges", benchGetNodeIncidentEdges},
+	{"cut_edge", benchCutEdge},
+	{"remove_cell", benchRemoveCell},
+	{"remove_face", benchRemoveFace},
+	{"remove_edge", benchRemoveEdge},
+	{"remove_node", benchRemoveNode},
+	{"garbage_collection", benchGarbageCollection},
+	{"get_disjoint_parts", benchGetDisjointParts},
+	{"displace", benchDisplace}
+};
+
+static const U32 g_ctPrimitives = sizeof(g_primitives) / sizeof(g_primitives[0]);
+
+///////////////////////////////////////////////////////////////////////////////////
+void writeResult(ostream& out, const BENCHRESULT& r, const VolMesh* lpBase) {
+	out << "\t\t{\"primitive\": \"" << r.primitive << "\", \"resolution\": " << r.resolution;
+	out << ", \"nodes\": " << lpBase->countNodes() << ", \"edges\": " << lpBase->countEdges();
+	out << ", \"faces\": " << lpBase->countFaces() << ", \"cells\": " << lpBase->countCells();
+	out << ", \"ops\": " << r.ops << ", \"repeats\": " << r.repeats;
+	out << ", \"best_ns_per_op\": " << r.bestNS << ", \"mean_ns_per_op\": " << r.meanNS << "}";
+}
+
+/*!
+ * reads the results of a report written by this tool. One result per line is expected so
+ * this is not a general json reader.
+ */
+bool readReport(const AnsiStr& strPath, vector<BENCHRESULT>& vResults) {
+	ifstream ifs(strPath.cptr());
+	if(!ifs.is_open()) {
+		LogErrorArg1("Unable to open report: %s", strPath.cptr());
+		return false;
+	}
+
+	vResults.resize(0);
+	string strLine;
+	while(std::getline(ifs, strLine)) {
+		const char* lpPrimitive = strstr(strLine.c_str(), "\"primitive\": \"");
+		const char* lpBest = strstr(strLine.c_str(), "\"best_ns_per_op\": ");
+		const char* lpMean = strstr(strLine.c_str(), "\"mean_ns_per_op\": ");
+		const char* lpOps = strstr(strLine.c_str(), "\"ops\": ");
+		if(lpPrimitive == NULL || lpBest == NULL || lpMean == NULL || lpOps == NULL)
+			continue;
+
+		BENCHRESULT r;
+		char name[128];
+		if(sscanf(lpPrimitive, "\"primitive\": \"%127[^\"]\", \"resolution\": %u", name, &r.resolution) != 2)
+			continue;
+		r.primitive = name;
+		sscanf(lpOps, "\"ops\": %u, \"repeats\": %u", &r.ops, &r.repeats);
+		sscanf(lpBest, "\"best_ns_per_op\": %lf", &r.bestNS);
+		sscanf(lpMean, "\"mean_ns_per_op\": %lf", &r.meanNS);
+		vResults.push_back(r);
+	}
+
+	return true;
+}
+
+/*!
+ * compares the best times of the results both reports have.
+ * @return number of results slower than the baseline by more than the threshold percent
+ */
+int compareReports(const vector<BENCHRESULT>& vBase, const vector<BENCHRESULT>& vCur, double threshold) {
+	int ctRegressions = 0;
+	U32 ctMatched = 0;
+
+	printf("%-24s %6s %14s %14s %9s\n", "primitive", "res", "base ns/op", "cur ns/op", "change");
+	for(U32 i=0; i < vCur.size(); i++) {
+		const BENCHRESULT& cur = vCur[i];
+		for(U32 j=0; j < vBase.size(); j++) {
+			const BENCHRESULT& base = vBase[j];
+			if(base.primitive != cur.primitive || base.resolution != cur.resolution)
+				continue;
+
+			double change = (base.bestNS > 0.0) ? 100.0 * (cur.bestNS - base.bestNS) / base.bestNS : 0.0;
+			bool isRegression = (change > threshold);
+			if(isRegression)
+				ctRegressions++;
+			ctMatched++;
+
+			printf("%-24s %6u %14.1f %14.1f %+8.1f%%%s\n", cur.primitive.c_str(), cur.resolution,
+					base.bestNS, cur.bestNS, change, isRegression ? " REGRESSION" : "");
+			break;
+		}
+	}
+
+	printf("compared %u results. %d slower than %.1f%%.\n", ctMatched, ctRegressions, threshold);
+	return ctRegressions;
+}
+
+//runs the selected primitives on a cube of the given resolution
+bool runResolution(ostream& out, U32 resolution, const vector<string>& vSelected, vector<BENCHRESULT>& vResults, bool& isFirst) {
+	VolMesh* lpBase = VolMeshSamples::CreateTruthCube(resolution, resolution, resolution, BENCH_CELL_SIZE);
+	if(lpBase == NULL)
+		return false;
+	lpBase->setVerbose(false);
+
+	LogInfoArg2("Resolution %u: cells %u", resolution, lpBase->countCells());
+
+	U32 ctRepeats = (U32)(MATHMAX(g_parser.value<int>("repeats"), 1));
+	for(U32 i=0; i < g_ctPrimitives; i++) {
+		const PRIMITIVE& prim = g_primitives[i];
+		if(vSelected.size() > 0 && std::find(vSelected.begin(), vSelected.end(), string(prim.name)) == vSelected.end())
+			continue;
+
+		BENCHRESULT r;
+		r.primitive = prim.name;
+		r.resolution = resolution;
+		r.repeats = ctRepeats;
+		r.bestNS = -1.0;
+
+		for(U32 k=0; k < ctRepeats; k++) {
+			U32 ops = 0;
+			double ns = 0.0;
+			prim.fn(lpBase, k, ops, ns);
+
+			double nsPerOp = (ops > 0) ? ns / (double)ops : 0.0;
+			if(r.bestNS < 0.0 || nsPerOp < r.bestNS)
+				r.bestNS = nsPerOp;
+			r.meanNS += nsPerOp / (double)ctRepeats;
+			r.ops = ops;
+		}
+
+		out << (isFirst ? "" : ",\n");
+		writeResult(out, r, lpBase);
+		isFirst = false;
+		vResults.push_back(r);
+
+		LogInfoArg3("%s: %.1f ns/op over %u ops", prim.name, r.bestNS, r.ops);
+	}
+
+	SAFE_DELETE(lpBase);
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+
+	//parser
+	g_parser.add_toggle("compactgc", "garbage collection marks removed entities and compacts the mesh in a single pass");
+	g_parser.add_option("resolutions", "[n0,n1,...] nodes per side of the truth cubes", Value(AnsiStr("10,20,40,70,100")));
+	g_parser.add_option("primitives", "[all, p0,p1,...] primitives to run", Value(AnsiStr("all")));
+	g_parser.add_option("samples", "calls per run of the primitives that are cheap per call", Value((int)100000));
+	g_parser.add_option("destructivesamples", "calls per run of the primitives that touch the whole mesh per call", Value((int)16));
+	g_parser.add_option("budget", "seconds a run of the primitives that touch the whole mesh may take", Value((int)2));
+	g_parser.add_option("repeats", "runs per primitive. The best and the mean time are reported.", Value((int)3));
+	g_parser.add_option("threads", "worker threads. 0 for all cores.", Value((int)0));
+	g_parser.add_option("output", "[filepath] json report", Value(AnsiStr("volmeshbench.json")));
+	g_parser.add_option("baseline", "[filepath] report to compare against", Value(AnsiStr("")));
+	g_parser.add_option("current", "[filepath] compares this report to the baseline instead of running", Value(AnsiStr("")));
+	g_parser.add_option("threshold", "slowdown in percent reported as a regression", Value((int)10));
+
+	if(g_parser.parse(argc, argv) < 0)
+		exit(1);
+
+	AnsiStr strBaseline = g_parser.value<AnsiStr>("baseline");
+	AnsiStr strCurrent = g_parser.value<AnsiStr>("current");
+	double threshold = (double)g_parser.value<int>("threshold");
+
+	//diff only
+	if(strCurrent.length() > 0) {
+		vector<BENCHRESULT> vBase, vCur;
+		if(strBaseline.length() == 0) {
+			LogError("A baseline report is needed to compare against.");
+			return 1;
+		}
+		if(!readReport(resolvePath(strBaseline), vBase) || !readReport(resolvePath(strCurrent), vCur))
+			return 1;
+
+		return (compareReports(vBase, vCur, threshold) > 0) ? 2 : 0;
+	}
+
+	int ctThreads = g_parser.value<int>("threads");
+	if(ctThreads <= 0)
+		ctThreads = tbb::task_scheduler_init::default_num_threads();
+	tbb::task_scheduler_init init(ctThreads);
+
+	vector<string> vSelected = splitList(g_parser.value<AnsiStr>("primitives"));
+	if(vSelected.size() == 1 && vSelected[0] == "all")
+		vSelected.resize(0);
+
+	vector<U32> vResolutions;
+	vector<string> vItems = splitList(g_parser.value<AnsiStr>("resolutions"));
+	for(U32 i=0; i < vItems.size(); i++) {
+		U32 res = (U32)atoi(vItems[i].c_str());
+		if(res >= 2)
+			vResolutions.push_back(res);
+	}
+
+	if(vResolutions.size() == 0) {
+		LogError("No valid resolutions.");
+		return 1;
+	}
+
+	AnsiStr strOutput = resolvePath(g_parser.value<AnsiStr>("output"));
+	ofstream out(strOutput.cptr());
+	if(!out.is_open()) {
+		LogErrorArg1("Unable to write the report to: %s", strOutput.cptr());
+		return 1;
+	}
+
+	out << "{\"benchmark\": \"volmeshbench\", \"threads\": " << ctThreads;
+	out << ", \"compactgc\": " << (g_parser.value<int>("compactgc") ? "true" : "false") << "," << endl;
+	out << "\t\"results\": [" << endl;
+
+	vector<BENCHRESULT> vResults;
+	bool isFirst = true;
+	for(U32 i=0; i < vResolutions.size(); i++) {
+		if(!runResolution(out, vResolutions[i], vSelected, vResults, isFirst))
+			return 1;
+		out.flush();
+	}
+
+	out << endl << "\t]" << endl << "}" << endl;
+	out.close();
+	LogInfoArg1("Benchmark report written to: %s", strOutput.cptr());
+
+	//diff against the baseline
+	if(strBaseline.length() > 0) {
+		vector<BENCHRESULT> vBase;
+		if(!readReport(resolvePath(strBaseline), vBase))
+			return 1;
+		return (compareReports(vBase, vResults, threshold) > 0) ? 2 : 0;
+	}
+
+	return 0;
+}